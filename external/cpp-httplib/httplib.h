@@ -139,6 +139,7 @@ std::pair<std::string, std::string> make_range_header(uint64_t value, Args... ar
 typedef std::multimap<std::string, std::string>                Params;
 typedef std::smatch                                            Match;
 typedef std::function<bool (uint64_t current, uint64_t total)> Progress;
+typedef std::function<bool (const char *data, size_t data_length)> ContentReceiver;
 
 struct MultipartFile {
     std::string filename;
@@ -161,6 +162,10 @@ struct Request {
 
     Progress       progress;
 
+    // Client only. If set, each chunk of a chunked response body is passed
+    // here as it arrives, instead of being collected in the response body.
+    ContentReceiver content_receiver;
+
     bool has_header(const std::string &key) const;
     std::string get_header_value(const std::string &key) const;
     void set_header(const std::string &key, const std::string &val);
@@ -204,7 +209,7 @@ public:
 
 class SocketStream : public Stream {
 public:
-    SocketStream(socket_t sock);
+    SocketStream(socket_t sock, time_t read_timeout_sec = CPPHTTPLIB_KEEPALIVE_TIMEOUT_SECOND);
     virtual ~SocketStream();
 
     virtual int read(char* ptr, size_t size);
@@ -214,6 +219,7 @@ public:
 
 private:
     socket_t sock_;
+    time_t read_timeout_sec_;
 };
 
 class BufferStream : public Stream {
@@ -322,6 +328,7 @@ public:
 
     std::shared_ptr<Response> Post(const std::string &path, const std::string& body, const std::string& content_type);
     std::shared_ptr<Response> Post(const std::string &path, const Headers& headers, const std::string& body, const std::string &content_type);
+    std::shared_ptr<Response> Post(const std::string &path, const Headers& headers, const std::string& body, const std::string &content_type, ContentReceiver content_receiver);
 
     std::shared_ptr<Response> Post(const std::string &path, const Params& params);
     std::shared_ptr<Response> Post(const std::string &path, const Headers& headers, const Params& params);
@@ -337,12 +344,16 @@ public:
 
     bool send(Request& req, Response& res, const bool isRetry = false);
 
+    // How long to wait for more of the response before giving up
+    void set_read_timeout(time_t sec);
+
 protected:
     bool process_request(Stream& strm, Request& req, Response& res, bool& connection_close);
 
     const std::string host_;
     const int         port_;
     time_t            timeout_sec_;
+    time_t            read_timeout_sec_ = CPPHTTPLIB_KEEPALIVE_TIMEOUT_SECOND;
     const std::string host_and_port_;
     socket_t          opened_connection_ = INVALID_SOCKET;
     /* So we don't perform two requests on the same socket */
@@ -360,7 +371,7 @@ private:
 #ifdef CPPHTTPLIB_OPENSSL_SUPPORT
 class SSLSocketStream : public Stream {
 public:
-    SSLSocketStream(socket_t sock, SSL* ssl);
+    SSLSocketStream(socket_t sock, SSL* ssl, time_t read_timeout_sec = CPPHTTPLIB_KEEPALIVE_TIMEOUT_SECOND);
     virtual ~SSLSocketStream();
 
     virtual int read(char* ptr, size_t size);
@@ -371,6 +382,7 @@ public:
 private:
     socket_t sock_;
     SSL* ssl_;
+    time_t read_timeout_sec_;
 };
 
 class SSLServer : public Server {
@@ -620,7 +632,8 @@ inline bool read_socket(
     T callback,
     bool close,
     std::atomic<bool> &shouldStop,
-    bool keepAliveForever = false)
+    bool keepAliveForever = false,
+    time_t read_timeout_sec = CPPHTTPLIB_KEEPALIVE_TIMEOUT_SECOND)
 {
     bool ret = false;
 
@@ -661,7 +674,7 @@ inline bool read_socket(
             count--;
         }
     } else {
-        SocketStream strm(sock);
+        SocketStream strm(sock, read_timeout_sec);
         auto dummy_connection_close = false;
         ret = callback(strm, true, dummy_connection_close);
     }
@@ -1076,7 +1089,7 @@ inline bool read_content_without_length(Stream& strm, std::string& out)
     return true;
 }
 
-inline bool read_content_chunked(Stream& strm, std::string& out)
+inline bool read_content_chunked(Stream& strm, std::string& out, ContentReceiver receiver = nullptr)
 {
     const auto bufsiz = 16;
     char buf[bufsiz];
@@ -1103,7 +1116,13 @@ inline bool read_content_chunked(Stream& strm, std::string& out)
             break;
         }
 
-        out += chunk;
+        if (receiver) {
+            if (!receiver(chunk.data(), chunk.size())) {
+                return false;
+            }
+        } else {
+            out += chunk;
+        }
 
         if (!reader.getline()) {
             return false;
@@ -1122,7 +1141,7 @@ inline bool read_content_chunked(Stream& strm, std::string& out)
 }
 
 template <typename T>
-bool read_content(Stream& strm, T& x, Progress progress = Progress())
+bool read_content(Stream& strm, T& x, Progress progress = Progress(), ContentReceiver receiver = nullptr)
 {
     uint64_t bodyLen = 0;
 
@@ -1137,7 +1156,7 @@ bool read_content(Stream& strm, T& x, Progress progress = Progress())
 
         if (!strcasecmp(encoding, "chunked"))
         {
-            return read_content_chunked(strm, x.body);
+            return read_content_chunked(strm, x.body, receiver);
         }
     }
 
@@ -1660,7 +1679,8 @@ inline void Stream::write_format(const char* fmt, const Args& ...args)
 }
 
 // Socket stream implementation
-inline SocketStream::SocketStream(socket_t sock): sock_(sock)
+inline SocketStream::SocketStream(socket_t sock, time_t read_timeout_sec)
+    : sock_(sock), read_timeout_sec_(read_timeout_sec)
 {
 }
 
@@ -1676,10 +1696,8 @@ inline int SocketStream::read(char* ptr, size_t size)
 
     timeval tv;
 
-    /* TODO: We really should pass these through from the client specified timeout...
-       but it's kind of a pain to get them all the way here */
-    tv.tv_sec = CPPHTTPLIB_KEEPALIVE_TIMEOUT_SECOND;
-    tv.tv_usec = CPPHTTPLIB_KEEPALIVE_TIMEOUT_USECOND;
+    tv.tv_sec = read_timeout_sec_;
+    tv.tv_usec = 0;
 
     /* See if we've got data to read */
     auto rv = select(sock_ + 1, &fds, NULL, NULL, &tv);
@@ -2474,8 +2492,9 @@ inline bool Client::send(Request& req, Response& res, const bool isRetry)
     opened_connection_ = INVALID_SOCKET;
 
     /* If the request failed, it's possible the socket timed out,
-       let's give it one more try to make sure */
-    if (!isRetry)
+       let's give it one more try to make sure. Don't retry if we got a
+       response, and have maybe already handed part of it to the receiver */
+    if (!isRetry && !(req.content_receiver && res.status != -1))
     {
         return send(req, res, true);
     }
@@ -2557,7 +2576,7 @@ inline bool Client::process_request(Stream& strm, Request& req, Response& res, b
 
     // Body
     if (req.method != "HEAD") {
-        if (!detail::read_content(strm, res, req.progress)) {
+        if (!detail::read_content(strm, res, req.progress, req.content_receiver)) {
             return false;
         }
         if (res.get_header_value("Content-Encoding") == "gzip") {
@@ -2586,7 +2605,13 @@ inline bool Client::read_socket(socket_t sock, Request& req, Response& res)
         },
         close,
         shouldStop,
-        false);
+        false,
+        read_timeout_sec_);
+}
+
+inline void Client::set_read_timeout(time_t sec)
+{
+    read_timeout_sec_ = sec;
 }
 
 inline bool Client::is_ssl() const
@@ -2651,6 +2676,24 @@ inline std::shared_ptr<Response> Client::Post(
     return send(req, *res) ? res : nullptr;
 }
 
+inline std::shared_ptr<Response> Client::Post(
+    const std::string &path, const Headers& headers, const std::string& body, const std::string &content_type,
+    ContentReceiver content_receiver)
+{
+    Request req;
+    req.method = "POST";
+    req.headers = headers;
+    req.path = path;
+
+    req.headers.emplace("Content-Type", content_type);
+    req.body = body;
+    req.content_receiver = content_receiver;
+
+    auto res = std::make_shared<Response>();
+
+    return send(req, *res) ? res : nullptr;
+}
+
 inline std::shared_ptr<Response> Client::Post(const std::string &path, const Params& params)
 {
     return Post(path, Headers(), params);
@@ -2743,7 +2786,8 @@ inline bool read_socket_ssl(
     T callback,
     bool close,
     std::atomic<bool> &shouldStop,
-    bool keepAliveForever = false)
+    bool keepAliveForever = false,
+    time_t read_timeout_sec = CPPHTTPLIB_KEEPALIVE_TIMEOUT_SECOND)
 {
     SSL* ssl = nullptr;
     {
@@ -2801,7 +2845,7 @@ inline bool read_socket_ssl(
             count--;
         }
     } else {
-        SSLSocketStream strm(sock, ssl);
+        SSLSocketStream strm(sock, ssl, read_timeout_sec);
         auto dummy_connection_close = false;
         ret = callback(strm, true, dummy_connection_close);
     }
@@ -2834,8 +2878,8 @@ static SSLInit sslinit_;
 } // namespace detail
 
 // SSL socket stream implementation
-inline SSLSocketStream::SSLSocketStream(socket_t sock, SSL* ssl)
-    : sock_(sock), ssl_(ssl)
+inline SSLSocketStream::SSLSocketStream(socket_t sock, SSL* ssl, time_t read_timeout_sec)
+    : sock_(sock), ssl_(ssl), read_timeout_sec_(read_timeout_sec)
 {
 }
 
@@ -2845,6 +2889,12 @@ inline SSLSocketStream::~SSLSocketStream()
 
 inline int SSLSocketStream::read(char* ptr, size_t size)
 {
+    /* Only wait on the socket if OpenSSL hasn't already got data buffered */
+    if (SSL_pending(ssl_) == 0 && detail::select_read(sock_, read_timeout_sec_, 0) <= 0)
+    {
+        return -1;
+    }
+
     return SSL_read(ssl_, ptr, size);
 }
 
@@ -2957,7 +3007,8 @@ inline bool SSLClient::read_socket(socket_t sock, Request& req, Response& res)
         },
         close,
         shouldStop,
-        false);
+        false,
+        read_timeout_sec_);
 }
 #endif
 
@@ -8,7 +8,9 @@
 #include "IReadBatch.h"
 #include "IWriteBatch.h"
 
+#include <functional>
 #include <string>
+#include <string_view>
 #include <system_error>
 
 namespace CryptoNote
@@ -64,5 +66,12 @@ namespace CryptoNote
         virtual std::error_code read(IReadBatch &batch) = 0;
 
         virtual std::error_code readThreadSafe(IReadBatch &batch) = 0;
+
+        /* Calls the callback with every key starting with the prefix, and its
+           value, in key order. Writes made from the callback aren't seen by
+           the scan. For migrating old schemes, it isn't quick. */
+        virtual std::error_code forEach(
+            const std::string &keyPrefix,
+            const std::function<void(std::string_view key, std::string_view value)> &callback) = 0;
     };
 } // namespace CryptoNote
@@ -6,6 +6,7 @@
 #pragma once
 
 #include <string>
+#include <string_view>
 #include <utility>
 #include <vector>
 
@@ -16,7 +17,10 @@ namespace CryptoNote
       public:
         virtual std::vector<std::string> getRawKeys() const = 0;
 
-        virtual void submitRawResult(const std::vector<std::string> &values, const std::vector<bool> &resultStates) = 0;
+        /* The values point into the DB's own buffers, and are only valid until
+           this returns */
+        virtual void
+            submitRawResult(const std::vector<std::string_view> &values, const std::vector<bool> &resultStates) = 0;
     };
 
 } // namespace CryptoNote
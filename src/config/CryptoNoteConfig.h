@@ -321,6 +321,8 @@ namespace CryptoNote
 
         const char CRYPTONOTE_POOLDATA_FILENAME[] = "poolstate.bin";
 
+        const char CRYPTONOTE_BLOCK_METADATA_DIRNAME[] = "blockmetadata";
+
         const char P2P_NET_DATA_FILENAME[] = "p2pstate.bin";
 
         const char MINER_CONFIG_FILE_NAME[] = "miner_conf.json";
@@ -359,7 +361,16 @@ namespace CryptoNote
 
     const size_t BLOCKS_IDS_SYNCHRONIZING_DEFAULT_COUNT = 10'000; // by default, blocks ids count in synchronizing
     const uint64_t BLOCKS_SYNCHRONIZING_DEFAULT_COUNT = 100; // by default, blocks count in blocks downloading
+    const uint64_t BLOCKS_SYNCHRONIZING_MIN_COUNT = 10; // smallest request made to a slow peer
+    const uint64_t BLOCKS_SYNCHRONIZING_MAX_AHEAD = 2'000; // how far ahead of the chain we download blocks
+    const uint64_t BLOCKS_SYNCHRONIZING_TIMEOUT = 30; // seconds before a block is requested from another peer
+    const uint64_t BLOCKS_SYNCHRONIZING_MAX_BUFFERED_COUNT = 4'000; // downloaded blocks held waiting for the chain
+    const uint64_t BLOCKS_SYNCHRONIZING_MAX_BUFFERED_SIZE = 256 * 1024 * 1024; // bytes of them
+    const size_t WALLET_SYNC_CACHE_MAX_SIZE = 256 * 1024 * 1024; // bytes of recently requested blocks kept for wallet sync
     const size_t COMMAND_RPC_GET_BLOCKS_FAST_MAX_COUNT = 1'000;
+    const uint64_t BLOCK_TEMPLATE_POOL_REFRESH_INTERVAL = 2; // seconds a template is reused while only the pool changes
+    const uint64_t RPC_BLOCKCHAIN_UPDATE_DEFAULT_TIMEOUT = 10; // seconds /block/template/wait waits for a change
+    const uint64_t RPC_BLOCKCHAIN_UPDATE_MAX_TIMEOUT = 60; // longest wait a client can ask /block/template/wait for
 
     const int P2P_DEFAULT_PORT = 11'897;
 
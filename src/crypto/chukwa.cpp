@@ -0,0 +1,172 @@
+// Copyright (c) 2019, The TurtleCoin Developers
+//
+// Please see the included LICENSE file for more information.
+
+///////////////////////////
+#include <crypto/chukwa.h>
+///////////////////////////
+
+#include <cstdlib>
+#include <cstring>
+#include <crypto/hash.h>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+
+#if defined(__linux__)
+#include <sys/mman.h>
+#endif
+
+namespace Crypto
+{
+    namespace
+    {
+        std::once_flag argon2ImplementationSelected;
+
+        const size_t HUGE_PAGE_SIZE = 2 * 1024 * 1024;
+    }
+
+    ChukwaContext::ChukwaContext()
+    {
+        /* Big enough for every variant we know about, so the miner never has
+           to reallocate when the block version changes */
+        allocate(argon2_memory_size(CHUKWA_MEMORY_V2, CHUKWA_THREADS_V2));
+    }
+
+    ChukwaContext::~ChukwaContext()
+    {
+        release();
+    }
+
+    void ChukwaContext::allocate(const size_t size)
+    {
+        release();
+
+#if defined(__linux__)
+        /* Huge page mappings have to be a whole number of huge pages */
+        const size_t hugeSize = (size + HUGE_PAGE_SIZE - 1) / HUGE_PAGE_SIZE * HUGE_PAGE_SIZE;
+
+        void *memory =
+            mmap(nullptr, hugeSize, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+
+        if (memory != MAP_FAILED)
+        {
+            m_size = hugeSize;
+            m_hugePages = true;
+        }
+        else
+        {
+            memory = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+
+            if (memory == MAP_FAILED)
+            {
+                throw std::bad_alloc();
+            }
+
+#if defined(MADV_HUGEPAGE)
+            /* No reserved huge pages - transparent ones are the next best
+               thing, if they're turned on */
+            madvise(memory, size, MADV_HUGEPAGE);
+#endif
+
+            m_size = size;
+        }
+
+        m_memory = static_cast<uint8_t *>(memory);
+        m_mapped = true;
+#else
+        m_memory = static_cast<uint8_t *>(std::malloc(size));
+
+        if (m_memory == nullptr)
+        {
+            throw std::bad_alloc();
+        }
+
+        m_size = size;
+#endif
+
+        /* Touch every page now, rather than page faulting during the first
+           hash */
+        std::memset(m_memory, 0, m_size);
+    }
+
+    void ChukwaContext::release()
+    {
+        if (m_memory == nullptr)
+        {
+            return;
+        }
+
+#if defined(__linux__)
+        if (m_mapped)
+        {
+            munmap(m_memory, m_size);
+        }
+#else
+        std::free(m_memory);
+#endif
+
+        m_memory = nullptr;
+        m_size = 0;
+        m_mapped = false;
+        m_hugePages = false;
+    }
+
+    bool ChukwaContext::usingHugePages() const
+    {
+        return m_hugePages;
+    }
+
+    void ChukwaContext::hashV1(const void *data, size_t length, Hash &hash)
+    {
+        argon2Hash(data, length, hash, CHUKWA_ITERS_V1, CHUKWA_MEMORY_V1, CHUKWA_THREADS_V1);
+    }
+
+    void ChukwaContext::hashV2(const void *data, size_t length, Hash &hash)
+    {
+        argon2Hash(data, length, hash, CHUKWA_ITERS_V2, CHUKWA_MEMORY_V2, CHUKWA_THREADS_V2);
+    }
+
+    void ChukwaContext::argon2Hash(
+        const void *data,
+        size_t length,
+        Hash &hash,
+        const uint32_t iterations,
+        const uint32_t memory,
+        const uint32_t threads)
+    {
+        std::call_once(argon2ImplementationSelected, [] { argon2_select_impl(NULL, NULL); });
+
+        const size_t required = argon2_memory_size(memory, threads);
+
+        if (required > m_size)
+        {
+            allocate(required);
+        }
+
+        uint8_t salt[CHUKWA_SALTLEN];
+        std::memcpy(salt, data, sizeof(salt));
+
+        argon2_context context {};
+
+        context.out = hash.data;
+        context.outlen = CHUKWA_HASHLEN;
+        context.pwd = static_cast<uint8_t *>(const_cast<void *>(data));
+        context.pwdlen = static_cast<uint32_t>(length);
+        context.salt = salt;
+        context.saltlen = CHUKWA_SALTLEN;
+        context.t_cost = iterations;
+        context.m_cost = memory;
+        context.lanes = threads;
+        context.threads = threads;
+        context.version = ARGON2_VERSION_13;
+        context.flags = ARGON2_DEFAULT_FLAGS;
+
+        const int result = argon2_ctx_mem(&context, Argon2_id, m_memory, m_size);
+
+        if (result != ARGON2_OK)
+        {
+            throw std::runtime_error("Argon2 hashing failed: " + std::string(argon2_error_message(result)));
+        }
+    }
+} // namespace Crypto
@@ -0,0 +1,62 @@
+// Copyright (c) 2019, The TurtleCoin Developers
+//
+// Please see the included LICENSE file for more information.
+
+#pragma once
+
+#include <CryptoTypes.h>
+#include <cstddef>
+#include <cstdint>
+
+namespace Crypto
+{
+    /* Holds on to the Argon2 work area between hashes, so hashing over and
+       over, like the miner does, doesn't allocate, fault in, and wipe a
+       fresh megabyte of memory for every nonce.
+
+       The memory is pre-faulted when it is allocated, and on Linux we ask
+       for huge pages, falling back to normal pages if none are free.
+
+       Not thread safe - use one per thread. */
+    class ChukwaContext
+    {
+      public:
+        ChukwaContext();
+
+        ~ChukwaContext();
+
+        ChukwaContext(const ChukwaContext &) = delete;
+
+        ChukwaContext &operator=(const ChukwaContext &) = delete;
+
+        /* Same results as chukwa_slow_hash_v1() and chukwa_slow_hash_v2()
+           in hash.h */
+        void hashV1(const void *data, size_t length, Hash &hash);
+
+        void hashV2(const void *data, size_t length, Hash &hash);
+
+        /* Whether the work area is backed by huge pages */
+        bool usingHugePages() const;
+
+      private:
+        void argon2Hash(
+            const void *data,
+            size_t length,
+            Hash &hash,
+            const uint32_t iterations,
+            const uint32_t memory,
+            const uint32_t threads);
+
+        void allocate(const size_t size);
+
+        void release();
+
+        uint8_t *m_memory = nullptr;
+
+        size_t m_size = 0;
+
+        bool m_mapped = false;
+
+        bool m_hugePages = false;
+    };
+} // namespace Crypto
@@ -1321,17 +1321,34 @@ B is the Ed25519 base point (x,4/5) with x positive.
 */
 
 void ge_double_scalarmult_base_vartime(ge_p2 *r, const unsigned char *a, const ge_p3 *A, const unsigned char *b)
+{
+    ge_dsmp Ai; /* A, 3A, 5A, 7A, 9A, 11A, 13A, 15A */
+
+    ge_dsm_precomp(Ai, A);
+
+    ge_double_scalarmult_base_precomp_vartime(r, a, Ai, b);
+}
+
+/*
+Same as ge_double_scalarmult_base_vartime, but A has already been precomputed
+with ge_dsm_precomp, so callers verifying many signatures against the same
+key only pay for the precomputation once.
+*/
+
+void ge_double_scalarmult_base_precomp_vartime(
+    ge_p2 *r,
+    const unsigned char *a,
+    const ge_dsmp Ai,
+    const unsigned char *b)
 {
     signed char aslide[256];
     signed char bslide[256];
-    ge_dsmp Ai; /* A, 3A, 5A, 7A, 9A, 11A, 13A, 15A */
     ge_p1p1 t;
     ge_p3 u;
     int i;
 
     slide(aslide, a);
     slide(bslide, b);
-    ge_dsm_precomp(Ai, A);
 
     ge_p2_0(r);
 
@@ -2236,11 +2253,25 @@ static void ge_cached_cmov(ge_cached *t, const ge_cached *u, unsigned char b)
 }
 
 /* Assumes that a[31] <= 127 */
-void ge_scalarmult(ge_p2 *r, const unsigned char *a, const ge_p3 *A)
+void ge_scalarmult_precomp(ge_scalarmult_table Ai, const ge_p3 *A)
+{
+    int i;
+    ge_p1p1 t;
+    ge_p3 u;
+
+    ge_p3_to_cached(&Ai[0], A);
+    for (i = 0; i < 7; i++)
+    {
+        ge_add(&t, A, &Ai[i]);
+        ge_p1p1_to_p3(&u, &t);
+        ge_p3_to_cached(&Ai[i + 1], &u);
+    }
+}
+
+void ge_scalarmult_with_precomp(ge_p2 *r, const unsigned char *a, const ge_scalarmult_table Ai)
 {
     signed char e[64];
     int carry, carry2, i;
-    ge_cached Ai[8]; /* 1 * A, 2 * A, ..., 8 * A */
     ge_p1p1 t;
     ge_p3 u;
 
@@ -2258,14 +2289,6 @@ void ge_scalarmult(ge_p2 *r, const unsigned char *a, const ge_p3 *A)
     e[62] = carry - (carry2 << 4); /* -8..7 */
     e[63] = carry2; /* 0..8 */
 
-    ge_p3_to_cached(&Ai[0], A);
-    for (i = 0; i < 7; i++)
-    {
-        ge_add(&t, A, &Ai[i]);
-        ge_p1p1_to_p3(&u, &t);
-        ge_p3_to_cached(&Ai[i + 1], &u);
-    }
-
     ge_p2_0(r);
     for (i = 63; i >= 0; i--)
     {
@@ -2300,23 +2323,43 @@ void ge_scalarmult(ge_p2 *r, const unsigned char *a, const ge_p3 *A)
     }
 }
 
+void ge_scalarmult(ge_p2 *r, const unsigned char *a, const ge_p3 *A)
+{
+    ge_scalarmult_table Ai; /* 1 * A, 2 * A, ..., 8 * A */
+
+    ge_scalarmult_precomp(Ai, A);
+    ge_scalarmult_with_precomp(r, a, Ai);
+}
+
 void ge_double_scalarmult_precomp_vartime(
     ge_p2 *r,
     const unsigned char *a,
     const ge_p3 *A,
     const unsigned char *b,
     const ge_dsmp Bi)
+{
+    ge_dsmp Ai; /* A, 3A, 5A, 7A, 9A, 11A, 13A, 15A */
+
+    ge_dsm_precomp(Ai, A);
+
+    ge_double_scalarmult_precomp_vartime2(r, a, Ai, b, Bi);
+}
+
+void ge_double_scalarmult_precomp_vartime2(
+    ge_p2 *r,
+    const unsigned char *a,
+    const ge_dsmp Ai,
+    const unsigned char *b,
+    const ge_dsmp Bi)
 {
     signed char aslide[256];
     signed char bslide[256];
-    ge_dsmp Ai; /* A, 3A, 5A, 7A, 9A, 11A, 13A, 15A */
     ge_p1p1 t;
     ge_p3 u;
     int i;
 
     slide(aslide, a);
     slide(bslide, b);
-    ge_dsm_precomp(Ai, A);
 
     ge_p2_0(r);
 
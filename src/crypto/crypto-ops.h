@@ -60,6 +60,8 @@ void ge_dsm_precomp(ge_dsmp r, const ge_p3 *s);
 
 void ge_double_scalarmult_base_vartime(ge_p2 *, const unsigned char *, const ge_p3 *, const unsigned char *);
 
+void ge_double_scalarmult_base_precomp_vartime(ge_p2 *, const unsigned char *, const ge_dsmp, const unsigned char *);
+
 /* From ge_frombytes.c, modified */
 
 extern const fe fe_sqrtm1;
@@ -116,6 +118,14 @@ void sc_reduce(unsigned char *);
 
 void ge_scalarmult(ge_p2 *, const unsigned char *, const ge_p3 *);
 
+/* 1 * A, 2 * A, ..., 8 * A - lets several scalars be multiplied by the same
+   point without building the table each time */
+typedef ge_cached ge_scalarmult_table[8];
+
+void ge_scalarmult_precomp(ge_scalarmult_table, const ge_p3 *);
+
+void ge_scalarmult_with_precomp(ge_p2 *, const unsigned char *, const ge_scalarmult_table);
+
 void ge_double_scalarmult_precomp_vartime(
     ge_p2 *,
     const unsigned char *,
@@ -123,6 +133,13 @@ void ge_double_scalarmult_precomp_vartime(
     const unsigned char *,
     const ge_dsmp);
 
+void ge_double_scalarmult_precomp_vartime2(
+    ge_p2 *,
+    const unsigned char *,
+    const ge_dsmp,
+    const unsigned char *,
+    const ge_dsmp);
+
 int ge_check_subgroup_precomp_vartime(const ge_dsmp);
 
 void ge_mul8(ge_p1p1 *, const ge_p2 *);
@@ -18,6 +18,7 @@
 #include <cstdlib>
 #include <cstring>
 #include <memory>
+#include <unordered_map>
 #include <vector>
 
 namespace Crypto
@@ -704,6 +705,208 @@ namespace Crypto
         return sc_isnonzero(reinterpret_cast<unsigned char *>(&h)) == 0;
     }
 
+    bool crypto_ops::generateKeyDerivations(
+        const PublicKey &txPublicKey,
+        const std::vector<SecretKey> &privateViewKeys,
+        std::vector<KeyDerivation> &derivations)
+    {
+        ge_p3 point;
+
+        if (ge_frombytes_vartime(&point, reinterpret_cast<const unsigned char *>(&txPublicKey)) != 0)
+        {
+            return false;
+        }
+
+        ge_scalarmult_table table;
+
+        ge_scalarmult_precomp(table, &point);
+
+        derivations.resize(privateViewKeys.size());
+
+        for (size_t i = 0; i < privateViewKeys.size(); i++)
+        {
+            ge_p2 point2;
+            ge_p1p1 point3;
+
+            assert(sc_check(reinterpret_cast<const unsigned char *>(&privateViewKeys[i])) == 0);
+
+            ge_scalarmult_with_precomp(&point2, reinterpret_cast<const unsigned char *>(&privateViewKeys[i]), table);
+            ge_mul8(&point3, &point2);
+            ge_p1p1_to_p2(&point2, &point3);
+            ge_tobytes(reinterpret_cast<unsigned char *>(&derivations[i]), &point2);
+        }
+
+        return true;
+    }
+
+    bool crypto_ops::underivePublicKeys(
+        const std::vector<KeyDerivation> &derivations,
+        const size_t outputIndex,
+        const PublicKey &outputKey,
+        std::vector<PublicKey> &spendKeys)
+    {
+        ge_p3 point1;
+
+        if (ge_frombytes_vartime(&point1, reinterpret_cast<const unsigned char *>(&outputKey)) != 0)
+        {
+            return false;
+        }
+
+        spendKeys.resize(derivations.size());
+
+        for (size_t i = 0; i < derivations.size(); i++)
+        {
+            EllipticCurveScalar scalar;
+            ge_p3 point2;
+            ge_cached point3;
+            ge_p1p1 point4;
+            ge_p2 point5;
+
+            derivation_to_scalar(derivations[i], outputIndex, scalar);
+            ge_scalarmult_base(&point2, reinterpret_cast<unsigned char *>(&scalar));
+            ge_p3_to_cached(&point3, &point2);
+            ge_sub(&point4, &point1, &point3);
+            ge_p1p1_to_p2(&point5, &point4);
+            ge_tobytes(reinterpret_cast<unsigned char *>(&spendKeys[i]), &point5);
+        }
+
+        return true;
+    }
+
+    std::tuple<bool, size_t> crypto_ops::checkRingSignatures(const std::vector<RingSignatureBatchEntry> &entries)
+    {
+        /* Decompressed and precomputed data for a single ring member. Decoys are
+         * frequently shared between the inputs of a block, so we only pay for the
+         * decompression, hash_to_ec and the two precomputation tables once per
+         * distinct key, rather than once per ring it appears in. */
+        struct PrecomputedKey
+        {
+            bool valid = false;
+
+            /* P, 3P, 5P, ... 15P */
+            ge_dsmp key;
+
+            /* Hp(P), 3Hp(P), ... 15Hp(P) */
+            ge_dsmp hashedKey;
+        };
+
+        std::unordered_map<PublicKey, std::unique_ptr<PrecomputedKey>> keyCache;
+
+        const auto getPrecomputedKey = [&keyCache](const PublicKey &publicKey) -> const PrecomputedKey &
+        {
+            auto &cached = keyCache[publicKey];
+
+            if (!cached)
+            {
+                cached = std::make_unique<PrecomputedKey>();
+
+                ge_p3 point;
+
+                if (ge_frombytes_vartime(&point, reinterpret_cast<const unsigned char *>(&publicKey)) == 0)
+                {
+                    ge_dsm_precomp(cached->key, &point);
+
+                    hash_to_ec(publicKey, point);
+
+                    ge_dsm_precomp(cached->hashedKey, &point);
+
+                    cached->valid = true;
+                }
+            }
+
+            return *cached;
+        };
+
+        /* Reused between entries - alloca() in a loop would grow the stack with every ring */
+        std::vector<unsigned char> commitment;
+
+        for (size_t index = 0; index < entries.size(); index++)
+        {
+            const auto &entry = entries[index];
+
+            const auto &pubs = entry.publicKeys;
+
+            const auto &signatures = entry.signatures;
+
+            if (signatures.size() < pubs.size())
+            {
+                return {false, index};
+            }
+
+            ge_p3 image_unp;
+
+            ge_dsmp image_pre;
+
+            EllipticCurveScalar sum, h;
+
+            commitment.resize(rs_comm_size(pubs.size()));
+
+            rs_comm *const buf = reinterpret_cast<rs_comm *>(commitment.data());
+
+            if (ge_frombytes_vartime(&image_unp, reinterpret_cast<const unsigned char *>(&entry.keyImage)) != 0)
+            {
+                return {false, index};
+            }
+
+            ge_dsm_precomp(image_pre, &image_unp);
+
+            if (ge_check_subgroup_precomp_vartime(image_pre) != 0)
+            {
+                return {false, index};
+            }
+
+            sc_0(reinterpret_cast<unsigned char *>(&sum));
+
+            buf->h = entry.prefixHash;
+
+            for (size_t i = 0; i < pubs.size(); i++)
+            {
+                ge_p2 tmp2;
+
+                const unsigned char *c = reinterpret_cast<const unsigned char *>(&signatures[i]);
+                const unsigned char *r = c + 32;
+
+                if (sc_check(c) != 0 || sc_check(r) != 0)
+                {
+                    return {false, index};
+                }
+
+                const PrecomputedKey &key = getPrecomputedKey(pubs[i]);
+
+                if (!key.valid)
+                {
+                    return {false, index};
+                }
+
+                /* L = r * G + c * P */
+                ge_double_scalarmult_base_precomp_vartime(&tmp2, c, key.key, r);
+
+                ge_tobytes(reinterpret_cast<unsigned char *>(&buf->ab[i].a), &tmp2);
+
+                /* R = r * Hp(P) + c * I */
+                ge_double_scalarmult_precomp_vartime2(&tmp2, r, key.hashedKey, c, image_pre);
+
+                ge_tobytes(reinterpret_cast<unsigned char *>(&buf->ab[i].b), &tmp2);
+
+                sc_add(reinterpret_cast<unsigned char *>(&sum), reinterpret_cast<unsigned char *>(&sum), c);
+            }
+
+            hash_to_scalar(buf, rs_comm_size(pubs.size()), h);
+
+            sc_sub(
+                reinterpret_cast<unsigned char *>(&h),
+                reinterpret_cast<unsigned char *>(&h),
+                reinterpret_cast<unsigned char *>(&sum));
+
+            if (sc_isnonzero(reinterpret_cast<unsigned char *>(&h)) != 0)
+            {
+                return {false, index};
+            }
+        }
+
+        return {true, 0};
+    }
+
     void crypto_ops::generateViewFromSpend(const Crypto::SecretKey &spend, Crypto::SecretKey &viewSecret)
     {
         /* If we don't need the pub key */
@@ -13,11 +13,25 @@
 #include <cstddef>
 #include <limits>
 #include <mutex>
+#include <tuple>
 #include <type_traits>
 #include <vector>
 
 namespace Crypto
 {
+    /* A single ring signature, queued up to be verified along with the rest
+     * of the ring signatures in a block by crypto_ops::checkRingSignatures */
+    struct RingSignatureBatchEntry
+    {
+        Hash prefixHash;
+
+        KeyImage keyImage;
+
+        std::vector<PublicKey> publicKeys;
+
+        std::vector<Signature> signatures;
+    };
+
     class crypto_ops
     {
         crypto_ops();
@@ -189,6 +203,30 @@ namespace Crypto
             const std::vector<PublicKey> pubs,
             const std::vector<Signature> signatures);
 
+        /* Verifies a batch of ring signatures, sharing the key decompression
+         * and precomputation of ring members which appear in more than one
+         * ring. Returns whether every signature is valid, and if not, the
+         * index of the first entry which failed. */
+        static std::tuple<bool, size_t> checkRingSignatures(const std::vector<RingSignatureBatchEntry> &entries);
+
+        /* Generates the key derivations of one transaction public key with
+         * several private view keys, decompressing the public key and
+         * building its table of multiples only once. Returns false if the
+         * public key is invalid. */
+        static bool generateKeyDerivations(
+            const PublicKey &txPublicKey,
+            const std::vector<SecretKey> &privateViewKeys,
+            std::vector<KeyDerivation> &derivations);
+
+        /* Underives the spend key of an output with each of the key
+         * derivations, decompressing the output key only once. Returns false
+         * if the output key is invalid. */
+        static bool underivePublicKeys(
+            const std::vector<KeyDerivation> &derivations,
+            const size_t outputIndex,
+            const PublicKey &outputKey,
+            std::vector<PublicKey> &spendKeys);
+
         static void generateViewFromSpend(const Crypto::SecretKey &spend, Crypto::SecretKey &viewSecret);
 
         static void generateViewFromSpend(
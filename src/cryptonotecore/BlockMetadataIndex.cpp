@@ -0,0 +1,229 @@
+// Copyright (c) 2018-2019, The TurtleCoin Developers
+//
+// Please see the included LICENSE file for more information.
+
+//////////////////////////////////////////////
+#include <cryptonotecore/BlockMetadataIndex.h>
+//////////////////////////////////////////////
+
+#include <algorithm>
+#include <common/FileSystemShim.h>
+#include <fstream>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+
+namespace CryptoNote
+{
+    namespace
+    {
+        template<typename T>
+        std::vector<uint64_t> getRange(
+            const Common::FileMappedVector<T> &column,
+            const uint32_t startIndex,
+            const uint32_t endIndex)
+        {
+            /* Thrown the same as at() in the single block getters, rather
+               than reading past the end of the mapping */
+            if (endIndex > column.size())
+            {
+                throw std::out_of_range(
+                    "Block metadata range ends at " + std::to_string(endIndex) + ", past the "
+                    + std::to_string(column.size()) + " blocks indexed");
+            }
+
+            if (startIndex >= endIndex)
+            {
+                return {};
+            }
+
+            return std::vector<uint64_t>(column.data() + startIndex, column.data() + endIndex);
+        }
+
+        template<typename T> void truncateColumn(Common::FileMappedVector<T> &column, const uint64_t newSize)
+        {
+            while (column.size() > newSize)
+            {
+                column.pop_back();
+            }
+        }
+    } // namespace
+
+    BlockMetadataIndex::BlockMetadataIndex(const std::string &directory):
+        m_directory(directory),
+        m_cleanShutdownMarker((fs::path(directory) / "clean_shutdown").string())
+    {
+        fs::create_directories(m_directory);
+
+        /* Removed until we next shut down cleanly, so a crash while we're
+           running leaves it missing */
+        std::error_code ec;
+
+        m_wasShutdownCleanly = fs::exists(m_cleanShutdownMarker, ec);
+
+        fs::remove(m_cleanShutdownMarker, ec);
+
+        openColumn(m_timestamps, "timestamps.dat");
+        openColumn(m_blockSizes, "sizes.dat");
+        openColumn(m_cumulativeDifficulties, "difficulties.dat");
+        openColumn(m_alreadyGeneratedCoins, "coins.dat");
+        openColumn(m_alreadyGeneratedTransactions, "transactions.dat");
+
+        /* If we stopped halfway through adding a block, some columns will be
+           one longer than the others */
+        truncate(static_cast<uint32_t>(std::min(
+            {m_timestamps.size(),
+             m_blockSizes.size(),
+             m_cumulativeDifficulties.size(),
+             m_alreadyGeneratedCoins.size(),
+             m_alreadyGeneratedTransactions.size()})));
+    }
+
+    BlockMetadataIndex::~BlockMetadataIndex()
+    {
+        try
+        {
+            m_timestamps.flush();
+            m_blockSizes.flush();
+            m_cumulativeDifficulties.flush();
+            m_alreadyGeneratedCoins.flush();
+            m_alreadyGeneratedTransactions.flush();
+        }
+        catch (const std::exception &)
+        {
+            /* No marker, so it's all checked on the next start */
+            return;
+        }
+
+        std::ofstream(m_cleanShutdownMarker, std::ios::trunc);
+    }
+
+    bool BlockMetadataIndex::wasShutdownCleanly() const
+    {
+        return m_wasShutdownCleanly;
+    }
+
+    template<typename T>
+    void BlockMetadataIndex::openColumn(Common::FileMappedVector<T> &column, const std::string &filename)
+    {
+        const std::string path = (fs::path(m_directory) / filename).string();
+
+        try
+        {
+            column.open(path, Common::FileMappedVectorOpenMode::OPEN_OR_CREATE, 0);
+        }
+        catch (const std::exception &)
+        {
+            /* Damaged, it will be rebuilt from the database */
+            fs::remove(path);
+            column.open(path, Common::FileMappedVectorOpenMode::CREATE, 0);
+        }
+
+        /* Flushing each value as it's written makes adding a block several
+           syncs slower. The OS writes the pages out in its own time, and
+           anything lost is rebuilt from the database. */
+        column.setAutoFlush(false);
+    }
+
+    uint32_t BlockMetadataIndex::size() const
+    {
+        std::shared_lock<std::shared_mutex> lock(m_mutex);
+
+        return static_cast<uint32_t>(m_timestamps.size());
+    }
+
+    void BlockMetadataIndex::push(const CachedBlockInfo &blockInfo)
+    {
+        std::unique_lock<std::shared_mutex> lock(m_mutex);
+
+        m_timestamps.push_back(blockInfo.timestamp);
+        m_blockSizes.push_back(blockInfo.blockSize);
+        m_cumulativeDifficulties.push_back(blockInfo.cumulativeDifficulty);
+        m_alreadyGeneratedCoins.push_back(blockInfo.alreadyGeneratedCoins);
+        m_alreadyGeneratedTransactions.push_back(blockInfo.alreadyGeneratedTransactions);
+    }
+
+    void BlockMetadataIndex::truncate(const uint32_t newSize)
+    {
+        std::unique_lock<std::shared_mutex> lock(m_mutex);
+
+        truncateColumn(m_timestamps, newSize);
+        truncateColumn(m_blockSizes, newSize);
+        truncateColumn(m_cumulativeDifficulties, newSize);
+        truncateColumn(m_alreadyGeneratedCoins, newSize);
+        truncateColumn(m_alreadyGeneratedTransactions, newSize);
+    }
+
+    void BlockMetadataIndex::clear()
+    {
+        std::unique_lock<std::shared_mutex> lock(m_mutex);
+
+        m_timestamps.clear();
+        m_blockSizes.clear();
+        m_cumulativeDifficulties.clear();
+        m_alreadyGeneratedCoins.clear();
+        m_alreadyGeneratedTransactions.clear();
+    }
+
+    bool BlockMetadataIndex::matches(const uint32_t blockIndex, const CachedBlockInfo &blockInfo) const
+    {
+        std::shared_lock<std::shared_mutex> lock(m_mutex);
+
+        return blockIndex < m_timestamps.size() && m_timestamps[blockIndex] == blockInfo.timestamp
+               && m_blockSizes[blockIndex] == blockInfo.blockSize
+               && m_cumulativeDifficulties[blockIndex] == blockInfo.cumulativeDifficulty
+               && m_alreadyGeneratedCoins[blockIndex] == blockInfo.alreadyGeneratedCoins
+               && m_alreadyGeneratedTransactions[blockIndex] == blockInfo.alreadyGeneratedTransactions;
+    }
+
+    CachedBlockInfo BlockMetadataIndex::getBlockInfo(const uint32_t blockIndex) const
+    {
+        std::shared_lock<std::shared_mutex> lock(m_mutex);
+
+        CachedBlockInfo blockInfo {};
+
+        blockInfo.timestamp = m_timestamps.at(blockIndex);
+        blockInfo.blockSize = m_blockSizes.at(blockIndex);
+        blockInfo.cumulativeDifficulty = m_cumulativeDifficulties.at(blockIndex);
+        blockInfo.alreadyGeneratedCoins = m_alreadyGeneratedCoins.at(blockIndex);
+        blockInfo.alreadyGeneratedTransactions = m_alreadyGeneratedTransactions.at(blockIndex);
+
+        return blockInfo;
+    }
+
+    uint64_t BlockMetadataIndex::getCumulativeDifficulty(const uint32_t blockIndex) const
+    {
+        std::shared_lock<std::shared_mutex> lock(m_mutex);
+
+        return m_cumulativeDifficulties.at(blockIndex);
+    }
+
+    uint64_t BlockMetadataIndex::getAlreadyGeneratedCoins(const uint32_t blockIndex) const
+    {
+        std::shared_lock<std::shared_mutex> lock(m_mutex);
+
+        return m_alreadyGeneratedCoins.at(blockIndex);
+    }
+
+    std::vector<uint64_t> BlockMetadataIndex::getTimestamps(const uint32_t startIndex, const uint32_t endIndex) const
+    {
+        std::shared_lock<std::shared_mutex> lock(m_mutex);
+
+        return getRange(m_timestamps, startIndex, endIndex);
+    }
+
+    std::vector<uint64_t> BlockMetadataIndex::getBlockSizes(const uint32_t startIndex, const uint32_t endIndex) const
+    {
+        std::shared_lock<std::shared_mutex> lock(m_mutex);
+
+        return getRange(m_blockSizes, startIndex, endIndex);
+    }
+
+    std::vector<uint64_t>
+        BlockMetadataIndex::getCumulativeDifficulties(const uint32_t startIndex, const uint32_t endIndex) const
+    {
+        std::shared_lock<std::shared_mutex> lock(m_mutex);
+
+        return getRange(m_cumulativeDifficulties, startIndex, endIndex);
+    }
+} // namespace CryptoNote
@@ -0,0 +1,113 @@
+// Copyright (c) 2018-2019, The TurtleCoin Developers
+//
+// Please see the included LICENSE file for more information.
+
+#pragma once
+
+#include <common/FileMappedVector.h>
+#include <cryptonotecore/BlockchainCache.h>
+#include <shared_mutex>
+#include <string>
+#include <vector>
+
+namespace CryptoNote
+{
+    /* The per block values the difficulty, reward and median calculations
+       need - timestamp, size, cumulative difficulty, generated coins and
+       generated transactions - stored by height, one memory mapped file per
+       value.
+
+       Asking for the last N timestamps or difficulties is then a copy of a
+       contiguous range of memory, rather than N database reads.
+
+       It is only a copy of what is in the database, so we don't flush it on
+       every block. Instead, a marker file is written once everything has
+       been flushed on shutdown. If the marker is missing on startup, we
+       stopped without flushing, and any block in the index may be stale,
+       so DatabaseBlockchainCache checks all of them against the database.
+
+       Adding a block can grow and remap the files, so reads from the RPC
+       threads take a shared lock, and changes an exclusive one. */
+    class BlockMetadataIndex
+    {
+      public:
+        /////////////////
+        /* CONSTRUCTOR */
+        /////////////////
+
+        /* Opens the index in the given directory, creating it if it doesn't
+           exist. Any column which is damaged is started again from empty. */
+        explicit BlockMetadataIndex(const std::string &directory);
+
+        /* Flushes the columns, and writes the clean shutdown marker */
+        ~BlockMetadataIndex();
+
+        /////////////////////////////
+        /* PUBLIC MEMBER FUNCTIONS */
+        /////////////////////////////
+
+        /* Whether the index was flushed when it was last closed. If not, only
+           what matches the database can be trusted. */
+        bool wasShutdownCleanly() const;
+
+        /* Number of blocks in the index */
+        uint32_t size() const;
+
+        /* Adds the block at height size() */
+        void push(const CachedBlockInfo &blockInfo);
+
+        /* Removes every block at or above this height */
+        void truncate(const uint32_t newSize);
+
+        void clear();
+
+        /* Whether the values stored for this block are the same as the ones
+           given */
+        bool matches(const uint32_t blockIndex, const CachedBlockInfo &blockInfo) const;
+
+        /* Everything but the block hash, which isn't stored */
+        CachedBlockInfo getBlockInfo(const uint32_t blockIndex) const;
+
+        uint64_t getCumulativeDifficulty(const uint32_t blockIndex) const;
+
+        uint64_t getAlreadyGeneratedCoins(const uint32_t blockIndex) const;
+
+        /* The ranges below are [startIndex, endIndex). They throw std::out_of_range
+           if endIndex is past the last block. */
+        std::vector<uint64_t> getTimestamps(const uint32_t startIndex, const uint32_t endIndex) const;
+
+        std::vector<uint64_t> getBlockSizes(const uint32_t startIndex, const uint32_t endIndex) const;
+
+        std::vector<uint64_t> getCumulativeDifficulties(const uint32_t startIndex, const uint32_t endIndex) const;
+
+      private:
+        //////////////////////////////
+        /* PRIVATE MEMBER FUNCTIONS */
+        //////////////////////////////
+
+        template<typename T> void openColumn(Common::FileMappedVector<T> &column, const std::string &filename);
+
+        /////////////////////////
+        /* PRIVATE MEMBER VARS */
+        /////////////////////////
+
+        const std::string m_directory;
+
+        const std::string m_cleanShutdownMarker;
+
+        bool m_wasShutdownCleanly = false;
+
+        Common::FileMappedVector<uint64_t> m_timestamps;
+
+        Common::FileMappedVector<uint32_t> m_blockSizes;
+
+        Common::FileMappedVector<uint64_t> m_cumulativeDifficulties;
+
+        Common::FileMappedVector<uint64_t> m_alreadyGeneratedCoins;
+
+        Common::FileMappedVector<uint64_t> m_alreadyGeneratedTransactions;
+
+        /* Blocks are pushed and popped while the RPC threads read the columns */
+        mutable std::shared_mutex m_mutex;
+    };
+} // namespace CryptoNote
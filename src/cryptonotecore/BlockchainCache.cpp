@@ -6,6 +6,7 @@
 
 #include "BlockchainCache.h"
 
+#include "BlockchainUtils.h"
 #include "TransactionValidatiorState.h"
 #include "common/CryptoNoteTools.h"
 #include "common/ShuffleGenerator.h"
@@ -99,6 +100,45 @@ namespace CryptoNote
         s(alreadyGeneratedTransactions, "already_generated_transaction_count");
     }
 
+    void TransactionSummary::serialize(ISerializer &s)
+    {
+        s(amountOut, "amount_out");
+        s(fee, "fee");
+        s(size, "size");
+    }
+
+    double BlockSummary::getPenalty() const
+    {
+        if (baseReward == 0)
+        {
+            return 0;
+        }
+
+        return static_cast<double>(baseReward - penalizedReward) / static_cast<double>(baseReward);
+    }
+
+    void BlockSummary::serialize(ISerializer &s)
+    {
+        s(blockHash, "block_hash");
+        s(previousBlockHash, "previous_block_hash");
+        s(blockIndex, "block_index");
+        s(majorVersion, "major_version");
+        s(minorVersion, "minor_version");
+        s(nonce, "nonce");
+        s(timestamp, "timestamp");
+        s(difficulty, "difficulty");
+        s(alreadyGeneratedCoins, "already_generated_coins");
+        s(alreadyGeneratedTransactions, "already_generated_transaction_count");
+        s(blockSize, "block_size");
+        s(transactionsCumulativeSize, "transactions_cumulative_size");
+        s(sizeMedian, "size_median");
+        s(baseReward, "base_reward");
+        s(penalizedReward, "penalized_reward");
+        s(reward, "reward");
+        s(totalFeeAmount, "total_fee_amount");
+        s(transactions, "transactions");
+    }
+
     void OutputGlobalIndexesForAmount::serialize(ISerializer &s)
     {
         s(startIndex, "start_index");
@@ -568,6 +608,14 @@ namespace CryptoNote
         return blockInfos.get<BlockIndexTag>()[blockIndex - startIndex].blockHash;
     }
 
+    std::vector<BlockSummary> BlockchainCache::getBlockSummaries(uint32_t startBlockIndex, uint32_t endBlockIndex) const
+    {
+        /* Only the database keeps them. Alternative chains, and main chain
+           blocks which haven't been merged into the database yet, are worked
+           out by the core when asked for. */
+        return {};
+    }
+
     std::vector<Crypto::Hash> BlockchainCache::getBlockHashes(uint32_t startBlockIndex, size_t maxCount) const
     {
         size_t blocksLeft;
@@ -1104,6 +1152,15 @@ namespace CryptoNote
         return outputs;
     }
 
+    std::vector<std::vector<std::pair<IBlockchainCache::GlobalOutputIndex, Crypto::PublicKey>>>
+        BlockchainCache::getRandomOutsByAmounts(
+            const std::vector<Amount> &amounts,
+            size_t count,
+            uint32_t blockIndex) const
+    {
+        return Utils::getRandomOutsOneAmountAtATime(*this, amounts, count, blockIndex);
+    }
+
     ExtractOutputKeysResult BlockchainCache::extractKeyOutputKeys(
         uint64_t amount,
         uint32_t blockIndex,
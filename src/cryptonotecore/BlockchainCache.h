@@ -195,6 +195,8 @@ namespace CryptoNote
 
         Crypto::Hash getBlockHash(uint32_t blockIndex) const override;
 
+        std::vector<BlockSummary> getBlockSummaries(uint32_t startBlockIndex, uint32_t endBlockIndex) const override;
+
         virtual std::vector<Crypto::Hash> getBlockHashes(uint32_t startIndex, size_t maxCount) const override;
 
         virtual IBlockchainCache *getParent() const override;
@@ -251,6 +253,11 @@ namespace CryptoNote
         virtual std::vector<uint32_t>
             getRandomOutsByAmount(uint64_t amount, size_t count, uint32_t blockIndex) const override;
 
+        virtual std::vector<std::vector<std::pair<GlobalOutputIndex, Crypto::PublicKey>>> getRandomOutsByAmounts(
+            const std::vector<Amount> &amounts,
+            size_t count,
+            uint32_t blockIndex) const override;
+
         virtual ExtractOutputKeysResult extractKeyOutputs(
             uint64_t amount,
             uint32_t blockIndex,
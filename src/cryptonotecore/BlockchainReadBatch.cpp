@@ -56,6 +56,12 @@ BlockchainReadBatch &BlockchainReadBatch::requestCachedBlock(uint32_t blockIndex
     return *this;
 }
 
+BlockchainReadBatch &BlockchainReadBatch::requestBlockSummary(uint32_t blockIndex)
+{
+    state.blockSummaries.emplace(blockIndex, BlockSummary());
+    return *this;
+}
+
 BlockchainReadBatch &BlockchainReadBatch::requestBlockIndexByBlockHash(const Crypto::Hash &blockHash)
 {
     state.blockIndexesByBlockHashes.emplace(blockHash, 0);
@@ -76,22 +82,6 @@ BlockchainReadBatch &BlockchainReadBatch::requestKeyOutputGlobalIndexForAmount(
     return *this;
 }
 
-BlockchainReadBatch &BlockchainReadBatch::requestRawBlock(uint32_t blockIndex)
-{
-    state.rawBlocks.emplace(blockIndex, RawBlock());
-    return *this;
-}
-
-BlockchainReadBatch &BlockchainReadBatch::requestRawBlocks(uint64_t startHeight, uint64_t endHeight)
-{
-    for (uint64_t i = startHeight; i < endHeight; i++)
-    {
-        state.rawBlocks.emplace(i, RawBlock());
-    }
-
-    return *this;
-}
-
 BlockchainReadBatch &BlockchainReadBatch::requestLastBlockIndex()
 {
     state.lastBlockIndex.second = true;
@@ -166,10 +156,10 @@ std::vector<std::string> BlockchainReadBatch::getRawKeys() const
     DB::serializeKeys(rawKeys, DB::TRANSACTION_HASH_TO_TRANSACTION_INFO_PREFIX, state.cachedTransactions);
     DB::serializeKeys(rawKeys, DB::BLOCK_INDEX_TO_TX_HASHES_PREFIX, state.transactionHashesByBlocks);
     DB::serializeKeys(rawKeys, DB::BLOCK_INDEX_TO_BLOCK_INFO_PREFIX, state.cachedBlocks);
+    DB::serializeKeys(rawKeys, DB::BLOCK_INDEX_TO_BLOCK_SUMMARY_PREFIX, state.blockSummaries);
     DB::serializeKeys(rawKeys, DB::BLOCK_HASH_TO_BLOCK_INDEX_PREFIX, state.blockIndexesByBlockHashes);
     DB::serializeKeys(rawKeys, DB::KEY_OUTPUT_AMOUNT_PREFIX, state.keyOutputGlobalIndexesCountForAmounts);
     DB::serializeKeys(rawKeys, DB::KEY_OUTPUT_AMOUNT_PREFIX, state.keyOutputGlobalIndexesForAmounts);
-    DB::serializeKeys(rawKeys, DB::BLOCK_INDEX_TO_RAW_BLOCK_PREFIX, state.rawBlocks);
     DB::serializeKeys(rawKeys, DB::CLOSEST_TIMESTAMP_BLOCK_INDEX_PREFIX, state.closestTimestampBlockIndex);
     DB::serializeKeys(rawKeys, DB::KEY_OUTPUT_AMOUNTS_COUNT_PREFIX, state.keyOutputAmounts);
     DB::serializeKeys(rawKeys, DB::PAYMENT_ID_TO_TX_HASH_PREFIX, state.transactionCountsByPaymentIds);
@@ -227,6 +217,11 @@ const std::unordered_map<uint32_t, CachedBlockInfo> &BlockchainReadResult::getCa
     return state.cachedBlocks;
 }
 
+const std::unordered_map<uint32_t, BlockSummary> &BlockchainReadResult::getBlockSummaries() const
+{
+    return state.blockSummaries;
+}
+
 const std::unordered_map<Crypto::Hash, uint32_t> &BlockchainReadResult::getBlockIndexesByBlockHashes() const
 {
     return state.blockIndexesByBlockHashes;
@@ -244,11 +239,6 @@ const std::unordered_map<std::pair<IBlockchainCache::Amount, uint32_t>, PackedOu
     return state.keyOutputGlobalIndexesForAmounts;
 }
 
-const std::unordered_map<uint32_t, RawBlock> &BlockchainReadResult::getRawBlocks() const
-{
-    return state.rawBlocks;
-}
-
 const std::pair<uint32_t, bool> &BlockchainReadResult::getLastBlockIndex() const
 {
     return state.lastBlockIndex;
@@ -290,7 +280,9 @@ const KeyOutputKeyResult &BlockchainReadResult::getKeyOutputInfo() const
     return state.keyOutputKeys;
 }
 
-void BlockchainReadBatch::submitRawResult(const std::vector<std::string> &values, const std::vector<bool> &resultStates)
+void BlockchainReadBatch::submitRawResult(
+    const std::vector<std::string_view> &values,
+    const std::vector<bool> &resultStates)
 {
     assert(state.size() == values.size());
     assert(values.size() == resultStates.size());
@@ -302,10 +294,10 @@ void BlockchainReadBatch::submitRawResult(const std::vector<std::string> &values
     DB::deserializeValues(state.cachedTransactions, iter, DB::TRANSACTION_HASH_TO_TRANSACTION_INFO_PREFIX);
     DB::deserializeValues(state.transactionHashesByBlocks, iter, DB::BLOCK_INDEX_TO_TX_HASHES_PREFIX);
     DB::deserializeValues(state.cachedBlocks, iter, DB::BLOCK_INDEX_TO_BLOCK_INFO_PREFIX);
+    DB::deserializeValues(state.blockSummaries, iter, DB::BLOCK_INDEX_TO_BLOCK_SUMMARY_PREFIX);
     DB::deserializeValues(state.blockIndexesByBlockHashes, iter, DB::BLOCK_HASH_TO_BLOCK_INDEX_PREFIX);
     DB::deserializeValues(state.keyOutputGlobalIndexesCountForAmounts, iter, DB::KEY_OUTPUT_AMOUNT_PREFIX);
     DB::deserializeValues(state.keyOutputGlobalIndexesForAmounts, iter, DB::KEY_OUTPUT_AMOUNT_PREFIX);
-    DB::deserializeValues(state.rawBlocks, iter, DB::BLOCK_INDEX_TO_RAW_BLOCK_PREFIX);
     DB::deserializeValues(state.closestTimestampBlockIndex, iter, DB::CLOSEST_TIMESTAMP_BLOCK_INDEX_PREFIX);
     DB::deserializeValues(state.keyOutputAmounts, iter, DB::KEY_OUTPUT_AMOUNTS_COUNT_PREFIX);
     DB::deserializeValues(state.transactionCountsByPaymentIds, iter, DB::PAYMENT_ID_TO_TX_HASH_PREFIX);
@@ -328,10 +320,10 @@ BlockchainReadState::BlockchainReadState(BlockchainReadState &&state):
     cachedTransactions(std::move(state.cachedTransactions)),
     transactionHashesByBlocks(std::move(state.transactionHashesByBlocks)),
     cachedBlocks(std::move(state.cachedBlocks)),
+    blockSummaries(std::move(state.blockSummaries)),
     blockIndexesByBlockHashes(std::move(state.blockIndexesByBlockHashes)),
     keyOutputGlobalIndexesCountForAmounts(std::move(state.keyOutputGlobalIndexesCountForAmounts)),
     keyOutputGlobalIndexesForAmounts(std::move(state.keyOutputGlobalIndexesForAmounts)),
-    rawBlocks(std::move(state.rawBlocks)),
     blockHashesByTimestamp(std::move(state.blockHashesByTimestamp)),
     keyOutputKeys(std::move(state.keyOutputKeys)),
     closestTimestampBlockIndex(std::move(state.closestTimestampBlockIndex)),
@@ -347,8 +339,9 @@ BlockchainReadState::BlockchainReadState(BlockchainReadState &&state):
 size_t BlockchainReadState::size() const
 {
     return spentKeyImagesByBlock.size() + blockIndexesBySpentKeyImages.size() + cachedTransactions.size()
-           + transactionHashesByBlocks.size() + cachedBlocks.size() + blockIndexesByBlockHashes.size()
-           + keyOutputGlobalIndexesCountForAmounts.size() + keyOutputGlobalIndexesForAmounts.size() + rawBlocks.size()
+           + transactionHashesByBlocks.size() + cachedBlocks.size() + blockSummaries.size()
+           + blockIndexesByBlockHashes.size()
+           + keyOutputGlobalIndexesCountForAmounts.size() + keyOutputGlobalIndexesForAmounts.size()
            + closestTimestampBlockIndex.size() + keyOutputAmounts.size() + transactionCountsByPaymentIds.size()
            + transactionHashesByPaymentIds.size() + blockHashesByTimestamp.size() + keyOutputKeys.size()
            + (lastBlockIndex.second ? 1 : 0) + (keyOutputAmountsCount.second ? 1 : 0)
@@ -58,6 +58,8 @@ namespace CryptoNote
 
         std::unordered_map<uint32_t, CachedBlockInfo> cachedBlocks;
 
+        std::unordered_map<uint32_t, BlockSummary> blockSummaries;
+
         std::unordered_map<Crypto::Hash, uint32_t> blockIndexesByBlockHashes;
 
         std::unordered_map<IBlockchainCache::Amount, uint32_t> keyOutputGlobalIndexesCountForAmounts;
@@ -65,8 +67,6 @@ namespace CryptoNote
         std::unordered_map<std::pair<IBlockchainCache::Amount, uint32_t>, PackedOutIndex>
             keyOutputGlobalIndexesForAmounts;
 
-        std::unordered_map<uint32_t, RawBlock> rawBlocks;
-
         std::unordered_map<uint64_t, uint32_t> closestTimestampBlockIndex;
 
         std::unordered_map<uint32_t, IBlockchainCache::Amount> keyOutputAmounts;
@@ -113,6 +113,8 @@ namespace CryptoNote
 
         const std::unordered_map<uint32_t, CachedBlockInfo> &getCachedBlocks() const;
 
+        const std::unordered_map<uint32_t, BlockSummary> &getBlockSummaries() const;
+
         const std::unordered_map<Crypto::Hash, uint32_t> &getBlockIndexesByBlockHashes() const;
 
         const std::unordered_map<IBlockchainCache::Amount, uint32_t> &getKeyOutputGlobalIndexesCountForAmounts() const;
@@ -120,8 +122,6 @@ namespace CryptoNote
         const std::unordered_map<std::pair<IBlockchainCache::Amount, uint32_t>, PackedOutIndex> &
             getKeyOutputGlobalIndexesForAmounts() const;
 
-        const std::unordered_map<uint32_t, RawBlock> &getRawBlocks() const;
-
         const std::pair<uint32_t, bool> &getLastBlockIndex() const;
 
         const std::unordered_map<uint64_t, uint32_t> &getClosestTimestampBlockIndex() const;
@@ -162,6 +162,8 @@ namespace CryptoNote
 
         BlockchainReadBatch &requestCachedBlock(uint32_t blockIndex);
 
+        BlockchainReadBatch &requestBlockSummary(uint32_t blockIndex);
+
         BlockchainReadBatch &requestBlockIndexByBlockHash(const Crypto::Hash &blockHash);
 
         BlockchainReadBatch &requestKeyOutputGlobalIndexesCountForAmount(IBlockchainCache::Amount amount);
@@ -169,10 +171,6 @@ namespace CryptoNote
         BlockchainReadBatch &
             requestKeyOutputGlobalIndexForAmount(IBlockchainCache::Amount amount, uint32_t outputIndexWithinAmout);
 
-        BlockchainReadBatch &requestRawBlock(uint32_t blockIndex);
-
-        BlockchainReadBatch &requestRawBlocks(uint64_t startHeight, uint64_t endHeight);
-
         BlockchainReadBatch &requestLastBlockIndex();
 
         BlockchainReadBatch &requestClosestTimestampBlockIndex(uint64_t timestamp);
@@ -193,7 +191,9 @@ namespace CryptoNote
 
         std::vector<std::string> getRawKeys() const override;
 
-        void submitRawResult(const std::vector<std::string> &values, const std::vector<bool> &resultStates) override;
+        void submitRawResult(
+            const std::vector<std::string_view> &values,
+            const std::vector<bool> &resultStates) override;
 
         BlockchainReadResult extractResult();
 
@@ -5,6 +5,9 @@
 
 #include "BlockchainUtils.h"
 
+#include <algorithm>
+#include <stdexcept>
+
 namespace CryptoNote
 {
     namespace Utils
@@ -29,5 +32,56 @@ namespace CryptoNote
             return true;
         }
 
+        std::vector<std::vector<std::pair<IBlockchainCache::GlobalOutputIndex, Crypto::PublicKey>>>
+            getRandomOutsOneAmountAtATime(
+                const IBlockchainCache &cache,
+                const std::vector<IBlockchainCache::Amount> &amounts,
+                size_t count,
+                uint32_t blockIndex)
+        {
+            std::vector<std::vector<std::pair<IBlockchainCache::GlobalOutputIndex, Crypto::PublicKey>>> result;
+
+            for (const auto amount : amounts)
+            {
+                std::vector<uint32_t> globalIndexes = cache.getRandomOutsByAmount(amount, count, blockIndex);
+
+                std::sort(globalIndexes.begin(), globalIndexes.end());
+
+                std::vector<Crypto::PublicKey> publicKeys;
+
+                switch (cache.extractKeyOutputKeys(
+                    amount, blockIndex, {globalIndexes.data(), globalIndexes.size()}, publicKeys))
+                {
+                    case ExtractOutputKeysResult::SUCCESS:
+                    {
+                        break;
+                    }
+                    case ExtractOutputKeysResult::INVALID_GLOBAL_INDEX:
+                    {
+                        throw std::runtime_error("Invalid global index is given");
+                    }
+                    case ExtractOutputKeysResult::OUTPUT_LOCKED:
+                    {
+                        throw std::runtime_error("Output is locked");
+                    }
+                    default:
+                    {
+                        throw std::runtime_error("Unknown error");
+                    }
+                }
+
+                std::vector<std::pair<IBlockchainCache::GlobalOutputIndex, Crypto::PublicKey>> outputs;
+
+                for (size_t i = 0; i < globalIndexes.size(); i++)
+                {
+                    outputs.emplace_back(globalIndexes[i], publicKeys[i]);
+                }
+
+                result.push_back(std::move(outputs));
+            }
+
+            return result;
+        }
+
     } // namespace Utils
 } // namespace CryptoNote
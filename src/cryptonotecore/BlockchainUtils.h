@@ -7,6 +7,7 @@
 
 #include "CachedTransaction.h"
 #include "CryptoNote.h"
+#include "IBlockchainCache.h"
 #include "common/CryptoNoteTools.h"
 
 #include <vector>
@@ -19,5 +20,14 @@ namespace CryptoNote
             const std::vector<BinaryArray> &binaryTransactions,
             std::vector<CachedTransaction> &transactions);
 
+        /* IBlockchainCache::getRandomOutsByAmounts, done with a
+           getRandomOutsByAmount and extractKeyOutputKeys per amount */
+        std::vector<std::vector<std::pair<IBlockchainCache::GlobalOutputIndex, Crypto::PublicKey>>>
+            getRandomOutsOneAmountAtATime(
+                const IBlockchainCache &cache,
+                const std::vector<IBlockchainCache::Amount> &amounts,
+                size_t count,
+                uint32_t blockIndex);
+
     } // namespace Utils
 } // namespace CryptoNote
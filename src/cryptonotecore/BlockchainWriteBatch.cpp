@@ -79,9 +79,9 @@ BlockchainWriteBatch &BlockchainWriteBatch::insertKeyOutputGlobalIndexes(
     return *this;
 }
 
-BlockchainWriteBatch &BlockchainWriteBatch::insertRawBlock(uint32_t blockIndex, const RawBlock &block)
+BlockchainWriteBatch &BlockchainWriteBatch::insertBlockSummary(uint32_t blockIndex, const BlockSummary &summary)
 {
-    rawDataToInsert.emplace_back(DB::serialize(DB::BLOCK_INDEX_TO_RAW_BLOCK_PREFIX, blockIndex, block));
+    rawDataToInsert.emplace_back(DB::serialize(DB::BLOCK_INDEX_TO_BLOCK_SUMMARY_PREFIX, blockIndex, summary));
     return *this;
 }
 
@@ -163,6 +163,7 @@ BlockchainWriteBatch &BlockchainWriteBatch::removeCachedBlock(const Crypto::Hash
     rawKeysToRemove.emplace_back(DB::serializeKey(DB::BLOCK_INDEX_TO_BLOCK_INFO_PREFIX, blockIndex));
     rawKeysToRemove.emplace_back(DB::serializeKey(DB::BLOCK_INDEX_TO_TX_HASHES_PREFIX, blockIndex));
     rawKeysToRemove.emplace_back(DB::serializeKey(DB::BLOCK_HASH_TO_BLOCK_INDEX_PREFIX, blockHash));
+    rawKeysToRemove.emplace_back(DB::serializeKey(DB::BLOCK_INDEX_TO_BLOCK_SUMMARY_PREFIX, blockIndex));
     rawDataToInsert.emplace_back(
         DB::serialize(DB::BLOCK_INDEX_TO_BLOCK_HASH_PREFIX, DB::LAST_BLOCK_INDEX_KEY, blockIndex - 1));
     return *this;
@@ -183,12 +184,6 @@ BlockchainWriteBatch &BlockchainWriteBatch::removeKeyOutputGlobalIndexes(
     return *this;
 }
 
-BlockchainWriteBatch &BlockchainWriteBatch::removeRawBlock(uint32_t blockIndex)
-{
-    rawKeysToRemove.emplace_back(DB::serializeKey(DB::BLOCK_INDEX_TO_RAW_BLOCK_PREFIX, blockIndex));
-    return *this;
-}
-
 BlockchainWriteBatch &BlockchainWriteBatch::removeClosestTimestampBlockIndex(uint64_t timestamp)
 {
     rawKeysToRemove.emplace_back(DB::serializeKey(DB::CLOSEST_TIMESTAMP_BLOCK_INDEX_PREFIX, timestamp));
@@ -40,7 +40,7 @@ namespace CryptoNote
             const std::vector<PackedOutIndex> &outputs,
             uint32_t totalOutputsCountForAmount);
 
-        BlockchainWriteBatch &insertRawBlock(uint32_t blockIndex, const RawBlock &block);
+        BlockchainWriteBatch &insertBlockSummary(uint32_t blockIndex, const BlockSummary &summary);
 
         BlockchainWriteBatch &insertClosestTimestampBlockIndex(uint64_t timestamp, uint32_t blockIndex);
 
@@ -69,8 +69,6 @@ namespace CryptoNote
             uint32_t outputsToRemoveCount,
             uint32_t totalOutputsCountForAmount);
 
-        BlockchainWriteBatch &removeRawBlock(uint32_t blockIndex);
-
         BlockchainWriteBatch &removeClosestTimestampBlockIndex(uint64_t timestamp);
 
         BlockchainWriteBatch &removeTimestamp(uint64_t timestamp);
@@ -7,8 +7,10 @@
 
 #include <WalletTypes.h>
 #include <algorithm>
+#include <cmath>
 #include <common/CryptoNoteTools.h>
 #include <common/Math.h>
+#include <common/ScopeExit.h>
 #include <common/MemoryInputStream.h>
 #include <common/ShuffleGenerator.h>
 #include <common/TransactionExtra.h>
@@ -25,6 +27,8 @@
 #include <cryptonotecore/TransactionApi.h>
 #include <cryptonotecore/TransactionPool.h>
 #include <cryptonotecore/TransactionPoolCleaner.h>
+#include <cryptonotecore/TransactionPoolSnapshot.h>
+#include <cryptonotecore/TransactionValidationErrors.h>
 #include <cryptonotecore/UpgradeManager.h>
 #include <cryptonoteprotocol/CryptoNoteProtocolHandlerCommon.h>
 #include <numeric>
@@ -51,6 +55,39 @@ namespace CryptoNote
 
         UseGenesis addGenesisBlock = UseGenesis(true);
 
+        BlockSummary makeBlockSummary(const BlockDetails &blockDetails)
+        {
+            BlockSummary summary;
+
+            summary.blockHash = blockDetails.hash;
+            summary.previousBlockHash = blockDetails.prevBlockHash;
+            summary.blockIndex = blockDetails.index;
+            summary.majorVersion = blockDetails.majorVersion;
+            summary.minorVersion = blockDetails.minorVersion;
+            summary.nonce = blockDetails.nonce;
+            summary.timestamp = blockDetails.timestamp;
+            summary.difficulty = blockDetails.difficulty;
+            summary.alreadyGeneratedCoins = blockDetails.alreadyGeneratedCoins;
+            summary.alreadyGeneratedTransactions = blockDetails.alreadyGeneratedTransactions;
+            summary.blockSize = blockDetails.blockSize;
+            summary.transactionsCumulativeSize = blockDetails.transactionsCumulativeSize;
+            summary.sizeMedian = blockDetails.sizeMedian;
+            summary.baseReward = blockDetails.baseReward;
+            summary.penalizedReward = blockDetails.baseReward
+                                      - static_cast<uint64_t>(std::llround(
+                                          blockDetails.penalty * static_cast<double>(blockDetails.baseReward)));
+            summary.reward = blockDetails.reward;
+            summary.totalFeeAmount = blockDetails.totalFeeAmount;
+
+            for (const auto &transaction : blockDetails.transactions)
+            {
+                summary.transactions.push_back(
+                    {transaction.hash, transaction.totalOutputsAmount, transaction.fee, transaction.size});
+            }
+
+            return summary;
+        }
+
         class TransactionSpentInputsChecker
         {
           public:
@@ -227,6 +264,10 @@ namespace CryptoNote
 
         const std::chrono::seconds OUTDATED_TRANSACTION_POLLING_INTERVAL = std::chrono::seconds(60);
 
+        /* How often the pool is written to disk, if it has changed, so a crash
+           doesn't lose all of it */
+        const std::chrono::minutes POOL_SNAPSHOT_INTERVAL = std::chrono::minutes(10);
+
     } // namespace
 
     Core::Core(
@@ -236,7 +277,10 @@ namespace CryptoNote
         System::Dispatcher &dispatcher,
         std::unique_ptr<IBlockchainCacheFactory> &&blockchainCacheFactory,
         std::unique_ptr<IMainChainStorage> &&mainchainStorage,
-        const uint32_t transactionValidationThreads):
+        const uint32_t transactionValidationThreads,
+        const bool batchSignatureVerification,
+        const bool trustedCheckpointImport,
+        const std::string &poolSnapshotFilename):
         currency(currency),
         dispatcher(dispatcher),
         contextGroup(dispatcher),
@@ -246,7 +290,12 @@ namespace CryptoNote
         blockchainCacheFactory(std::move(blockchainCacheFactory)),
         mainChainStorage(std::move(mainchainStorage)),
         initialized(false),
-        m_transactionValidationThreadPool(transactionValidationThreads)
+        m_transactionValidationThreadPool(transactionValidationThreads),
+        m_batchSignatureVerification(batchSignatureVerification),
+        m_trustedCheckpointImport(trustedCheckpointImport),
+        m_walletSyncCache(WALLET_SYNC_CACHE_MAX_SIZE),
+        m_poolSnapshotFilename(poolSnapshotFilename),
+        m_poolSnapshotRevision(0)
     {
         upgradeManager->addMajorBlockVersion(BLOCK_MAJOR_VERSION_2, currency.upgradeHeight(BLOCK_MAJOR_VERSION_2));
         upgradeManager->addMajorBlockVersion(BLOCK_MAJOR_VERSION_3, currency.upgradeHeight(BLOCK_MAJOR_VERSION_3));
@@ -271,18 +320,30 @@ namespace CryptoNote
 
     bool Core::addMessageQueue(MessageQueue<BlockchainMessage> &messageQueue)
     {
+        std::scoped_lock<std::mutex> lock(m_queueListMutex);
+
         return queueList.insert(messageQueue);
     }
 
     bool Core::removeMessageQueue(MessageQueue<BlockchainMessage> &messageQueue)
     {
+        std::scoped_lock<std::mutex> lock(m_queueListMutex);
+
         return queueList.remove(messageQueue);
     }
 
     bool Core::notifyObservers(BlockchainMessage &&msg) /* noexcept */
     {
+        /* Blocks after the common root are no longer on the main chain */
+        if (msg.getType() == BlockchainMessage::Type::ChainSwitch)
+        {
+            m_walletSyncCache.invalidateFrom(msg.getChainSwitch().commonRootIndex + 1);
+        }
+
         try
         {
+            std::scoped_lock<std::mutex> lock(m_queueListMutex);
+
             for (auto &queue : queueList)
             {
                 queue.push(std::move(msg));
@@ -475,6 +536,38 @@ namespace CryptoNote
         }
     }
 
+    TransactionValidatorState
+        Core::getSpentOutputsAboveSplit(IBlockchainCache *newLeaf, IBlockchainCache *oldLeaf) const
+    {
+        std::unordered_set<const IBlockchainCache *> oldSegments;
+
+        for (auto segment = oldLeaf; segment != nullptr; segment = segment->getParent())
+        {
+            oldSegments.insert(segment);
+        }
+
+        TransactionValidatorState spentOutputs;
+
+        for (auto segment = newLeaf; segment != nullptr && oldSegments.count(segment) == 0;
+             segment = segment->getParent())
+        {
+            for (const auto &rawTransaction : segment->getRawTransactions(segment->getTransactionHashes()))
+            {
+                const CachedTransaction transaction(rawTransaction);
+
+                for (const auto &input : transaction.getTransaction().inputs)
+                {
+                    if (input.type() == typeid(KeyInput))
+                    {
+                        spentOutputs.spentKeyImages.insert(boost::get<KeyInput>(input).keyImage);
+                    }
+                }
+            }
+        }
+
+        return spentOutputs;
+    }
+
     bool Core::queryBlocks(
         const std::vector<Crypto::Hash> &blockHashes,
         uint64_t timestamp,
@@ -801,44 +894,64 @@ namespace CryptoNote
                 return true;
             }
 
-            std::vector<RawBlock> rawBlocks;
+            const uint64_t generation = m_walletSyncCache.getGeneration();
 
-            if (skipCoinbaseTransactions)
-            {
-                rawBlocks = mainChain->getNonEmptyBlocks(startIndex, actualBlockCount);
-            }
-            else
-            {
-                rawBlocks = mainChain->getBlocksByHeight(startIndex, endIndex);
-            }
+            const auto blocks = skipCoinbaseTransactions
+                                    ? getNonEmptyWalletSyncBlocks(mainChain, startIndex, actualBlockCount)
+                                    : getWalletSyncBlocks(mainChain, startIndex, endIndex);
 
-            for (const auto &rawBlock : rawBlocks)
+            uint64_t cacheHits = 0;
+
+            for (const auto &[syncBlock, cached] : blocks)
             {
-                BlockTemplate block;
+                if (cached)
+                {
+                    cacheHits++;
+                }
 
-                fromBinaryArray(block, rawBlock.block);
+                if (syncBlock->walletBlock)
+                {
+                    walletBlocks.push_back(*syncBlock->walletBlock);
+                }
+                else
+                {
+                    BlockTemplate block;
 
-                WalletTypes::WalletBlockInfo walletBlock;
+                    fromBinaryArray(block, syncBlock->rawBlock.block);
 
-                CachedBlock cachedBlock(block);
+                    WalletTypes::WalletBlockInfo walletBlock;
 
-                walletBlock.blockHeight = cachedBlock.getBlockIndex();
-                walletBlock.blockHash = cachedBlock.getBlockHash();
-                walletBlock.blockTimestamp = block.timestamp;
+                    CachedBlock cachedBlock(block);
 
-                if (!skipCoinbaseTransactions)
-                {
+                    walletBlock.blockHeight = cachedBlock.getBlockIndex();
+                    walletBlock.blockHash = cachedBlock.getBlockHash();
+                    walletBlock.blockTimestamp = block.timestamp;
                     walletBlock.coinbaseTransaction = getRawCoinbaseTransaction(block.baseTransaction);
+
+                    for (const auto &transaction : syncBlock->rawBlock.transactions)
+                    {
+                        walletBlock.transactions.push_back(getRawTransaction(transaction));
+                    }
+
+                    /* Keep it, so the next wallet to ask doesn't have to decode it again */
+                    auto updatedBlock = std::make_shared<WalletSyncCache::Block>();
+
+                    updatedBlock->rawBlock = syncBlock->rawBlock;
+                    updatedBlock->walletBlock = walletBlock;
+
+                    m_walletSyncCache.addBlock(walletBlock.blockHeight, updatedBlock, generation);
+
+                    walletBlocks.push_back(std::move(walletBlock));
                 }
 
-                for (const auto &transaction : rawBlock.transactions)
+                if (skipCoinbaseTransactions)
                 {
-                    walletBlock.transactions.push_back(getRawTransaction(transaction));
+                    walletBlocks.back().coinbaseTransaction = std::nullopt;
                 }
-
-                walletBlocks.push_back(walletBlock);
             }
 
+            m_walletSyncCache.recordLookups(cacheHits, blocks.size() - cacheHits);
+
             if (walletBlocks.empty())
             {
                 topBlockInfo = WalletTypes::TopBlock({currentHash, currentIndex});
@@ -947,15 +1060,24 @@ namespace CryptoNote
                 return true;
             }
 
-            if (skipCoinbaseTransactions)
-            {
-                blocks = mainChain->getNonEmptyBlocks(startIndex, actualBlockCount);
-            }
-            else
+            const auto syncBlocks = skipCoinbaseTransactions
+                                        ? getNonEmptyWalletSyncBlocks(mainChain, startIndex, actualBlockCount)
+                                        : getWalletSyncBlocks(mainChain, startIndex, endIndex);
+
+            uint64_t cacheHits = 0;
+
+            for (const auto &[syncBlock, cached] : syncBlocks)
             {
-                blocks = mainChain->getBlocksByHeight(startIndex, endIndex);
+                if (cached)
+                {
+                    cacheHits++;
+                }
+
+                blocks.push_back(syncBlock->rawBlock);
             }
 
+            m_walletSyncCache.recordLookups(cacheHits, syncBlocks.size() - cacheHits);
+
             if (blocks.empty())
             {
                 topBlockInfo = WalletTypes::TopBlock({currentHash, currentIndex});
@@ -970,6 +1092,115 @@ namespace CryptoNote
         }
     }
 
+    std::vector<std::tuple<std::shared_ptr<const WalletSyncCache::Block>, bool>> Core::getWalletSyncBlocks(
+        IBlockchainCache *mainChain,
+        const uint64_t startIndex,
+        const uint64_t endIndex) const
+    {
+        /* Taken before reading from the chain, so if there's a reorg while
+           we're reading, we don't cache blocks from the old chain */
+        const uint64_t generation = m_walletSyncCache.getGeneration();
+
+        std::vector<std::tuple<std::shared_ptr<const WalletSyncCache::Block>, bool>> blocks;
+
+        uint64_t height = startIndex;
+
+        while (height < endIndex)
+        {
+            if (auto block = m_walletSyncCache.getBlock(height))
+            {
+                blocks.emplace_back(block, true);
+                height++;
+                continue;
+            }
+
+            /* Find the end of the run of blocks we don't have, so we can read
+               them from the database in one go */
+            uint64_t missingEnd = height + 1;
+
+            std::shared_ptr<const WalletSyncCache::Block> nextBlock;
+
+            while (missingEnd < endIndex && !(nextBlock = m_walletSyncCache.getBlock(missingEnd)))
+            {
+                missingEnd++;
+            }
+
+            for (auto &rawBlock : mainChain->getBlocksByHeight(height, missingEnd))
+            {
+                auto block = std::make_shared<WalletSyncCache::Block>();
+
+                block->rawBlock = std::move(rawBlock);
+
+                m_walletSyncCache.addBlock(height, block, generation);
+
+                blocks.emplace_back(block, false);
+                height++;
+            }
+
+            /* Chain got shorter underneath us */
+            if (height != missingEnd)
+            {
+                break;
+            }
+
+            if (nextBlock)
+            {
+                blocks.emplace_back(nextBlock, true);
+                height++;
+            }
+        }
+
+        return blocks;
+    }
+
+    std::vector<std::tuple<std::shared_ptr<const WalletSyncCache::Block>, bool>> Core::getNonEmptyWalletSyncBlocks(
+        IBlockchainCache *mainChain,
+        const uint64_t startIndex,
+        const uint64_t blockCount) const
+    {
+        std::vector<std::tuple<std::shared_ptr<const WalletSyncCache::Block>, bool>> nonEmptyBlocks;
+
+        const uint64_t chainHeight = mainChain->getTopBlockIndex() + 1;
+
+        uint64_t height = startIndex;
+
+        while (nonEmptyBlocks.size() < blockCount && height < chainHeight)
+        {
+            /* Same as getNonEmptyBlocks() - take twice what we need, to try and
+               get enough non empty blocks without taking too many */
+            const uint64_t endHeight = std::min(chainHeight, height + blockCount * 2);
+
+            const auto blocks = getWalletSyncBlocks(mainChain, height, endHeight);
+
+            for (const auto &block : blocks)
+            {
+                if (nonEmptyBlocks.size() == blockCount)
+                {
+                    break;
+                }
+
+                if (!std::get<0>(block)->rawBlock.transactions.empty())
+                {
+                    nonEmptyBlocks.push_back(block);
+                }
+            }
+
+            if (blocks.size() != endHeight - height)
+            {
+                break;
+            }
+
+            height = endHeight;
+        }
+
+        return nonEmptyBlocks;
+    }
+
+    WalletSyncCache::Statistics Core::getWalletSyncCacheStatistics() const
+    {
+        return m_walletSyncCache.getStatistics();
+    }
+
     WalletTypes::RawCoinbaseTransaction Core::getRawCoinbaseTransaction(const CryptoNote::Transaction &t)
     {
         WalletTypes::RawCoinbaseTransaction transaction;
@@ -1153,8 +1384,274 @@ namespace CryptoNote
     }
 
     std::error_code Core::addBlock(const CachedBlock &cachedBlock, RawBlock &&rawBlock)
+    {
+        return addPreparedBlock(cachedBlock, std::move(rawBlock), nullptr);
+    }
+
+    void Core::addBlocks(
+        const std::vector<CachedBlock> &cachedBlocks,
+        std::vector<RawBlock> &&rawBlocks,
+        const std::function<bool(size_t, const std::error_code &)> &blockAdded)
     {
         throwIfNotInitialized();
+
+        assert(cachedBlocks.size() == rawBlocks.size());
+
+        const size_t blockCount = cachedBlocks.size();
+
+        std::vector<PreparedBlock> preparedBlocks(blockCount);
+
+        /* Set by whoever prepares the block - a pool thread, or the importing
+           thread if it gets to the block first */
+        std::vector<std::atomic<bool>> claimed(blockCount);
+
+        std::atomic<uint64_t> prepareTime(0);
+
+        const auto prepare = [&](const size_t i)
+        {
+            if (claimed[i].exchange(true))
+            {
+                return;
+            }
+
+            const auto startTime = std::chrono::steady_clock::now();
+
+            prepareBlock(cachedBlocks[i], rawBlocks[i], preparedBlocks[i]);
+
+            prepareTime += std::chrono::duration_cast<std::chrono::microseconds>(
+                               std::chrono::steady_clock::now() - startTime)
+                               .count();
+        };
+
+        std::vector<std::future<void>> preparing(blockCount);
+
+        for (size_t i = 0; i < blockCount; i++)
+        {
+            claimed[i] = false;
+        }
+
+        BlockImportStatistics batch;
+
+        /* The prepare jobs reference our locals, so however we leave - done,
+           stopped by blockAdded, or by an exception - stop any blocks we no
+           longer need from being prepared, and wait for the rest */
+        Tools::ScopeExit waitForPreparing(
+            [&]()
+            {
+                for (size_t i = 0; i < blockCount; i++)
+                {
+                    claimed[i] = true;
+                }
+
+                for (auto &future : preparing)
+                {
+                    if (future.valid())
+                    {
+                        future.wait();
+                    }
+                }
+
+                batch.prepareTime = std::chrono::microseconds(prepareTime.load());
+
+                m_blockImportStatistics.blockCount += batch.blockCount;
+                m_blockImportStatistics.prepareTime += batch.prepareTime;
+                m_blockImportStatistics.prepareWaitTime += batch.prepareWaitTime;
+
+                logBlockImportStatistics(batch);
+            });
+
+        /* Submitted in reverse, as the pool threads take their most recently
+           added job first, and we want the earliest blocks prepared first */
+        for (size_t i = blockCount; i-- > 0;)
+        {
+            preparing[i] = m_transactionValidationThreadPool.addJob([&prepare, i] { prepare(i); });
+        }
+
+        for (size_t i = 0; i < blockCount; i++)
+        {
+            const auto waitStart = std::chrono::steady_clock::now();
+
+            /* If a pool thread hasn't started on this block yet, prepare it
+               ourselves rather than waiting */
+            prepare(i);
+            preparing[i].wait();
+
+            batch.prepareWaitTime +=
+                std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - waitStart);
+
+            const auto validateTime = m_blockImportStatistics.validateTime;
+            const auto commitTime = m_blockImportStatistics.commitTime;
+
+            const auto result = addPreparedBlock(cachedBlocks[i], std::move(rawBlocks[i]), &preparedBlocks[i]);
+
+            batch.validateTime += m_blockImportStatistics.validateTime - validateTime;
+            batch.commitTime += m_blockImportStatistics.commitTime - commitTime;
+            batch.blockCount++;
+
+            /* Free the transactions now rather than holding on to the whole batch */
+            preparedBlocks[i] = PreparedBlock();
+
+            if (!blockAdded(i, result))
+            {
+                break;
+            }
+        }
+    }
+
+    void Core::prepareBlock(const CachedBlock &cachedBlock, const RawBlock &rawBlock, PreparedBlock &preparedBlock)
+    {
+        preparedBlock.transactionsExtracted =
+            extractTransactions(rawBlock.transactions, preparedBlock.transactions, preparedBlock.cumulativeSize);
+
+        if (!preparedBlock.transactionsExtracted)
+        {
+            return;
+        }
+
+        /* Warm up the hashes the validation will need */
+        for (const auto &transaction : preparedBlock.transactions)
+        {
+            transaction.getTransactionHash();
+            transaction.getTransactionPrefixHash();
+        }
+
+        /* The proof of work itself can only be checked once we know the
+           difficulty, but the expensive part is the hash, which we can do now */
+        if (!checkpoints.isInCheckpointZone(cachedBlock.getBlockIndex()))
+        {
+            try
+            {
+                cachedBlock.getBlockLongHash();
+            }
+            catch (const std::exception &)
+            {
+                /* Will be thrown again, and handled, when validating the block */
+            }
+        }
+    }
+
+    bool Core::verifyCheckpointChain(const uint32_t startIndex, const std::vector<Crypto::Hash> &blockIds)
+    {
+        throwIfNotInitialized();
+
+        /* The last id in the chain at a checkpoint. The checkpointed block's
+           hash covers its previous block hash, which covers the one before
+           it, and so on, so the ids up to it are the only ones that block
+           can link to. The ids after it are left for the next chain entry. */
+        size_t verifiedCount = 0;
+
+        for (size_t i = 0; i < blockIds.size(); i++)
+        {
+            const uint32_t blockIndex = startIndex + static_cast<uint32_t>(i);
+
+            if (!checkpoints.isInCheckpointZone(blockIndex))
+            {
+                break;
+            }
+
+            bool isCheckpoint = false;
+
+            if (!checkpoints.checkBlock(blockIndex, blockIds[i], isCheckpoint))
+            {
+                logger(Logging::WARNING) << "Block id " << blockIds[i] << " at " << blockIndex
+                                         << " doesn't match the checkpoint";
+                return false;
+            }
+
+            if (isCheckpoint)
+            {
+                verifiedCount = i + 1;
+            }
+        }
+
+        if (!m_trustedCheckpointImport)
+        {
+            return true;
+        }
+
+        const uint32_t topBlockIndex = getTopBlockIndex();
+
+        std::scoped_lock lock(m_checkpointVerifiedBlocksMutex);
+
+        /* Forget the blocks we've got since, so chains we didn't end up
+           downloading don't build up */
+        for (auto it = m_checkpointVerifiedBlocks.begin(); it != m_checkpointVerifiedBlocks.end();)
+        {
+            if (it->second <= topBlockIndex)
+            {
+                it = m_checkpointVerifiedBlocks.erase(it);
+            }
+            else
+            {
+                ++it;
+            }
+        }
+
+        for (size_t i = 0; i < verifiedCount; i++)
+        {
+            const uint32_t blockIndex = startIndex + static_cast<uint32_t>(i);
+
+            if (blockIndex > topBlockIndex)
+            {
+                m_checkpointVerifiedBlocks.emplace(blockIds[i], blockIndex);
+            }
+        }
+
+        return true;
+    }
+
+    bool Core::isCheckpointVerified(const Crypto::Hash &blockHash, const uint32_t blockIndex) const
+    {
+        std::scoped_lock lock(m_checkpointVerifiedBlocksMutex);
+
+        const auto it = m_checkpointVerifiedBlocks.find(blockHash);
+
+        return it != m_checkpointVerifiedBlocks.end() && it->second == blockIndex;
+    }
+
+    void Core::logBlockImportStatistics(const BlockImportStatistics &batch)
+    {
+        const auto perSecond = [](const uint64_t blockCount, const std::chrono::microseconds time)
+        {
+            return time.count() == 0 ? 0 : blockCount * 1000000 / time.count();
+        };
+
+        const auto describe = [&](const BlockImportStatistics &stats)
+        {
+            std::stringstream stream;
+
+            stream << stats.blockCount << " blocks"
+                   << ", prepare: " << stats.prepareTime.count() / 1000 << " ms ("
+                   << perSecond(stats.blockCount, stats.prepareTime) << " blocks/s per thread)"
+                   << ", waiting on prepare: " << stats.prepareWaitTime.count() / 1000 << " ms"
+                   << ", validate: " << stats.validateTime.count() / 1000 << " ms ("
+                   << perSecond(stats.blockCount, stats.validateTime) << " blocks/s)"
+                   << ", commit: " << stats.commitTime.count() / 1000 << " ms ("
+                   << perSecond(stats.blockCount, stats.commitTime) << " blocks/s)";
+
+            return stream.str();
+        };
+
+        logger(Logging::DEBUGGING) << "Block import: " << describe(batch);
+
+        /* Print the running totals every so often, so we can see where the
+           time goes over a long sync */
+        if (m_blockImportStatistics.blockCount / 10000
+            != (m_blockImportStatistics.blockCount - batch.blockCount) / 10000)
+        {
+            logger(Logging::INFO) << "Block import totals: " << describe(m_blockImportStatistics);
+        }
+    }
+
+    std::error_code Core::addPreparedBlock(
+        const CachedBlock &cachedBlock,
+        RawBlock &&rawBlock,
+        PreparedBlock *preparedBlock)
+    {
+        throwIfNotInitialized();
+
+        const auto validateStart = std::chrono::steady_clock::now();
+
         uint32_t blockIndex = cachedBlock.getBlockIndex();
         Crypto::Hash blockHash = cachedBlock.getBlockHash();
         std::ostringstream os;
@@ -1189,7 +1686,15 @@ namespace CryptoNote
 
         std::vector<CachedTransaction> transactions;
         uint64_t cumulativeSize = 0;
-        if (!extractTransactions(rawBlock.transactions, transactions, cumulativeSize))
+
+        if (preparedBlock != nullptr)
+        {
+            transactions = std::move(preparedBlock->transactions);
+            cumulativeSize = preparedBlock->cumulativeSize;
+        }
+
+        if (preparedBlock != nullptr ? !preparedBlock->transactionsExtracted
+                                     : !extractTransactions(rawBlock.transactions, transactions, cumulativeSize))
         {
             logger(Logging::DEBUGGING) << "Couldn't deserialize raw block transactions in block " << blockStr;
             return error::AddBlockErrorCode::DESERIALIZATION_FAILED;
@@ -1210,8 +1715,23 @@ namespace CryptoNote
             return error::BlockValidationError::CUMULATIVE_BLOCK_SIZE_TOO_BIG;
         }
 
+        /* Below the last checkpoint the blocks are already known to be valid,
+           provided they are the blocks the checkpoints commit to. The block
+           ids a peer sent us were checked against the checkpoints when they
+           arrived, so for a block among them we can skip validating the block
+           and its transactions, and just pull out what we need to store them.
+           We only do this when extending the main chain - anything else is
+           validated fully.
+
+           The block hash covers the transaction hashes, so we still check the
+           transactions we got are the ones in the header. */
+        const bool trustedImport = m_trustedCheckpointImport && checkpoints.isInCheckpointZone(blockIndex)
+                                   && addOnTop && cache == chainsLeaves[0] && cache->getChildCount() == 0
+                                   && isCheckpointVerified(blockHash, blockIndex);
+
         uint64_t minerReward = 0;
-        auto blockValidationResult = validateBlock(cachedBlock, cache, minerReward);
+
+        auto blockValidationResult = trustedImport ? std::error_code() : validateBlock(cachedBlock, cache, minerReward);
         if (blockValidationResult)
         {
             logger(Logging::DEBUGGING) << "Failed to validate block " << blockStr << ": "
@@ -1228,7 +1748,7 @@ namespace CryptoNote
 
         // Copyright (c) 2018-2019, The Galaxia Project Developers
         // See https://github.com/turtlecoin/turtlecoin/issues/748 for more information
-        if (blockIndex >= CryptoNote::parameters::BLOCK_BLOB_SHUFFLE_CHECK_HEIGHT)
+        if (trustedImport || blockIndex >= CryptoNote::parameters::BLOCK_BLOB_SHUFFLE_CHECK_HEIGHT)
         {
             /* Check to verify that the blocktemplate suppied contains no duplicate transaction hashes */
             if (!Utilities::is_unique(blockTemplate.transactionHashes.begin(), blockTemplate.transactionHashes.end()))
@@ -1273,11 +1793,43 @@ namespace CryptoNote
 
         uint64_t cumulativeFee = 0;
 
+        const auto removeInvalidPoolTransaction = [this](const Crypto::Hash &hash)
+        {
+            if (transactionPool->checkIfTransactionPresent(hash))
+            {
+                logger(Logging::DEBUGGING) << "Invalid transaction " << hash << " is present in the pool, removing";
+                transactionPool->removeTransaction(hash);
+                notifyObservers(makeDelTransactionMessage({hash}, Messages::DeleteTransaction::Reason::NotActual));
+            }
+        };
+
+        /* Ring signatures of every transaction in the block, if we are verifying
+         * them in one go after the rest of the validation */
+        std::vector<Crypto::RingSignatureBatchEntry> deferredSignatures;
+
+        /* The number of deferred signatures after each transaction, so we can
+         * figure out which transaction a failing signature belongs to */
+        std::vector<size_t> deferredSignatureOffsets;
+
         for (const auto &transaction : transactions)
         {
+            if (trustedImport)
+            {
+                mergeStates(validatorState, extractSpentOutputs(transaction));
+                cumulativeFee += transaction.getTransactionFee();
+                continue;
+            }
+
             uint64_t fee = 0;
             auto transactionValidationResult = validateTransaction(
-                transaction, validatorState, cache, m_transactionValidationThreadPool, fee, previousBlockIndex, false);
+                transaction,
+                validatorState,
+                cache,
+                m_transactionValidationThreadPool,
+                fee,
+                previousBlockIndex,
+                false,
+                m_batchSignatureVerification ? &deferredSignatures : nullptr);
 
             if (!transactionValidationResult.valid)
             {
@@ -1286,17 +1838,35 @@ namespace CryptoNote
                 logger(Logging::DEBUGGING)
                     << "Failed to validate transaction " << hash << ": " << transactionValidationResult.errorMessage;
 
-                if (transactionPool->checkIfTransactionPresent(hash))
-                {
-                    logger(Logging::DEBUGGING) << "Invalid transaction " << hash << " is present in the pool, removing";
-                    transactionPool->removeTransaction(hash);
-                    notifyObservers(makeDelTransactionMessage({hash}, Messages::DeleteTransaction::Reason::NotActual));
-                }
+                removeInvalidPoolTransaction(hash);
 
                 return transactionValidationResult.errorCode;
             }
 
             cumulativeFee += fee;
+
+            deferredSignatureOffsets.push_back(deferredSignatures.size());
+        }
+
+        if (!deferredSignatures.empty())
+        {
+            auto [valid, failedIndex] = checkRingSignatures(std::move(deferredSignatures));
+
+            if (!valid)
+            {
+                const auto transactionIndex = std::distance(
+                    deferredSignatureOffsets.begin(),
+                    std::upper_bound(deferredSignatureOffsets.begin(), deferredSignatureOffsets.end(), failedIndex));
+
+                const auto hash = transactions[transactionIndex].getTransactionHash();
+
+                logger(Logging::DEBUGGING) << "Failed to validate transaction " << hash
+                                           << ": Transaction contains invalid signatures";
+
+                removeInvalidPoolTransaction(hash);
+
+                return error::TransactionValidationError::INPUT_INVALID_SIGNATURES;
+            }
         }
 
         uint64_t reward = 0;
@@ -1320,7 +1890,7 @@ namespace CryptoNote
             return error::BlockValidationError::CUMULATIVE_BLOCK_SIZE_TOO_BIG;
         }
 
-        if (minerReward != reward)
+        if (!trustedImport && minerReward != reward)
         {
             logger(Logging::DEBUGGING) << "Block reward mismatch for block " << blockStr
                                        << ". Expected reward: " << reward << ", got reward: " << minerReward;
@@ -1341,6 +1911,8 @@ namespace CryptoNote
             return error::BlockValidationError::PROOF_OF_WORK_TOO_WEAK;
         }
 
+        const auto commitStart = std::chrono::steady_clock::now();
+
         auto ret = error::AddBlockErrorCode::ADDED_TO_ALTERNATIVE;
 
         if (addOnTop)
@@ -1371,6 +1943,13 @@ namespace CryptoNote
                        be in the pool that would now be considered invalid */
                     checkAndRemoveInvalidPoolTransactions(validatorState);
 
+                    if (trustedImport)
+                    {
+                        std::scoped_lock lock(m_checkpointVerifiedBlocksMutex);
+
+                        m_checkpointVerifiedBlocks.erase(blockHash);
+                    }
+
                     ret = error::AddBlockErrorCode::ADDED_TO_MAIN;
                     logger(Logging::DEBUGGING) << "Block " << blockStr << " added to main chain.";
                     if ((previousBlockIndex + 1) % 100 == 0)
@@ -1405,10 +1984,11 @@ namespace CryptoNote
 
                         updateBlockMedianSize();
 
-                        /* Take the current block spent key images and run them
-                           against the pool to remove any transactions that may
-                           be in the pool that would now be considered invalid */
-                        checkAndRemoveInvalidPoolTransactions(validatorState);
+                        /* Every block we switched to can have spent something
+                           in the pool, not just this one, so run all of their
+                           key images against the pool */
+                        checkAndRemoveInvalidPoolTransactions(
+                            getSpentOutputsAboveSplit(chainsLeaves[0], chainsLeaves[endpointIndex]));
 
                         copyTransactionsToPool(chainsLeaves[endpointIndex]);
 
@@ -1492,6 +2072,16 @@ namespace CryptoNote
         logger(Logging::DEBUGGING) << "Block: " << blockStr << " successfully added";
         notifyOnSuccess(ret, previousBlockIndex, cachedBlock, *cache);
 
+        if (preparedBlock != nullptr)
+        {
+            const auto commitEnd = std::chrono::steady_clock::now();
+
+            m_blockImportStatistics.validateTime +=
+                std::chrono::duration_cast<std::chrono::microseconds>(commitStart - validateStart);
+            m_blockImportStatistics.commitTime +=
+                std::chrono::duration_cast<std::chrono::microseconds>(commitEnd - commitStart);
+        }
+
         return ret;
     }
 
@@ -1505,55 +2095,37 @@ namespace CryptoNote
     {
         auto &pool = *transactionPool;
 
-        const auto poolHashes = pool.getTransactionHashes();
-
         const auto maxTransactionSize = getMaximumTransactionAllowedSize(blockMedianSize, currency);
 
-        for (const auto &poolTxHash : poolHashes)
-        {
-            const auto poolTx = pool.tryGetTransaction(poolTxHash);
-
-            /* Tx got removed by another thread */
-            if (!poolTx)
-            {
-                continue;
-            }
+        const auto [minMixin, maxMixin, defaultMixin] = Utilities::getMixinAllowableRange(getTopBlockIndex());
 
-            const auto poolTxState = extractSpentOutputs(*poolTx);
+        /* The pool's indexes give us the transactions which spend something
+           the block spent - including the ones in the block - and the ones
+           which are now too big, or have the wrong mixin. So this costs as
+           much as the block, not as much as the pool. */
+        std::unordered_set<Crypto::Hash> invalidTransactions;
 
-            auto [mixinSuccess, err] = Mixins::validate({*poolTx}, getTopBlockIndex());
+        for (const auto &hash : pool.getTransactionHashesByKeyImages(blockTransactionsState.spentKeyImages))
+        {
+            invalidTransactions.insert(hash);
+        }
 
-            bool isValid = true;
+        for (const auto &hash : pool.getTransactionHashesOutsideLimits(maxTransactionSize, minMixin, maxMixin))
+        {
+            invalidTransactions.insert(hash);
+        }
 
-            /* If the transaction is in the chain but somehow was not previously removed, fail */
-            if (isTransactionInChain(poolTxHash))
-            {
-                isValid = false;
-            }
-            /* If the transaction does not have the right number of mixins, fail */
-            else if (!mixinSuccess)
-            {
-                isValid = false;
-            }
-            /* If the transaction exceeds the maximum size of a transaction, fail */
-            else if (poolTx->getTransactionBinaryArray().size() > maxTransactionSize)
-            {
-                isValid = false;
-            }
-            /* If the the transaction contains outputs that were spent in the new block, fail */
-            else if (hasIntersections(blockTransactionsState, poolTxState))
+        /* Remove them from the pool, and tell everyone else that they should
+           also remove them from the pool */
+        for (const auto &poolTxHash : invalidTransactions)
+        {
+            /* Tx got removed by another thread */
+            if (!pool.removeTransaction(poolTxHash))
             {
-                isValid = false;
+                continue;
             }
 
-            /* If the transaction is no longer valid, remove it from the pool
-               and tell everyone else that they should also remove it from the pool */
-            if (!isValid)
-            {
-                pool.removeTransaction(poolTxHash);
-                notifyObservers(
-                    makeDelTransactionMessage({poolTxHash}, Messages::DeleteTransaction::Reason::NotActual));
-            }
+            notifyObservers(makeDelTransactionMessage({poolTxHash}, Messages::DeleteTransaction::Reason::NotActual));
         }
     }
 
@@ -1699,14 +2271,17 @@ namespace CryptoNote
     }
 
     std::tuple<bool, std::string> Core::getRandomOutputs(
-        uint64_t amount,
+        const std::vector<uint64_t> &amounts,
         uint16_t count,
-        std::vector<uint32_t> &globalIndexes,
-        std::vector<Crypto::PublicKey> &publicKeys) const
+        std::vector<std::vector<uint32_t>> &globalIndexes,
+        std::vector<std::vector<Crypto::PublicKey>> &publicKeys) const
     {
         throwIfNotInitialized();
 
-        if (count == 0)
+        globalIndexes.assign(amounts.size(), {});
+        publicKeys.assign(amounts.size(), {});
+
+        if (count == 0 || amounts.empty())
         {
             return {true, ""};
         }
@@ -1719,55 +2294,46 @@ namespace CryptoNote
             return {false, error};
         }
 
-        globalIndexes = chainsLeaves[0]->getRandomOutsByAmount(amount, count, getTopBlockIndex());
+        std::vector<std::vector<std::pair<IBlockchainCache::GlobalOutputIndex, Crypto::PublicKey>>> outputs;
 
-        if (globalIndexes.empty())
+        try
         {
-            std::stringstream stream;
-
-            stream << "Failed to get any matching outputs for amount " << amount << " ("
-                   << Utilities::formatAmount(amount) << "). Further explanation here: "
-                   << "https://gist.github.com/zpalmtree/80b3e80463225bcfb8f8432043cb594c\n"
-                   << "Note: If you are a public node operator, you can safely ignore this message. "
-                   << "It is only relevant to the user sending the transaction.";
-
-            std::string error = stream.str();
-
-            logger(Logging::ERROR) << error;
-
-            return {false, error};
+            outputs = chainsLeaves[0]->getRandomOutsByAmounts(amounts, count, getTopBlockIndex());
         }
+        catch (const std::exception &e)
+        {
+            logger(Logging::DEBUGGING) << "Failed to get random outputs: " << e.what();
 
-        std::sort(globalIndexes.begin(), globalIndexes.end());
+            return {false, e.what()};
+        }
 
-        switch (chainsLeaves[0]->extractKeyOutputKeys(
-            amount, getTopBlockIndex(), {globalIndexes.data(), globalIndexes.size()}, publicKeys))
+        for (size_t i = 0; i < amounts.size(); i++)
         {
-            case ExtractOutputKeysResult::SUCCESS:
-            {
-                return {true, ""};
-            }
-            case ExtractOutputKeysResult::INVALID_GLOBAL_INDEX:
+            if (outputs[i].empty())
             {
-                std::string error = "Invalid global index is given";
+                std::stringstream stream;
+
+                stream << "Failed to get any matching outputs for amount " << amounts[i] << " ("
+                       << Utilities::formatAmount(amounts[i]) << "). Further explanation here: "
+                       << "https://gist.github.com/zpalmtree/80b3e80463225bcfb8f8432043cb594c\n"
+                       << "Note: If you are a public node operator, you can safely ignore this message. "
+                       << "It is only relevant to the user sending the transaction.";
+
+                std::string error = stream.str();
 
-                logger(Logging::DEBUGGING) << error;
+                logger(Logging::ERROR) << error;
 
                 return {false, error};
             }
-            case ExtractOutputKeysResult::OUTPUT_LOCKED:
-            {
-                std::string error = "Output is locked";
-
-                logger(Logging::DEBUGGING) << error;
 
-                return {false, error};
-            }
-            default:
+            for (const auto &[globalIndex, publicKey] : outputs[i])
             {
-                return {false, "Unknown error"};
+                globalIndexes[i].push_back(globalIndex);
+                publicKeys[i].push_back(publicKey);
             }
         }
+
+        return {true, ""};
     }
 
     bool Core::getGlobalIndexesForRange(
@@ -1961,18 +2527,28 @@ namespace CryptoNote
         return getTopBlockHash() == lastBlockHash;
     }
 
-    std::tuple<bool, std::string> Core::getBlockTemplate(
-        BlockTemplate &b,
-        const Crypto::PublicKey &publicViewKey,
-        const Crypto::PublicKey &publicSpendKey,
-        const BinaryArray &extraNonce,
-        uint64_t &difficulty,
-        uint32_t &height)
+    bool Core::getPoolChangesSince(
+        const uint64_t epoch,
+        const uint64_t revision,
+        std::vector<Crypto::Hash> &addedTransactions,
+        std::vector<Crypto::Hash> &deletedTransactions,
+        uint64_t &currentEpoch,
+        uint64_t &currentRevision) const
     {
         throwIfNotInitialized();
 
-        height = getTopBlockIndex() + 1;
-        difficulty = getDifficultyForNextBlock();
+        return transactionPool->getChangesSince(
+            epoch, revision, addedTransactions, deletedTransactions, currentEpoch, currentRevision);
+    }
+
+    std::tuple<bool, std::string> Core::updateCachedBlockTemplate()
+    {
+        CachedBlockTemplate &cached = m_cachedBlockTemplate;
+
+        cached.valid = false;
+
+        const uint32_t height = getTopBlockIndex() + 1;
+        const uint64_t difficulty = getDifficultyForNextBlock();
 
         if (height >= CryptoNote::parameters::CRYPTONOTE_STOP_BLOCK_NUMBER)
         {
@@ -1992,6 +2568,8 @@ namespace CryptoNote
             return {false, error};
         }
 
+        BlockTemplate &b = cached.block;
+
         b = boost::value_initialized<BlockTemplate>();
         b.majorVersion = getBlockMajorVersionForHeight(height);
 
@@ -2030,7 +2608,6 @@ namespace CryptoNote
         }
 
         b.previousBlockHash = getTopBlockHash();
-        b.timestamp = time(nullptr);
 
         /* Ok, so if an attacker is fiddling around with timestamps on the network,
            they can make it so all the valid pools / miners don't produce valid
@@ -2066,31 +2643,95 @@ namespace CryptoNote
            proper median yet */
         if (height >= blockchain_timestamp_check_window)
         {
-            std::vector<uint64_t> timestamps;
-
             /* For the last N blocks, get their timestamps */
-            for (size_t offset = height - blockchain_timestamp_check_window; offset < height; offset++)
-            {
-                timestamps.push_back(getBlockTimestampByIndex(offset));
-            }
+            std::vector<uint64_t> timestamps =
+                chainsLeaves[0]->getLastTimestamps(blockchain_timestamp_check_window, height - 1, addGenesisBlock);
+
+            cached.medianTimestamp = Common::medianValue(timestamps);
+        }
+        else
+        {
+            cached.medianTimestamp = 0;
+        }
+
+        cached.medianSize = calculateCumulativeBlocksizeLimit(height) / 2;
+
+        assert(!chainsStorage.empty());
+        assert(!chainsLeaves.empty());
+        cached.alreadyGeneratedCoins = chainsLeaves[0]->getAlreadyGeneratedCoins();
 
-            uint64_t medianTimestamp = Common::medianValue(timestamps);
+        /* Taken before filling, so a transaction removed by another thread
+           while we fill means a rebuild next time, rather than a template with
+           a transaction the pool no longer has */
+        const uint64_t poolRemovalRevision = transactionPool->getRemovalRevision();
 
-            if (b.timestamp < medianTimestamp)
+        fillBlockTemplate(
+            b,
+            cached.medianSize,
+            currency.maxBlockCumulativeSize(height),
+            height,
+            cached.transactionsSize,
+            cached.fee);
+
+        cached.topBlockHash = getTopBlockHash();
+        cached.difficulty = difficulty;
+        cached.height = height;
+
+        /* Taken after filling, as invalid transactions are removed from the
+           pool as we go */
+        cached.poolRevision = transactionPool->getRevision();
+        cached.poolRemovalRevision = poolRemovalRevision;
+        cached.builtAt = std::chrono::steady_clock::now();
+        cached.valid = true;
+
+        return {true, std::string()};
+    }
+
+    std::tuple<bool, std::string> Core::getBlockTemplate(
+        BlockTemplate &b,
+        const Crypto::PublicKey &publicViewKey,
+        const Crypto::PublicKey &publicSpendKey,
+        const BinaryArray &extraNonce,
+        uint64_t &difficulty,
+        uint32_t &height)
+    {
+        throwIfNotInitialized();
+
+        std::scoped_lock<std::mutex> lock(m_blockTemplateMutex);
+
+        /* A transaction which has left the pool, say when the pool cleaner
+           expires it, might be in the template, and submitBlock() would then
+           reject the block, so any removal means a rebuild. New pool
+           transactions can wait for the next rebuild. */
+        const bool poolTransactionRemoved =
+            m_cachedBlockTemplate.poolRemovalRevision != transactionPool->getRemovalRevision();
+
+        const bool poolOutdated = m_cachedBlockTemplate.poolRevision != transactionPool->getRevision()
+                                  && std::chrono::steady_clock::now() - m_cachedBlockTemplate.builtAt
+                                         >= std::chrono::seconds(BLOCK_TEMPLATE_POOL_REFRESH_INTERVAL);
+
+        if (!m_cachedBlockTemplate.valid || m_cachedBlockTemplate.topBlockHash != getTopBlockHash()
+            || poolTransactionRemoved || poolOutdated)
+        {
+            const auto [success, error] = updateCachedBlockTemplate();
+
+            if (!success)
             {
-                b.timestamp = medianTimestamp;
+                return {false, error};
             }
         }
 
-        size_t medianSize = calculateCumulativeBlocksizeLimit(height) / 2;
+        /* All that's left is the timestamp and the miner transaction */
+        b = m_cachedBlockTemplate.block;
+        difficulty = m_cachedBlockTemplate.difficulty;
+        height = m_cachedBlockTemplate.height;
 
-        assert(!chainsStorage.empty());
-        assert(!chainsLeaves.empty());
-        uint64_t alreadyGeneratedCoins = chainsLeaves[0]->getAlreadyGeneratedCoins();
+        b.timestamp = std::max<uint64_t>(time(nullptr), m_cachedBlockTemplate.medianTimestamp);
 
-        size_t transactionsSize;
-        uint64_t fee;
-        fillBlockTemplate(b, medianSize, currency.maxBlockCumulativeSize(height), height, transactionsSize, fee);
+        const size_t medianSize = m_cachedBlockTemplate.medianSize;
+        const uint64_t alreadyGeneratedCoins = m_cachedBlockTemplate.alreadyGeneratedCoins;
+        const size_t transactionsSize = m_cachedBlockTemplate.transactionsSize;
+        const uint64_t fee = m_cachedBlockTemplate.fee;
 
         /*
            two-phase miner transaction generation: we don't know exact block size until we prepare block, but we don't
@@ -2299,10 +2940,11 @@ namespace CryptoNote
         const CachedTransaction &cachedTransaction,
         TransactionValidatorState &state,
         IBlockchainCache *cache,
-        Utilities::ThreadPool<bool> &threadPool,
+        Utilities::ThreadPool &threadPool,
         uint64_t &fee,
         uint32_t blockIndex,
-        const bool isPoolTransaction)
+        const bool isPoolTransaction,
+        std::vector<Crypto::RingSignatureBatchEntry> *deferredSignatures)
     {
         ValidateTransaction txValidator(
             cachedTransaction,
@@ -2313,7 +2955,8 @@ namespace CryptoNote
             threadPool,
             blockIndex,
             blockMedianSize,
-            isPoolTransaction);
+            isPoolTransaction,
+            deferredSignatures);
 
         auto result = txValidator.validate();
 
@@ -2322,6 +2965,54 @@ namespace CryptoNote
         return result;
     }
 
+    std::tuple<bool, size_t> Core::checkRingSignatures(std::vector<Crypto::RingSignatureBatchEntry> &&signatures)
+    {
+        /* Split the signatures into one contiguous batch per validation thread.
+         * Each batch shares the decompressed ring members between its signatures. */
+        const size_t batchCount =
+            std::min<size_t>(m_transactionValidationThreadPool.getThreadCount(), signatures.size());
+
+        const size_t batchSize = (signatures.size() + batchCount - 1) / batchCount;
+
+        std::vector<std::vector<Crypto::RingSignatureBatchEntry>> batches(batchCount);
+
+        for (size_t i = 0; i < signatures.size(); i++)
+        {
+            batches[i / batchSize].push_back(std::move(signatures[i]));
+        }
+
+        std::vector<size_t> failedIndexes(batchCount, 0);
+
+        std::vector<char> batchValid(batchCount, true);
+
+        m_transactionValidationThreadPool.parallelFor(
+            0,
+            batchCount,
+            [&batches, &failedIndexes, &batchValid](const size_t i)
+            {
+                const auto [valid, failedIndex] = Crypto::crypto_ops::checkRingSignatures(batches[i]);
+
+                failedIndexes[i] = failedIndex;
+                batchValid[i] = valid;
+            });
+
+        bool valid = true;
+
+        size_t firstFailedIndex = 0;
+
+        for (size_t i = 0; i < batchCount; i++)
+        {
+            if (!batchValid[i])
+            {
+                valid = false;
+                firstFailedIndex = i * batchSize + failedIndexes[i];
+                break;
+            }
+        }
+
+        return {valid, firstFailedIndex};
+    }
+
     uint32_t Core::findBlockchainSupplement(const std::vector<Crypto::Hash> &remoteBlockIds) const
     {
         /* Requester doesn't know anything about the chain yet */
@@ -2496,6 +3187,8 @@ namespace CryptoNote
         deleteAlternativeChains();
         mergeMainChainSegments();
         chainsLeaves[0]->save();
+
+        savePoolSnapshot();
     }
 
     void Core::load()
@@ -2542,6 +3235,10 @@ namespace CryptoNote
         }
 
         initialized = true;
+
+        /* Before we start serving block templates, so the first ones aren't
+           empty */
+        loadPoolSnapshot();
     }
 
     void Core::initRootSegment()
@@ -2569,64 +3266,155 @@ namespace CryptoNote
 
         auto previousBlockHash = getBlockHash(mainChainStorage->getBlockByIndex(commonIndex));
         auto blockCount = mainChainStorage->getBlockCount();
-        for (uint32_t i = commonIndex + 1; i < blockCount; ++i)
+
+        if (commonIndex + 1 >= blockCount)
+        {
+            return;
+        }
+
+        logger(Logging::INFO) << "Importing blocks " << (commonIndex + 1) << " to " << (blockCount - 1)
+                              << " from the main chain storage";
+
+        /* Reads the blocks in [startIndex, endIndex) from the storage, and
+           decodes and hashes them across the thread pool. Only the pushing
+           into the database has to happen one block at a time. */
+        const auto prepareBlocks = [this](const uint32_t startIndex, const uint32_t endIndex)
         {
-            RawBlock rawBlock = mainChainStorage->getBlockByIndex(i);
-            auto blockTemplate = extractBlockTemplate(rawBlock);
-            CachedBlock cachedBlock(blockTemplate);
+            std::vector<ImportedBlock> blocks(endIndex - startIndex);
 
-            if (blockTemplate.previousBlockHash != previousBlockHash)
+            for (uint32_t i = startIndex; i < endIndex; i++)
             {
-                logger(Logging::ERROR)
-                    << "Local blockchain corruption detected. " << std::endl
-                    << "Block with index " << i << " and hash " << cachedBlock.getBlockHash()
-                    << " has previous block hash " << blockTemplate.previousBlockHash << ", but parent has hash "
-                    << previousBlockHash << "." << std::endl
-                    << "Please try to repair this issue by starting the node with the option: --rewind-to-height " << i
-                    << std::endl
-                    << "If the above does not repair the issue, please launch the node with the option: --resync"
-                    << std::endl;
-                throw std::system_error(make_error_code(error::CoreErrorCode::CORRUPTED_BLOCKCHAIN));
+                blocks[i - startIndex].rawBlock = mainChainStorage->getBlockByIndex(i);
             }
 
-            previousBlockHash = cachedBlock.getBlockHash();
+            m_transactionValidationThreadPool.parallelFor(
+                0,
+                blocks.size(),
+                [this, &blocks](const size_t i) { prepareImportedBlock(blocks[i]); });
 
-            std::vector<CachedTransaction> transactions;
-            uint64_t cumulativeSize = 0;
-            if (!extractTransactions(rawBlock.transactions, transactions, cumulativeSize))
+            return blocks;
+        };
+
+        const auto nextBatch = [blockCount](const uint32_t startIndex)
+        {
+            return std::min(blockCount, startIndex + IMPORT_BATCH_SIZE);
+        };
+
+        /* While we push one batch, the next is being prepared */
+        std::future<std::vector<ImportedBlock>> preparing = m_transactionValidationThreadPool.addJob(
+            [&prepareBlocks, &nextBatch, commonIndex]()
+            { return prepareBlocks(commonIndex + 1, nextBatch(commonIndex + 1)); });
+
+        /* The job references our locals, don't leave until it is done */
+        Tools::ScopeExit waitForPreparing(
+            [&preparing]()
             {
-                logger(Logging::ERROR) << "Couldn't deserialize raw block transactions in block "
-                                       << cachedBlock.getBlockHash();
-                throw std::system_error(make_error_code(error::AddBlockErrorCode::DESERIALIZATION_FAILED));
-            }
+                if (preparing.valid())
+                {
+                    preparing.wait();
+                }
+            });
 
-            cumulativeSize += getObjectBinarySize(blockTemplate.baseTransaction);
-            TransactionValidatorState spentOutputs = extractSpentOutputs(transactions);
-            auto currentDifficulty = chainsLeaves[0]->getDifficultyForNextBlock(i - 1);
+        const auto startTime = std::chrono::steady_clock::now();
 
-            uint64_t cumulativeFee = std::accumulate(
-                transactions.begin(),
-                transactions.end(),
-                UINT64_C(0),
-                [](uint64_t fee, const CachedTransaction &transaction)
-                { return fee + transaction.getTransactionFee(); });
+        uint32_t batchStart = commonIndex + 1;
 
-            int64_t emissionChange =
-                getEmissionChange(currency, *chainsLeaves[0], i - 1, cachedBlock, cumulativeSize, cumulativeFee);
-            chainsLeaves[0]->pushBlock(
-                cachedBlock,
-                transactions,
-                spentOutputs,
-                cumulativeSize,
-                emissionChange,
-                currentDifficulty,
-                std::move(rawBlock));
+        while (batchStart < blockCount)
+        {
+            std::vector<ImportedBlock> blocks = preparing.get();
+
+            const uint32_t batchEnd = batchStart + static_cast<uint32_t>(blocks.size());
+
+            if (batchEnd < blockCount)
+            {
+                preparing = m_transactionValidationThreadPool.addJob(
+                    [&prepareBlocks, &nextBatch, batchEnd]() { return prepareBlocks(batchEnd, nextBatch(batchEnd)); });
+            }
 
-            if (i % 1000 == 0)
+            for (uint32_t i = batchStart; i < batchEnd; ++i)
             {
-                logger(Logging::INFO) << "Imported block with index " << i << " / " << (blockCount - 1);
+                ImportedBlock &block = blocks[i - batchStart];
+                const CachedBlock &cachedBlock = *block.cachedBlock;
+
+                if (block.blockTemplate.previousBlockHash != previousBlockHash)
+                {
+                    logger(Logging::ERROR)
+                        << "Local blockchain corruption detected. " << std::endl
+                        << "Block with index " << i << " and hash " << cachedBlock.getBlockHash()
+                        << " has previous block hash " << block.blockTemplate.previousBlockHash
+                        << ", but parent has hash " << previousBlockHash << "." << std::endl
+                        << "Please try to repair this issue by starting the node with the option: --rewind-to-height "
+                        << i << std::endl
+                        << "If the above does not repair the issue, please launch the node with the option: --resync"
+                        << std::endl;
+                    throw std::system_error(make_error_code(error::CoreErrorCode::CORRUPTED_BLOCKCHAIN));
+                }
+
+                previousBlockHash = cachedBlock.getBlockHash();
+
+                if (!block.transactionsExtracted)
+                {
+                    logger(Logging::ERROR) << "Couldn't deserialize raw block transactions in block "
+                                           << cachedBlock.getBlockHash();
+                    throw std::system_error(make_error_code(error::AddBlockErrorCode::DESERIALIZATION_FAILED));
+                }
+
+                auto currentDifficulty = chainsLeaves[0]->getDifficultyForNextBlock(i - 1);
+
+                int64_t emissionChange = getEmissionChange(
+                    currency, *chainsLeaves[0], i - 1, cachedBlock, block.cumulativeSize, block.cumulativeFee);
+
+                /* Each block is written to the database as it is pushed, so if
+                   we're stopped part way through, the next start carries on
+                   from the last block written */
+                chainsLeaves[0]->pushBlock(
+                    cachedBlock,
+                    block.transactions,
+                    block.spentOutputs,
+                    block.cumulativeSize,
+                    emissionChange,
+                    currentDifficulty,
+                    std::move(block.rawBlock));
             }
+
+            const auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(
+                                     std::chrono::steady_clock::now() - startTime)
+                                     .count();
+
+            const uint64_t imported = batchEnd - (commonIndex + 1);
+
+            logger(Logging::INFO) << "Imported block with index " << (batchEnd - 1) << " / " << (blockCount - 1)
+                                  << " (" << (imported * 1000 / std::max<int64_t>(elapsed, 1)) << " blocks/s)";
+
+            batchStart = batchEnd;
+        }
+    }
+
+    void Core::prepareImportedBlock(ImportedBlock &block)
+    {
+        block.blockTemplate = extractBlockTemplate(block.rawBlock);
+
+        /* References blockTemplate, which doesn't move from here on */
+        block.cachedBlock.emplace(block.blockTemplate);
+        block.cachedBlock->getBlockHash();
+
+        block.transactionsExtracted =
+            extractTransactions(block.rawBlock.transactions, block.transactions, block.cumulativeSize);
+
+        if (!block.transactionsExtracted)
+        {
+            return;
+        }
+
+        block.cumulativeSize += getObjectBinarySize(block.blockTemplate.baseTransaction);
+
+        for (const auto &transaction : block.transactions)
+        {
+            transaction.getTransactionHash();
+            block.cumulativeFee += transaction.getTransactionFee();
         }
+
+        block.spentOutputs = extractSpentOutputs(block.transactions);
     }
 
     void Core::cutSegment(IBlockchainCache &segment, uint32_t startIndex)
@@ -3372,6 +4160,56 @@ namespace CryptoNote
         return blockDetails;
     }
 
+    std::vector<BlockSummary> Core::getBlockSummaries(const uint32_t startIndex, const uint32_t count) const
+    {
+        throwIfNotInitialized();
+
+        const uint32_t endIndex =
+            static_cast<uint32_t>(std::min<uint64_t>(static_cast<uint64_t>(startIndex) + count, getTopBlockIndex() + 1));
+
+        /* The database is the bottom segment of the main chain */
+        IBlockchainCache *database = chainsLeaves[0];
+
+        while (database->getParent() != nullptr)
+        {
+            database = database->getParent();
+        }
+
+        std::vector<BlockSummary> summaries = database->getBlockSummaries(startIndex, endIndex);
+
+        for (uint32_t blockIndex = startIndex + static_cast<uint32_t>(summaries.size()); blockIndex < endIndex;
+             blockIndex++)
+        {
+            summaries.push_back(makeBlockSummary(getBlockDetails(getBlockHashByIndex(blockIndex))));
+        }
+
+        return summaries;
+    }
+
+    BlockSummary Core::getBlockSummary(const Crypto::Hash &blockHash) const
+    {
+        throwIfNotInitialized();
+
+        IBlockchainCache *segment = findSegmentContainingBlock(blockHash);
+
+        if (segment == nullptr)
+        {
+            throw std::runtime_error("Requested hash wasn't found in blockchain.");
+        }
+
+        if (mainChainSet.count(segment) != 0)
+        {
+            const auto summaries = getBlockSummaries(segment->getBlockIndex(blockHash), 1);
+
+            if (!summaries.empty())
+            {
+                return summaries.front();
+            }
+        }
+
+        return makeBlockSummary(getBlockDetails(blockHash));
+    }
+
     TransactionDetails Core::getTransactionDetails(const Crypto::Hash &transactionHash) const
     {
         throwIfNotInitialized();
@@ -3629,6 +4467,8 @@ namespace CryptoNote
     {
         System::Timer timer(dispatcher);
 
+        auto lastPoolSnapshot = std::chrono::steady_clock::now();
+
         try
         {
             for (;;)
@@ -3638,6 +4478,14 @@ namespace CryptoNote
                 auto deletedTransactions = transactionPool->clean(getTopBlockIndex());
                 notifyObservers(makeDelTransactionMessage(
                     std::move(deletedTransactions), Messages::DeleteTransaction::Reason::Outdated));
+
+                if (std::chrono::steady_clock::now() - lastPoolSnapshot >= POOL_SNAPSHOT_INTERVAL
+                    && transactionPool->getRevision() != m_poolSnapshotRevision)
+                {
+                    savePoolSnapshot();
+
+                    lastPoolSnapshot = std::chrono::steady_clock::now();
+                }
             }
         }
         catch (System::InterruptedException &)
@@ -3650,6 +4498,165 @@ namespace CryptoNote
         }
     }
 
+    void Core::savePoolSnapshot()
+    {
+        if (m_poolSnapshotFilename.empty())
+        {
+            return;
+        }
+
+        /* Take the top block before the pool, so the pool is at least as new
+           as the block we say it's from */
+        const uint32_t topBlockIndex = getTopBlockIndex();
+        const Crypto::Hash topBlockHash = getTopBlockHash();
+        const uint64_t revision = transactionPool->getRevision();
+
+        std::vector<PoolSnapshotTransaction> transactions;
+
+        for (const auto &[transaction, receiveTime] : transactionPool->getPoolTransactionsWithReceiveTime())
+        {
+            transactions.push_back({receiveTime, transaction.getTransactionBinaryArray()});
+        }
+
+        if (!TransactionPoolSnapshot::save(m_poolSnapshotFilename, topBlockIndex, topBlockHash, transactions))
+        {
+            logger(Logging::WARNING) << "Failed to save the transaction pool to " << m_poolSnapshotFilename;
+            return;
+        }
+
+        m_poolSnapshotRevision = revision;
+
+        logger(Logging::DEBUGGING) << "Saved " << transactions.size() << " pool transactions";
+    }
+
+    /* TransactionPoolSnapshot only loads a snapshot we wrote ourselves, and
+       the transactions were fully validated when they went into the pool, so
+       we only redo the checks that depend on the chain having moved on: the
+       size, extra and mixin limits, and whether their key images have been
+       spent since. Ring signatures are only checked again if the block the
+       snapshot was taken at is no longer in the main chain, as then the
+       outputs they refer to might be different. */
+    void Core::loadPoolSnapshot()
+    {
+        if (m_poolSnapshotFilename.empty())
+        {
+            return;
+        }
+
+        const auto startTime = std::chrono::steady_clock::now();
+
+        uint32_t snapshotBlockIndex;
+        Crypto::Hash snapshotBlockHash;
+        std::vector<PoolSnapshotTransaction> snapshot;
+
+        if (!TransactionPoolSnapshot::load(m_poolSnapshotFilename, snapshotBlockIndex, snapshotBlockHash, snapshot))
+        {
+            logger(Logging::DEBUGGING) << "No transaction pool snapshot to restore";
+            return;
+        }
+
+        const uint32_t topBlockIndex = getTopBlockIndex();
+
+        const bool sameChain =
+            snapshotBlockIndex <= topBlockIndex && getBlockHashByIndex(snapshotBlockIndex) == snapshotBlockHash;
+
+        const uint64_t currentTime = static_cast<uint64_t>(time(nullptr));
+
+        std::vector<std::optional<CachedTransaction>> transactions(snapshot.size());
+
+        /* Parsing, hashing and the height checks don't touch the database, so
+           can be done in parallel */
+        m_transactionValidationThreadPool.parallelFor(
+            0,
+            snapshot.size(),
+            [&](const size_t i)
+            {
+                /* Would be removed by the pool cleaner in a minute anyway */
+                if (currentTime > snapshot[i].receiveTime
+                    && currentTime - snapshot[i].receiveTime >= currency.mempoolTxLiveTime())
+                {
+                    return;
+                }
+
+                try
+                {
+                    CachedTransaction transaction(snapshot[i].transaction);
+
+                    /* These are worked out when first asked for, get them done
+                       while we're in parallel */
+                    transaction.getTransactionHash();
+                    transaction.getTransactionFee();
+
+                    if (validateBlockTemplateTransaction(transaction, topBlockIndex))
+                    {
+                        transactions[i] = std::move(transaction);
+                    }
+                }
+                catch (const std::exception &)
+                {
+                }
+            });
+
+        size_t restored = 0;
+
+        for (size_t i = 0; i < transactions.size(); i++)
+        {
+            if (!transactions[i])
+            {
+                continue;
+            }
+
+            TransactionValidatorState validatorState;
+
+            if (sameChain)
+            {
+                validatorState = extractSpentOutputs(*transactions[i]);
+
+                const bool spent = std::any_of(
+                    validatorState.spentKeyImages.begin(),
+                    validatorState.spentKeyImages.end(),
+                    [this](const Crypto::KeyImage &keyImage) { return chainsLeaves[0]->checkIfSpent(keyImage); });
+
+                if (spent)
+                {
+                    continue;
+                }
+            }
+            else
+            {
+                uint64_t fee;
+
+                const auto result = validateTransaction(
+                    *transactions[i],
+                    validatorState,
+                    chainsLeaves[0],
+                    m_transactionValidationThreadPool,
+                    fee,
+                    topBlockIndex,
+                    true);
+
+                if (!result.valid)
+                {
+                    continue;
+                }
+            }
+
+            if (transactionPool->pushTransaction(
+                    std::move(*transactions[i]), std::move(validatorState), snapshot[i].receiveTime))
+            {
+                restored++;
+            }
+        }
+
+        m_poolSnapshotRevision = transactionPool->getRevision();
+
+        const auto elapsed =
+            std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - startTime);
+
+        logger(Logging::INFO) << "Restored " << restored << " of " << snapshot.size()
+                              << " transactions to the pool in " << elapsed.count() << " ms";
+    }
+
     void Core::updateBlockMedianSize()
     {
         auto mainChain = chainsLeaves[0];
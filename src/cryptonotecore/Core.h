@@ -21,11 +21,14 @@
 #include "IUpgradeManager.h"
 #include "MessageQueue.h"
 #include "TransactionValidatiorState.h"
+#include "WalletSyncCache.h"
 
 #include <WalletTypes.h>
+#include <chrono>
 #include <cryptonotecore/ValidateTransaction.h>
 #include <ctime>
 #include <logging/LoggerMessage.h>
+#include <mutex>
 #include <system/ContextGroup.h>
 #include <unordered_map>
 #include <utilities/ThreadPool.h>
@@ -43,7 +46,10 @@ namespace CryptoNote
             System::Dispatcher &dispatcher,
             std::unique_ptr<IBlockchainCacheFactory> &&blockchainCacheFactory,
             std::unique_ptr<IMainChainStorage> &&mainChainStorage,
-            uint32_t transactionValidationThreads);
+            uint32_t transactionValidationThreads,
+            bool batchSignatureVerification = false,
+            bool trustedCheckpointImport = false,
+            const std::string &poolSnapshotFilename = std::string());
 
         virtual ~Core();
 
@@ -73,6 +79,8 @@ namespace CryptoNote
             uint32_t &totalBlockCount,
             uint32_t &startBlockIndex) const override;
 
+        virtual bool verifyCheckpointChain(uint32_t startIndex, const std::vector<Crypto::Hash> &blockIds) override;
+
         virtual std::vector<RawBlock> getBlocks(uint32_t minIndex, uint32_t count) const override;
 
         virtual void getBlocks(
@@ -146,17 +154,24 @@ namespace CryptoNote
 
         virtual std::error_code addBlock(RawBlock &&rawBlock) override;
 
+        virtual void addBlocks(
+            const std::vector<CachedBlock> &cachedBlocks,
+            std::vector<RawBlock> &&rawBlocks,
+            const std::function<bool(size_t, const std::error_code &)> &blockAdded) override;
+
         virtual std::error_code submitBlock(const BinaryArray &rawBlockTemplate) override;
 
         virtual bool getTransactionGlobalIndexes(
             const Crypto::Hash &transactionHash,
             std::vector<uint32_t> &globalIndexes) const override;
 
+        /* Fills globalIndexes and publicKeys with the outputs for each amount,
+           in the same order as amounts */
         virtual std::tuple<bool, std::string> getRandomOutputs(
-            uint64_t amount,
+            const std::vector<uint64_t> &amounts,
             uint16_t count,
-            std::vector<uint32_t> &globalIndexes,
-            std::vector<Crypto::PublicKey> &publicKeys) const override;
+            std::vector<std::vector<uint32_t>> &globalIndexes,
+            std::vector<std::vector<Crypto::PublicKey>> &publicKeys) const override;
 
         virtual bool getGlobalIndexesForRange(
             const uint64_t startHeight,
@@ -181,6 +196,18 @@ namespace CryptoNote
             std::vector<Transaction> &addedTransactions,
             std::vector<Crypto::Hash> &deletedTransactions) const override;
 
+        /* The pool transactions added and deleted since the pool was at the
+           given epoch and revision. False if that's from another epoch, or
+           too long ago, in which case every pool transaction is returned as
+           added. */
+        virtual bool getPoolChangesSince(
+            const uint64_t epoch,
+            const uint64_t revision,
+            std::vector<Crypto::Hash> &addedTransactions,
+            std::vector<Crypto::Hash> &deletedTransactions,
+            uint64_t &currentEpoch,
+            uint64_t &currentRevision) const override;
+
         virtual std::tuple<bool, std::string> getBlockTemplate(
             BlockTemplate &b,
             const Crypto::PublicKey &publicViewKey,
@@ -212,6 +239,14 @@ namespace CryptoNote
 
         BlockDetails getBlockDetails(const uint32_t blockHeight, const uint32_t attempt = 0) const;
 
+        /* The summaries of up to count main chain blocks, starting at
+           startIndex. Read from the database, and only worked out for blocks
+           which aren't in it. */
+        std::vector<BlockSummary> getBlockSummaries(const uint32_t startIndex, const uint32_t count) const;
+
+        /* Works for alternative blocks too, but they have to be worked out */
+        BlockSummary getBlockSummary(const Crypto::Hash &blockHash) const;
+
         virtual TransactionDetails getTransactionDetails(const Crypto::Hash &transactionHash) const override;
 
         virtual std::vector<Crypto::Hash>
@@ -229,7 +264,99 @@ namespace CryptoNote
 
         CryptoNote::RawBlock getRawBlock(const Crypto::Hash &blockHash) const;
 
+        WalletSyncCache::Statistics getWalletSyncCacheStatistics() const;
+
       private:
+        /* The parts of a block which can be computed without the chain state,
+           and so can be prepared in parallel ahead of adding the block */
+        struct PreparedBlock
+        {
+            bool transactionsExtracted = false;
+
+            std::vector<CachedTransaction> transactions;
+
+            uint64_t cumulativeSize = 0;
+        };
+
+        /* A block read back from the main chain storage when the database is
+           behind it, decoded ahead of being pushed */
+        struct ImportedBlock
+        {
+            RawBlock rawBlock;
+
+            BlockTemplate blockTemplate;
+
+            /* Refers to blockTemplate, so an ImportedBlock must not be moved
+               once this is set */
+            boost::optional<CachedBlock> cachedBlock;
+
+            bool transactionsExtracted = false;
+
+            std::vector<CachedTransaction> transactions;
+
+            TransactionValidatorState spentOutputs;
+
+            uint64_t cumulativeSize = 0;
+
+            uint64_t cumulativeFee = 0;
+        };
+
+        /* Everything in a block template which doesn't depend on who is mining
+           it. Rebuilt when the top block changes, or a transaction leaves the
+           pool, as it might be in the template. On a busy pool new transactions
+           arrive with nearly every request, so those only rebuild it once
+           BLOCK_TEMPLATE_POOL_REFRESH_INTERVAL has passed. */
+        struct CachedBlockTemplate
+        {
+            bool valid = false;
+
+            Crypto::Hash topBlockHash;
+
+            uint64_t poolRevision = 0;
+
+            uint64_t poolRemovalRevision = 0;
+
+            std::chrono::steady_clock::time_point builtAt;
+
+            /* Everything but the timestamp and the miner transaction */
+            BlockTemplate block;
+
+            uint64_t difficulty = 0;
+
+            uint32_t height = 0;
+
+            /* Zero if we don't have enough blocks for a median yet */
+            uint64_t medianTimestamp = 0;
+
+            size_t medianSize = 0;
+
+            uint64_t alreadyGeneratedCoins = 0;
+
+            size_t transactionsSize = 0;
+
+            uint64_t fee = 0;
+        };
+
+        /* How many blocks importBlocksFromStorage prepares at once */
+        static constexpr uint32_t IMPORT_BATCH_SIZE = 1000;
+
+        /* Time spent in each stage of addBlocks, for working out where the
+           time goes when syncing */
+        struct BlockImportStatistics
+        {
+            uint64_t blockCount = 0;
+
+            /* Summed over every thread preparing blocks */
+            std::chrono::microseconds prepareTime {0};
+
+            /* Time the importing thread spent waiting for a block to be prepared */
+            std::chrono::microseconds prepareWaitTime {0};
+
+            std::chrono::microseconds validateTime {0};
+
+            std::chrono::microseconds commitTime {0};
+        };
+
         const Currency &currency;
 
         System::Dispatcher &dispatcher;
@@ -254,11 +381,46 @@ namespace CryptoNote
 
         IntrusiveLinkedList<MessageQueue<BlockchainMessage>> queueList;
 
+        /* The RPC server adds its queue from its own thread */
+        std::mutex m_queueListMutex;
+
         std::unique_ptr<IBlockchainCacheFactory> blockchainCacheFactory;
 
         std::unique_ptr<IMainChainStorage> mainChainStorage;
 
-        Utilities::ThreadPool<bool> m_transactionValidationThreadPool;
+        Utilities::ThreadPool m_transactionValidationThreadPool;
+
+        /* Verify the ring signatures of a block all at once after the rest of
+         * the transaction validation, instead of one input at a time */
+        bool m_batchSignatureVerification;
+
+        /* Skip validating blocks below the last checkpoint, once we have
+         * checked they link up to the checkpointed hashes */
+        bool m_trustedCheckpointImport;
+
+        /* The ids of blocks we haven't got yet, from peers' chains which
+         * match the checkpoints, and the index of each. Kept until the
+         * blocks are added, however many batches they come in. */
+        std::unordered_map<Crypto::Hash, uint32_t> m_checkpointVerifiedBlocks;
+
+        /* The RPC server can add blocks from its own threads */
+        mutable std::mutex m_checkpointVerifiedBlocksMutex;
+
+        BlockImportStatistics m_blockImportStatistics;
+
+        CachedBlockTemplate m_cachedBlockTemplate;
+
+        /* Pools ask for templates from several RPC threads at once */
+        std::mutex m_blockTemplateMutex;
+
+        /* Blocks recently served to syncing wallets */
+        mutable WalletSyncCache m_walletSyncCache;
+
+        /* Where the pool is kept between restarts. Empty to not keep it. */
+        const std::string m_poolSnapshotFilename;
+
+        /* The pool revision last written to the snapshot */
+        uint64_t m_poolSnapshotRevision;
 
         bool initialized;
 
@@ -273,14 +435,32 @@ namespace CryptoNote
             std::vector<CachedTransaction> &transactions,
             uint64_t &cumulativeSize);
 
+        void prepareBlock(const CachedBlock &cachedBlock, const RawBlock &rawBlock, PreparedBlock &preparedBlock);
+
+        /* Whether the block is one verifyCheckpointChain() found below a
+           checkpoint, at the index it has there */
+        bool isCheckpointVerified(const Crypto::Hash &blockHash, uint32_t blockIndex) const;
+
+        void prepareImportedBlock(ImportedBlock &block);
+
+        std::error_code addPreparedBlock(
+            const CachedBlock &cachedBlock,
+            RawBlock &&rawBlock,
+            PreparedBlock *preparedBlock);
+
+        void logBlockImportStatistics(const BlockImportStatistics &batch);
+
         TransactionValidationResult validateTransaction(
             const CachedTransaction &transaction,
             TransactionValidatorState &state,
             IBlockchainCache *cache,
-            Utilities::ThreadPool<bool> &threadPool,
+            Utilities::ThreadPool &threadPool,
             uint64_t &fee,
             uint32_t blockIndex,
-            const bool isPoolTransaction);
+            const bool isPoolTransaction,
+            std::vector<Crypto::RingSignatureBatchEntry> *deferredSignatures = nullptr);
+
+        std::tuple<bool, size_t> checkRingSignatures(std::vector<Crypto::RingSignatureBatchEntry> &&signatures);
 
         uint32_t findBlockchainSupplement(const std::vector<Crypto::Hash> &remoteBlockIds) const;
 
@@ -312,6 +492,17 @@ namespace CryptoNote
 
         RawBlock getRawBlock(IBlockchainCache *segment, uint32_t blockIndex) const;
 
+        /* Main chain blocks from startIndex up to endIndex, from the wallet
+           sync cache where we have them, and whether each one was cached */
+        std::vector<std::tuple<std::shared_ptr<const WalletSyncCache::Block>, bool>>
+            getWalletSyncBlocks(IBlockchainCache *mainChain, const uint64_t startIndex, const uint64_t endIndex) const;
+
+        /* Up to blockCount blocks with transactions in, from startIndex onwards */
+        std::vector<std::tuple<std::shared_ptr<const WalletSyncCache::Block>, bool>> getNonEmptyWalletSyncBlocks(
+            IBlockchainCache *mainChain,
+            const uint64_t startIndex,
+            const uint64_t blockCount) const;
+
         size_t pushBlockHashes(
             uint32_t startIndex,
             uint32_t fullOffset,
@@ -361,6 +552,8 @@ namespace CryptoNote
 
         bool validateBlockTemplateTransaction(const CachedTransaction &cachedTransaction, const uint64_t blockHeight);
 
+        std::tuple<bool, std::string> updateCachedBlockTemplate();
+
         void fillBlockTemplate(
             BlockTemplate &block,
             const size_t medianSize,
@@ -390,12 +583,21 @@ namespace CryptoNote
 
         void copyTransactionsToPool(IBlockchainCache *alt);
 
+        /* The key images spent by every block the new main chain has above
+           where it split from the old one */
+        TransactionValidatorState
+            getSpentOutputsAboveSplit(IBlockchainCache *newLeaf, IBlockchainCache *oldLeaf) const;
+
         void checkAndRemoveInvalidPoolTransactions(const TransactionValidatorState blockTransactionsState);
 
         bool isTransactionInChain(const Crypto::Hash &txnHash);
 
         void transactionPoolCleaningProcedure();
 
+        void savePoolSnapshot();
+
+        void loadPoolSnapshot();
+
         void updateBlockMedianSize();
 
         std::tuple<bool, std::string> addTransactionToPool(CachedTransaction &&cachedTransaction);
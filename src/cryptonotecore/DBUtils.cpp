@@ -5,36 +5,66 @@
 
 #include "DBUtils.h"
 
-namespace
-{
-    const std::string RAW_BLOCK_NAME = "raw_block";
-
-    const std::string RAW_TXS_NAME = "raw_txs";
-} // namespace
-
 namespace CryptoNote
 {
     namespace DB
     {
-        std::string serialize(const RawBlock &value, const std::string &name)
+        namespace
         {
-            std::stringstream ss;
-            Common::StdOutputStream stream(ss);
-            CryptoNote::BinaryOutputStreamSerializer serializer(stream);
+            const size_t PACKED_BLOCK_INFO_SIZE = sizeof(Crypto::Hash) + 4 * sizeof(uint64_t) + sizeof(uint32_t);
+
+            template<typename T> void writePacked(std::string &out, const T value)
+            {
+                for (size_t i = 0; i < sizeof(T); i++)
+                {
+                    out += static_cast<char>((static_cast<uint64_t>(value) >> (i * 8)) & 0xff);
+                }
+            }
+
+            template<typename T> T readPacked(const char *&in)
+            {
+                uint64_t value = 0;
+
+                for (size_t i = 0; i < sizeof(T); i++)
+                {
+                    value |= static_cast<uint64_t>(static_cast<uint8_t>(in[i])) << (i * 8);
+                }
 
-            serializer(const_cast<RawBlock &>(value).block, RAW_BLOCK_NAME);
-            serializer(const_cast<RawBlock &>(value).transactions, RAW_TXS_NAME);
+                in += sizeof(T);
 
-            return ss.str();
+                return static_cast<T>(value);
+            }
+        } // namespace
+
+        void serializePacked(const CachedBlockInfo &value, std::string &serialized)
+        {
+            serialized.reserve(serialized.size() + PACKED_BLOCK_INFO_SIZE);
+
+            serialized.append(reinterpret_cast<const char *>(value.blockHash.data), sizeof(value.blockHash.data));
+            writePacked(serialized, value.timestamp);
+            writePacked(serialized, value.cumulativeDifficulty);
+            writePacked(serialized, value.alreadyGeneratedCoins);
+            writePacked(serialized, value.alreadyGeneratedTransactions);
+            writePacked(serialized, value.blockSize);
         }
 
-        void deserialize(const std::string &serialized, RawBlock &value, const std::string &name)
+        void deserializePacked(std::string_view serialized, CachedBlockInfo &value)
         {
-            std::stringstream ss(serialized);
-            Common::StdInputStream stream(ss);
-            CryptoNote::BinaryInputStreamSerializer serializer(stream);
-            serializer(value.block, RAW_BLOCK_NAME);
-            serializer(value.transactions, RAW_TXS_NAME);
+            if (serialized.size() != PACKED_BLOCK_INFO_SIZE)
+            {
+                throw std::runtime_error("Invalid DB value size for cached block info");
+            }
+
+            const char *in = serialized.data();
+
+            std::copy(in, in + sizeof(value.blockHash.data), value.blockHash.data);
+            in += sizeof(value.blockHash.data);
+
+            value.timestamp = readPacked<uint64_t>(in);
+            value.cumulativeDifficulty = readPacked<uint64_t>(in);
+            value.alreadyGeneratedCoins = readPacked<uint64_t>(in);
+            value.alreadyGeneratedTransactions = readPacked<uint64_t>(in);
+            value.blockSize = readPacked<uint32_t>(in);
         }
     } // namespace DB
 } // namespace CryptoNote
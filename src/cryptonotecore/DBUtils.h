@@ -5,16 +5,19 @@
 
 #pragma once
 
-#include "common/StdInputStream.h"
-#include "common/StdOutputStream.h"
+#include "common/MemoryInputStream.h"
+#include "common/StringOutputStream.h"
+#include "cryptonotecore/BlockchainCache.h"
 #include "cryptonotecore/CryptoNoteFormatUtils.h"
+#include "serialization/BinaryInputStreamSerializer.h"
+#include "serialization/BinaryOutputStreamSerializer.h"
 #include "serialization/CryptoNoteSerialization.h"
-#include "serialization/KVBinaryInputStreamSerializer.h"
-#include "serialization/KVBinaryOutputStreamSerializer.h"
 #include "serialization/SerializationOverloads.h"
 
-#include <sstream>
+#include <stdexcept>
 #include <string>
+#include <string_view>
+#include <type_traits>
 
 namespace CryptoNote
 {
@@ -26,8 +29,6 @@ namespace CryptoNote
 
         const std::string BLOCK_INDEX_TO_TRANSACTION_INFO_PREFIX = "2";
 
-        const std::string BLOCK_INDEX_TO_RAW_BLOCK_PREFIX = "4";
-
         const std::string BLOCK_HASH_TO_BLOCK_INDEX_PREFIX = "5";
 
         const std::string BLOCK_INDEX_TO_BLOCK_INFO_PREFIX = "6";
@@ -56,40 +57,121 @@ namespace CryptoNote
 
         const std::string KEY_OUTPUT_KEY_PREFIX = "j";
 
-        template<class Value> std::string serialize(const Value &value, const std::string &name)
+        const std::string BLOCK_INDEX_TO_BLOCK_SUMMARY_PREFIX = "k";
+
+        /* Stored as a decimal string, the same in every scheme */
+        const std::string DB_SCHEME_VERSION_KEY = "db_scheme_version";
+
+        /* Keys are the prefix followed by each part of the key. Integers are
+           written fixed width and big endian, so keys sort by their value, and
+           hashes and key images as their raw bytes. */
+        inline void appendKey(std::string &rawKey, const std::string &value)
         {
-            CryptoNote::KVBinaryOutputStreamSerializer serializer;
-            std::stringstream ss;
-            Common::StdOutputStream stream(ss);
+            rawKey += value;
+        }
 
-            serializer(const_cast<Value &>(value), name);
-            serializer.dump(stream);
+        inline void appendKey(std::string &rawKey, const Crypto::Hash &value)
+        {
+            rawKey.append(reinterpret_cast<const char *>(value.data), sizeof(value.data));
+        }
 
-            return ss.str();
+        inline void appendKey(std::string &rawKey, const Crypto::KeyImage &value)
+        {
+            rawKey.append(reinterpret_cast<const char *>(value.data), sizeof(value.data));
         }
 
-        std::string serialize(const RawBlock &value, const std::string &name);
+        template<class T> typename std::enable_if<std::is_integral<T>::value>::type appendKey(std::string &rawKey, T value)
+        {
+            for (size_t i = sizeof(T); i > 0; i--)
+            {
+                rawKey += static_cast<char>((static_cast<uint64_t>(value) >> ((i - 1) * 8)) & 0xff);
+            }
+        }
 
-        template<class Key, class Value>
-        std::pair<std::string, std::string> serialize(const std::string &keyPrefix, const Key &key, const Value &value)
+        template<class T1, class T2> void appendKey(std::string &rawKey, const std::pair<T1, T2> &value)
         {
-            return {DB::serialize(std::make_pair(keyPrefix, key), keyPrefix), DB::serialize(value, keyPrefix)};
+            appendKey(rawKey, value.first);
+            appendKey(rawKey, value.second);
+        }
+
+        void serializePacked(const CachedBlockInfo &value, std::string &serialized);
+
+        void deserializePacked(std::string_view serialized, CachedBlockInfo &value);
+
+        /* Integers and block infos are stored as fixed width little endian,
+           and everything else in the compact binary format. Neither stores
+           field names. */
+        template<class Value> std::string serialize(const Value &value, const std::string &name)
+        {
+            std::string serialized;
+
+            if constexpr (std::is_integral<Value>::value)
+            {
+                for (size_t i = 0; i < sizeof(Value); i++)
+                {
+                    serialized += static_cast<char>((static_cast<uint64_t>(value) >> (i * 8)) & 0xff);
+                }
+            }
+            else if constexpr (std::is_same<Value, CachedBlockInfo>::value)
+            {
+                serializePacked(value, serialized);
+            }
+            else
+            {
+                Common::StringOutputStream stream(serialized);
+                CryptoNote::BinaryOutputStreamSerializer serializer(stream);
+
+                serializer(const_cast<Value &>(value), name);
+            }
+
+            return serialized;
         }
 
         template<class Key> std::string serializeKey(const std::string &keyPrefix, const Key &key)
         {
-            return DB::serialize(std::make_pair(keyPrefix, key), keyPrefix);
+            std::string rawKey = keyPrefix;
+            appendKey(rawKey, key);
+            return rawKey;
         }
 
-        template<class Value> void deserialize(const std::string &serialized, Value &value, const std::string &name)
+        template<class Key, class Value>
+        std::pair<std::string, std::string> serialize(const std::string &keyPrefix, const Key &key, const Value &value)
         {
-            std::stringstream ss(serialized);
-            Common::StdInputStream stream(ss);
-            CryptoNote::KVBinaryInputStreamSerializer serializer(stream);
-            serializer(value, name);
+            return {DB::serializeKey(keyPrefix, key), DB::serialize(value, keyPrefix)};
         }
 
-        void deserialize(const std::string &serialized, RawBlock &value, const std::string &name);
+        /* Reads the value straight from the DB's buffer, without copying it
+           into a string first */
+        template<class Value> void deserialize(std::string_view serialized, Value &value, const std::string &name)
+        {
+            if constexpr (std::is_integral<Value>::value)
+            {
+                if (serialized.size() != sizeof(Value))
+                {
+                    throw std::runtime_error("Invalid DB value size for " + name);
+                }
+
+                uint64_t result = 0;
+
+                for (size_t i = 0; i < sizeof(Value); i++)
+                {
+                    result |= static_cast<uint64_t>(static_cast<uint8_t>(serialized[i])) << (i * 8);
+                }
+
+                value = static_cast<Value>(result);
+            }
+            else if constexpr (std::is_same<Value, CachedBlockInfo>::value)
+            {
+                deserializePacked(serialized, value);
+            }
+            else
+            {
+                Common::MemoryInputStream stream(serialized.data(), serialized.size());
+                CryptoNote::BinaryInputStreamSerializer serializer(stream);
+
+                serializer(value, name);
+            }
+        }
 
         template<class Key, class Value>
         void serializeKeys(
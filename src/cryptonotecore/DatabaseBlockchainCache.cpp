@@ -9,11 +9,15 @@
 
 #include <boost/iterator/iterator_facade.hpp>
 #include <common/CryptoNoteTools.h>
+#include <common/FileSystemShim.h>
+#include <common/Math.h>
 #include <common/ShuffleGenerator.h>
 #include <common/TransactionExtra.h>
 #include <cryptonotecore/BlockchainStorage.h>
 #include <cryptonotecore/CryptoNoteBasicImpl.h>
+#include <cryptonotecore/DBUtils.h>
 #include <cryptonotecore/DatabaseBlockchainCache.h>
+#include <cryptonotecore/DatabaseMigration.h>
 #include <cstdlib>
 #include <ctime>
 
@@ -23,6 +27,9 @@ namespace CryptoNote
     {
         const uint32_t ONE_DAY_SECONDS = 60 * 60 * 24;
 
+        /* Most chains have far fewer amounts than this in use */
+        const size_t RANDOM_OUTPUT_TOTALS_CACHE_SIZE = 10000;
+
         const CachedBlockInfo NULL_CACHED_BLOCK_INFO {Constants::NULL_HASH, 0, 0, 0, 0, 0};
 
         bool requestPackedOutputs(
@@ -236,27 +243,6 @@ namespace CryptoNote
             return result;
         }
 
-        bool requestRawBlock(IDataBase &database, uint32_t blockIndex, RawBlock &block)
-        {
-            auto batch = BlockchainReadBatch().requestRawBlock(blockIndex);
-
-            auto error = database.read(batch);
-            if (error)
-            {
-                // may be throw in all similiar functions???
-                return false;
-            }
-
-            auto result = batch.extractResult();
-            if (result.getRawBlocks().count(blockIndex) == 0)
-            {
-                return false;
-            }
-
-            block = result.getRawBlocks().at(blockIndex);
-            return true;
-        }
-
         Transaction extractTransaction(const RawBlock &block, uint32_t transactionIndex)
         {
             assert(transactionIndex < block.transactions.size() + 1);
@@ -302,7 +288,11 @@ namespace CryptoNote
             return result.getTransactionCountByPaymentIds().at(paymentId);
         }
 
-        bool requestPaymentId(IDataBase &database, const Crypto::Hash &transactionHash, Crypto::Hash &paymentId)
+        bool requestPaymentId(
+            IDataBase &database,
+            const IMainChainStorage &mainChainStorage,
+            const Crypto::Hash &transactionHash,
+            Crypto::Hash &paymentId)
         {
             std::vector<CachedTransactionInfo> cachedTransactions;
 
@@ -316,11 +306,7 @@ namespace CryptoNote
                 return false;
             }
 
-            RawBlock block;
-            if (!requestRawBlock(database, cachedTransactions[0].blockIndex, block))
-            {
-                return false;
-            }
+            const RawBlock block = mainChainStorage.getBlockByIndex(cachedTransactions[0].blockIndex);
 
             Transaction transaction = extractTransaction(block, cachedTransactions[0].transactionIndex);
             return getPaymentIdFromTxExtra(transaction.extra, paymentId);
@@ -468,19 +454,6 @@ namespace CryptoNote
             }
         }
 
-        void cutTail(std::deque<CachedBlockInfo> &cache, size_t count)
-        {
-            if (count >= cache.size())
-            {
-                cache.clear();
-                return;
-            }
-
-            cache.erase(std::next(cache.begin(), cache.size() - count), cache.end());
-        }
-
-        const std::string DB_VERSION_KEY = "db_scheme_version";
-
         class DatabaseVersionReadBatch : public IReadBatch
         {
           public:
@@ -488,11 +461,12 @@ namespace CryptoNote
 
             virtual std::vector<std::string> getRawKeys() const override
             {
-                return {DB_VERSION_KEY};
+                return {DB::DB_SCHEME_VERSION_KEY};
             }
 
-            virtual void
-                submitRawResult(const std::vector<std::string> &values, const std::vector<bool> &resultStates) override
+            virtual void submitRawResult(
+                const std::vector<std::string_view> &values,
+                const std::vector<bool> &resultStates) override
             {
                 assert(values.size() == 1);
                 assert(resultStates.size() == values.size());
@@ -502,7 +476,7 @@ namespace CryptoNote
                     return;
                 }
 
-                version = static_cast<uint32_t>(std::atoi(values[0].c_str()));
+                version = static_cast<uint32_t>(std::atoi(std::string(values[0]).c_str()));
             }
 
             boost::optional<uint32_t> getDbSchemeVersion()
@@ -523,7 +497,7 @@ namespace CryptoNote
 
             virtual std::vector<std::pair<std::string, std::string>> extractRawDataToInsert() override
             {
-                return {make_pair(DB_VERSION_KEY, std::to_string(schemeVersion))};
+                return {make_pair(DB::DB_SCHEME_VERSION_KEY, std::to_string(schemeVersion))};
             }
 
             virtual std::vector<std::string> extractRawKeysToRemove() override
@@ -535,7 +509,10 @@ namespace CryptoNote
             uint32_t schemeVersion;
         };
 
-        const uint32_t CURRENT_DB_SCHEME_VERSION = 2;
+        /* 2 stored KV binary keys and values, 3 fixed width ones, 4 dropped
+           the raw blocks, and 5 is 4 split into column families. See
+           DatabaseMigration for getting from one to the next. */
+        const uint32_t CURRENT_DB_SCHEME_VERSION = 5;
 
     } // namespace
 
@@ -543,17 +520,25 @@ namespace CryptoNote
     {
         PushedBlockInfo pushedBlockInfo;
         uint64_t timestamp;
+        Crypto::Hash blockHash;
+        /* False if the main chain storage doesn't have this block */
+        bool hasRawBlock;
     };
 
     DatabaseBlockchainCache::DatabaseBlockchainCache(
         const Currency &curr,
         IDataBase &dataBase,
         IBlockchainCacheFactory &blockchainCacheFactory,
+        const IMainChainStorage &mainChainStorage,
+        const std::string &blockMetadataDirectory,
         std::shared_ptr<Logging::ILogger> _logger):
         currency(curr),
         database(dataBase),
         blockchainCacheFactory(blockchainCacheFactory),
-        logger(_logger, "DatabaseBlockchainCache")
+        mainChainStorage(mainChainStorage),
+        logger(_logger, "DatabaseBlockchainCache"),
+        blockMetadata(blockMetadataDirectory),
+        spentKeyImagesFilename((fs::path(blockMetadataDirectory) / "keyimages.dat").string())
     {
         DatabaseVersionReadBatch readBatch;
         auto ec = database.read(readBatch);
@@ -584,6 +569,359 @@ namespace CryptoNote
             logger(Logging::DEBUGGING) << "top block index is null, add genesis block";
             addGenesisBlock(CachedBlock(currency.genesisBlock()));
         }
+
+        syncBlockMetadata();
+
+        syncBlockSummaries();
+
+        loadSpentKeyImages();
+
+        std::scoped_lock<std::mutex> lock(randomOutputsMutex);
+
+        loadRecentKeyOutputCounts();
+    }
+
+    void DatabaseBlockchainCache::syncBlockMetadata()
+    {
+        const uint32_t blockCount = getTopBlockIndex() + 1;
+
+        /* Blocks which were popped from the DB, but we stopped before removing
+           them from the index */
+        if (blockMetadata.size() > blockCount)
+        {
+            blockMetadata.truncate(blockCount);
+        }
+
+        const uint32_t step = 10000;
+
+        if (!blockMetadata.wasShutdownCleanly())
+        {
+            /* Pages which weren't written out before we stopped could be
+               anywhere in the index, not just at the end, so check every
+               block, and rebuild from the first one that's wrong */
+            logger(Logging::INFO) << "Block metadata index was not closed cleanly, checking it against the database";
+
+            const uint32_t indexSize = blockMetadata.size();
+
+            std::optional<uint32_t> mismatchIndex;
+
+            for (uint32_t startIndex = 0; startIndex < indexSize && !mismatchIndex; startIndex += step)
+            {
+                const auto blockInfos = getCachedBlockInfos(startIndex, std::min(startIndex + step, indexSize));
+
+                for (uint32_t i = 0; i < blockInfos.size(); i++)
+                {
+                    if (!blockMetadata.matches(startIndex + i, blockInfos[i]))
+                    {
+                        mismatchIndex = startIndex + i;
+                        break;
+                    }
+                }
+            }
+
+            if (mismatchIndex)
+            {
+                logger(Logging::WARNING) << "Block metadata index does not match the database at height "
+                                         << *mismatchIndex << ", rebuilding from there";
+
+                blockMetadata.truncate(*mismatchIndex);
+            }
+        }
+        else if (blockMetadata.size() != 0)
+        {
+            const uint32_t lastIndex = blockMetadata.size() - 1;
+
+            if (!blockMetadata.matches(lastIndex, getCachedBlockInfo(lastIndex)))
+            {
+                logger(Logging::WARNING) << "Block metadata index does not match the database, rebuilding it";
+                blockMetadata.clear();
+            }
+        }
+
+        if (blockMetadata.size() == blockCount)
+        {
+            return;
+        }
+
+        logger(Logging::INFO) << "Building block metadata index from height " << blockMetadata.size() << " to "
+                              << blockCount << ", this may take a while...";
+
+        while (blockMetadata.size() < blockCount)
+        {
+            const uint32_t startIndex = blockMetadata.size();
+
+            for (const auto &blockInfo : getCachedBlockInfos(startIndex, std::min(startIndex + step, blockCount)))
+            {
+                blockMetadata.push(blockInfo);
+            }
+        }
+
+        logger(Logging::INFO) << "Block metadata index built";
+    }
+
+    BlockSummary DatabaseBlockchainCache::makeBlockSummary(
+        const uint32_t blockIndex,
+        const BlockTemplate &block,
+        const size_t blockBlobSize,
+        const CachedTransaction &baseTransaction,
+        const std::vector<CachedTransaction> &transactions,
+        const CachedBlockInfo &blockInfo,
+        const uint64_t blockDifficulty) const
+    {
+        BlockSummary summary;
+
+        summary.blockHash = blockInfo.blockHash;
+        summary.previousBlockHash = block.previousBlockHash;
+        summary.blockIndex = blockIndex;
+        summary.majorVersion = block.majorVersion;
+        summary.minorVersion = block.minorVersion;
+        summary.nonce = block.nonce;
+        summary.timestamp = block.timestamp;
+        summary.difficulty = blockDifficulty;
+        summary.alreadyGeneratedCoins = blockInfo.alreadyGeneratedCoins;
+        summary.alreadyGeneratedTransactions = blockInfo.alreadyGeneratedTransactions;
+        summary.transactionsCumulativeSize = blockInfo.blockSize;
+        summary.blockSize =
+            blockBlobSize + blockInfo.blockSize - baseTransaction.getTransactionBinaryArray().size();
+
+        uint64_t previousGeneratedCoins = 0;
+
+        summary.sizeMedian = 0;
+
+        if (blockIndex > 0)
+        {
+            auto lastBlocksSizes =
+                getLastBlocksSizes(currency.rewardBlocksWindow(), blockIndex - 1, UseGenesis(true));
+
+            summary.sizeMedian = Common::medianValue(lastBlocksSizes);
+            previousGeneratedCoins = blockMetadata.getAlreadyGeneratedCoins(blockIndex - 1);
+        }
+
+        int64_t emissionChange = 0;
+
+        summary.baseReward = 0;
+        summary.penalizedReward = 0;
+
+        if (!currency.getBlockReward(
+                blockIndex,
+                block.majorVersion,
+                summary.sizeMedian,
+                0,
+                previousGeneratedCoins,
+                0,
+                summary.baseReward,
+                emissionChange)
+            || !currency.getBlockReward(
+                blockIndex,
+                block.majorVersion,
+                summary.sizeMedian,
+                summary.transactionsCumulativeSize,
+                previousGeneratedCoins,
+                0,
+                summary.penalizedReward,
+                emissionChange))
+        {
+            logger(Logging::WARNING) << "Could not calculate the reward for block " << blockIndex;
+        }
+
+        summary.totalFeeAmount = 0;
+        summary.transactions.reserve(transactions.size() + 1);
+
+        const auto addTransaction = [&summary](const CachedTransaction &transaction)
+        {
+            TransactionSummary transactionSummary;
+
+            transactionSummary.transactionHash = transaction.getTransactionHash();
+            transactionSummary.amountOut = 0;
+            transactionSummary.fee = transaction.getTransactionFee();
+            transactionSummary.size = transaction.getTransactionBinaryArray().size();
+
+            for (const auto &output : transaction.getTransaction().outputs)
+            {
+                transactionSummary.amountOut += output.amount;
+            }
+
+            summary.totalFeeAmount += transactionSummary.fee;
+            summary.transactions.push_back(transactionSummary);
+        };
+
+        addTransaction(baseTransaction);
+
+        for (const auto &transaction : transactions)
+        {
+            addTransaction(transaction);
+        }
+
+        summary.reward = summary.transactions.front().amountOut;
+
+        return summary;
+    }
+
+    bool DatabaseBlockchainCache::hasBlockSummary(const uint32_t blockIndex) const
+    {
+        auto batch = BlockchainReadBatch().requestBlockSummary(blockIndex).requestCachedBlock(blockIndex);
+
+        const auto result = readDatabase(batch);
+
+        const auto summary = result.getBlockSummaries().find(blockIndex);
+        const auto blockInfo = result.getCachedBlocks().find(blockIndex);
+
+        /* Left behind by a version which didn't remove them on a rewind */
+        return summary != result.getBlockSummaries().end() && blockInfo != result.getCachedBlocks().end()
+               && summary->second.blockHash == blockInfo->second.blockHash;
+    }
+
+    void DatabaseBlockchainCache::syncBlockSummaries()
+    {
+        const uint32_t blockCount = getTopBlockIndex() + 1;
+
+        if (hasBlockSummary(blockCount - 1))
+        {
+            return;
+        }
+
+        /* Blocks are added in order, so everything up to the first block
+           without a summary has one */
+        uint32_t startIndex = 0;
+        uint32_t endIndex = blockCount - 1;
+
+        while (startIndex < endIndex)
+        {
+            const uint32_t middle = startIndex + (endIndex - startIndex) / 2;
+
+            if (hasBlockSummary(middle))
+            {
+                startIndex = middle + 1;
+            }
+            else
+            {
+                endIndex = middle;
+            }
+        }
+
+        logger(Logging::INFO) << "Building block summaries from height " << startIndex << " to " << blockCount
+                              << ", this may take a while...";
+
+        const uint32_t step = 1000;
+
+        for (uint32_t blockIndex = startIndex; blockIndex < blockCount;)
+        {
+            const uint32_t stepEnd = std::min(blockIndex + step, blockCount);
+
+            BlockchainWriteBatch batch;
+
+            bool missingBlock = false;
+
+            for (const auto &blockInfo : getCachedBlockInfos(blockIndex, stepEnd))
+            {
+                BlockTemplate block;
+
+                RawBlock rawBlock;
+
+                std::vector<CachedTransaction> transactions;
+
+                try
+                {
+                    if (blockIndex < mainChainStorage.getBlockCount())
+                    {
+                        rawBlock = mainChainStorage.getBlockByIndex(blockIndex);
+                    }
+                }
+                catch (const std::exception &)
+                {
+                    /* Corrupted, treat it as missing */
+                }
+
+                /* The main chain storage is behind the DB, or has another
+                   chain. The core works these out when they're asked for. */
+                if (!fromBinaryArray(block, rawBlock.block) || CachedBlock(block).getBlockHash() != blockInfo.blockHash
+                    || !Utils::restoreCachedTransactions(rawBlock.transactions, transactions))
+                {
+                    missingBlock = true;
+                    break;
+                }
+
+                const uint64_t previousCumulativeDifficulty =
+                    blockIndex > 0 ? blockMetadata.getCumulativeDifficulty(blockIndex - 1) : 0;
+
+                batch.insertBlockSummary(
+                    blockIndex,
+                    makeBlockSummary(
+                        blockIndex,
+                        block,
+                        rawBlock.block.size(),
+                        CachedTransaction(block.baseTransaction),
+                        transactions,
+                        blockInfo,
+                        blockInfo.cumulativeDifficulty - previousCumulativeDifficulty));
+
+                blockIndex++;
+            }
+
+            auto res = database.write(batch);
+
+            if (res)
+            {
+                logger(Logging::ERROR) << "Failed to write block summaries: " << res.message();
+                throw std::runtime_error(res.message());
+            }
+
+            if (missingBlock)
+            {
+                logger(Logging::WARNING) << "Block " << blockIndex << " is not in the main chain storage, "
+                                         << "not building the summaries above it";
+                return;
+            }
+        }
+
+        logger(Logging::INFO) << "Block summaries built";
+    }
+
+    void DatabaseBlockchainCache::loadSpentKeyImages()
+    {
+        const uint32_t blockCount = getTopBlockIndex() + 1;
+
+        if (!spentKeyImages.load(spentKeyImagesFilename, blockCount, getTopBlockHash()))
+        {
+            logger(Logging::INFO) << "Building spent key image filter, this may take a while...";
+
+            spentKeyImages.clear();
+
+            const uint32_t step = 1000;
+
+            for (uint32_t startIndex = 0; startIndex < blockCount; startIndex += step)
+            {
+                const uint32_t endIndex = std::min(startIndex + step, blockCount);
+
+                BlockchainReadBatch batch;
+
+                for (uint32_t blockIndex = startIndex; blockIndex < endIndex; blockIndex++)
+                {
+                    batch.requestSpentKeyImagesByBlock(blockIndex);
+                }
+
+                const auto result = readDatabase(batch);
+
+                for (uint32_t blockIndex = startIndex; blockIndex < endIndex; blockIndex++)
+                {
+                    const auto it = result.getSpentKeyImagesByBlock().find(blockIndex);
+
+                    if (it == result.getSpentKeyImagesByBlock().end())
+                    {
+                        continue;
+                    }
+
+                    for (const auto &keyImage : it->second)
+                    {
+                        spentKeyImages.add(blockIndex, keyImage);
+                    }
+                }
+            }
+        }
+
+        logger(Logging::INFO) << "Spent key image filter: " << spentKeyImages.size() << " key images, "
+                              << spentKeyImages.memoryUsage() / 1024 << "KB, estimated false positive rate "
+                              << spentKeyImages.falsePositiveRate() * 100 << "%";
     }
 
     bool DatabaseBlockchainCache::checkDBSchemeVersion(IDataBase &database, std::shared_ptr<Logging::ILogger> _logger)
@@ -603,11 +941,30 @@ namespace CryptoNote
             // DB scheme version not found. Looks like it was just created.
             return true;
         }
+        else if (*version < CURRENT_DB_SCHEME_VERSION && DatabaseMigration::canMigrate(*version))
+        {
+            logger(Logging::INFO) << "Migrating DB from scheme version " << *version << " to "
+                                  << CURRENT_DB_SCHEME_VERSION;
+
+            DatabaseMigration(database, _logger).migrate(*version);
+
+            DatabaseVersionWriteBatch writeBatch(CURRENT_DB_SCHEME_VERSION);
+            auto writeError = database.write(writeBatch);
+            if (writeError)
+            {
+                throw std::system_error(writeError);
+            }
+
+            logger(Logging::INFO) << "DB migrated to scheme version " << CURRENT_DB_SCHEME_VERSION;
+
+            return true;
+        }
         else if (*version < CURRENT_DB_SCHEME_VERSION)
         {
             logger(Logging::WARNING) << "DB scheme version is less than expected. Expected version "
                                      << CURRENT_DB_SCHEME_VERSION << ". Actual version " << *version
-                                     << ". DB will be destroyed and recreated from blocks.bin file.";
+                                     << ". It's too old to migrate, so it will be destroyed and recreated from "
+                                        "blocks.bin file.";
             return false;
         }
         else if (*version > CURRENT_DB_SCHEME_VERSION)
@@ -679,15 +1036,32 @@ namespace CryptoNote
 
         BlockchainWriteBatch writeBatch;
         auto currentTop = getTopBlockIndex();
+
+        /* The raw blocks live in the main chain storage. If it has already
+           been rewound past them, or holds another chain, we can still remove
+           them from here, but can't keep them in the child segment. */
+        bool keepBlocks = true;
+
         for (uint32_t blockIndex = splitBlockIndex; blockIndex <= currentTop; ++blockIndex)
         {
             ExtendedPushedBlockInfo extendedInfo = getExtendedPushedBlockInfo(blockIndex);
 
+            if (keepBlocks && !extendedInfo.hasRawBlock)
+            {
+                logger(Logging::WARNING) << "Block " << blockIndex << " is not in the main chain storage, "
+                                         << "removing it and the blocks above it without keeping them";
+                keepBlocks = false;
+            }
+
             auto validatorState = extendedInfo.pushedBlockInfo.validatorState;
-            logger(Logging::DEBUGGING) << "pushing block " << blockIndex << " to child segment";
-            auto blockHash = pushBlockToAnotherCache(*cache, std::move(extendedInfo.pushedBlockInfo));
 
-            deletingBlocks.emplace_back(blockIndex, blockHash, validatorState, extendedInfo.timestamp);
+            if (keepBlocks)
+            {
+                logger(Logging::DEBUGGING) << "pushing block " << blockIndex << " to child segment";
+                pushBlockToAnotherCache(*cache, std::move(extendedInfo.pushedBlockInfo));
+            }
+
+            deletingBlocks.emplace_back(blockIndex, extendedInfo.blockHash, validatorState, extendedInfo.timestamp);
         }
 
         for (auto it = deletingBlocks.rbegin(); it != deletingBlocks.rend(); ++it)
@@ -697,7 +1071,7 @@ namespace CryptoNote
             auto &validatorState = std::get<2>(*it);
             uint64_t timestamp = std::get<3>(*it);
 
-            writeBatch.removeCachedBlock(blockHash, blockIndex).removeRawBlock(blockIndex);
+            writeBatch.removeCachedBlock(blockHash, blockIndex);
             requestDeleteSpentOutputs(writeBatch, blockIndex, validatorState);
             requestRemoveTimestamp(writeBatch, timestamp, blockHash);
         }
@@ -726,6 +1100,11 @@ namespace CryptoNote
         deleteClosestTimestampBlockIndex(writeBatch, splitBlockIndex);
 
         logger(Logging::DEBUGGING) << "Performing delete operations";
+
+        /* Until the counts are reloaded, the top block index and the recent
+           counts don't match the database */
+        std::unique_lock<std::mutex> randomOutputsLock(randomOutputsMutex);
+
         // all data and indexes are now copied, no errors detected, can now erase data from database
         auto err = database.write(writeBatch);
         if (err)
@@ -734,7 +1113,17 @@ namespace CryptoNote
             throw std::runtime_error(err.message());
         }
 
-        cutTail(unitsCache, currentTop + 1 - splitBlockIndex);
+        blockMetadata.truncate(splitBlockIndex);
+
+        for (const auto &[blockIndex, blockHash, validatorState, timestamp] : deletingBlocks)
+        {
+            for (const auto &keyImage : validatorState.spentKeyImages)
+            {
+                spentKeyImages.remove(blockIndex, keyImage);
+            }
+        }
+
+        spentKeyImages.truncate(splitBlockIndex);
 
         children.push_back(cache.get());
         logger(Logging::TRACE) << "Delete successfull";
@@ -744,6 +1133,10 @@ namespace CryptoNote
         topBlockHash = boost::none;
         transactionsCount = boost::none;
 
+        loadRecentKeyOutputCounts();
+
+        randomOutputsLock.unlock();
+
         logger(Logging::DEBUGGING) << "split completed";
         // return new cache
         return cache;
@@ -825,7 +1218,7 @@ namespace CryptoNote
         for (const auto &hash : transactionHashes)
         {
             Crypto::Hash paymentId;
-            if (!requestPaymentId(database, hash, paymentId))
+            if (!requestPaymentId(database, mainChainStorage, hash, paymentId))
             {
                 continue;
             }
@@ -1113,8 +1506,7 @@ namespace CryptoNote
         logger(Logging::DEBUGGING) << "push block with hash " << cachedBlock.getBlockHash() << ", and "
                                    << cachedTransactions.size() + 1 << " transactions"; //+1 for base transaction
 
-        // TODO: cache top block difficulty, size, timestamp, coins; use it here
-        auto lastBlockInfo = getCachedBlockInfo(getTopBlockIndex());
+        auto lastBlockInfo = blockMetadata.getBlockInfo(getTopBlockIndex());
         auto cumulativeDifficulty = lastBlockInfo.cumulativeDifficulty + blockDifficulty;
         auto alreadyGeneratedCoins = lastBlockInfo.alreadyGeneratedCoins + generatedCoins;
         auto alreadyGeneratedTransactions = lastBlockInfo.alreadyGeneratedTransactions + cachedTransactions.size() + 1;
@@ -1129,6 +1521,14 @@ namespace CryptoNote
 
         batch.insertSpentKeyImages(getTopBlockIndex() + 1, validatorState.spentKeyImages);
 
+        /* Added before the DB is written, so for a moment the filter may say a
+           key image is spent which the DB doesn't have yet, but never the
+           other way round */
+        for (const auto &keyImage : validatorState.spentKeyImages)
+        {
+            spentKeyImages.add(getTopBlockIndex() + 1, keyImage);
+        }
+
         auto txHashes = cachedBlock.getBlock().transactionHashes;
         auto baseTransaction = cachedBlock.getBlock().baseTransaction;
         auto cachedBaseTransaction = CachedTransaction {std::move(baseTransaction)};
@@ -1137,7 +1537,17 @@ namespace CryptoNote
         txHashes.insert(txHashes.begin(), cachedBaseTransaction.getTransactionHash());
 
         batch.insertCachedBlock(blockInfo, getTopBlockIndex() + 1, txHashes);
-        batch.insertRawBlock(getTopBlockIndex() + 1, std::move(rawBlock));
+
+        batch.insertBlockSummary(
+            getTopBlockIndex() + 1,
+            makeBlockSummary(
+                getTopBlockIndex() + 1,
+                cachedBlock.getBlock(),
+                rawBlock.block.size(),
+                cachedBaseTransaction,
+                cachedTransactions,
+                blockInfo,
+                blockDifficulty));
 
         auto transactionIndex = 0;
         pushTransaction(cachedBaseTransaction, getTopBlockIndex() + 1, transactionIndex++, batch);
@@ -1164,31 +1574,146 @@ namespace CryptoNote
 
         insertBlockTimestamp(batch, cachedBlock.getBlock().timestamp, cachedBlock.getBlockHash());
 
-        auto res = database.write(batch);
-        if (res)
+        auto keyOutputCounts = countKeyOutputs(cachedBlock, cachedTransactions);
+
         {
-            logger(Logging::ERROR) << "push block " << cachedBlock.getBlockHash() << " write failed: " << res.message();
-            throw std::runtime_error(res.message());
+            /* Otherwise a reader could load a total from the DB which already
+               includes this block's outputs, and then have them added to it
+               again by pushRecentKeyOutputCounts */
+            std::scoped_lock<std::mutex> lock(randomOutputsMutex);
+
+            auto res = database.write(batch);
+            if (res)
+            {
+                logger(Logging::ERROR) << "push block " << cachedBlock.getBlockHash()
+                                       << " write failed: " << res.message();
+                throw std::runtime_error(res.message());
+            }
+
+            topBlockIndex = *topBlockIndex + 1;
+            topBlockHash = cachedBlock.getBlockHash();
+
+            pushRecentKeyOutputCounts(std::move(keyOutputCounts));
         }
 
-        topBlockIndex = *topBlockIndex + 1;
-        topBlockHash = cachedBlock.getBlockHash();
         logger(Logging::DEBUGGING) << "push block " << cachedBlock.getBlockHash() << " completed";
 
-        unitsCache.push_back(blockInfo);
-        if (unitsCache.size() > unitsCacheSize)
+        blockMetadata.push(blockInfo);
+    }
+
+    void DatabaseBlockchainCache::loadRecentKeyOutputCounts()
+    {
+        recentKeyOutputCounts.clear();
+        randomOutputTotals.clear();
+        randomOutputTotalsUsage.clear();
+
+        const uint32_t topIndex = getTopBlockIndex();
+        const uint32_t window = currency.minedMoneyUnlockWindow();
+        const uint32_t startIndex = topIndex + 1 > window ? topIndex + 1 - window : 0;
+
+        BlockchainReadBatch hashesBatch;
+
+        for (uint32_t blockIndex = startIndex; blockIndex <= topIndex; blockIndex++)
         {
-            unitsCache.pop_front();
+            hashesBatch.requestTransactionHashesByBlock(blockIndex);
+        }
+
+        const auto hashesResult = readDatabase(hashesBatch);
+        const auto &hashesByBlock = hashesResult.getTransactionHashesByBlocks();
+
+        std::vector<Crypto::Hash> transactionHashes;
+
+        for (const auto &[blockIndex, hashes] : hashesByBlock)
+        {
+            transactionHashes.insert(transactionHashes.end(), hashes.begin(), hashes.end());
+        }
+
+        auto transactionsBatch = BlockchainReadBatch().requestCachedTransactions(transactionHashes);
+        const auto transactionsResult = readDatabase(transactionsBatch);
+        const auto &transactions = transactionsResult.getCachedTransactions();
+
+        for (uint32_t blockIndex = startIndex; blockIndex <= topIndex; blockIndex++)
+        {
+            std::unordered_map<Amount, uint32_t> counts;
+
+            for (const auto &hash : hashesByBlock.at(blockIndex))
+            {
+                for (const auto &[amount, globalIndexes] : transactions.at(hash).amountToKeyIndexes)
+                {
+                    counts[amount] += static_cast<uint32_t>(globalIndexes.size());
+                }
+            }
+
+            recentKeyOutputCounts.push_back(std::move(counts));
+        }
+    }
+
+    std::unordered_map<IBlockchainCache::Amount, uint32_t> DatabaseBlockchainCache::countKeyOutputs(
+        const CachedBlock &cachedBlock,
+        const std::vector<CachedTransaction> &cachedTransactions) const
+    {
+        std::unordered_map<Amount, uint32_t> counts;
+
+        const auto countOutputs = [&counts](const Transaction &transaction)
+        {
+            for (const auto &output : transaction.outputs)
+            {
+                if (output.target.type() == typeid(KeyOutput))
+                {
+                    counts[output.amount]++;
+                }
+            }
+        };
+
+        countOutputs(cachedBlock.getBlock().baseTransaction);
+
+        for (const auto &transaction : cachedTransactions)
+        {
+            countOutputs(transaction.getTransaction());
+        }
+
+        return counts;
+    }
+
+    void DatabaseBlockchainCache::pushRecentKeyOutputCounts(std::unordered_map<Amount, uint32_t> counts)
+    {
+        for (const auto &[amount, count] : counts)
+        {
+            const auto it = randomOutputTotals.find(amount);
+
+            if (it != randomOutputTotals.end())
+            {
+                it->second.total += count;
+            }
+        }
+
+        recentKeyOutputCounts.push_back(std::move(counts));
+
+        while (recentKeyOutputCounts.size() > currency.minedMoneyUnlockWindow())
+        {
+            recentKeyOutputCounts.pop_front();
         }
     }
 
     PushedBlockInfo DatabaseBlockchainCache::getPushedBlockInfo(uint32_t blockIndex) const
     {
-        return getExtendedPushedBlockInfo(blockIndex).pushedBlockInfo;
+        auto extendedInfo = getExtendedPushedBlockInfo(blockIndex);
+
+        if (!extendedInfo.hasRawBlock)
+        {
+            throw std::runtime_error("Block " + std::to_string(blockIndex) + " is not in the main chain storage");
+        }
+
+        return std::move(extendedInfo.pushedBlockInfo);
     }
 
     bool DatabaseBlockchainCache::checkIfSpent(const Crypto::KeyImage &keyImage, uint32_t blockIndex) const
     {
+        if (!spentKeyImages.mayContain(keyImage))
+        {
+            return false;
+        }
+
         auto batch = BlockchainReadBatch().requestBlockIndexBySpentKeyImage(keyImage);
         auto res = database.readThreadSafe(batch);
 
@@ -1419,7 +1944,7 @@ namespace CryptoNote
     std::vector<uint64_t>
         DatabaseBlockchainCache::getLastTimestamps(size_t count, uint32_t blockIndex, UseGenesis useGenesis) const
     {
-        return getLastUnits(count, blockIndex, useGenesis, [](const CachedBlockInfo &inf) { return inf.timestamp; });
+        return blockMetadata.getTimestamps(getLastUnitsStart(count, blockIndex, useGenesis), blockIndex + 1);
     }
 
     std::vector<uint64_t> DatabaseBlockchainCache::getLastBlocksSizes(size_t count) const
@@ -1430,7 +1955,7 @@ namespace CryptoNote
     std::vector<uint64_t>
         DatabaseBlockchainCache::getLastBlocksSizes(size_t count, uint32_t blockIndex, UseGenesis useGenesis) const
     {
-        return getLastUnits(count, blockIndex, useGenesis, [](const CachedBlockInfo &cb) { return cb.blockSize; });
+        return blockMetadata.getBlockSizes(getLastUnitsStart(count, blockIndex, useGenesis), blockIndex + 1);
     }
 
     std::vector<uint64_t> DatabaseBlockchainCache::getLastCumulativeDifficulties(
@@ -1438,8 +1963,8 @@ namespace CryptoNote
         uint32_t blockIndex,
         UseGenesis useGenesis) const
     {
-        return getLastUnits(
-            count, blockIndex, useGenesis, [](const CachedBlockInfo &info) { return info.cumulativeDifficulty; });
+        return blockMetadata.getCumulativeDifficulties(
+            getLastUnitsStart(count, blockIndex, useGenesis), blockIndex + 1);
     }
 
     std::vector<uint64_t> DatabaseBlockchainCache::getLastCumulativeDifficulties(size_t count) const
@@ -1470,13 +1995,13 @@ namespace CryptoNote
 
     uint64_t DatabaseBlockchainCache::getCurrentCumulativeDifficulty() const
     {
-        return getCachedBlockInfo(getTopBlockIndex()).cumulativeDifficulty;
+        return blockMetadata.getCumulativeDifficulty(getTopBlockIndex());
     }
 
     uint64_t DatabaseBlockchainCache::getCurrentCumulativeDifficulty(uint32_t blockIndex) const
     {
         assert(blockIndex <= getTopBlockIndex());
-        return getCachedBlockInfo(blockIndex).cumulativeDifficulty;
+        return blockMetadata.getCumulativeDifficulty(blockIndex);
     }
 
     CachedBlockInfo DatabaseBlockchainCache::getCachedBlockInfo(uint32_t index) const
@@ -1493,80 +2018,46 @@ namespace CryptoNote
 
     uint64_t DatabaseBlockchainCache::getAlreadyGeneratedCoins(uint32_t blockIndex) const
     {
-        return getCachedBlockInfo(blockIndex).alreadyGeneratedCoins;
+        return blockMetadata.getAlreadyGeneratedCoins(blockIndex);
     }
 
     uint64_t DatabaseBlockchainCache::getAlreadyGeneratedTransactions(uint32_t blockIndex) const
     {
-        return getCachedBlockInfo(blockIndex).alreadyGeneratedTransactions;
+        return blockMetadata.getBlockInfo(blockIndex).alreadyGeneratedTransactions;
     }
 
-    std::vector<CachedBlockInfo>
-        DatabaseBlockchainCache::getLastCachedUnits(uint32_t blockIndex, size_t count, UseGenesis useGenesis) const
+    uint32_t DatabaseBlockchainCache::getLastUnitsStart(size_t count, uint32_t blockIndex, UseGenesis useGenesis) const
     {
         assert(blockIndex <= getTopBlockIndex());
+        assert(count <= std::numeric_limits<uint32_t>::max());
 
-        std::vector<CachedBlockInfo> cachedResult;
-        const uint32_t cacheStartIndex = (getTopBlockIndex() + 1) - static_cast<uint32_t>(unitsCache.size());
-
-        count = std::min(unitsCache.size(), count);
-
-        if (cacheStartIndex > blockIndex || count == 0)
-        {
-            return cachedResult;
-        }
-
-        count = std::min(blockIndex - cacheStartIndex + 1, static_cast<uint32_t>(count));
-        uint32_t offset = static_cast<uint32_t>(blockIndex + 1 - count) - cacheStartIndex;
-
-        assert(offset < unitsCache.size());
-
-        if (!useGenesis && cacheStartIndex == 0 && offset == 0)
-        {
-            ++offset;
-            --count;
-        }
-
-        if (offset >= unitsCache.size() || count == 0)
-        {
-            return cachedResult;
-        }
-
-        cachedResult.reserve(count);
-        for (size_t i = 0; i < count; ++i)
+        uint32_t startIndex = blockIndex + 1 - std::min(blockIndex + 1, static_cast<uint32_t>(count));
+        if (startIndex == 0 && !useGenesis)
         {
-            cachedResult.push_back(unitsCache[offset + i]);
+            startIndex += 1;
         }
 
-        return cachedResult;
+        return startIndex;
     }
 
     std::vector<CachedBlockInfo>
-        DatabaseBlockchainCache::getLastDbUnits(uint32_t blockIndex, size_t count, UseGenesis useGenesis) const
+        DatabaseBlockchainCache::getCachedBlockInfos(uint32_t startIndex, uint32_t endIndex) const
     {
-        uint32_t readFrom = blockIndex + 1 - std::min(blockIndex + 1, static_cast<uint32_t>(count));
-        if (readFrom == 0 && !useGenesis)
-        {
-            readFrom += 1;
-        }
-
-        uint32_t toRead = blockIndex - readFrom + 1;
         std::vector<CachedBlockInfo> units;
-        units.reserve(toRead);
+        units.reserve(endIndex - startIndex);
 
         const uint32_t step = 200;
-        while (toRead > 0)
+        while (startIndex < endIndex)
         {
-            auto next = std::min(toRead, step);
-            toRead -= next;
+            auto next = std::min(endIndex - startIndex, step);
 
             BlockchainReadBatch batch;
-            for (auto id = readFrom; id < readFrom + next; ++id)
+            for (auto id = startIndex; id < startIndex + next; ++id)
             {
                 batch.requestCachedBlock(id);
             }
 
-            readFrom += next;
+            startIndex += next;
 
             auto res = readDatabase(batch);
 
@@ -1576,75 +2067,91 @@ namespace CryptoNote
             {
                 units.push_back(kv.second);
             }
-            //    std::transform(sortedResult.begin(), sortedResult.end(), std::back_inserter(units),
-            //                   [&](const std::pair<uint32_t, CachedBlockInfo>& cb) { return pred(cb.second); });
         }
 
         return units;
     }
 
+    /* Served from the block metadata index, which doesn't store block hashes,
+       so pred must not use them */
     std::vector<uint64_t> DatabaseBlockchainCache::getLastUnits(
         size_t count,
         uint32_t blockIndex,
         UseGenesis useGenesis,
         std::function<uint64_t(const CachedBlockInfo &)> pred) const
     {
-        assert(count <= std::numeric_limits<uint32_t>::max());
-
-        auto cachedUnits = getLastCachedUnits(blockIndex, count, useGenesis);
+        std::vector<uint64_t> result;
 
-        uint32_t availableUnits = blockIndex;
-        if (useGenesis)
+        for (uint32_t i = getLastUnitsStart(count, blockIndex, useGenesis); i <= blockIndex; i++)
         {
-            availableUnits += 1;
+            result.push_back(pred(blockMetadata.getBlockInfo(i)));
         }
 
-        assert(availableUnits >= cachedUnits.size());
+        return result;
+    }
 
-        if (availableUnits - cachedUnits.size() == 0)
+    Crypto::Hash DatabaseBlockchainCache::getBlockHash(uint32_t blockIndex) const
+    {
+        if (blockIndex == getTopBlockIndex())
         {
-            std::vector<uint64_t> result;
-            result.reserve(cachedUnits.size());
-            for (const auto &unit : cachedUnits)
-            {
-                result.push_back(pred(unit));
-            }
-
-            return result;
+            return getTopBlockHash();
         }
 
-        assert(blockIndex + 1 >= cachedUnits.size());
-        uint32_t dbIndex = blockIndex - static_cast<uint32_t>(cachedUnits.size());
+        auto batch = BlockchainReadBatch().requestCachedBlock(blockIndex);
+        auto result = readDatabase(batch);
+        return result.getCachedBlocks().at(blockIndex).blockHash;
+    }
 
-        assert(count >= cachedUnits.size());
-        size_t leftCount = count - cachedUnits.size();
+    std::vector<BlockSummary> DatabaseBlockchainCache::getBlockSummaries(uint32_t startIndex, uint32_t endIndex) const
+    {
+        endIndex = std::min(endIndex, getTopBlockIndex() + 1);
 
-        auto dbUnits = getLastDbUnits(dbIndex, leftCount, useGenesis);
-        std::vector<uint64_t> result;
-        result.reserve(dbUnits.size() + cachedUnits.size());
-        for (const auto &unit : dbUnits)
+        if (startIndex >= endIndex)
         {
-            result.push_back(pred(unit));
+            return {};
         }
 
-        for (const auto &unit : cachedUnits)
+        BlockchainReadBatch batch;
+
+        for (uint32_t blockIndex = startIndex; blockIndex < endIndex; blockIndex++)
         {
-            result.push_back(pred(unit));
+            batch.requestBlockSummary(blockIndex)
+                .requestCachedBlock(blockIndex)
+                .requestTransactionHashesByBlock(blockIndex);
         }
 
-        return result;
-    }
+        const auto result = readDatabase(batch);
 
-    Crypto::Hash DatabaseBlockchainCache::getBlockHash(uint32_t blockIndex) const
-    {
-        if (blockIndex == getTopBlockIndex())
+        const auto &storedSummaries = result.getBlockSummaries();
+        const auto &blockInfos = result.getCachedBlocks();
+        const auto &transactionHashes = result.getTransactionHashesByBlocks();
+
+        std::vector<BlockSummary> summaries;
+
+        summaries.reserve(endIndex - startIndex);
+
+        for (uint32_t blockIndex = startIndex; blockIndex < endIndex; blockIndex++)
         {
-            return getTopBlockHash();
+            const auto summary = storedSummaries.find(blockIndex);
+            const auto blockInfo = blockInfos.find(blockIndex);
+            const auto hashes = transactionHashes.find(blockIndex);
+
+            if (summary == storedSummaries.end() || blockInfo == blockInfos.end() || hashes == transactionHashes.end()
+                || summary->second.blockHash != blockInfo->second.blockHash
+                || summary->second.transactions.size() != hashes->second.size())
+            {
+                break;
+            }
+
+            summaries.push_back(summary->second);
+
+            for (size_t i = 0; i < hashes->second.size(); i++)
+            {
+                summaries.back().transactions[i].transactionHash = hashes->second[i];
+            }
         }
 
-        auto batch = BlockchainReadBatch().requestCachedBlock(blockIndex);
-        auto result = readDatabase(batch);
-        return result.getCachedBlocks().at(blockIndex).blockHash;
+        return summaries;
     }
 
     std::vector<Crypto::Hash> DatabaseBlockchainCache::getBlockHashes(uint32_t startIndex, size_t maxCount) const
@@ -1802,7 +2309,13 @@ namespace CryptoNote
         return children.size();
     }
 
-    void DatabaseBlockchainCache::save() {}
+    void DatabaseBlockchainCache::save()
+    {
+        if (!spentKeyImages.save(spentKeyImagesFilename, getTopBlockIndex() + 1, getTopBlockHash()))
+        {
+            logger(Logging::WARNING) << "Failed to save spent key image filter, it will be rebuilt on startup";
+        }
+    }
 
     void DatabaseBlockchainCache::load() {}
 
@@ -1836,16 +2349,18 @@ namespace CryptoNote
         }
 
         auto res = readDatabase(batch);
+
+        std::unordered_map<uint32_t, RawBlock> blocksMap;
         for (auto &tx : res.getCachedTransactions())
         {
-            batch.requestRawBlock(tx.second.blockIndex);
+            if (blocksMap.find(tx.second.blockIndex) == blocksMap.end())
+            {
+                blocksMap.emplace(tx.second.blockIndex, mainChainStorage.getBlockByIndex(tx.second.blockIndex));
+            }
         }
 
-        auto blocks = readDatabase(batch);
-
         foundTransactions.reserve(foundTransactions.size() + transactions.size());
         auto &hashesMap = res.getCachedTransactions();
-        auto &blocksMap = blocks.getRawBlocks();
         for (const auto &hash : transactions)
         {
             auto transactionIt = hashesMap.find(hash);
@@ -1882,9 +2397,8 @@ namespace CryptoNote
 
     RawBlock DatabaseBlockchainCache::getBlockByIndex(uint32_t index) const
     {
-        auto batch = BlockchainReadBatch().requestRawBlock(index);
-        auto res = readDatabase(batch);
-        return std::move(res.getRawBlocks().at(index));
+        assert(index <= getTopBlockIndex());
+        return mainChainStorage.getBlockByIndex(index);
     }
 
     BinaryArray DatabaseBlockchainCache::getRawTransaction(uint32_t blockIndex, uint32_t transactionIndex) const
@@ -1901,6 +2415,22 @@ namespace CryptoNote
     std::vector<uint32_t>
         DatabaseBlockchainCache::getRandomOutsByAmount(uint64_t amount, size_t count, uint32_t blockIndex) const
     {
+        std::vector<uint32_t> unlockedCounts;
+
+        if (getUnlockedKeyOutputCounts({amount}, blockIndex, unlockedCounts))
+        {
+            const auto outputs = pickRandomKeyOutputs({amount}, unlockedCounts, count, blockIndex);
+
+            std::vector<uint32_t> resultOuts;
+
+            for (const auto &output : outputs[0])
+            {
+                resultOuts.push_back(output.first);
+            }
+
+            return resultOuts;
+        }
+
         auto batch = BlockchainReadBatch().requestKeyOutputGlobalIndexesCountForAmount(amount);
         auto result = readDatabase(batch);
         auto outputsCount = result.getKeyOutputGlobalIndexesCountForAmounts();
@@ -1969,6 +2499,205 @@ namespace CryptoNote
         return resultOuts;
     }
 
+    std::vector<std::vector<std::pair<IBlockchainCache::GlobalOutputIndex, Crypto::PublicKey>>>
+        DatabaseBlockchainCache::getRandomOutsByAmounts(
+            const std::vector<Amount> &amounts,
+            size_t count,
+            uint32_t blockIndex) const
+    {
+        std::vector<uint32_t> unlockedCounts;
+
+        if (getUnlockedKeyOutputCounts(amounts, blockIndex, unlockedCounts))
+        {
+            return pickRandomKeyOutputs(amounts, unlockedCounts, count, blockIndex);
+        }
+
+        return Utils::getRandomOutsOneAmountAtATime(*this, amounts, count, blockIndex);
+    }
+
+    bool DatabaseBlockchainCache::getUnlockedKeyOutputCounts(
+        const std::vector<Amount> &amounts,
+        uint32_t blockIndex,
+        std::vector<uint32_t> &unlockedCounts) const
+    {
+        /* Outputs in blocks above this are still locked */
+        uint32_t upperBlockIndex = 0;
+        if (blockIndex > currency.minedMoneyUnlockWindow())
+        {
+            upperBlockIndex = blockIndex - currency.minedMoneyUnlockWindow();
+        }
+
+        /* Taken before reading the top block index, so it can't move on from
+           the recent counts while we use them */
+        std::scoped_lock<std::mutex> lock(randomOutputsMutex);
+
+        const uint32_t topIndex = getTopBlockIndex();
+
+        const uint32_t firstRecentIndex = topIndex + 1 - static_cast<uint32_t>(recentKeyOutputCounts.size());
+
+        /* Some of the locked blocks are older than the ones we keep counts for */
+        if (upperBlockIndex + 1 < firstRecentIndex)
+        {
+            return false;
+        }
+
+        std::vector<uint32_t> totals(amounts.size());
+
+        BlockchainReadBatch batch;
+        bool haveMissing = false;
+
+        for (size_t i = 0; i < amounts.size(); i++)
+        {
+            const auto it = randomOutputTotals.find(amounts[i]);
+
+            if (it != randomOutputTotals.end())
+            {
+                randomOutputTotalsUsage.splice(
+                    randomOutputTotalsUsage.begin(), randomOutputTotalsUsage, it->second.usage);
+
+                totals[i] = it->second.total;
+            }
+            else
+            {
+                batch.requestKeyOutputGlobalIndexesCountForAmount(amounts[i]);
+                haveMissing = true;
+            }
+        }
+
+        if (haveMissing)
+        {
+            const auto result = readDatabase(batch);
+            const auto &databaseTotals = result.getKeyOutputGlobalIndexesCountForAmounts();
+
+            for (size_t i = 0; i < amounts.size(); i++)
+            {
+                const auto it = databaseTotals.find(amounts[i]);
+
+                /* Either already cached, or has no outputs, and an amount
+                   which doesn't exist isn't worth a place in the cache */
+                if (it == databaseTotals.end() || it->second == 0)
+                {
+                    continue;
+                }
+
+                totals[i] = it->second;
+
+                if (randomOutputTotals.find(amounts[i]) == randomOutputTotals.end())
+                {
+                    randomOutputTotalsUsage.push_front(amounts[i]);
+                    randomOutputTotals[amounts[i]] = {it->second, randomOutputTotalsUsage.begin()};
+                }
+            }
+
+            while (randomOutputTotals.size() > RANDOM_OUTPUT_TOTALS_CACHE_SIZE)
+            {
+                randomOutputTotals.erase(randomOutputTotalsUsage.back());
+                randomOutputTotalsUsage.pop_back();
+            }
+        }
+
+        unlockedCounts.clear();
+        unlockedCounts.reserve(amounts.size());
+
+        for (size_t i = 0; i < amounts.size(); i++)
+        {
+            uint32_t unlocked = totals[i];
+
+            for (uint32_t j = std::max(upperBlockIndex + 1, firstRecentIndex); j <= topIndex; j++)
+            {
+                const auto &counts = recentKeyOutputCounts[j - firstRecentIndex];
+                const auto it = counts.find(amounts[i]);
+
+                if (it != counts.end())
+                {
+                    unlocked -= it->second;
+                }
+            }
+
+            unlockedCounts.push_back(unlocked);
+        }
+
+        return true;
+    }
+
+    std::vector<std::vector<std::pair<IBlockchainCache::GlobalOutputIndex, Crypto::PublicKey>>>
+        DatabaseBlockchainCache::pickRandomKeyOutputs(
+            const std::vector<Amount> &amounts,
+            const std::vector<uint32_t> &unlockedCounts,
+            size_t count,
+            uint32_t blockIndex) const
+    {
+        std::vector<std::vector<std::pair<GlobalOutputIndex, Crypto::PublicKey>>> result(amounts.size());
+
+        std::vector<ShuffleGenerator<uint32_t>> generators;
+        generators.reserve(amounts.size());
+
+        for (size_t i = 0; i < amounts.size(); i++)
+        {
+            generators.emplace_back(unlockedCounts[i]);
+        }
+
+        /* Every candidate has passed the unlock window, so we only need the
+           output info to check its unlock time, which also gives us the key.
+           Usually one read is enough, we only go round again if some outputs
+           had an unlock time in the future. */
+        while (true)
+        {
+            BlockchainReadBatch batch;
+
+            std::vector<std::vector<uint32_t>> candidates(amounts.size());
+
+            bool haveCandidates = false;
+
+            for (size_t i = 0; i < amounts.size(); i++)
+            {
+                while (result[i].size() + candidates[i].size() < count && !generators[i].empty())
+                {
+                    const uint32_t globalIndex = generators[i]();
+
+                    candidates[i].push_back(globalIndex);
+                    batch.requestKeyOutputInfo(amounts[i], globalIndex);
+                    haveCandidates = true;
+                }
+            }
+
+            if (!haveCandidates)
+            {
+                break;
+            }
+
+            const auto readResult = readDatabase(batch);
+            const auto &outputs = readResult.getKeyOutputInfo();
+
+            for (size_t i = 0; i < amounts.size(); i++)
+            {
+                for (const auto globalIndex : candidates[i])
+                {
+                    const auto it = outputs.find({amounts[i], globalIndex});
+
+                    if (it == outputs.end())
+                    {
+                        logger(Logging::DEBUGGING) << "pickRandomKeyOutputs: missing output " << globalIndex
+                                                   << " for amount " << amounts[i];
+                        throw std::runtime_error("Invalid global index is given");
+                    }
+
+                    if (isTransactionSpendTimeUnlocked(it->second.unlockTime, blockIndex))
+                    {
+                        result[i].emplace_back(globalIndex, it->second.publicKey);
+                    }
+                }
+            }
+        }
+
+        for (auto &outputs : result)
+        {
+            std::sort(outputs.begin(), outputs.end(), [](const auto &a, const auto &b) { return a.first < b.first; });
+        }
+
+        return result;
+    }
+
     ExtractOutputKeysResult DatabaseBlockchainCache::extractKeyOutputs(
         uint64_t amount,
         uint32_t blockIndex,
@@ -2083,12 +2812,11 @@ namespace CryptoNote
                not taking too many */
             uint64_t endHeight = startHeight + (blockCount * 2);
 
-            auto blockBatch = BlockchainReadBatch().requestRawBlocks(startHeight, endHeight);
-            const auto rawBlocks = readDatabase(blockBatch).getRawBlocks();
+            const auto rawBlocks = getBlocksByHeight(startHeight, endHeight);
 
             while (orderedBlocks.size() < blockCount && height < startHeight + rawBlocks.size())
             {
-                const auto block = rawBlocks.at(height);
+                const auto &block = rawBlocks[height - startHeight];
 
                 height++;
 
@@ -2107,17 +2835,14 @@ namespace CryptoNote
     std::vector<RawBlock>
         DatabaseBlockchainCache::getBlocksByHeight(const uint64_t startHeight, uint64_t endHeight) const
     {
-        auto blockBatch = BlockchainReadBatch().requestRawBlocks(startHeight, endHeight);
-
-        /* Get the info from the DB */
-        auto rawBlocks = readDatabase(blockBatch).getRawBlocks();
-
         std::vector<RawBlock> orderedBlocks;
 
-        /* Order, and convert from map, to vector */
-        for (uint64_t height = startHeight; height < startHeight + rawBlocks.size(); height++)
+        /* Only the blocks we have, the storage may be ahead of us */
+        endHeight = std::min<uint64_t>(endHeight, getTopBlockIndex() + 1);
+
+        for (uint64_t height = startHeight; height < endHeight; height++)
         {
-            orderedBlocks.push_back(rawBlocks.at(height));
+            orderedBlocks.push_back(mainChainStorage.getBlockByIndex(static_cast<uint32_t>(height)));
         }
 
         return orderedBlocks;
@@ -2148,7 +2873,6 @@ namespace CryptoNote
         assert(blockIndex <= getTopBlockIndex());
 
         auto batch = BlockchainReadBatch()
-                         .requestRawBlock(blockIndex)
                          .requestCachedBlock(blockIndex)
                          .requestSpentKeyImagesByBlock(blockIndex);
 
@@ -2164,7 +2888,26 @@ namespace CryptoNote
 
         ExtendedPushedBlockInfo extendedInfo;
 
-        extendedInfo.pushedBlockInfo.rawBlock = dbResult.getRawBlocks().at(blockIndex);
+        extendedInfo.blockHash = blockInfo.blockHash;
+        extendedInfo.hasRawBlock = false;
+
+        if (blockIndex < mainChainStorage.getBlockCount())
+        {
+            try
+            {
+                RawBlock rawBlock = mainChainStorage.getBlockByIndex(blockIndex);
+
+                if (CachedBlock(fromBinaryArray<BlockTemplate>(rawBlock.block)).getBlockHash() == blockInfo.blockHash)
+                {
+                    extendedInfo.pushedBlockInfo.rawBlock = std::move(rawBlock);
+                    extendedInfo.hasRawBlock = true;
+                }
+            }
+            catch (const std::exception &)
+            {
+                /* Corrupted, treat it as missing */
+            }
+        }
         extendedInfo.pushedBlockInfo.blockSize = blockInfo.blockSize;
         extendedInfo.pushedBlockInfo.blockDifficulty =
             blockInfo.cumulativeDifficulty - previousBlockInfo.cumulativeDifficulty;
@@ -2242,7 +2985,16 @@ namespace CryptoNote
         pushTransaction(cachedBaseTransaction, 0, 0, batch);
 
         batch.insertCachedBlock(blockInfo, 0, {cachedBaseTransaction.getTransactionHash()});
-        batch.insertRawBlock(0, {toBinaryArray(genesisBlock.getBlock()), {}});
+        batch.insertBlockSummary(
+            0,
+            makeBlockSummary(
+                0,
+                genesisBlock.getBlock(),
+                getObjectBinarySize(genesisBlock.getBlock()),
+                cachedBaseTransaction,
+                {},
+                blockInfo,
+                blockInfo.cumulativeDifficulty));
         batch.insertClosestTimestampBlockIndex(roundToMidnight(genesisBlock.getBlock().timestamp), 0);
 
         auto res = database.write(batch);
@@ -2254,7 +3006,8 @@ namespace CryptoNote
 
         topBlockHash = genesisBlock.getBlockHash();
 
-        unitsCache.push_back(blockInfo);
+        blockMetadata.clear();
+        blockMetadata.push(blockInfo);
     }
 
 } // namespace CryptoNote
@@ -23,10 +23,16 @@
 #include "cryptonotecore/UpgradeManager.h"
 
 #include <IDataBase.h>
+#include <cryptonotecore/BlockMetadataIndex.h>
 #include <cryptonotecore/BlockchainReadBatch.h>
 #include <cryptonotecore/BlockchainWriteBatch.h>
 #include <cryptonotecore/DatabaseCacheData.h>
 #include <cryptonotecore/IBlockchainCacheFactory.h>
+#include <cryptonotecore/IMainChainStorage.h>
+#include <cryptonotecore/KeyImageFilter.h>
+#include <deque>
+#include <list>
+#include <mutex>
 
 namespace CryptoNote
 {
@@ -51,6 +57,8 @@ namespace CryptoNote
             const Currency &currency,
             IDataBase &dataBase,
             IBlockchainCacheFactory &blockchainCacheFactory,
+            const IMainChainStorage &mainChainStorage,
+            const std::string &blockMetadataDirectory,
             std::shared_ptr<Logging::ILogger> logger);
 
         static bool checkDBSchemeVersion(IDataBase &dataBase, std::shared_ptr<Logging::ILogger> logger);
@@ -149,6 +157,8 @@ namespace CryptoNote
 
         Crypto::Hash getBlockHash(uint32_t blockIndex) const override;
 
+        std::vector<BlockSummary> getBlockSummaries(uint32_t startIndex, uint32_t endIndex) const override;
+
         virtual std::vector<Crypto::Hash> getBlockHashes(uint32_t startIndex, size_t maxCount) const override;
 
         /*
@@ -214,6 +224,11 @@ namespace CryptoNote
         virtual std::vector<uint32_t>
             getRandomOutsByAmount(uint64_t amount, size_t count, uint32_t blockIndex) const override;
 
+        virtual std::vector<std::vector<std::pair<GlobalOutputIndex, Crypto::PublicKey>>> getRandomOutsByAmounts(
+            const std::vector<Amount> &amounts,
+            size_t count,
+            uint32_t blockIndex) const override;
+
         virtual ExtractOutputKeysResult extractKeyOutputs(
             uint64_t amount,
             uint32_t blockIndex,
@@ -240,6 +255,9 @@ namespace CryptoNote
 
         IBlockchainCacheFactory &blockchainCacheFactory;
 
+        /* The raw blocks are only kept here, not in the database */
+        const IMainChainStorage &mainChainStorage;
+
         mutable boost::optional<uint32_t> topBlockIndex;
 
         mutable boost::optional<Crypto::Hash> topBlockHash;
@@ -250,13 +268,49 @@ namespace CryptoNote
 
         mutable std::unordered_map<Amount, int32_t> keyOutputCountsForAmounts;
 
+        /* The number of key outputs of each amount created in each of the last
+           minedMoneyUnlockWindow blocks, oldest first. Every output older than
+           these has passed the unlock window, so the unlocked outputs of an
+           amount are the global indexes below its total, less these. */
+        std::deque<std::unordered_map<Amount, uint32_t>> recentKeyOutputCounts;
+
+        struct RandomOutputTotal
+        {
+            uint32_t total;
+
+            /* Position in randomOutputTotalsUsage */
+            std::list<Amount>::iterator usage;
+        };
+
+        /* Total key outputs of each amount, read from the database when first
+           asked for, then kept up to date as blocks are pushed. Only amounts
+           with outputs are kept, and the least recently used are dropped
+           once there are too many, as anyone can ask for any amount. */
+        mutable std::unordered_map<Amount, RandomOutputTotal> randomOutputTotals;
+
+        /* Amounts in randomOutputTotals, most recently used at the front */
+        mutable std::list<Amount> randomOutputTotalsUsage;
+
+        /* Random outputs are picked by RPC threads while blocks are pushed.
+           Held while a block is written to the database, and the top block
+           index, the totals and the recent counts are updated, so a total
+           read from the database always matches the counts it is used with. */
+        mutable std::mutex randomOutputsMutex;
+
         std::vector<IBlockchainCache *> children;
 
         Logging::LoggerRef logger;
 
-        std::deque<CachedBlockInfo> unitsCache;
+        /* Timestamps, sizes, difficulties and coins of every block, so the
+           difficulty and median calculations don't have to read the DB */
+        BlockMetadataIndex blockMetadata;
 
-        const size_t unitsCacheSize = 1000;
+        /* Every spent key image, so checkIfSpent only has to read the DB
+           for the few which might have been spent */
+        KeyImageFilter spentKeyImages;
+
+        /* Where the filter is kept between runs */
+        const std::string spentKeyImagesFilename;
 
         struct ExtendedPushedBlockInfo;
 
@@ -290,6 +344,28 @@ namespace CryptoNote
 
         void addGenesisBlock(CachedBlock &&genesisBlock);
 
+        /* randomOutputsMutex must be held for this and pushRecentKeyOutputCounts */
+        void loadRecentKeyOutputCounts();
+
+        std::unordered_map<Amount, uint32_t> countKeyOutputs(
+            const CachedBlock &cachedBlock,
+            const std::vector<CachedTransaction> &cachedTransactions) const;
+
+        void pushRecentKeyOutputCounts(std::unordered_map<Amount, uint32_t> counts);
+
+        /* How many outputs of each amount have passed the unlock window at
+           blockIndex. False if blockIndex is too far below our top to tell. */
+        bool getUnlockedKeyOutputCounts(
+            const std::vector<Amount> &amounts,
+            uint32_t blockIndex,
+            std::vector<uint32_t> &unlockedCounts) const;
+
+        std::vector<std::vector<std::pair<GlobalOutputIndex, Crypto::PublicKey>>> pickRandomKeyOutputs(
+            const std::vector<Amount> &amounts,
+            const std::vector<uint32_t> &unlockedCounts,
+            size_t count,
+            uint32_t blockIndex) const;
+
         enum class OutputSearchResult : uint8_t
         {
             FOUND,
@@ -334,8 +410,36 @@ namespace CryptoNote
 
         uint64_t getCachedTransactionsCount() const;
 
-        std::vector<CachedBlockInfo> getLastCachedUnits(uint32_t blockIndex, size_t count, UseGenesis useGenesis) const;
+        /* Index of the first of the last `count` blocks up to and including blockIndex */
+        uint32_t getLastUnitsStart(size_t count, uint32_t blockIndex, UseGenesis useGenesis) const;
 
-        std::vector<CachedBlockInfo> getLastDbUnits(uint32_t blockIndex, size_t count, UseGenesis useGenesis) const;
+        /* Reads the blocks in [startIndex, endIndex) from the DB */
+        std::vector<CachedBlockInfo> getCachedBlockInfos(uint32_t startIndex, uint32_t endIndex) const;
+
+        /* Checks the block metadata index against the DB, and rebuilds
+           whatever is missing or doesn't match */
+        void syncBlockMetadata();
+
+        /* The summary for a block which is about to be, or already has been,
+           added at blockIndex. Needs the blocks below it in the metadata
+           index. */
+        BlockSummary makeBlockSummary(
+            uint32_t blockIndex,
+            const BlockTemplate &block,
+            size_t blockBlobSize,
+            const CachedTransaction &baseTransaction,
+            const std::vector<CachedTransaction> &transactions,
+            const CachedBlockInfo &blockInfo,
+            uint64_t blockDifficulty) const;
+
+        /* Whether the DB has a summary for the block currently at blockIndex */
+        bool hasBlockSummary(uint32_t blockIndex) const;
+
+        /* Adds summaries for blocks added before we stored them */
+        void syncBlockSummaries();
+
+        /* Loads the spent key image filter saved on shutdown, or builds it
+           from the DB if it's missing or out of date */
+        void loadSpentKeyImages();
     };
 } // namespace CryptoNote
@@ -13,8 +13,13 @@ namespace CryptoNote
 {
     DatabaseBlockchainCacheFactory::DatabaseBlockchainCacheFactory(
         IDataBase &database,
+        const IMainChainStorage &mainChainStorage,
+        const std::string &blockMetadataDirectory,
         std::shared_ptr<Logging::ILogger> logger):
-        database(database), logger(logger)
+        database(database),
+        mainChainStorage(mainChainStorage),
+        blockMetadataDirectory(blockMetadataDirectory),
+        logger(logger)
     {
     }
 
@@ -23,7 +28,8 @@ namespace CryptoNote
     std::unique_ptr<IBlockchainCache>
         DatabaseBlockchainCacheFactory::createRootBlockchainCache(const Currency &currency)
     {
-        return std::unique_ptr<IBlockchainCache>(new DatabaseBlockchainCache(currency, database, *this, logger));
+        return std::unique_ptr<IBlockchainCache>(new DatabaseBlockchainCache(
+            currency, database, *this, mainChainStorage, blockMetadataDirectory, logger));
     }
 
     std::unique_ptr<IBlockchainCache> DatabaseBlockchainCacheFactory::createBlockchainCache(
@@ -6,6 +6,7 @@
 #pragma once
 
 #include "IBlockchainCacheFactory.h"
+#include "IMainChainStorage.h"
 
 #include <logging/LoggerMessage.h>
 
@@ -16,7 +17,11 @@ namespace CryptoNote
     class DatabaseBlockchainCacheFactory : public IBlockchainCacheFactory
     {
       public:
-        explicit DatabaseBlockchainCacheFactory(IDataBase &database, std::shared_ptr<Logging::ILogger> logger);
+        DatabaseBlockchainCacheFactory(
+            IDataBase &database,
+            const IMainChainStorage &mainChainStorage,
+            const std::string &blockMetadataDirectory,
+            std::shared_ptr<Logging::ILogger> logger);
 
         virtual ~DatabaseBlockchainCacheFactory();
 
@@ -28,6 +33,10 @@ namespace CryptoNote
       private:
         IDataBase &database;
 
+        const IMainChainStorage &mainChainStorage;
+
+        const std::string blockMetadataDirectory;
+
         std::shared_ptr<Logging::ILogger> logger;
     };
 
@@ -0,0 +1,372 @@
+// Copyright (c) 2012-2017, The CryptoNote developers, The Bytecoin developers
+// Copyright (c) 2018-2019, The TurtleCoin Developers
+//
+// Please see the included LICENSE file for more information.
+
+#include "DatabaseMigration.h"
+
+#include "DBUtils.h"
+#include "DatabaseCacheData.h"
+#include "common/MemoryInputStream.h"
+#include "serialization/KVBinaryInputStreamSerializer.h"
+
+#include <optional>
+#include <system_error>
+
+namespace CryptoNote
+{
+    namespace
+    {
+        /* Every scheme 2 key is a KV binary object, which starts with this
+           byte of the KV binary signature. No later key does. */
+        const std::string KV_BINARY_KEY_PREFIX = "\x01";
+
+        /* Raw blocks were kept in the DB as well as in blocks.bin until
+           scheme 4 */
+        const std::string RAW_BLOCK_PREFIX = "4";
+
+        const size_t MIGRATION_BATCH_SIZE = 100000;
+
+        const std::vector<std::string> KV_BINARY_PREFIXES = {
+            DB::BLOCK_INDEX_TO_KEY_IMAGE_PREFIX,
+            DB::BLOCK_INDEX_TO_TX_HASHES_PREFIX,
+            RAW_BLOCK_PREFIX,
+            DB::BLOCK_HASH_TO_BLOCK_INDEX_PREFIX,
+            DB::BLOCK_INDEX_TO_BLOCK_INFO_PREFIX,
+            DB::KEY_IMAGE_TO_BLOCK_INDEX_PREFIX,
+            DB::BLOCK_INDEX_TO_BLOCK_HASH_PREFIX,
+            DB::TRANSACTION_HASH_TO_TRANSACTION_INFO_PREFIX,
+            DB::KEY_OUTPUT_AMOUNT_PREFIX,
+            DB::CLOSEST_TIMESTAMP_BLOCK_INDEX_PREFIX,
+            DB::PAYMENT_ID_TO_TX_HASH_PREFIX,
+            DB::TIMESTAMP_TO_BLOCKHASHES_PREFIX,
+            DB::KEY_OUTPUT_AMOUNTS_COUNT_PREFIX,
+            DB::KEY_OUTPUT_KEY_PREFIX};
+
+        /* Keys were stored as {prefix: {first: prefix, second: key}}, so the
+           prefix is the name of the only field at the top */
+        std::optional<std::string> readKVBinaryPrefix(std::string_view rawKey)
+        {
+            try
+            {
+                Common::MemoryInputStream stream(rawKey.data(), rawKey.size());
+                KVBinaryInputStreamSerializer serializer(stream);
+
+                for (const std::string &prefix : KV_BINARY_PREFIXES)
+                {
+                    if (serializer.beginObject(prefix))
+                    {
+                        return prefix;
+                    }
+                }
+            }
+            catch (const std::exception &)
+            {
+            }
+
+            return std::nullopt;
+        }
+
+        /* False if the key under this prefix is a different type. Several
+           prefixes hold a count as well as the entries it counts. */
+        template<class Key> bool readKVBinaryKey(std::string_view rawKey, const std::string &prefix, Key &key)
+        {
+            try
+            {
+                Common::MemoryInputStream stream(rawKey.data(), rawKey.size());
+                KVBinaryInputStreamSerializer serializer(stream);
+
+                std::pair<std::string, Key> prefixAndKey;
+
+                if (!serializer(prefixAndKey, prefix))
+                {
+                    return false;
+                }
+
+                key = std::move(prefixAndKey.second);
+
+                return true;
+            }
+            catch (const std::exception &)
+            {
+                return false;
+            }
+        }
+
+        template<class Value> void readKVBinaryValue(std::string_view rawValue, const std::string &prefix, Value &value)
+        {
+            Common::MemoryInputStream stream(rawValue.data(), rawValue.size());
+            KVBinaryInputStreamSerializer serializer(stream);
+
+            if (!serializer(value, prefix))
+            {
+                throw std::runtime_error("Missing DB value for prefix " + prefix);
+            }
+        }
+
+        /* The key and value in the current scheme, or nothing if the key
+           isn't this type */
+        template<class Key, class Value>
+        std::optional<std::pair<std::string, std::string>>
+            convertKVBinary(std::string_view rawKey, std::string_view rawValue, const std::string &prefix)
+        {
+            Key key;
+
+            if (!readKVBinaryKey(rawKey, prefix, key))
+            {
+                return std::nullopt;
+            }
+
+            Value value;
+
+            readKVBinaryValue(rawValue, prefix, value);
+
+            return DB::serialize(prefix, key, value);
+        }
+    } // namespace
+
+    void DatabaseMigration::MigrationWriteBatch::insert(std::pair<std::string, std::string> &&keyValue)
+    {
+        rawDataToInsert.push_back(std::move(keyValue));
+    }
+
+    void DatabaseMigration::MigrationWriteBatch::remove(std::string_view key)
+    {
+        rawKeysToRemove.emplace_back(key);
+    }
+
+    size_t DatabaseMigration::MigrationWriteBatch::size() const
+    {
+        return rawDataToInsert.size() + rawKeysToRemove.size();
+    }
+
+    std::vector<std::pair<std::string, std::string>> DatabaseMigration::MigrationWriteBatch::extractRawDataToInsert()
+    {
+        return std::move(rawDataToInsert);
+    }
+
+    std::vector<std::string> DatabaseMigration::MigrationWriteBatch::extractRawKeysToRemove()
+    {
+        return std::move(rawKeysToRemove);
+    }
+
+    DatabaseMigration::DatabaseMigration(IDataBase &database, std::shared_ptr<Logging::ILogger> logger):
+        database(database), logger(logger, "DatabaseMigration")
+    {
+    }
+
+    bool DatabaseMigration::canMigrate(uint32_t fromVersion)
+    {
+        return fromVersion >= 2;
+    }
+
+    void DatabaseMigration::migrate(uint32_t fromVersion)
+    {
+        if (!canMigrate(fromVersion))
+        {
+            throw std::runtime_error("Can't migrate DB scheme version " + std::to_string(fromVersion));
+        }
+
+        /* Scheme 2 drops its raw blocks along with everything else, and
+           writes straight into the column families */
+        if (fromVersion == 2)
+        {
+            convertFromKVBinary();
+        }
+        else if (fromVersion == 3)
+        {
+            removeRawBlocks();
+        }
+
+        /* 4 to 5 only split RocksDB into column families, which
+           RocksDBWrapper has already done */
+    }
+
+    void DatabaseMigration::convertFromKVBinary()
+    {
+        logger(Logging::INFO) << "Converting the DB to fixed width keys and values, this may take a while...";
+
+        uint64_t convertedCount = 0;
+
+        uint64_t skippedCount = 0;
+
+        using Amount = IBlockchainCache::Amount;
+
+        using GlobalOutputIndex = IBlockchainCache::GlobalOutputIndex;
+
+        const auto error = database.forEach(
+            KV_BINARY_KEY_PREFIX,
+            [&](std::string_view rawKey, std::string_view rawValue)
+            {
+                const std::optional<std::string> prefix = readKVBinaryPrefix(rawKey);
+
+                if (!prefix)
+                {
+                    skippedCount++;
+                    return;
+                }
+
+                std::optional<std::pair<std::string, std::string>> converted;
+
+                /* Where a prefix holds more than one type of key, the most
+                   common is tried first */
+                if (*prefix == DB::BLOCK_INDEX_TO_KEY_IMAGE_PREFIX)
+                {
+                    converted = convertKVBinary<uint32_t, std::vector<Crypto::KeyImage>>(rawKey, rawValue, *prefix);
+                }
+                else if (*prefix == DB::BLOCK_INDEX_TO_TX_HASHES_PREFIX)
+                {
+                    converted = convertKVBinary<uint32_t, std::vector<Crypto::Hash>>(rawKey, rawValue, *prefix);
+                }
+                else if (*prefix == DB::BLOCK_HASH_TO_BLOCK_INDEX_PREFIX)
+                {
+                    converted = convertKVBinary<Crypto::Hash, uint32_t>(rawKey, rawValue, *prefix);
+                }
+                else if (*prefix == DB::BLOCK_INDEX_TO_BLOCK_INFO_PREFIX)
+                {
+                    converted = convertKVBinary<uint32_t, CachedBlockInfo>(rawKey, rawValue, *prefix);
+                }
+                else if (*prefix == DB::KEY_IMAGE_TO_BLOCK_INDEX_PREFIX)
+                {
+                    converted = convertKVBinary<Crypto::KeyImage, uint32_t>(rawKey, rawValue, *prefix);
+                }
+                else if (*prefix == DB::BLOCK_INDEX_TO_BLOCK_HASH_PREFIX)
+                {
+                    converted = convertKVBinary<std::string, uint32_t>(rawKey, rawValue, *prefix);
+                }
+                else if (*prefix == DB::TRANSACTION_HASH_TO_TRANSACTION_INFO_PREFIX)
+                {
+                    converted = convertKVBinary<Crypto::Hash, ExtendedTransactionInfo>(rawKey, rawValue, *prefix);
+
+                    if (!converted)
+                    {
+                        converted = convertKVBinary<std::string, uint64_t>(rawKey, rawValue, *prefix);
+                    }
+                }
+                else if (*prefix == DB::KEY_OUTPUT_AMOUNT_PREFIX)
+                {
+                    converted =
+                        convertKVBinary<std::pair<Amount, uint32_t>, PackedOutIndex>(rawKey, rawValue, *prefix);
+
+                    if (!converted)
+                    {
+                        converted = convertKVBinary<Amount, uint32_t>(rawKey, rawValue, *prefix);
+                    }
+                }
+                else if (*prefix == DB::CLOSEST_TIMESTAMP_BLOCK_INDEX_PREFIX)
+                {
+                    converted = convertKVBinary<uint64_t, uint32_t>(rawKey, rawValue, *prefix);
+                }
+                else if (*prefix == DB::PAYMENT_ID_TO_TX_HASH_PREFIX)
+                {
+                    converted =
+                        convertKVBinary<std::pair<Crypto::Hash, uint32_t>, Crypto::Hash>(rawKey, rawValue, *prefix);
+
+                    if (!converted)
+                    {
+                        converted = convertKVBinary<Crypto::Hash, uint32_t>(rawKey, rawValue, *prefix);
+                    }
+                }
+                else if (*prefix == DB::TIMESTAMP_TO_BLOCKHASHES_PREFIX)
+                {
+                    converted = convertKVBinary<uint64_t, std::vector<Crypto::Hash>>(rawKey, rawValue, *prefix);
+                }
+                else if (*prefix == DB::KEY_OUTPUT_AMOUNTS_COUNT_PREFIX)
+                {
+                    converted = convertKVBinary<uint32_t, Amount>(rawKey, rawValue, *prefix);
+
+                    if (!converted)
+                    {
+                        converted = convertKVBinary<std::string, uint32_t>(rawKey, rawValue, *prefix);
+                    }
+                }
+                else if (*prefix == DB::KEY_OUTPUT_KEY_PREFIX)
+                {
+                    converted = convertKVBinary<std::pair<Amount, GlobalOutputIndex>, KeyOutputInfo>(
+                        rawKey, rawValue, *prefix);
+                }
+
+                /* Raw blocks are already in blocks.bin, so they're just
+                   removed */
+                if (!converted && *prefix != RAW_BLOCK_PREFIX)
+                {
+                    skippedCount++;
+                    return;
+                }
+
+                if (converted)
+                {
+                    batch.insert(std::move(*converted));
+                }
+
+                batch.remove(rawKey);
+
+                convertedCount++;
+
+                if (convertedCount % 1000000 == 0)
+                {
+                    logger(Logging::INFO) << "Converted " << convertedCount << " keys";
+                }
+
+                flush(false);
+            });
+
+        if (error)
+        {
+            throw std::system_error(error);
+        }
+
+        flush(true);
+
+        /* Left where they are, so a newer version which knows what they are
+           can still read them */
+        if (skippedCount != 0)
+        {
+            logger(Logging::WARNING) << "Left " << skippedCount << " DB keys we don't recognise";
+        }
+
+        logger(Logging::INFO) << "Converted " << convertedCount << " keys";
+    }
+
+    void DatabaseMigration::removeRawBlocks()
+    {
+        logger(Logging::INFO) << "Removing raw blocks from the DB, they are kept in blocks.bin...";
+
+        uint64_t removedCount = 0;
+
+        const auto error = database.forEach(
+            RAW_BLOCK_PREFIX,
+            [&](std::string_view rawKey, std::string_view)
+            {
+                batch.remove(rawKey);
+
+                removedCount++;
+
+                flush(false);
+            });
+
+        if (error)
+        {
+            throw std::system_error(error);
+        }
+
+        flush(true);
+
+        logger(Logging::INFO) << "Removed " << removedCount << " raw blocks";
+    }
+
+    void DatabaseMigration::flush(bool force)
+    {
+        if (batch.size() == 0 || (!force && batch.size() < MIGRATION_BATCH_SIZE))
+        {
+            return;
+        }
+
+        const auto error = database.write(batch);
+
+        if (error)
+        {
+            throw std::system_error(error);
+        }
+    }
+} // namespace CryptoNote
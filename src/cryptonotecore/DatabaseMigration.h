@@ -0,0 +1,76 @@
+// Copyright (c) 2012-2017, The CryptoNote developers, The Bytecoin developers
+// Copyright (c) 2018-2019, The TurtleCoin Developers
+//
+// Please see the included LICENSE file for more information.
+
+#pragma once
+
+#include "IDataBase.h"
+#include "IWriteBatch.h"
+
+#include <logging/LoggerRef.h>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace CryptoNote
+{
+    /* Brings a blockchain DB written with an older scheme up to the current
+       one in place, rather than throwing it away and importing every block
+       again. The state kept outside the DB, such as the block metadata index
+       and the spent key image filter, is rebuilt by DatabaseBlockchainCache
+       when it next opens the DB, as is any block summary which is missing. */
+    class DatabaseMigration
+    {
+      public:
+        DatabaseMigration(IDataBase &database, std::shared_ptr<Logging::ILogger> logger);
+
+        /* Scheme 2, KV binary keys and values, is the oldest we can read */
+        static bool canMigrate(uint32_t fromVersion);
+
+        /* Leaves writing the new scheme version to the caller. Each batch
+           written removes the old keys it replaces, so if we stop part way
+           through, running it again carries on from there. */
+        void migrate(uint32_t fromVersion);
+
+      private:
+        class MigrationWriteBatch : public IWriteBatch
+        {
+          public:
+            void insert(std::pair<std::string, std::string> &&keyValue);
+
+            void remove(std::string_view key);
+
+            size_t size() const;
+
+            std::vector<std::pair<std::string, std::string>> extractRawDataToInsert() override;
+
+            std::vector<std::string> extractRawKeysToRemove() override;
+
+          private:
+            std::vector<std::pair<std::string, std::string>> rawDataToInsert;
+
+            std::vector<std::string> rawKeysToRemove;
+        };
+
+        /* Scheme 2 to the fixed width keys and packed values, without raw
+           blocks */
+        void convertFromKVBinary();
+
+        /* Scheme 3 to 4. RocksDBWrapper has already moved the rest of a
+           scheme 3 DB into its column families when it opened it. */
+        void removeRawBlocks();
+
+        /* Writes the batch out once it's big enough, or whatever is left in
+           it if force is set */
+        void flush(bool force);
+
+        IDataBase &database;
+
+        Logging::LoggerRef logger;
+
+        MigrationWriteBatch batch;
+    };
+} // namespace CryptoNote
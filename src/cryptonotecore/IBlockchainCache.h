@@ -11,6 +11,7 @@
 #include "cryptonotecore/TransactionValidatiorState.h"
 
 #include <CryptoNote.h>
+#include <memory>
 #include <unordered_map>
 #include <vector>
 
@@ -50,6 +51,73 @@ namespace CryptoNote
         uint64_t blockDifficulty;
     };
 
+    /* What the block explorer shows for each transaction in a block */
+    struct TransactionSummary
+    {
+        /* Not stored, it is filled in from the block's transaction hashes */
+        Crypto::Hash transactionHash;
+
+        uint64_t amountOut;
+
+        uint64_t fee;
+
+        uint64_t size;
+
+        void serialize(ISerializer &s);
+    };
+
+    /* The values the block explorer shows for a block, worked out once when
+       the block is added, rather than every time it's asked for */
+    struct BlockSummary
+    {
+        Crypto::Hash blockHash;
+
+        Crypto::Hash previousBlockHash;
+
+        uint32_t blockIndex;
+
+        uint8_t majorVersion;
+
+        uint8_t minorVersion;
+
+        uint32_t nonce;
+
+        uint64_t timestamp;
+
+        uint64_t difficulty;
+
+        uint64_t alreadyGeneratedCoins;
+
+        uint64_t alreadyGeneratedTransactions;
+
+        /* The block and its transactions */
+        uint64_t blockSize;
+
+        /* The transactions, including the coinbase */
+        uint64_t transactionsCumulativeSize;
+
+        uint64_t sizeMedian;
+
+        /* The reward for a block of this height, not counting fees, before
+           and after the penalty for going over the median size */
+        uint64_t baseReward;
+
+        uint64_t penalizedReward;
+
+        /* The coinbase outputs */
+        uint64_t reward;
+
+        uint64_t totalFeeAmount;
+
+        /* Coinbase first */
+        std::vector<TransactionSummary> transactions;
+
+        /* Fraction of the base reward lost to the penalty */
+        double getPenalty() const;
+
+        void serialize(ISerializer &s);
+    };
+
     class UseGenesis
     {
       public:
@@ -175,6 +243,10 @@ namespace CryptoNote
 
         virtual Crypto::Hash getBlockHash(uint32_t blockIndex) const = 0;
 
+        /* Summaries of the blocks in [startIndex, endIndex), stopping at the
+           first block which doesn't have one */
+        virtual std::vector<BlockSummary> getBlockSummaries(uint32_t startIndex, uint32_t endIndex) const = 0;
+
         virtual std::vector<Crypto::Hash> getBlockHashes(uint32_t startIndex, size_t maxCount) const = 0;
 
         virtual IBlockchainCache *getParent() const = 0;
@@ -234,6 +306,13 @@ namespace CryptoNote
         virtual std::vector<uint32_t>
             getRandomOutsByAmount(uint64_t amount, size_t count, uint32_t blockIndex) const = 0;
 
+        /* Up to count random unlocked outputs for each amount, with their keys,
+           sorted by global index. The result is in the same order as amounts. */
+        virtual std::vector<std::vector<std::pair<GlobalOutputIndex, Crypto::PublicKey>>> getRandomOutsByAmounts(
+            const std::vector<Amount> &amounts,
+            size_t count,
+            uint32_t blockIndex) const = 0;
+
         virtual std::vector<Crypto::Hash> getTransactionHashesByPaymentId(const Crypto::Hash &paymentId) const = 0;
 
         virtual std::vector<Crypto::Hash>
@@ -17,6 +17,7 @@
 #include "MessageQueue.h"
 
 #include <CryptoNote.h>
+#include <functional>
 #include <optional>
 #include <unordered_map>
 #include <unordered_set>
@@ -61,6 +62,11 @@ namespace CryptoNote
             uint32_t &totalBlockCount,
             uint32_t &startBlockIndex) const = 0;
 
+        /* Checks the block ids a peer sent for its chain, the first at
+           startIndex, against the checkpoints. Returns false if one of them
+           contradicts a checkpoint. */
+        virtual bool verifyCheckpointChain(uint32_t startIndex, const std::vector<Crypto::Hash> &blockIds) = 0;
+
         virtual std::vector<RawBlock> getBlocks(uint32_t startIndex, uint32_t count) const = 0;
 
         virtual void getBlocks(
@@ -139,17 +145,29 @@ namespace CryptoNote
 
         virtual std::error_code addBlock(RawBlock &&rawBlock) = 0;
 
+        /* Adds a batch of blocks in order. The parts of each block which do not
+           depend on the chain state are prepared on the thread pool ahead of
+           the block being validated and committed. blockAdded is called with
+           the index and result of each block, and should return false to stop
+           adding the rest of the batch. */
+        virtual void addBlocks(
+            const std::vector<CachedBlock> &cachedBlocks,
+            std::vector<RawBlock> &&rawBlocks,
+            const std::function<bool(size_t, const std::error_code &)> &blockAdded) = 0;
+
         virtual std::error_code submitBlock(const BinaryArray &rawBlockTemplate) = 0;
 
         virtual bool getTransactionGlobalIndexes(
             const Crypto::Hash &transactionHash,
             std::vector<uint32_t> &globalIndexes) const = 0;
 
+        /* Fills globalIndexes and publicKeys with the outputs for each amount,
+           in the same order as amounts */
         virtual std::tuple<bool, std::string> getRandomOutputs(
-            uint64_t amount,
+            const std::vector<uint64_t> &amounts,
             uint16_t count,
-            std::vector<uint32_t> &globalIndexes,
-            std::vector<Crypto::PublicKey> &publicKeys) const = 0;
+            std::vector<std::vector<uint32_t>> &globalIndexes,
+            std::vector<std::vector<Crypto::PublicKey>> &publicKeys) const = 0;
 
         virtual bool getGlobalIndexesForRange(
             const uint64_t startHeight,
@@ -175,6 +193,18 @@ namespace CryptoNote
             std::vector<Transaction> &addedTransactions,
             std::vector<Crypto::Hash> &deletedTransactions) const = 0;
 
+        /* The pool transactions added and deleted since the pool was at the
+           given epoch and revision. False if that's from another epoch, or
+           too long ago, in which case every pool transaction is returned as
+           added. */
+        virtual bool getPoolChangesSince(
+            const uint64_t epoch,
+            const uint64_t revision,
+            std::vector<Crypto::Hash> &addedTransactions,
+            std::vector<Crypto::Hash> &deletedTransactions,
+            uint64_t &currentEpoch,
+            uint64_t &currentRevision) const = 0;
+
         virtual std::tuple<bool, std::string> getBlockTemplate(
             BlockTemplate &b,
             const Crypto::PublicKey &publicViewKey,
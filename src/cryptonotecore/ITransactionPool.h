@@ -7,6 +7,8 @@
 
 #include "CachedTransaction.h"
 
+#include <unordered_set>
+
 namespace CryptoNote
 {
     struct TransactionValidatorState;
@@ -18,6 +20,12 @@ namespace CryptoNote
 
         virtual bool pushTransaction(CachedTransaction &&tx, TransactionValidatorState &&transactionState) = 0;
 
+        /* For putting back transactions we received before a restart */
+        virtual bool pushTransaction(
+            CachedTransaction &&tx,
+            TransactionValidatorState &&transactionState,
+            const uint64_t receiveTime) = 0;
+
         virtual const CachedTransaction &getTransaction(const Crypto::Hash &hash) const = 0;
 
         virtual const std::optional<CachedTransaction> tryGetTransaction(const Crypto::Hash &hash) const = 0;
@@ -41,9 +49,41 @@ namespace CryptoNote
 
         virtual uint64_t getTransactionReceiveTime(const Crypto::Hash &hash) const = 0;
 
+        /* Every transaction in the pool, with the time it was received */
+        virtual std::vector<std::tuple<CachedTransaction, uint64_t>> getPoolTransactionsWithReceiveTime() const = 0;
+
         virtual std::vector<Crypto::Hash> getTransactionHashesByPaymentId(const Crypto::Hash &paymentId) const = 0;
 
+        /* The transactions which spend any of these key images */
+        virtual std::vector<Crypto::Hash>
+            getTransactionHashesByKeyImages(const std::unordered_set<Crypto::KeyImage> &keyImages) const = 0;
+
+        /* The transactions which are bigger than maxTransactionSize, or have a
+           mixin outside [minMixin, maxMixin] */
+        virtual std::vector<Crypto::Hash> getTransactionHashesOutsideLimits(
+            const uint64_t maxTransactionSize,
+            const uint64_t minMixin,
+            const uint64_t maxMixin) const = 0;
+
         virtual void flush() = 0;
+
+        /* Goes up by one every time a transaction is added or removed */
+        virtual uint64_t getRevision() const = 0;
+
+        /* Goes up by one every time a transaction is removed */
+        virtual uint64_t getRemovalRevision() const = 0;
+
+        /* The transactions added and removed since the pool was at this
+           epoch and revision. If the epoch isn't ours, or we don't remember
+           that far back, returns false, and every transaction in the pool as
+           added. */
+        virtual bool getChangesSince(
+            const uint64_t epoch,
+            const uint64_t revision,
+            std::vector<Crypto::Hash> &addedTransactions,
+            std::vector<Crypto::Hash> &deletedTransactions,
+            uint64_t &currentEpoch,
+            uint64_t &currentRevision) const = 0;
     };
 
 } // namespace CryptoNote
@@ -0,0 +1,433 @@
+// Copyright (c) 2018-2019, The TurtleCoin Developers
+//
+// Please see the included LICENSE file for more information.
+
+//////////////////////////////////////////
+#include <cryptonotecore/KeyImageFilter.h>
+//////////////////////////////////////////
+
+#include <algorithm>
+#include <common/FileSystemShim.h>
+#include <cstring>
+#include <fstream>
+#include <mutex>
+
+namespace CryptoNote
+{
+    namespace
+    {
+        const size_t SLOTS_PER_BUCKET = 4;
+
+        /* 16k buckets, 128KB */
+        const uint64_t INITIAL_BUCKET_COUNT = 1 << 14;
+
+        /* Past this, inserts start taking a lot of moves, and failing */
+        const double MAX_LOAD_FACTOR = 0.9;
+
+        const size_t MAX_MOVES = 500;
+
+        const uint32_t FILE_VERSION = 1;
+
+        /* Key images are curve points, so their bytes are already as good as
+           random. The first 8 pick the bucket, the next 2 are the fingerprint. */
+        uint64_t getBucketHash(const Crypto::KeyImage &keyImage)
+        {
+            uint64_t hash;
+            std::memcpy(&hash, keyImage.data, sizeof(hash));
+            return hash;
+        }
+
+        uint16_t getFingerprint(const Crypto::KeyImage &keyImage)
+        {
+            uint16_t fingerprint;
+            std::memcpy(&fingerprint, keyImage.data + sizeof(uint64_t), sizeof(fingerprint));
+
+            /* Zero marks an empty slot */
+            return fingerprint == 0 ? 1 : fingerprint;
+        }
+
+        /* The other bucket a fingerprint can go in. Works both ways. */
+        uint64_t getAlternateBucket(const uint64_t bucket, const uint16_t fingerprint, const uint64_t bucketMask)
+        {
+            return (bucket ^ (fingerprint * 0x5bd1e995ULL)) & bucketMask;
+        }
+
+        bool insertIntoBucket(std::vector<uint16_t> &slots, const uint64_t bucket, const uint16_t fingerprint)
+        {
+            for (size_t i = bucket * SLOTS_PER_BUCKET; i < (bucket + 1) * SLOTS_PER_BUCKET; i++)
+            {
+                if (slots[i] == 0)
+                {
+                    slots[i] = fingerprint;
+                    return true;
+                }
+            }
+
+            return false;
+        }
+
+        bool bucketContains(const std::vector<uint16_t> &slots, const uint64_t bucket, const uint16_t fingerprint)
+        {
+            const uint16_t *bucketSlots = slots.data() + bucket * SLOTS_PER_BUCKET;
+
+            return bucketSlots[0] == fingerprint || bucketSlots[1] == fingerprint || bucketSlots[2] == fingerprint
+                   || bucketSlots[3] == fingerprint;
+        }
+
+        template<typename T> void writeValue(std::ofstream &file, const T &value)
+        {
+            file.write(reinterpret_cast<const char *>(&value), sizeof(value));
+        }
+
+        template<typename T> bool readValue(std::ifstream &file, T &value)
+        {
+            return static_cast<bool>(file.read(reinterpret_cast<char *>(&value), sizeof(value)));
+        }
+    } // namespace
+
+    KeyImageFilter::KeyImageFilter()
+    {
+        clear();
+    }
+
+    KeyImageFilter::Table KeyImageFilter::makeTable(const uint32_t startBlockIndex, const uint64_t bucketCount)
+    {
+        Table table;
+
+        table.startBlockIndex = startBlockIndex;
+        table.bucketMask = bucketCount - 1;
+        table.count = 0;
+        table.slots.resize(bucketCount * SLOTS_PER_BUCKET, 0);
+
+        return table;
+    }
+
+    bool KeyImageFilter::insert(Table &table, const Crypto::KeyImage &keyImage)
+    {
+        uint16_t fingerprint = getFingerprint(keyImage);
+
+        uint64_t bucket = getBucketHash(keyImage) & table.bucketMask;
+
+        if (insertIntoBucket(table.slots, bucket, fingerprint)
+            || insertIntoBucket(table.slots, getAlternateBucket(bucket, fingerprint, table.bucketMask), fingerprint))
+        {
+            table.count++;
+            return true;
+        }
+
+        /* Both buckets are full. Swap our fingerprint with one already there,
+           and move that one to its other bucket, until something fits. */
+        std::vector<std::pair<uint64_t, size_t>> moves;
+
+        for (size_t move = 0; move < MAX_MOVES; move++)
+        {
+            const size_t slot = bucket * SLOTS_PER_BUCKET + (move + fingerprint) % SLOTS_PER_BUCKET;
+
+            std::swap(fingerprint, table.slots[slot]);
+
+            moves.emplace_back(bucket, slot);
+
+            bucket = getAlternateBucket(bucket, fingerprint, table.bucketMask);
+
+            if (insertIntoBucket(table.slots, bucket, fingerprint))
+            {
+                table.count++;
+                return true;
+            }
+        }
+
+        /* Put everything back, so nothing already in the table is lost */
+        for (auto it = moves.rbegin(); it != moves.rend(); ++it)
+        {
+            std::swap(fingerprint, table.slots[it->second]);
+        }
+
+        return false;
+    }
+
+    bool KeyImageFilter::erase(Table &table, const Crypto::KeyImage &keyImage)
+    {
+        const uint16_t fingerprint = getFingerprint(keyImage);
+
+        const uint64_t bucket = getBucketHash(keyImage) & table.bucketMask;
+
+        for (const uint64_t b : {bucket, getAlternateBucket(bucket, fingerprint, table.bucketMask)})
+        {
+            for (size_t i = b * SLOTS_PER_BUCKET; i < (b + 1) * SLOTS_PER_BUCKET; i++)
+            {
+                if (table.slots[i] == fingerprint)
+                {
+                    table.slots[i] = 0;
+                    table.count--;
+                    return true;
+                }
+            }
+        }
+
+        return false;
+    }
+
+    bool KeyImageFilter::contains(const Table &table, const Crypto::KeyImage &keyImage)
+    {
+        const uint16_t fingerprint = getFingerprint(keyImage);
+
+        const uint64_t bucket = getBucketHash(keyImage) & table.bucketMask;
+
+        return bucketContains(table.slots, bucket, fingerprint)
+               || bucketContains(table.slots, getAlternateBucket(bucket, fingerprint, table.bucketMask), fingerprint);
+    }
+
+    KeyImageFilter::Table &KeyImageFilter::getTable(const uint32_t blockIndex)
+    {
+        for (auto it = m_tables.rbegin(); it != m_tables.rend(); ++it)
+        {
+            if (it->startBlockIndex <= blockIndex)
+            {
+                return *it;
+            }
+        }
+
+        return m_tables.front();
+    }
+
+    void KeyImageFilter::add(const uint32_t blockIndex, const Crypto::KeyImage &keyImage)
+    {
+        std::unique_lock<std::shared_mutex> lock(m_mutex);
+
+        const Table &top = m_tables.back();
+
+        /* Only start a table on the first key image of a block, so all of a
+           block's key images are in the same table, and we know which one to
+           remove them from */
+        const bool newBlock = !m_lastAddedBlockIndex || blockIndex != *m_lastAddedBlockIndex;
+
+        m_lastAddedBlockIndex = blockIndex;
+
+        if (newBlock && top.count >= top.slots.size() * MAX_LOAD_FACTOR && blockIndex > top.startBlockIndex)
+        {
+            const uint64_t bucketCount = (top.bucketMask + 1) * 2;
+
+            m_tables.push_back(makeTable(blockIndex, bucketCount));
+        }
+
+        if (!insert(m_tables.back(), keyImage))
+        {
+            m_overflow.insert(keyImage);
+        }
+    }
+
+    void KeyImageFilter::remove(const uint32_t blockIndex, const Crypto::KeyImage &keyImage)
+    {
+        std::unique_lock<std::shared_mutex> lock(m_mutex);
+
+        if (m_overflow.erase(keyImage) == 0)
+        {
+            erase(getTable(blockIndex), keyImage);
+        }
+    }
+
+    void KeyImageFilter::truncate(const uint32_t blockCount)
+    {
+        std::unique_lock<std::shared_mutex> lock(m_mutex);
+
+        while (m_tables.size() > 1 && m_tables.back().startBlockIndex >= blockCount)
+        {
+            m_tables.pop_back();
+        }
+    }
+
+    void KeyImageFilter::clear()
+    {
+        std::unique_lock<std::shared_mutex> lock(m_mutex);
+
+        m_tables.clear();
+        m_tables.push_back(makeTable(0, INITIAL_BUCKET_COUNT));
+
+        m_overflow.clear();
+
+        m_lastAddedBlockIndex.reset();
+    }
+
+    bool KeyImageFilter::mayContain(const Crypto::KeyImage &keyImage) const
+    {
+        std::shared_lock<std::shared_mutex> lock(m_mutex);
+
+        for (const auto &table : m_tables)
+        {
+            if (contains(table, keyImage))
+            {
+                return true;
+            }
+        }
+
+        return !m_overflow.empty() && m_overflow.find(keyImage) != m_overflow.end();
+    }
+
+    uint64_t KeyImageFilter::size() const
+    {
+        std::shared_lock<std::shared_mutex> lock(m_mutex);
+
+        uint64_t count = m_overflow.size();
+
+        for (const auto &table : m_tables)
+        {
+            count += table.count;
+        }
+
+        return count;
+    }
+
+    uint64_t KeyImageFilter::memoryUsage() const
+    {
+        std::shared_lock<std::shared_mutex> lock(m_mutex);
+
+        /* Each set node holds the key image, and a couple of pointers */
+        uint64_t bytes = m_overflow.size() * (sizeof(Crypto::KeyImage) + 2 * sizeof(void *));
+
+        for (const auto &table : m_tables)
+        {
+            bytes += table.slots.size() * sizeof(uint16_t);
+        }
+
+        return bytes;
+    }
+
+    double KeyImageFilter::falsePositiveRate() const
+    {
+        std::shared_lock<std::shared_mutex> lock(m_mutex);
+
+        double rate = 0;
+
+        /* A lookup compares against both buckets of every table, and each
+           filled slot matches one in 65535 */
+        for (const auto &table : m_tables)
+        {
+            const double loadFactor = static_cast<double>(table.count) / table.slots.size();
+
+            rate += 2 * SLOTS_PER_BUCKET * loadFactor / 65535;
+        }
+
+        return std::min(rate, 1.0);
+    }
+
+    bool KeyImageFilter::save(
+        const std::string &filename,
+        const uint32_t blockCount,
+        const Crypto::Hash &topBlockHash) const
+    {
+        std::shared_lock<std::shared_mutex> lock(m_mutex);
+
+        const std::string tempFilename = filename + ".tmp";
+
+        {
+            std::ofstream file(tempFilename, std::ios::binary | std::ios::trunc);
+
+            writeValue(file, FILE_VERSION);
+            writeValue(file, blockCount);
+            writeValue(file, topBlockHash);
+            writeValue(file, static_cast<uint64_t>(m_tables.size()));
+
+            for (const auto &table : m_tables)
+            {
+                writeValue(file, table.startBlockIndex);
+                writeValue(file, table.bucketMask);
+                writeValue(file, table.count);
+
+                file.write(
+                    reinterpret_cast<const char *>(table.slots.data()), table.slots.size() * sizeof(uint16_t));
+            }
+
+            writeValue(file, static_cast<uint64_t>(m_overflow.size()));
+
+            for (const auto &keyImage : m_overflow)
+            {
+                writeValue(file, keyImage);
+            }
+
+            if (!file.flush())
+            {
+                return false;
+            }
+        }
+
+        /* So a half written file is never mistaken for a good one */
+        std::error_code ec;
+
+        fs::rename(tempFilename, filename, ec);
+
+        return !ec;
+    }
+
+    bool KeyImageFilter::load(const std::string &filename, const uint32_t blockCount, const Crypto::Hash &topBlockHash)
+    {
+        std::ifstream file(filename, std::ios::binary);
+
+        uint32_t version;
+        uint32_t fileBlockCount;
+        Crypto::Hash fileTopBlockHash;
+        uint64_t tableCount;
+
+        if (!readValue(file, version) || version != FILE_VERSION || !readValue(file, fileBlockCount)
+            || fileBlockCount != blockCount || !readValue(file, fileTopBlockHash) || fileTopBlockHash != topBlockHash
+            || !readValue(file, tableCount) || tableCount == 0)
+        {
+            return false;
+        }
+
+        std::vector<Table> tables(tableCount);
+
+        for (auto &table : tables)
+        {
+            if (!readValue(file, table.startBlockIndex) || !readValue(file, table.bucketMask)
+                || !readValue(file, table.count))
+            {
+                return false;
+            }
+
+            const uint64_t bucketCount = table.bucketMask + 1;
+
+            /* Not a power of two, or bigger than we'd ever make */
+            if ((bucketCount & table.bucketMask) != 0 || bucketCount > (1ULL << 40))
+            {
+                return false;
+            }
+
+            table.slots.resize(bucketCount * SLOTS_PER_BUCKET);
+
+            if (!file.read(reinterpret_cast<char *>(table.slots.data()), table.slots.size() * sizeof(uint16_t)))
+            {
+                return false;
+            }
+        }
+
+        uint64_t overflowCount;
+
+        if (!readValue(file, overflowCount))
+        {
+            return false;
+        }
+
+        std::unordered_set<Crypto::KeyImage> overflow;
+
+        for (uint64_t i = 0; i < overflowCount; i++)
+        {
+            Crypto::KeyImage keyImage;
+
+            if (!readValue(file, keyImage))
+            {
+                return false;
+            }
+
+            overflow.insert(keyImage);
+        }
+
+        std::unique_lock<std::shared_mutex> lock(m_mutex);
+
+        m_tables = std::move(tables);
+        m_overflow = std::move(overflow);
+
+        m_lastAddedBlockIndex.reset();
+
+        return true;
+    }
+} // namespace CryptoNote
@@ -0,0 +1,120 @@
+// Copyright (c) 2018-2019, The TurtleCoin Developers
+//
+// Please see the included LICENSE file for more information.
+
+#pragma once
+
+#include <CryptoTypes.h>
+#include <optional>
+#include <shared_mutex>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+namespace CryptoNote
+{
+    /* A cuckoo filter of every spent key image, so checking that a key image
+       hasn't been spent - which is nearly always the answer - doesn't have to
+       read the database.
+
+       It never says a spent key image is unspent. It says an unspent key image
+       might be spent about falsePositiveRate() of the time, and then the
+       database has to be asked.
+
+       When a table fills up, a new one twice the size is started at the next
+       block, and lookups check every table. Each table knows the height it
+       was started at, so a key image is always removed from the table it was
+       added to, and removing it can't take out another key image with the
+       same fingerprint. The odd key image which can't be fitted into a table
+       goes in an exact set instead. */
+    class KeyImageFilter
+    {
+      public:
+        /////////////////
+        /* CONSTRUCTOR */
+        /////////////////
+
+        KeyImageFilter();
+
+        /////////////////////////////
+        /* PUBLIC MEMBER FUNCTIONS */
+        /////////////////////////////
+
+        /* Key images have to be added in height order */
+        void add(const uint32_t blockIndex, const Crypto::KeyImage &keyImage);
+
+        /* The key image must have been added at this height */
+        void remove(const uint32_t blockIndex, const Crypto::KeyImage &keyImage);
+
+        /* Drops the tables started at or above this height. Call it once
+           every key image at or above it has been removed. */
+        void truncate(const uint32_t blockCount);
+
+        void clear();
+
+        /* False if the key image definitely hasn't been spent */
+        bool mayContain(const Crypto::KeyImage &keyImage) const;
+
+        /* Number of key images in the filter */
+        uint64_t size() const;
+
+        /* Roughly how many bytes the filter takes up */
+        uint64_t memoryUsage() const;
+
+        /* The expected chance an unspent key image is reported as maybe spent */
+        double falsePositiveRate() const;
+
+        /* Writes the filter to disk, along with the block it's up to date with */
+        bool save(const std::string &filename, const uint32_t blockCount, const Crypto::Hash &topBlockHash) const;
+
+        /* Reads the filter from disk. Fails if it isn't up to date with the
+           given block. */
+        bool load(const std::string &filename, const uint32_t blockCount, const Crypto::Hash &topBlockHash);
+
+      private:
+        struct Table
+        {
+            /* The height of the first block added to this table */
+            uint32_t startBlockIndex;
+
+            uint64_t bucketMask;
+
+            uint64_t count;
+
+            /* SLOTS_PER_BUCKET fingerprints per bucket, zero is empty */
+            std::vector<uint16_t> slots;
+        };
+
+        //////////////////////////////
+        /* PRIVATE MEMBER FUNCTIONS */
+        //////////////////////////////
+
+        static Table makeTable(const uint32_t startBlockIndex, const uint64_t bucketCount);
+
+        static bool insert(Table &table, const Crypto::KeyImage &keyImage);
+
+        static bool erase(Table &table, const Crypto::KeyImage &keyImage);
+
+        static bool contains(const Table &table, const Crypto::KeyImage &keyImage);
+
+        /* The table a key image added at this height went in */
+        Table &getTable(const uint32_t blockIndex);
+
+        /////////////////////////
+        /* PRIVATE MEMBER VARS */
+        /////////////////////////
+
+        /* Oldest first */
+        std::vector<Table> m_tables;
+
+        /* Key images there was no room for in their table */
+        std::unordered_set<Crypto::KeyImage> m_overflow;
+
+        /* The block the last key image was added for, so a new table is
+           never started part way through a block */
+        std::optional<uint32_t> m_lastAddedBlockIndex;
+
+        /* Blocks are pushed and popped while transactions are validated */
+        mutable std::shared_mutex m_mutex;
+    };
+} // namespace CryptoNote
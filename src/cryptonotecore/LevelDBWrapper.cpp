@@ -212,8 +212,9 @@ std::error_code LevelDBWrapper::read(IReadBatch &batch)
     keySlices.reserve(rawKeys.size());
 
     std::vector<std::string> values;
-    std::error_code error;
     std::vector<bool> resultStates;
+    values.reserve(rawKeys.size());
+    resultStates.reserve(rawKeys.size());
 
     for (const std::string &key : rawKeys)
     {
@@ -223,13 +224,13 @@ std::error_code LevelDBWrapper::read(IReadBatch &batch)
         {
             return make_error_code(CryptoNote::error::DataBaseErrorCodes::INTERNAL_ERROR);
         }
-        values.push_back(tmp_value);
+        values.push_back(std::move(tmp_value));
         resultStates.push_back(s.ok());
     }
 
-    values.reserve(rawKeys.size());
+    const std::vector<std::string_view> valueViews(values.begin(), values.end());
 
-    batch.submitRawResult(values, resultStates);
+    batch.submitRawResult(valueViews, resultStates);
     return std::error_code();
 }
 
@@ -239,6 +240,33 @@ std::error_code LevelDBWrapper::readThreadSafe(IReadBatch &batch)
     return read(batch);
 }
 
+std::error_code LevelDBWrapper::forEach(
+    const std::string &keyPrefix,
+    const std::function<void(std::string_view key, std::string_view value)> &callback)
+{
+    if (state.load() != INITIALIZED)
+    {
+        throw std::runtime_error("Not initialized.");
+    }
+
+    std::unique_ptr<leveldb::Iterator> it(db->NewIterator(leveldb::ReadOptions()));
+
+    for (it->Seek(keyPrefix); it->Valid() && it->key().starts_with(keyPrefix); it->Next())
+    {
+        callback(
+            std::string_view(it->key().data(), it->key().size()),
+            std::string_view(it->value().data(), it->value().size()));
+    }
+
+    if (!it->status().ok())
+    {
+        logger(ERROR) << "Can't read from DB. " << it->status().ToString();
+        return make_error_code(CryptoNote::error::DataBaseErrorCodes::INTERNAL_ERROR);
+    }
+
+    return std::error_code();
+}
+
 std::string LevelDBWrapper::getDataDir(const DataBaseConfig &config)
 {
     return config.dataDir + '/' + DB_NAME;
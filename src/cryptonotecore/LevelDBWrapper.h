@@ -42,6 +42,10 @@ namespace CryptoNote
 
         std::error_code readThreadSafe(IReadBatch &batch) override;
 
+        std::error_code forEach(
+            const std::string &keyPrefix,
+            const std::function<void(std::string_view key, std::string_view value)> &callback) override;
+
       private:
         std::error_code write(IWriteBatch &batch, bool sync);
 
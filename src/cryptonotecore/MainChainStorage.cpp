@@ -14,12 +14,15 @@ namespace CryptoNote
 {
     const size_t STORAGE_CACHE_SIZE = 100;
 
-    MainChainStorage::MainChainStorage(const std::string &blocksFilename, const std::string &indexesFilename)
+    MainChainStorage::MainChainStorage(const std::string &blocksFilename, const std::string &indexesFilename):
+        m_blocksFilename(blocksFilename)
     {
         if (!storage.open(blocksFilename, indexesFilename, STORAGE_CACHE_SIZE))
         {
             throw std::runtime_error("Failed to load main chain storage: " + blocksFilename);
         }
+
+        dropReaders();
     }
 
     MainChainStorage::~MainChainStorage()
@@ -29,24 +32,36 @@ namespace CryptoNote
 
     void MainChainStorage::pushBlock(const RawBlock &rawBlock)
     {
+        std::unique_lock lock(m_mutex);
+
         storage.push_back(rawBlock);
     }
 
     void MainChainStorage::popBlock()
     {
+        std::unique_lock lock(m_mutex);
+
         storage.pop_back();
+
+        dropReaders();
     }
 
     void MainChainStorage::rewindTo(const uint32_t index) const
     {
-        while (getBlockCount() >= index)
+        std::unique_lock lock(m_mutex);
+
+        while (storage.size() >= index)
         {
             storage.pop_back();
         }
+
+        dropReaders();
     }
 
     RawBlock MainChainStorage::getBlockByIndex(uint32_t index) const
     {
+        std::shared_lock lock(m_mutex);
+
         if (index >= storage.size())
         {
             throw std::out_of_range(
@@ -54,9 +69,15 @@ namespace CryptoNote
                 + " is out of range. Blocks count: " + std::to_string(storage.size()));
         }
 
+        auto reader = takeReader();
+
         try
         {
-            return storage[index];
+            auto block = storage.read(index, *reader);
+
+            returnReader(std::move(reader));
+
+            return block;
         }
         catch (std::exception &)
         {
@@ -76,14 +97,57 @@ namespace CryptoNote
         }
     }
 
+    std::unique_ptr<std::ifstream> MainChainStorage::takeReader() const
+    {
+        {
+            std::scoped_lock lock(m_readersMutex);
+
+            if (!m_readers.empty())
+            {
+                auto reader = std::move(m_readers.back());
+                m_readers.pop_back();
+                return reader;
+            }
+        }
+
+        auto reader = std::make_unique<std::ifstream>(m_blocksFilename, std::ios::binary);
+
+        if (!*reader)
+        {
+            throw std::runtime_error("Failed to open main chain storage: " + m_blocksFilename);
+        }
+
+        return reader;
+    }
+
+    void MainChainStorage::returnReader(std::unique_ptr<std::ifstream> reader) const
+    {
+        std::scoped_lock lock(m_readersMutex);
+
+        m_readers.push_back(std::move(reader));
+    }
+
+    void MainChainStorage::dropReaders() const
+    {
+        std::scoped_lock lock(m_readersMutex);
+
+        m_readers.clear();
+    }
+
     uint32_t MainChainStorage::getBlockCount() const
     {
+        std::shared_lock lock(m_mutex);
+
         return static_cast<uint32_t>(storage.size());
     }
 
     void MainChainStorage::clear()
     {
+        std::unique_lock lock(m_mutex);
+
         storage.clear();
+
+        dropReaders();
     }
 
     std::unique_ptr<IMainChainStorage>
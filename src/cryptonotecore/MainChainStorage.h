@@ -9,6 +9,12 @@
 #include "IMainChainStorage.h"
 #include "SwappedVector.h"
 
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <vector>
+
 namespace CryptoNote
 {
     class MainChainStorage : public IMainChainStorage
@@ -31,7 +37,32 @@ namespace CryptoNote
         virtual void clear() override;
 
       private:
+        /* Takes a handle on the blocks file from m_readers, or opens one */
+        std::unique_ptr<std::ifstream> takeReader() const;
+
+        void returnReader(std::unique_ptr<std::ifstream> reader) const;
+
+        /* Closes the pooled handles. Called with m_mutex held exclusively
+           whenever the blocks file is opened, cleared or cut short, so a
+           later read can't be served from a handle's buffer of the old
+           contents. */
+        void dropReaders() const;
+
         mutable SwappedVector<RawBlock> storage;
+
+        const std::string m_blocksFilename;
+
+        /* The blockchain cache reads blocks from here for RPC and P2P threads,
+           while the core is adding them. Readers share the lock, and each
+           reads through its own file handle, since the SwappedVector's file
+           and cache can't be used from several threads at once. Adding and
+           removing blocks takes it exclusively. */
+        mutable std::shared_mutex m_mutex;
+
+        /* File handles not currently being used by a reader */
+        mutable std::vector<std::unique_ptr<std::ifstream>> m_readers;
+
+        mutable std::mutex m_readersMutex;
     };
 
     std::unique_ptr<IMainChainStorage>
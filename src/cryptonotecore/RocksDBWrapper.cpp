@@ -5,19 +5,63 @@
 
 #include "RocksDBWrapper.h"
 
+#include "DBUtils.h"
 #include "DataBaseErrors.h"
 #include "rocksdb/cache.h"
 #include "rocksdb/db.h"
+#include "rocksdb/filter_policy.h"
 #include "rocksdb/table.h"
 #include "rocksdb/utilities/backupable_db.h"
 
+#include <algorithm>
+
 using namespace CryptoNote;
 using namespace Logging;
 
 namespace
 {
     const std::string DB_NAME = "DB";
-}
+
+    struct ColumnFamily
+    {
+        std::string name;
+
+        /* The key prefixes from DBUtils.h stored in this family */
+        std::string prefixes;
+
+        /* For keys we look up by hash or key image, where most lookups are
+           for keys which aren't there. Without a filter, each of those reads
+           an index block and a data block from every level. */
+        bool bloomFilter;
+    };
+
+    /* DB scheme versions, see DatabaseBlockchainCache.cpp. 3 still has raw
+       blocks in it, so stays at 3 until DatabaseMigration has removed them. */
+    const std::vector<std::string> SCHEMES_WITHOUT_COLUMN_FAMILIES = {"3", "4"};
+
+    const std::string LAST_SCHEME_WITHOUT_COLUMN_FAMILIES = "4";
+
+    const std::string FIRST_SCHEME_WITH_COLUMN_FAMILIES = "5";
+
+    /* Anything else, like the scheme version, is in the default family */
+    const std::vector<ColumnFamily> COLUMN_FAMILIES = {
+        /* Looked up by height, and nearly always there */
+        {"blocks",
+         DB::BLOCK_INDEX_TO_KEY_IMAGE_PREFIX + DB::BLOCK_INDEX_TO_TX_HASHES_PREFIX
+             + DB::BLOCK_INDEX_TO_TRANSACTION_INFO_PREFIX + DB::BLOCK_INDEX_TO_BLOCK_INFO_PREFIX
+             + DB::BLOCK_INDEX_TO_BLOCK_HASH_PREFIX + DB::CLOSEST_TIMESTAMP_BLOCK_INDEX_PREFIX
+             + DB::TIMESTAMP_TO_BLOCKHASHES_PREFIX + DB::BLOCK_INDEX_TO_BLOCK_SUMMARY_PREFIX,
+         false},
+        {"block_hashes", DB::BLOCK_HASH_TO_BLOCK_INDEX_PREFIX, true},
+        {"key_images", DB::KEY_IMAGE_TO_BLOCK_INDEX_PREFIX, true},
+        {"transactions", DB::TRANSACTION_HASH_TO_TRANSACTION_INFO_PREFIX, true},
+        {"payment_ids", DB::PAYMENT_ID_TO_TX_HASH_PREFIX, true},
+        /* Looked up by amount and global index, and nearly always there */
+        {"key_outputs",
+         DB::KEY_OUTPUT_AMOUNT_PREFIX + DB::KEY_OUTPUT_AMOUNTS_COUNT_PREFIX + DB::KEY_OUTPUT_KEY_PREFIX,
+         false},
+    };
+} // namespace
 
 RocksDBWrapper::RocksDBWrapper(std::shared_ptr<Logging::ILogger> logger):
     logger(logger, "RocksDBWrapper"), state(NOT_INITIALIZED)
@@ -39,8 +83,24 @@ void RocksDBWrapper::init(const DataBaseConfig &config)
 
     rocksdb::DB *dbPtr;
 
+    blockCache = rocksdb::NewLRUCache(config.readCacheSize);
+
     rocksdb::Options dbOptions = getDBOptions(config);
-    rocksdb::Status status = rocksdb::DB::Open(dbOptions, dataDir, &dbPtr);
+
+    /* A DB from before we used column families only has the default one */
+    dbOptions.create_missing_column_families = true;
+
+    std::vector<rocksdb::ColumnFamilyDescriptor> descriptors {
+        {rocksdb::kDefaultColumnFamilyName, rocksdb::ColumnFamilyOptions(dbOptions)}};
+
+    for (const auto &family : COLUMN_FAMILIES)
+    {
+        descriptors.emplace_back(family.name, getColumnFamilyOptions(config, family.bloomFilter));
+    }
+
+    columnFamilies.clear();
+
+    rocksdb::Status status = rocksdb::DB::Open(dbOptions, dataDir, descriptors, &columnFamilies, &dbPtr);
     if (status.ok())
     {
         logger(INFO) << "DB opened in " << dataDir;
@@ -49,7 +109,7 @@ void RocksDBWrapper::init(const DataBaseConfig &config)
     {
         logger(INFO) << "DB not found in " << dataDir << ". Creating new DB...";
         dbOptions.create_if_missing = true;
-        rocksdb::Status status = rocksdb::DB::Open(dbOptions, dataDir, &dbPtr);
+        rocksdb::Status status = rocksdb::DB::Open(dbOptions, dataDir, descriptors, &columnFamilies, &dbPtr);
         if (!status.ok())
         {
             logger(ERROR) << "DB Error. DB can't be created in " << dataDir << ". Error: " << status.ToString();
@@ -68,9 +128,115 @@ void RocksDBWrapper::init(const DataBaseConfig &config)
     }
 
     db.reset(dbPtr);
+
+    columnFamilyByPrefix.fill(columnFamilies[0]);
+
+    for (size_t i = 0; i < COLUMN_FAMILIES.size(); i++)
+    {
+        for (const char prefix : COLUMN_FAMILIES[i].prefixes)
+        {
+            columnFamilyByPrefix[static_cast<uint8_t>(prefix)] = columnFamilies[i + 1];
+        }
+    }
+
+    /* Only schemes from before the split need moving. It's checked here
+       rather than by the blockchain cache, since which family a key lives in
+       is nothing to do with it. Scheme 2 keys aren't moved, they're rewritten
+       by DatabaseMigration, and land in the right family then. */
+    std::string schemeVersion;
+
+    if (db->Get(rocksdb::ReadOptions(), columnFamilies[0], DB::DB_SCHEME_VERSION_KEY, &schemeVersion).ok()
+        && std::find(
+               SCHEMES_WITHOUT_COLUMN_FAMILIES.begin(), SCHEMES_WITHOUT_COLUMN_FAMILIES.end(), schemeVersion)
+               != SCHEMES_WITHOUT_COLUMN_FAMILIES.end())
+    {
+        moveToColumnFamilies(schemeVersion);
+    }
+
     state.store(INITIALIZED);
 }
 
+void RocksDBWrapper::moveToColumnFamilies(const std::string &schemeVersion)
+{
+    logger(INFO) << "Moving the DB into column families, this may take a while...";
+
+    std::unique_ptr<rocksdb::Iterator> it(db->NewIterator(rocksdb::ReadOptions(), columnFamilies[0]));
+
+    rocksdb::WriteBatch batch;
+
+    uint64_t movedCount = 0;
+
+    for (it->SeekToFirst(); it->Valid(); it->Next())
+    {
+        rocksdb::ColumnFamilyHandle *family = getColumnFamily(it->key().ToString());
+
+        if (family == columnFamilies[0])
+        {
+            continue;
+        }
+
+        /* Both in one batch, so stopping halfway leaves each key in exactly
+           one place, and we carry on from there next time */
+        batch.Put(family, it->key(), it->value());
+        batch.Delete(columnFamilies[0], it->key());
+
+        movedCount++;
+
+        if (batch.Count() >= 100000)
+        {
+            rocksdb::Status status = db->Write(rocksdb::WriteOptions(), &batch);
+
+            if (!status.ok())
+            {
+                logger(ERROR) << "DB Error. Can't move keys into column families. Error: " << status.ToString();
+                throw std::system_error(make_error_code(CryptoNote::error::DataBaseErrorCodes::INTERNAL_ERROR));
+            }
+
+            batch.Clear();
+        }
+    }
+
+    if (!it->status().ok())
+    {
+        logger(ERROR) << "DB Error. Can't read keys to move into column families. Error: "
+                      << it->status().ToString();
+        throw std::system_error(make_error_code(CryptoNote::error::DataBaseErrorCodes::INTERNAL_ERROR));
+    }
+
+    /* With the last of the keys, so we only scan again if we stopped before
+       getting here */
+    if (schemeVersion == LAST_SCHEME_WITHOUT_COLUMN_FAMILIES)
+    {
+        batch.Put(columnFamilies[0], DB::DB_SCHEME_VERSION_KEY, FIRST_SCHEME_WITH_COLUMN_FAMILIES);
+    }
+
+    rocksdb::Status status = db->Write(rocksdb::WriteOptions(), &batch);
+
+    if (!status.ok())
+    {
+        logger(ERROR) << "DB Error. Can't move keys into column families. Error: " << status.ToString();
+        throw std::system_error(make_error_code(CryptoNote::error::DataBaseErrorCodes::INTERNAL_ERROR));
+    }
+
+    it.reset();
+
+    /* Otherwise the deleted keys hang around until they happen to be
+       compacted */
+    db->CompactRange(rocksdb::CompactRangeOptions(), columnFamilies[0], nullptr, nullptr);
+
+    logger(INFO) << "Moved " << movedCount << " keys into column families";
+}
+
+rocksdb::ColumnFamilyHandle *RocksDBWrapper::getColumnFamily(const std::string &key) const
+{
+    if (key.empty())
+    {
+        return columnFamilies[0];
+    }
+
+    return columnFamilyByPrefix[static_cast<uint8_t>(key[0])];
+}
+
 void RocksDBWrapper::shutdown()
 {
     if (state.load() != INITIALIZED)
@@ -79,8 +245,15 @@ void RocksDBWrapper::shutdown()
     }
 
     logger(INFO) << "Closing DB.";
-    db->Flush(rocksdb::FlushOptions());
+    db->Flush(rocksdb::FlushOptions(), columnFamilies);
     db->SyncWAL();
+
+    for (rocksdb::ColumnFamilyHandle *family : columnFamilies)
+    {
+        db->DestroyColumnFamilyHandle(family);
+    }
+
+    columnFamilies.clear();
     db.reset();
     state.store(NOT_INITIALIZED);
 }
@@ -129,13 +302,13 @@ std::error_code RocksDBWrapper::write(IWriteBatch &batch, bool sync)
     std::vector<std::pair<std::string, std::string>> rawData(batch.extractRawDataToInsert());
     for (const std::pair<std::string, std::string> &kvPair : rawData)
     {
-        rocksdbBatch.Put(rocksdb::Slice(kvPair.first), rocksdb::Slice(kvPair.second));
+        rocksdbBatch.Put(getColumnFamily(kvPair.first), rocksdb::Slice(kvPair.first), rocksdb::Slice(kvPair.second));
     }
 
     std::vector<std::string> rawKeys(batch.extractRawKeysToRemove());
     for (const std::string &key : rawKeys)
     {
-        rocksdbBatch.Delete(rocksdb::Slice(key));
+        rocksdbBatch.Delete(getColumnFamily(key), rocksdb::Slice(key));
     }
 
     rocksdb::Status status = db->Write(writeOptions, &rocksdbBatch);
@@ -162,28 +335,40 @@ std::error_code RocksDBWrapper::read(IReadBatch &batch)
 
     std::vector<std::string> rawKeys(batch.getRawKeys());
     std::vector<rocksdb::Slice> keySlices;
+    std::vector<rocksdb::ColumnFamilyHandle *> keyFamilies;
     keySlices.reserve(rawKeys.size());
+    keyFamilies.reserve(rawKeys.size());
     for (const std::string &key : rawKeys)
     {
         keySlices.emplace_back(rocksdb::Slice(key));
+        keyFamilies.push_back(getColumnFamily(key));
     }
 
-    std::vector<std::string> values;
-    values.reserve(rawKeys.size());
-    std::vector<rocksdb::Status> statuses = db->MultiGet(readOptions, keySlices, &values);
+    /* Pinned values point straight into the block cache, so nothing is
+       copied until the batch deserializes them */
+    std::vector<rocksdb::PinnableSlice> values(rawKeys.size());
+    std::vector<rocksdb::Status> statuses(rawKeys.size());
+
+    db->MultiGet(
+        readOptions, rawKeys.size(), keyFamilies.data(), keySlices.data(), values.data(), statuses.data(), false);
 
-    std::error_code error;
+    std::vector<std::string_view> valueViews;
     std::vector<bool> resultStates;
-    for (const rocksdb::Status &status : statuses)
+    valueViews.reserve(rawKeys.size());
+    resultStates.reserve(rawKeys.size());
+
+    for (size_t i = 0; i < rawKeys.size(); i++)
     {
-        if (!status.ok() && !status.IsNotFound())
+        if (!statuses[i].ok() && !statuses[i].IsNotFound())
         {
             return make_error_code(CryptoNote::error::DataBaseErrorCodes::INTERNAL_ERROR);
         }
-        resultStates.push_back(status.ok());
+
+        valueViews.emplace_back(values[i].data(), values[i].size());
+        resultStates.push_back(statuses[i].ok());
     }
 
-    batch.submitRawResult(values, resultStates);
+    batch.submitRawResult(valueViews, resultStates);
     return std::error_code();
 }
 
@@ -198,34 +383,59 @@ std::error_code RocksDBWrapper::readThreadSafe(IReadBatch &batch)
 
     std::vector<std::string> rawKeys(batch.getRawKeys());
 
-    std::vector<std::string> values(rawKeys.size());
+    std::vector<rocksdb::PinnableSlice> values(rawKeys.size());
+
+    std::vector<std::string_view> valueViews;
 
     std::vector<bool> resultStates;
 
-    int i = 0;
+    valueViews.reserve(rawKeys.size());
 
-    for (const std::string &key : rawKeys)
+    resultStates.reserve(rawKeys.size());
+
+    for (size_t i = 0; i < rawKeys.size(); i++)
     {
-        const rocksdb::Status status = db->Get(readOptions, rocksdb::Slice(key), &values[i]);
+        const rocksdb::Status status =
+            db->Get(readOptions, getColumnFamily(rawKeys[i]), rocksdb::Slice(rawKeys[i]), &values[i]);
 
-        if (status.ok())
+        if (!status.ok() && !status.IsNotFound())
         {
-            resultStates.push_back(true);
+            return make_error_code(CryptoNote::error::DataBaseErrorCodes::INTERNAL_ERROR);
         }
-        else
-        {
-            if (!status.IsNotFound())
-            {
-                return make_error_code(CryptoNote::error::DataBaseErrorCodes::INTERNAL_ERROR);
-            }
 
-            resultStates.push_back(false);
-        }
+        valueViews.emplace_back(values[i].data(), values[i].size());
 
-        i++;
+        resultStates.push_back(status.ok());
+    }
+
+    batch.submitRawResult(valueViews, resultStates);
+    return std::error_code();
+}
+
+std::error_code RocksDBWrapper::forEach(
+    const std::string &keyPrefix,
+    const std::function<void(std::string_view key, std::string_view value)> &callback)
+{
+    if (state.load() != INITIALIZED)
+    {
+        throw std::runtime_error("Not initialized.");
+    }
+
+    std::unique_ptr<rocksdb::Iterator> it(db->NewIterator(rocksdb::ReadOptions(), getColumnFamily(keyPrefix)));
+
+    for (it->Seek(keyPrefix); it->Valid() && it->key().starts_with(keyPrefix); it->Next())
+    {
+        callback(
+            std::string_view(it->key().data(), it->key().size()),
+            std::string_view(it->value().data(), it->value().size()));
+    }
+
+    if (!it->status().ok())
+    {
+        logger(ERROR) << "Can't read from DB. " << it->status().ToString();
+        return make_error_code(CryptoNote::error::DataBaseErrorCodes::INTERNAL_ERROR);
     }
 
-    batch.submitRawResult(values, resultStates);
     return std::error_code();
 }
 
@@ -236,6 +446,15 @@ rocksdb::Options RocksDBWrapper::getDBOptions(const DataBaseConfig &config)
     dbOptions.info_log_level = rocksdb::InfoLogLevel::WARN_LEVEL;
     dbOptions.max_open_files = config.maxOpenFiles;
 
+    /* Each column family has its own memtables. Cap them all at about what
+       the one family used before we split the keys up. */
+    dbOptions.db_write_buffer_size = config.writeBufferSize * 2;
+
+    return rocksdb::Options(dbOptions, getColumnFamilyOptions(config, false));
+}
+
+rocksdb::ColumnFamilyOptions RocksDBWrapper::getColumnFamilyOptions(const DataBaseConfig &config, const bool bloomFilter)
+{
     rocksdb::ColumnFamilyOptions fOptions;
     fOptions.write_buffer_size = static_cast<size_t>(config.writeBufferSize);
     // merge two memtables when flushing to L0
@@ -274,11 +493,22 @@ rocksdb::Options RocksDBWrapper::getDBOptions(const DataBaseConfig &config)
     fOptions.bottommost_compression = compressionLevel;
 
     rocksdb::BlockBasedTableOptions tableOptions;
-    tableOptions.block_cache = rocksdb::NewLRUCache(config.readCacheSize);
+    tableOptions.block_cache = blockCache;
+    // keep index and filter blocks in the cache, and never evict the L0 ones,
+    // which every lookup has to check
+    tableOptions.cache_index_and_filter_blocks = true;
+    tableOptions.pin_l0_filter_and_index_blocks_in_cache = true;
+
+    if (bloomFilter)
+    {
+        // 10 bits per key, about 1% false positives
+        tableOptions.filter_policy.reset(rocksdb::NewBloomFilterPolicy(10, false));
+    }
+
     std::shared_ptr<rocksdb::TableFactory> tfp(NewBlockBasedTableFactory(tableOptions));
     fOptions.table_factory = tfp;
 
-    return rocksdb::Options(dbOptions, fOptions);
+    return fOptions;
 }
 
 std::string RocksDBWrapper::getDataDir(const DataBaseConfig &config)
@@ -8,10 +8,12 @@
 #include "IDataBase.h"
 #include "rocksdb/db.h"
 
+#include <array>
 #include <atomic>
 #include <logging/LoggerRef.h>
 #include <memory>
 #include <string>
+#include <vector>
 
 namespace CryptoNote
 {
@@ -42,13 +44,26 @@ namespace CryptoNote
 
         std::error_code readThreadSafe(IReadBatch &batch) override;
 
+        std::error_code forEach(
+            const std::string &keyPrefix,
+            const std::function<void(std::string_view key, std::string_view value)> &callback) override;
+
       private:
         std::error_code write(IWriteBatch &batch, bool sync);
 
         rocksdb::Options getDBOptions(const DataBaseConfig &config);
 
+        rocksdb::ColumnFamilyOptions getColumnFamilyOptions(const DataBaseConfig &config, const bool bloomFilter);
+
         std::string getDataDir(const DataBaseConfig &config);
 
+        /* The column family a key is stored in, going by its prefix */
+        rocksdb::ColumnFamilyHandle *getColumnFamily(const std::string &key) const;
+
+        /* Moves everything which was stored in the default column family,
+           before we split the keys up, into the family it belongs in */
+        void moveToColumnFamilies(const std::string &schemeVersion);
+
         enum State
         {
             NOT_INITIALIZED,
@@ -59,6 +74,15 @@ namespace CryptoNote
 
         std::unique_ptr<rocksdb::DB> db;
 
+        /* Shared between every column family */
+        std::shared_ptr<rocksdb::Cache> blockCache;
+
+        /* Default first, then the ones in the order they're defined in */
+        std::vector<rocksdb::ColumnFamilyHandle *> columnFamilies;
+
+        /* Indexed by the first byte of the key */
+        std::array<rocksdb::ColumnFamilyHandle *, 256> columnFamilyByPrefix;
+
         std::atomic<State> state;
     };
 } // namespace CryptoNote
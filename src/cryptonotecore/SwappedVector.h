@@ -177,6 +177,12 @@ template<class T> class SwappedVector
 
     const T &operator[](uint64_t index);
 
+    /* Reads the item through the given stream, which should be opened on the
+       items file, without using the cache or our own file handle. Safe to
+       call from several threads at once, each with their own stream, as long
+       as nothing is modifying the vector. */
+    T read(uint64_t index, std::istream &itemsFile) const;
+
     const T &front();
 
     const T &back();
@@ -373,6 +379,25 @@ template<class T> const T &SwappedVector<T>::operator[](uint64_t index)
     return *item;
 }
 
+template<class T> T SwappedVector<T>::read(uint64_t index, std::istream &itemsFile) const
+{
+    if (index >= m_offsets.size())
+    {
+        throw std::runtime_error("SwappedVector::read");
+    }
+
+    itemsFile.clear();
+    itemsFile.seekg(m_offsets[index]);
+
+    T item;
+
+    Common::StdInputStream stream(itemsFile);
+    CryptoNote::BinaryInputStreamSerializer archive(stream);
+    serialize(item, archive);
+
+    return item;
+}
+
 template<class T> const T &SwappedVector<T>::front()
 {
     return operator[](0);
@@ -471,6 +496,9 @@ template<class T> void SwappedVector<T>::push_back(const T &item)
         }
     }
 
+    /* So read() through another handle can see it */
+    m_itemsFile.flush();
+
     m_offsets.push_back(m_itemsFileSize);
     m_itemsFileSize = itemsFileSize;
 
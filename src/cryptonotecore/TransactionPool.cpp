@@ -9,8 +9,17 @@
 #include "common/TransactionExtra.h"
 #include "common/int-util.h"
 
+#include <crypto/random.h>
+
 namespace CryptoNote
 {
+    namespace
+    {
+        /* How many adds and removes we remember, for clients asking what has
+           changed since they last looked */
+        const size_t MAX_POOL_EVENTS = 100000;
+    } // namespace
+
     /* Is the left hand side preferred over the right hand side? */
     bool TransactionPool::TransactionPriorityComparator::operator()(
         const PendingTransactionInfo &lhs,
@@ -128,13 +137,37 @@ namespace CryptoNote
         transactionHashIndex(transactions.get<TransactionHashTag>()),
         transactionCostIndex(transactions.get<TransactionCostTag>()),
         paymentIdIndex(transactions.get<PaymentIdTag>()),
+        transactionSizeIndex(transactions.get<TransactionSizeTag>()),
+        mixinIndex(transactions.get<MixinTag>()),
+        m_epoch(Random::randomValue<uint64_t>()),
         logger(logger, "TransactionPool")
     {
     }
 
+    void TransactionPool::addEvent(const Crypto::Hash &transactionHash, const bool added)
+    {
+        m_revision++;
+
+        m_events.push_back({transactionHash, added});
+
+        if (m_events.size() > MAX_POOL_EVENTS)
+        {
+            m_events.pop_front();
+        }
+    }
+
     bool TransactionPool::pushTransaction(CachedTransaction &&transaction, TransactionValidatorState &&transactionState)
     {
-        auto pendingTx = PendingTransactionInfo {static_cast<uint64_t>(time(nullptr)), std::move(transaction)};
+        return pushTransaction(
+            std::move(transaction), std::move(transactionState), static_cast<uint64_t>(time(nullptr)));
+    }
+
+    bool TransactionPool::pushTransaction(
+        CachedTransaction &&transaction,
+        TransactionValidatorState &&transactionState,
+        const uint64_t receiveTime)
+    {
+        auto pendingTx = PendingTransactionInfo {receiveTime, std::move(transaction)};
 
         Crypto::Hash paymentId;
         if (getPaymentIdFromTxExtra(pendingTx.cachedTransaction.getTransaction().extra, paymentId))
@@ -142,6 +175,20 @@ namespace CryptoNote
             pendingTx.paymentId = paymentId;
         }
 
+        pendingTx.size = pendingTx.cachedTransaction.getTransactionBinaryArray().size();
+
+        uint64_t ringSize = 1;
+
+        for (const auto &input : pendingTx.cachedTransaction.getTransaction().inputs)
+        {
+            if (input.type() == typeid(KeyInput))
+            {
+                ringSize = std::max<uint64_t>(ringSize, boost::get<KeyInput>(input).outputIndexes.size());
+            }
+        }
+
+        pendingTx.mixin = ringSize - 1;
+
         std::scoped_lock lock(m_transactionsMutex);
 
         if (transactionHashIndex.count(pendingTx.getTransactionHash()) > 0)
@@ -158,8 +205,15 @@ namespace CryptoNote
 
         mergeStates(poolState, transactionState);
 
+        for (const auto &keyImage : transactionState.spentKeyImages)
+        {
+            keyImageIndex[keyImage] = pendingTx.getTransactionHash();
+        }
+
         logger(Logging::DEBUGGING) << "pushed transaction " << pendingTx.getTransactionHash() << " to pool";
 
+        addEvent(pendingTx.getTransactionHash(), true);
+
         return transactionHashIndex.insert(std::move(pendingTx)).second;
     }
 
@@ -199,8 +253,21 @@ namespace CryptoNote
         }
 
         excludeFromState(poolState, it->cachedTransaction);
+
+        for (const auto &input : it->cachedTransaction.getTransaction().inputs)
+        {
+            if (input.type() == typeid(KeyInput))
+            {
+                keyImageIndex.erase(boost::get<KeyInput>(input).keyImage);
+            }
+        }
+
         transactionHashIndex.erase(it);
 
+        addEvent(hash, false);
+
+        m_removalRevision++;
+
         logger(Logging::DEBUGGING) << "transaction " << hash << " removed from pool";
         return true;
     }
@@ -307,6 +374,21 @@ namespace CryptoNote
         return it->receiveTime;
     }
 
+    std::vector<std::tuple<CachedTransaction, uint64_t>> TransactionPool::getPoolTransactionsWithReceiveTime() const
+    {
+        std::scoped_lock lock(m_transactionsMutex);
+
+        std::vector<std::tuple<CachedTransaction, uint64_t>> result;
+        result.reserve(transactionHashIndex.size());
+
+        for (const auto &transactionItem : transactionHashIndex)
+        {
+            result.emplace_back(transactionItem.cachedTransaction, transactionItem.receiveTime);
+        }
+
+        return result;
+    }
+
     std::vector<Crypto::Hash> TransactionPool::getTransactionHashesByPaymentId(const Crypto::Hash &paymentId) const
     {
         std::scoped_lock lock(m_transactionsMutex);
@@ -324,6 +406,54 @@ namespace CryptoNote
         return transactionHashes;
     }
 
+    std::vector<Crypto::Hash>
+        TransactionPool::getTransactionHashesByKeyImages(const std::unordered_set<Crypto::KeyImage> &keyImages) const
+    {
+        std::scoped_lock lock(m_transactionsMutex);
+
+        std::unordered_set<Crypto::Hash> transactionHashes;
+
+        for (const auto &keyImage : keyImages)
+        {
+            const auto it = keyImageIndex.find(keyImage);
+
+            if (it != keyImageIndex.end())
+            {
+                transactionHashes.insert(it->second);
+            }
+        }
+
+        return {transactionHashes.begin(), transactionHashes.end()};
+    }
+
+    std::vector<Crypto::Hash> TransactionPool::getTransactionHashesOutsideLimits(
+        const uint64_t maxTransactionSize,
+        const uint64_t minMixin,
+        const uint64_t maxMixin) const
+    {
+        std::scoped_lock lock(m_transactionsMutex);
+
+        std::unordered_set<Crypto::Hash> transactionHashes;
+
+        for (auto it = transactionSizeIndex.rbegin(); it != transactionSizeIndex.rend() && it->size > maxTransactionSize;
+             ++it)
+        {
+            transactionHashes.insert(it->getTransactionHash());
+        }
+
+        for (auto it = mixinIndex.begin(); it != mixinIndex.end() && it->mixin < minMixin; ++it)
+        {
+            transactionHashes.insert(it->getTransactionHash());
+        }
+
+        for (auto it = mixinIndex.rbegin(); it != mixinIndex.rend() && it->mixin > maxMixin; ++it)
+        {
+            transactionHashes.insert(it->getTransactionHash());
+        }
+
+        return {transactionHashes.begin(), transactionHashes.end()};
+    }
+
     void TransactionPool::flush()
     {
         const auto txns = getTransactionHashes();
@@ -334,4 +464,79 @@ namespace CryptoNote
         }
     }
 
+    uint64_t TransactionPool::getRevision() const
+    {
+        std::scoped_lock lock(m_transactionsMutex);
+
+        return m_revision;
+    }
+
+    uint64_t TransactionPool::getRemovalRevision() const
+    {
+        std::scoped_lock lock(m_transactionsMutex);
+
+        return m_removalRevision;
+    }
+
+    bool TransactionPool::getChangesSince(
+        const uint64_t epoch,
+        const uint64_t revision,
+        std::vector<Crypto::Hash> &addedTransactions,
+        std::vector<Crypto::Hash> &deletedTransactions,
+        uint64_t &currentEpoch,
+        uint64_t &currentRevision) const
+    {
+        std::scoped_lock lock(m_transactionsMutex);
+
+        currentEpoch = m_epoch;
+        currentRevision = m_revision;
+
+        const uint64_t oldestRevision = m_revision - m_events.size();
+
+        /* From before we restarted, too old, or made up */
+        if (epoch != m_epoch || revision < oldestRevision || revision > m_revision)
+        {
+            for (const auto &transaction : transactionCostIndex)
+            {
+                addedTransactions.push_back(transaction.getTransactionHash());
+            }
+
+            return false;
+        }
+
+        const auto firstEvent = m_events.begin() + (revision - oldestRevision);
+
+        /* A transaction added then removed since then cancels out, and so
+           does one removed then added back */
+        std::unordered_map<Crypto::Hash, int64_t> changes;
+
+        for (auto it = firstEvent; it != m_events.end(); ++it)
+        {
+            changes[it->transactionHash] += it->added ? 1 : -1;
+        }
+
+        for (auto it = firstEvent; it != m_events.end(); ++it)
+        {
+            const auto change = changes.find(it->transactionHash);
+
+            if (change == changes.end())
+            {
+                continue;
+            }
+
+            if (change->second > 0)
+            {
+                addedTransactions.push_back(it->transactionHash);
+            }
+            else if (change->second < 0)
+            {
+                deletedTransactions.push_back(it->transactionHash);
+            }
+
+            changes.erase(change);
+        }
+
+        return true;
+    }
+
 } // namespace CryptoNote
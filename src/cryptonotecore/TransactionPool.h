@@ -16,6 +16,7 @@
 #include <boost/multi_index/ordered_index.hpp>
 #include <boost/multi_index_container.hpp>
 #include <logging/LoggerMessage.h>
+#include <deque>
 #include <logging/LoggerRef.h>
 #include <unordered_map>
 
@@ -29,6 +30,11 @@ namespace CryptoNote
         virtual bool
             pushTransaction(CachedTransaction &&transaction, TransactionValidatorState &&transactionState) override;
 
+        virtual bool pushTransaction(
+            CachedTransaction &&transaction,
+            TransactionValidatorState &&transactionState,
+            const uint64_t receiveTime) override;
+
         virtual const CachedTransaction &getTransaction(const Crypto::Hash &hash) const override;
 
         virtual const std::optional<CachedTransaction> tryGetTransaction(const Crypto::Hash &hash) const override;
@@ -52,10 +58,33 @@ namespace CryptoNote
 
         virtual uint64_t getTransactionReceiveTime(const Crypto::Hash &hash) const override;
 
+        virtual std::vector<std::tuple<CachedTransaction, uint64_t>>
+            getPoolTransactionsWithReceiveTime() const override;
+
         virtual std::vector<Crypto::Hash> getTransactionHashesByPaymentId(const Crypto::Hash &paymentId) const override;
 
+        virtual std::vector<Crypto::Hash>
+            getTransactionHashesByKeyImages(const std::unordered_set<Crypto::KeyImage> &keyImages) const override;
+
+        virtual std::vector<Crypto::Hash> getTransactionHashesOutsideLimits(
+            const uint64_t maxTransactionSize,
+            const uint64_t minMixin,
+            const uint64_t maxMixin) const override;
+
         virtual void flush() override;
 
+        virtual uint64_t getRevision() const override;
+
+        virtual uint64_t getRemovalRevision() const override;
+
+        virtual bool getChangesSince(
+            const uint64_t epoch,
+            const uint64_t revision,
+            std::vector<Crypto::Hash> &addedTransactions,
+            std::vector<Crypto::Hash> &deletedTransactions,
+            uint64_t &currentEpoch,
+            uint64_t &currentRevision) const override;
+
       private:
         TransactionValidatorState poolState;
 
@@ -67,9 +96,23 @@ namespace CryptoNote
 
             boost::optional<Crypto::Hash> paymentId;
 
+            /* Size of the transaction blob */
+            uint64_t size;
+
+            /* The largest ring size less one */
+            uint64_t mixin;
+
             const Crypto::Hash &getTransactionHash() const;
         };
 
+        struct PoolEvent
+        {
+            Crypto::Hash transactionHash;
+
+            /* Otherwise removed */
+            bool added;
+        };
+
         struct TransactionPriorityComparator
         {
             // lhs > hrs
@@ -85,6 +128,12 @@ namespace CryptoNote
         struct PaymentIdTag
         {
         };
+        struct TransactionSizeTag
+        {
+        };
+        struct MixinTag
+        {
+        };
 
         typedef boost::multi_index::ordered_non_unique<
             boost::multi_index::tag<TransactionCostTag>,
@@ -111,9 +160,27 @@ namespace CryptoNote
             PaymentIdHasher>
             PaymentIdIndex;
 
+        /* The size and mixin limits change with the height. Keeping the pool
+           sorted by each means the transactions which no longer fit are at
+           the ends, so we don't have to check all of them. */
+        typedef boost::multi_index::ordered_non_unique<
+            boost::multi_index::tag<TransactionSizeTag>,
+            BOOST_MULTI_INDEX_MEMBER(PendingTransactionInfo, uint64_t, size)>
+            TransactionSizeIndex;
+
+        typedef boost::multi_index::ordered_non_unique<
+            boost::multi_index::tag<MixinTag>,
+            BOOST_MULTI_INDEX_MEMBER(PendingTransactionInfo, uint64_t, mixin)>
+            MixinIndex;
+
         typedef boost::multi_index_container<
             PendingTransactionInfo,
-            boost::multi_index::indexed_by<TransactionHashIndex, TransactionCostIndex, PaymentIdIndex>>
+            boost::multi_index::indexed_by<
+                TransactionHashIndex,
+                TransactionCostIndex,
+                PaymentIdIndex,
+                TransactionSizeIndex,
+                MixinIndex>>
             TransactionsContainer;
 
         TransactionsContainer transactions;
@@ -124,8 +191,34 @@ namespace CryptoNote
 
         TransactionsContainer::index<PaymentIdTag>::type &paymentIdIndex;
 
+        TransactionsContainer::index<TransactionSizeTag>::type &transactionSizeIndex;
+
+        TransactionsContainer::index<MixinTag>::type &mixinIndex;
+
+        /* The transaction spending each key image in the pool. The pool never
+           holds two transactions spending the same key image, so after a
+           block, finding the ones it conflicts with is one lookup per input. */
+        std::unordered_map<Crypto::KeyImage, Crypto::Hash> keyImageIndex;
+
         mutable std::mutex m_transactionsMutex;
 
+        /* Picked at random when the pool is created, and given to clients
+           along with the revision. A revision from before we restarted
+           could otherwise look like one we remember. */
+        const uint64_t m_epoch;
+
+        /* Bumped on every add and remove, guarded by m_transactionsMutex */
+        uint64_t m_revision = 0;
+
+        /* Bumped on every remove, guarded by m_transactionsMutex */
+        uint64_t m_removalRevision = 0;
+
+        /* The last adds and removes, oldest first. The last one took the pool
+           to m_revision. */
+        std::deque<PoolEvent> m_events;
+
+        void addEvent(const Crypto::Hash &transactionHash, const bool added);
+
         Logging::LoggerRef logger;
     };
 
@@ -37,6 +37,15 @@ namespace CryptoNote
                && transactionPool->pushTransaction(std::move(tx), std::move(transactionState));
     }
 
+    bool TransactionPoolCleanWrapper::pushTransaction(
+        CachedTransaction &&tx,
+        TransactionValidatorState &&transactionState,
+        const uint64_t receiveTime)
+    {
+        return !isTransactionRecentlyDeleted(tx.getTransactionHash())
+               && transactionPool->pushTransaction(std::move(tx), std::move(transactionState), receiveTime);
+    }
+
     const CachedTransaction &TransactionPoolCleanWrapper::getTransaction(const Crypto::Hash &hash) const
     {
         return transactionPool->getTransaction(hash);
@@ -94,17 +103,59 @@ namespace CryptoNote
         return transactionPool->getTransactionReceiveTime(hash);
     }
 
+    std::vector<std::tuple<CachedTransaction, uint64_t>>
+        TransactionPoolCleanWrapper::getPoolTransactionsWithReceiveTime() const
+    {
+        return transactionPool->getPoolTransactionsWithReceiveTime();
+    }
+
     std::vector<Crypto::Hash>
         TransactionPoolCleanWrapper::getTransactionHashesByPaymentId(const Crypto::Hash &paymentId) const
     {
         return transactionPool->getTransactionHashesByPaymentId(paymentId);
     }
 
+    std::vector<Crypto::Hash> TransactionPoolCleanWrapper::getTransactionHashesByKeyImages(
+        const std::unordered_set<Crypto::KeyImage> &keyImages) const
+    {
+        return transactionPool->getTransactionHashesByKeyImages(keyImages);
+    }
+
+    std::vector<Crypto::Hash> TransactionPoolCleanWrapper::getTransactionHashesOutsideLimits(
+        const uint64_t maxTransactionSize,
+        const uint64_t minMixin,
+        const uint64_t maxMixin) const
+    {
+        return transactionPool->getTransactionHashesOutsideLimits(maxTransactionSize, minMixin, maxMixin);
+    }
+
     void TransactionPoolCleanWrapper::flush()
     {
         return transactionPool->flush();
     }
 
+    uint64_t TransactionPoolCleanWrapper::getRevision() const
+    {
+        return transactionPool->getRevision();
+    }
+
+    uint64_t TransactionPoolCleanWrapper::getRemovalRevision() const
+    {
+        return transactionPool->getRemovalRevision();
+    }
+
+    bool TransactionPoolCleanWrapper::getChangesSince(
+        const uint64_t epoch,
+        const uint64_t revision,
+        std::vector<Crypto::Hash> &addedTransactions,
+        std::vector<Crypto::Hash> &deletedTransactions,
+        uint64_t &currentEpoch,
+        uint64_t &currentRevision) const
+    {
+        return transactionPool->getChangesSince(
+            epoch, revision, addedTransactions, deletedTransactions, currentEpoch, currentRevision);
+    }
+
     std::vector<Crypto::Hash> TransactionPoolCleanWrapper::clean(const uint32_t height)
     {
         try
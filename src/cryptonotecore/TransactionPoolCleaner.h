@@ -39,6 +39,11 @@ namespace CryptoNote
 
         virtual bool pushTransaction(CachedTransaction &&tx, TransactionValidatorState &&transactionState) override;
 
+        virtual bool pushTransaction(
+            CachedTransaction &&tx,
+            TransactionValidatorState &&transactionState,
+            const uint64_t receiveTime) override;
+
         virtual const CachedTransaction &getTransaction(const Crypto::Hash &hash) const override;
 
         virtual const std::optional<CachedTransaction> tryGetTransaction(const Crypto::Hash &hash) const override;
@@ -62,10 +67,33 @@ namespace CryptoNote
 
         virtual uint64_t getTransactionReceiveTime(const Crypto::Hash &hash) const override;
 
+        virtual std::vector<std::tuple<CachedTransaction, uint64_t>>
+            getPoolTransactionsWithReceiveTime() const override;
+
         virtual std::vector<Crypto::Hash> getTransactionHashesByPaymentId(const Crypto::Hash &paymentId) const override;
 
+        virtual std::vector<Crypto::Hash>
+            getTransactionHashesByKeyImages(const std::unordered_set<Crypto::KeyImage> &keyImages) const override;
+
+        virtual std::vector<Crypto::Hash> getTransactionHashesOutsideLimits(
+            const uint64_t maxTransactionSize,
+            const uint64_t minMixin,
+            const uint64_t maxMixin) const override;
+
         virtual void flush() override;
 
+        virtual uint64_t getRevision() const override;
+
+        virtual uint64_t getRemovalRevision() const override;
+
+        virtual bool getChangesSince(
+            const uint64_t epoch,
+            const uint64_t revision,
+            std::vector<Crypto::Hash> &addedTransactions,
+            std::vector<Crypto::Hash> &deletedTransactions,
+            uint64_t &currentEpoch,
+            uint64_t &currentRevision) const override;
+
         virtual std::vector<Crypto::Hash> clean(const uint32_t height) override;
 
       private:
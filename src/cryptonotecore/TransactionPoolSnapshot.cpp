@@ -0,0 +1,232 @@
+// Copyright (c) 2018-2019, The TurtleCoin Developers
+//
+// Please see the included LICENSE file for more information.
+
+///////////////////////////////////////////////////
+#include <cryptonotecore/TransactionPoolSnapshot.h>
+///////////////////////////////////////////////////
+
+#include <array>
+#include <common/FileSystemShim.h>
+#include <cstring>
+#include <crypto/hash.h>
+#include <crypto/random.h>
+#include <fstream>
+#include <iterator>
+
+namespace CryptoNote
+{
+    namespace
+    {
+        /* 2 keyed the hash at the end */
+        const uint32_t FILE_VERSION = 2;
+
+        template<typename T> void appendValue(std::vector<uint8_t> &buffer, const T &value)
+        {
+            const auto bytes = reinterpret_cast<const uint8_t *>(&value);
+
+            buffer.insert(buffer.end(), bytes, bytes + sizeof(value));
+        }
+
+        /* Reads a value at the offset, and moves the offset past it */
+        template<typename T> bool readValue(const std::vector<uint8_t> &buffer, const size_t end, size_t &offset, T &value)
+        {
+            if (end - offset < sizeof(value))
+            {
+                return false;
+            }
+
+            std::memcpy(&value, buffer.data() + offset, sizeof(value));
+
+            offset += sizeof(value);
+
+            return true;
+        }
+
+        /* Made up the first time a snapshot is saved. Only readable by us, so
+           nobody else can write a snapshot we'd load. */
+        bool loadKey(const std::string &snapshotFilename, const bool create, Crypto::Hash &key)
+        {
+            const std::string keyFilename = snapshotFilename + ".key";
+
+            {
+                std::ifstream file(keyFilename, std::ios::binary);
+
+                if (file.read(reinterpret_cast<char *>(&key), sizeof(key)))
+                {
+                    return true;
+                }
+            }
+
+            if (!create)
+            {
+                return false;
+            }
+
+            Random::randomBytes(sizeof(key), key.data);
+
+            {
+                std::ofstream file(keyFilename, std::ios::binary | std::ios::trunc);
+
+                file.write(reinterpret_cast<const char *>(&key), sizeof(key));
+
+                if (!file.flush())
+                {
+                    return false;
+                }
+            }
+
+            std::error_code ec;
+
+            fs::permissions(keyFilename, fs::perms::owner_read | fs::perms::owner_write, ec);
+
+            return !ec;
+        }
+
+        /* The key hashed together with the hash of the contents, so the hash
+           at the end of the file can't be made without the key */
+        Crypto::Hash keyedHash(const Crypto::Hash &key, const uint8_t *data, const size_t size)
+        {
+            const std::array<Crypto::Hash, 2> keyAndHash = {key, Crypto::cn_fast_hash(data, size)};
+
+            return Crypto::cn_fast_hash(keyAndHash.data(), sizeof(keyAndHash));
+        }
+    } // namespace
+
+    bool TransactionPoolSnapshot::save(
+        const std::string &filename,
+        const uint32_t topBlockIndex,
+        const Crypto::Hash &topBlockHash,
+        const std::vector<PoolSnapshotTransaction> &transactions)
+    {
+        Crypto::Hash key;
+
+        if (!loadKey(filename, true, key))
+        {
+            return false;
+        }
+
+        std::vector<uint8_t> buffer;
+
+        size_t totalSize = sizeof(FILE_VERSION) + sizeof(topBlockIndex) + sizeof(topBlockHash) + sizeof(uint64_t)
+                           + sizeof(Crypto::Hash);
+
+        for (const auto &transaction : transactions)
+        {
+            totalSize += sizeof(transaction.receiveTime) + sizeof(uint32_t) + transaction.transaction.size();
+        }
+
+        buffer.reserve(totalSize);
+
+        appendValue(buffer, FILE_VERSION);
+        appendValue(buffer, topBlockIndex);
+        appendValue(buffer, topBlockHash);
+        appendValue(buffer, static_cast<uint64_t>(transactions.size()));
+
+        for (const auto &transaction : transactions)
+        {
+            appendValue(buffer, transaction.receiveTime);
+            appendValue(buffer, static_cast<uint32_t>(transaction.transaction.size()));
+
+            buffer.insert(buffer.end(), transaction.transaction.begin(), transaction.transaction.end());
+        }
+
+        appendValue(buffer, keyedHash(key, buffer.data(), buffer.size()));
+
+        const std::string tempFilename = filename + ".tmp";
+
+        {
+            std::ofstream file(tempFilename, std::ios::binary | std::ios::trunc);
+
+            file.write(reinterpret_cast<const char *>(buffer.data()), buffer.size());
+
+            if (!file.flush())
+            {
+                return false;
+            }
+        }
+
+        std::error_code ec;
+
+        fs::rename(tempFilename, filename, ec);
+
+        return !ec;
+    }
+
+    bool TransactionPoolSnapshot::load(
+        const std::string &filename,
+        uint32_t &topBlockIndex,
+        Crypto::Hash &topBlockHash,
+        std::vector<PoolSnapshotTransaction> &transactions)
+    {
+        Crypto::Hash key;
+
+        if (!loadKey(filename, false, key))
+        {
+            return false;
+        }
+
+        std::ifstream file(filename, std::ios::binary);
+
+        if (!file)
+        {
+            return false;
+        }
+
+        const std::vector<uint8_t> buffer(
+            (std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+
+        if (buffer.size() < sizeof(Crypto::Hash))
+        {
+            return false;
+        }
+
+        const size_t end = buffer.size() - sizeof(Crypto::Hash);
+
+        Crypto::Hash checksum;
+
+        std::memcpy(&checksum, buffer.data() + end, sizeof(checksum));
+
+        if (keyedHash(key, buffer.data(), end) != checksum)
+        {
+            return false;
+        }
+
+        size_t offset = 0;
+
+        uint32_t version;
+        uint64_t count;
+
+        if (!readValue(buffer, end, offset, version) || version != FILE_VERSION
+            || !readValue(buffer, end, offset, topBlockIndex) || !readValue(buffer, end, offset, topBlockHash)
+            || !readValue(buffer, end, offset, count))
+        {
+            return false;
+        }
+
+        std::vector<PoolSnapshotTransaction> result;
+
+        for (uint64_t i = 0; i < count; i++)
+        {
+            PoolSnapshotTransaction transaction;
+
+            uint32_t size;
+
+            if (!readValue(buffer, end, offset, transaction.receiveTime) || !readValue(buffer, end, offset, size)
+                || end - offset < size)
+            {
+                return false;
+            }
+
+            transaction.transaction.assign(buffer.begin() + offset, buffer.begin() + offset + size);
+
+            offset += size;
+
+            result.push_back(std::move(transaction));
+        }
+
+        transactions = std::move(result);
+
+        return true;
+    }
+} // namespace CryptoNote
@@ -0,0 +1,50 @@
+// Copyright (c) 2018-2019, The TurtleCoin Developers
+//
+// Please see the included LICENSE file for more information.
+
+#pragma once
+
+#include <CryptoNote.h>
+#include <string>
+#include <vector>
+
+namespace CryptoNote
+{
+    struct PoolSnapshotTransaction
+    {
+        /* When the transaction first reached our pool */
+        uint64_t receiveTime;
+
+        BinaryArray transaction;
+    };
+
+    /* The contents of the transaction pool, written to disk so a restarted
+       node doesn't start with an empty pool.
+
+       The file is the block the pool was valid at, then each transaction
+       blob with the time we received it, then a hash of all of that keyed
+       with a secret kept next to it. The transactions were validated when
+       they went into our pool, so a file we wrote ourselves is trusted as
+       much as the rest of the data directory. One that is damaged, or that
+       we didn't write, such as one copied from another node, is thrown
+       away rather than loaded. */
+    class TransactionPoolSnapshot
+    {
+      public:
+        /* Writes to a temporary file then renames it, so a crash part way
+           through leaves the last snapshot in place */
+        static bool save(
+            const std::string &filename,
+            const uint32_t topBlockIndex,
+            const Crypto::Hash &topBlockHash,
+            const std::vector<PoolSnapshotTransaction> &transactions);
+
+        /* Fails if the file is missing, from another version, damaged, or
+           wasn't written with our key */
+        static bool load(
+            const std::string &filename,
+            uint32_t &topBlockIndex,
+            Crypto::Hash &topBlockHash,
+            std::vector<PoolSnapshotTransaction> &transactions);
+    };
+} // namespace CryptoNote
@@ -17,10 +17,11 @@ ValidateTransaction::ValidateTransaction(
     CryptoNote::IBlockchainCache *cache,
     const CryptoNote::Currency &currency,
     const CryptoNote::Checkpoints &checkpoints,
-    Utilities::ThreadPool<bool> &threadPool,
+    Utilities::ThreadPool &threadPool,
     const uint64_t blockHeight,
     const uint64_t blockSizeMedian,
-    const bool isPoolTransaction):
+    const bool isPoolTransaction,
+    std::vector<Crypto::RingSignatureBatchEntry> *deferredSignatures):
     m_cachedTransaction(cachedTransaction),
     m_transaction(cachedTransaction.getTransaction()),
     m_validatorState(state),
@@ -31,6 +32,7 @@ ValidateTransaction::ValidateTransaction(
     m_blockHeight(blockHeight),
     m_blockSizeMedian(blockSizeMedian),
     m_isPoolTransaction(isPoolTransaction),
+    m_deferredSignatures(deferredSignatures),
     m_transactionStopHeight(
         CryptoNote::parameters::CRYPTONOTE_STOP_BLOCK_NUMBER
         - CryptoNote::parameters::CRYPTONOTE_STOP_TX_X_BLOCKS_BEFORE - 1)
@@ -467,105 +469,111 @@ bool ValidateTransaction::validateTransactionInputsExpensive()
         return true;
     }
 
-    uint64_t inputIndex = 0;
-
-    std::vector<std::future<bool>> validationResult;
     std::atomic<bool> cancelValidation = false;
     const Crypto::Hash prefixHash = m_cachedTransaction.getTransactionPrefixHash();
 
-    for (const auto &input : m_transaction.inputs)
+    const auto validateInput = [&prefixHash, this](const size_t inputIndex)
     {
-        /* Validate each input on a separate thread in our thread pool */
-        validationResult.push_back(m_threadPool.addJob(
-            [inputIndex, &input, &prefixHash, &cancelValidation, this]
+        const CryptoNote::KeyInput &in = boost::get<CryptoNote::KeyInput>(m_transaction.inputs[inputIndex]);
+
+        if (m_blockchainCache->checkIfSpent(in.keyImage, m_blockHeight))
+        {
+            setTransactionValidationResult(
+                CryptoNote::error::TransactionValidationError::INPUT_KEYIMAGE_ALREADY_SPENT,
+                "Transaction contains key image that has already been spent: " + Common::podToHex(in.keyImage));
+
+            return false;
+        }
+
+        std::vector<Crypto::PublicKey> outputKeys;
+        std::vector<uint32_t> globalIndexes(in.outputIndexes.size());
+
+        globalIndexes[0] = in.outputIndexes[0];
+
+        /* Convert output indexes from relative to absolute */
+        for (size_t i = 1; i < in.outputIndexes.size(); ++i)
+        {
+            globalIndexes[i] = globalIndexes[i - 1] + in.outputIndexes[i];
+        }
+
+        const auto result = m_blockchainCache->extractKeyOutputKeys(
+            in.amount, m_blockHeight, {globalIndexes.data(), globalIndexes.size()}, outputKeys);
+
+        if (result == CryptoNote::ExtractOutputKeysResult::INVALID_GLOBAL_INDEX)
+        {
+            setTransactionValidationResult(
+                CryptoNote::error::TransactionValidationError::INPUT_INVALID_GLOBAL_INDEX,
+                "Transaction contains invalid global indexes");
+
+            return false;
+        }
+
+        if (result == CryptoNote::ExtractOutputKeysResult::OUTPUT_LOCKED)
+        {
+            setTransactionValidationResult(
+                CryptoNote::error::TransactionValidationError::INPUT_SPEND_LOCKED_OUT,
+                "Transaction includes an input which is still locked");
+
+            return false;
+        }
+
+        if (m_isPoolTransaction
+            || m_blockHeight >= CryptoNote::parameters::TRANSACTION_SIGNATURE_COUNT_VALIDATION_HEIGHT)
+        {
+            if (outputKeys.size() != m_transaction.signatures[inputIndex].size())
             {
-                const CryptoNote::KeyInput &in = boost::get<CryptoNote::KeyInput>(input);
-                if (cancelValidation)
-                {
-                    return false; // fail the validation immediately if cancel requested
-                }
-                if (m_blockchainCache->checkIfSpent(in.keyImage, m_blockHeight))
-                {
-                    setTransactionValidationResult(
-                        CryptoNote::error::TransactionValidationError::INPUT_KEYIMAGE_ALREADY_SPENT,
-                        "Transaction contains key image that has already been spent: " + Common::podToHex(in.keyImage));
-
-                    return false;
-                }
-
-                std::vector<Crypto::PublicKey> outputKeys;
-                std::vector<uint32_t> globalIndexes(in.outputIndexes.size());
-
-                globalIndexes[0] = in.outputIndexes[0];
-
-                /* Convert output indexes from relative to absolute */
-                for (size_t i = 1; i < in.outputIndexes.size(); ++i)
-                {
-                    globalIndexes[i] = globalIndexes[i - 1] + in.outputIndexes[i];
-                }
-
-                const auto result = m_blockchainCache->extractKeyOutputKeys(
-                    in.amount, m_blockHeight, {globalIndexes.data(), globalIndexes.size()}, outputKeys);
-
-                if (result == CryptoNote::ExtractOutputKeysResult::INVALID_GLOBAL_INDEX)
-                {
-                    setTransactionValidationResult(
-                        CryptoNote::error::TransactionValidationError::INPUT_INVALID_GLOBAL_INDEX,
-                        "Transaction contains invalid global indexes");
-
-                    return false;
-                }
-
-                if (result == CryptoNote::ExtractOutputKeysResult::OUTPUT_LOCKED)
-                {
-                    setTransactionValidationResult(
-                        CryptoNote::error::TransactionValidationError::INPUT_SPEND_LOCKED_OUT,
-                        "Transaction includes an input which is still locked");
-
-                    return false;
-                }
-
-                if (m_isPoolTransaction
-                    || m_blockHeight >= CryptoNote::parameters::TRANSACTION_SIGNATURE_COUNT_VALIDATION_HEIGHT)
-                {
-                    if (outputKeys.size() != m_transaction.signatures[inputIndex].size())
-                    {
-                        setTransactionValidationResult(
-                            CryptoNote::error::TransactionValidationError::INPUT_INVALID_SIGNATURES_COUNT,
-                            "Transaction has an invalid number of signatures");
-
-                        return false;
-                    }
-                }
-
-                if (!Crypto::crypto_ops::checkRingSignature(
-                        prefixHash, in.keyImage, outputKeys, m_transaction.signatures[inputIndex]))
-                {
-                    setTransactionValidationResult(
-                        CryptoNote::error::TransactionValidationError::INPUT_INVALID_SIGNATURES,
-                        "Transaction contains invalid signatures: " + Common::podToHex(in.keyImage));
-
-                    return false;
-                }
-
-                return true;
-            }));
-
-        inputIndex++;
-    }
+                setTransactionValidationResult(
+                    CryptoNote::error::TransactionValidationError::INPUT_INVALID_SIGNATURES_COUNT,
+                    "Transaction has an invalid number of signatures");
 
-    bool valid = true;
+                return false;
+            }
+        }
 
-    for (auto &result : validationResult)
-    {
-        if (!result.get())
+        /* Leave the signature for the block level batch verification */
+        if (m_deferredSignatures != nullptr)
         {
-            valid = false;
-            cancelValidation = true;
+            std::scoped_lock<std::mutex> lock(m_mutex);
+
+            m_deferredSignatures->push_back(
+                {prefixHash, in.keyImage, std::move(outputKeys), m_transaction.signatures[inputIndex]});
+
+            return true;
         }
-    }
 
-    return valid;
+        if (!Crypto::crypto_ops::checkRingSignature(
+                prefixHash, in.keyImage, outputKeys, m_transaction.signatures[inputIndex]))
+        {
+            setTransactionValidationResult(
+                CryptoNote::error::TransactionValidationError::INPUT_INVALID_SIGNATURES,
+                "Transaction contains invalid signatures: " + Common::podToHex(in.keyImage));
+
+            return false;
+        }
+
+        return true;
+    };
+
+    /* Validate the inputs in parallel on our thread pool. Small rings are
+     * cheap to check, so the pool batches several inputs into each job. */
+    m_threadPool.parallelFor(
+        0,
+        m_transaction.inputs.size(),
+        [&validateInput, &cancelValidation](const size_t inputIndex)
+        {
+            /* fail the validation immediately if cancel requested */
+            if (cancelValidation)
+            {
+                return;
+            }
+
+            if (!validateInput(inputIndex))
+            {
+                cancelValidation = true;
+            }
+        });
+
+    return !cancelValidation;
 }
 
 void ValidateTransaction::setTransactionValidationResult(
@@ -45,10 +45,11 @@ class ValidateTransaction
         CryptoNote::IBlockchainCache *cache,
         const CryptoNote::Currency &currency,
         const CryptoNote::Checkpoints &checkpoints,
-        Utilities::ThreadPool<bool> &threadPool,
+        Utilities::ThreadPool &threadPool,
         const uint64_t blockHeight,
         const uint64_t blockSizeMedian,
-        const bool isPoolTransaction);
+        const bool isPoolTransaction,
+        std::vector<Crypto::RingSignatureBatchEntry> *deferredSignatures = nullptr);
 
     /////////////////////////////
     /* PUBLIC MEMBER FUNCTIONS */
@@ -109,7 +110,11 @@ class ValidateTransaction
     uint64_t m_sumOfOutputs = 0;
     uint64_t m_sumOfInputs = 0;
 
-    Utilities::ThreadPool<bool> &m_threadPool;
+    Utilities::ThreadPool &m_threadPool;
+
+    /* If set, ring signatures are pushed here to be verified along with the
+     * rest of the block, instead of being verified inline */
+    std::vector<Crypto::RingSignatureBatchEntry> *m_deferredSignatures;
 
     std::mutex m_mutex;
 };
@@ -0,0 +1,153 @@
+// Copyright (c) 2018-2019, The TurtleCoin Developers
+//
+// Please see the included LICENSE file for more information.
+
+#include "WalletSyncCache.h"
+
+namespace CryptoNote
+{
+    size_t WalletSyncCache::Block::memoryUsage() const
+    {
+        size_t size = sizeof(*this) + rawBlock.block.size();
+
+        for (const auto &transaction : rawBlock.transactions)
+        {
+            size += sizeof(transaction) + transaction.size();
+        }
+
+        if (walletBlock)
+        {
+            const auto coinbaseUsage = [](const WalletTypes::RawCoinbaseTransaction &transaction) {
+                return sizeof(transaction) + transaction.keyOutputs.size() * sizeof(WalletTypes::KeyOutput);
+            };
+
+            if (walletBlock->coinbaseTransaction)
+            {
+                size += coinbaseUsage(*walletBlock->coinbaseTransaction);
+            }
+
+            for (const auto &transaction : walletBlock->transactions)
+            {
+                size += coinbaseUsage(transaction) + transaction.paymentID.size()
+                        + transaction.keyInputs.size() * sizeof(CryptoNote::KeyInput);
+            }
+        }
+
+        return size;
+    }
+
+    WalletSyncCache::WalletSyncCache(const size_t maxSize): m_maxSize(maxSize) {}
+
+    std::shared_ptr<const WalletSyncCache::Block> WalletSyncCache::getBlock(const uint64_t height)
+    {
+        std::scoped_lock lock(m_mutex);
+
+        const auto it = m_blocks.find(height);
+
+        if (it == m_blocks.end())
+        {
+            return nullptr;
+        }
+
+        /* Move to the front of the queue */
+        m_recentlyUsed.splice(m_recentlyUsed.begin(), m_recentlyUsed, it->second.usage);
+
+        return it->second.block;
+    }
+
+    void WalletSyncCache::addBlock(
+        const uint64_t height,
+        std::shared_ptr<const Block> block,
+        const uint64_t generation)
+    {
+        std::scoped_lock lock(m_mutex);
+
+        const size_t size = block->memoryUsage();
+
+        if (generation != m_generation || size > m_maxSize)
+        {
+            return;
+        }
+
+        const auto it = m_blocks.find(height);
+
+        /* Replacing an existing block, probably to add the wallet block */
+        if (it != m_blocks.end())
+        {
+            m_size = m_size - it->second.size + size;
+
+            it->second.block = std::move(block);
+            it->second.size = size;
+
+            m_recentlyUsed.splice(m_recentlyUsed.begin(), m_recentlyUsed, it->second.usage);
+        }
+        else
+        {
+            m_size += size;
+
+            m_recentlyUsed.push_front(height);
+            m_blocks[height] = {std::move(block), size, m_recentlyUsed.begin()};
+        }
+
+        /* The block we just added is at the front, so is never the one dropped */
+        while (m_size > m_maxSize)
+        {
+            const auto oldest = m_blocks.find(m_recentlyUsed.back());
+
+            m_size -= oldest->second.size;
+
+            m_blocks.erase(oldest);
+            m_recentlyUsed.pop_back();
+        }
+    }
+
+    void WalletSyncCache::recordLookups(const uint64_t hits, const uint64_t misses)
+    {
+        std::scoped_lock lock(m_mutex);
+
+        m_hits += hits;
+        m_misses += misses;
+    }
+
+    uint64_t WalletSyncCache::getGeneration() const
+    {
+        std::scoped_lock lock(m_mutex);
+
+        return m_generation;
+    }
+
+    void WalletSyncCache::invalidateFrom(const uint64_t height)
+    {
+        std::scoped_lock lock(m_mutex);
+
+        m_generation++;
+
+        for (auto it = m_blocks.begin(); it != m_blocks.end();)
+        {
+            if (it->first >= height)
+            {
+                m_size -= it->second.size;
+                m_recentlyUsed.erase(it->second.usage);
+                it = m_blocks.erase(it);
+            }
+            else
+            {
+                ++it;
+            }
+        }
+    }
+
+    WalletSyncCache::Statistics WalletSyncCache::getStatistics() const
+    {
+        std::scoped_lock lock(m_mutex);
+
+        Statistics statistics;
+
+        statistics.hits = m_hits;
+        statistics.misses = m_misses;
+        statistics.blockCount = m_blocks.size();
+        statistics.size = m_size;
+
+        return statistics;
+    }
+} // namespace CryptoNote
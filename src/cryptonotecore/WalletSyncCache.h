@@ -0,0 +1,114 @@
+// Copyright (c) 2018-2019, The TurtleCoin Developers
+//
+// Please see the included LICENSE file for more information.
+
+#pragma once
+
+#include <CryptoNote.h>
+#include <WalletTypes.h>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <unordered_map>
+
+namespace CryptoNote
+{
+    /* Keeps the main chain blocks wallets have recently asked for, so lots of
+       wallets syncing the same heights don't each make us read them from the
+       database and decode them again. Least recently used blocks are dropped
+       once their total size goes over the limit, since a block can be
+       anything from a few hundred bytes to the full block size.
+
+       Used from the RPC threads, so everything takes the lock. */
+    class WalletSyncCache
+    {
+      public:
+        struct Block
+        {
+            RawBlock rawBlock;
+
+            /* Filled in the first time a /sync request wants this block.
+               Always includes the coinbase transaction. */
+            std::optional<WalletTypes::WalletBlockInfo> walletBlock;
+
+            /* Roughly how much memory this takes up */
+            size_t memoryUsage() const;
+        };
+
+        struct Statistics
+        {
+            uint64_t hits = 0;
+
+            uint64_t misses = 0;
+
+            size_t blockCount = 0;
+
+            /* Bytes */
+            size_t size = 0;
+        };
+
+        /////////////////
+        /* CONSTRUCTOR */
+        /////////////////
+        /* maxSize is in bytes */
+        explicit WalletSyncCache(const size_t maxSize);
+
+        /////////////////////////////
+        /* PUBLIC MEMBER FUNCTIONS */
+        /////////////////////////////
+
+        /* Returns nullptr if we don't have the block at this height. Doesn't
+           count towards the hits and misses, as we also look up blocks we
+           don't end up sending to the wallet. */
+        std::shared_ptr<const Block> getBlock(const uint64_t height);
+
+        /* Counts the blocks sent to a wallet that we did and didn't have */
+        void recordLookups(const uint64_t hits, const uint64_t misses);
+
+        /* Generation should be taken from getGeneration() before reading the
+           block from the chain. If the chain has changed since then, the
+           block may be stale, and is not added. */
+        void addBlock(const uint64_t height, std::shared_ptr<const Block> block, const uint64_t generation);
+
+        uint64_t getGeneration() const;
+
+        /* Drops every block at or above this height, after a reorg */
+        void invalidateFrom(const uint64_t height);
+
+        Statistics getStatistics() const;
+
+      private:
+        /////////////////////////
+        /* PRIVATE MEMBER VARS */
+        /////////////////////////
+        struct Entry
+        {
+            std::shared_ptr<const Block> block;
+
+            size_t size;
+
+            /* Position in m_recentlyUsed */
+            std::list<uint64_t>::iterator usage;
+        };
+
+        const size_t m_maxSize;
+
+        /* Total size of the blocks in m_blocks */
+        size_t m_size = 0;
+
+        std::unordered_map<uint64_t, Entry> m_blocks;
+
+        /* Heights, most recently used at the front */
+        std::list<uint64_t> m_recentlyUsed;
+
+        /* Bumped every time blocks are invalidated */
+        uint64_t m_generation = 0;
+
+        uint64_t m_hits = 0;
+
+        uint64_t m_misses = 0;
+
+        mutable std::mutex m_mutex;
+    };
+} // namespace CryptoNote
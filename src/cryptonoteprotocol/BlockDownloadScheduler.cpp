@@ -0,0 +1,416 @@
+// Copyright (c) 2018-2019, The TurtleCoin Developers
+//
+// Please see the included LICENSE file for more information.
+
+#include "BlockDownloadScheduler.h"
+
+#include <algorithm>
+#include <config/CryptoNoteConfig.h>
+#include <map>
+#include <numeric>
+
+namespace CryptoNote
+{
+    BlockDownloadScheduler::BlockDownloadScheduler(ICore &core): m_core(core) {}
+
+    std::vector<Crypto::Hash> BlockDownloadScheduler::takeBlocks(CryptoNoteConnectionContext &context)
+    {
+        std::vector<Crypto::Hash> blocks;
+
+        const auto now = std::chrono::steady_clock::now();
+        const auto timeout = std::chrono::seconds(BLOCKS_SYNCHRONIZING_TIMEOUT);
+        const size_t requestSize = getRequestSize(context.m_connection_id);
+
+        size_t scanned = 0;
+
+        auto it = context.m_needed_objects.begin();
+
+        /* Don't get too far ahead of the chain, or we'll end up holding a
+           lot of blocks in memory while we wait for the ones before them */
+        while (it != context.m_needed_objects.end() && blocks.size() < requestSize
+               && scanned < BLOCKS_SYNCHRONIZING_MAX_AHEAD)
+        {
+            const auto stateIt = m_blocks.find(*it);
+
+            if (stateIt == m_blocks.end())
+            {
+                /* Already added to the chain, peer no longer needs to give it to us */
+                if (m_core.hasBlock(*it))
+                {
+                    it = context.m_needed_objects.erase(it);
+                    continue;
+                }
+
+                auto &state = m_blocks[*it];
+
+                state.peer = context.m_connection_id;
+                state.requestTime = now;
+
+                blocks.push_back(*it);
+            }
+            /* Another peer is taking too long to send it, ask this one instead */
+            else if (!stateIt->second.downloaded && !stateIt->second.adding
+                     && stateIt->second.peer != context.m_connection_id
+                     && now - stateIt->second.requestTime > timeout)
+            {
+                stateIt->second.peer = context.m_connection_id;
+                stateIt->second.requestTime = now;
+
+                blocks.push_back(*it);
+            }
+
+            ++it;
+            ++scanned;
+        }
+
+        return blocks;
+    }
+
+    bool BlockDownloadScheduler::addDownloadedBlock(
+        const boost::uuids::uuid &peer,
+        RawBlock &&rawBlock,
+        const CachedBlock &cachedBlock)
+    {
+        const auto &blockHash = cachedBlock.getBlockHash();
+
+        const auto it = m_blocks.find(blockHash);
+
+        /* Nobody asked for it, or someone has already sent it. It is still in
+           the map if we gave up waiting for it from this peer and asked
+           another, which is fine, we still need it. */
+        if (it == m_blocks.end() || it->second.downloaded || it->second.adding)
+        {
+            return false;
+        }
+
+        if (m_core.hasBlock(blockHash))
+        {
+            eraseBlock(it);
+            return false;
+        }
+
+        /* The block index comes from the peer, so don't hold on to blocks it
+           says are far beyond what we could add any time soon */
+        if (cachedBlock.getBlockIndex() > m_core.getTopBlockIndex() + BLOCKS_SYNCHRONIZING_MAX_AHEAD)
+        {
+            eraseBlock(it);
+            return false;
+        }
+
+        auto &state = it->second;
+
+        state.peer = peer;
+        state.downloaded = true;
+        state.blockIndex = cachedBlock.getBlockIndex();
+        state.previousBlockHash = cachedBlock.getBlock().previousBlockHash;
+        state.size = std::accumulate(
+            rawBlock.transactions.begin(),
+            rawBlock.transactions.end(),
+            rawBlock.block.size(),
+            [](const size_t total, const BinaryArray &transaction) { return total + transaction.size(); });
+        state.rawBlock = std::move(rawBlock);
+        state.blockTemplate = cachedBlock.getBlock();
+
+        m_downloadedCount++;
+        m_downloadedSize += state.size;
+
+        enforceBufferLimits();
+
+        /* It might have been the one furthest ahead */
+        return m_blocks.count(blockHash) != 0;
+    }
+
+    void BlockDownloadScheduler::releaseBlocks(
+        const boost::uuids::uuid &peer,
+        const std::unordered_set<Crypto::Hash> &hashes)
+    {
+        for (const auto &hash : hashes)
+        {
+            const auto it = m_blocks.find(hash);
+
+            if (it != m_blocks.end() && !it->second.downloaded && !it->second.adding && it->second.peer == peer)
+            {
+                m_blocks.erase(it);
+            }
+        }
+    }
+
+    std::vector<BlockDownloadScheduler::DownloadedBlock> BlockDownloadScheduler::takeReadyBlocks()
+    {
+        const uint32_t topBlockIndex = m_core.getTopBlockIndex();
+
+        /* Downloaded blocks in chain order */
+        std::map<uint32_t, std::vector<Crypto::Hash>> downloaded;
+
+        for (auto it = m_blocks.begin(); it != m_blocks.end();)
+        {
+            const auto &state = it->second;
+
+            /* Way behind the chain - on a fork nobody needs any more */
+            if (state.downloaded && state.blockIndex + BLOCKS_SYNCHRONIZING_MAX_AHEAD < topBlockIndex)
+            {
+                it = eraseBlock(it);
+                continue;
+            }
+
+            if (state.downloaded)
+            {
+                downloaded[state.blockIndex].push_back(it->first);
+            }
+
+            ++it;
+        }
+
+        std::vector<DownloadedBlock> ready;
+
+        Crypto::Hash lastHash;
+        uint32_t lastIndex = 0;
+
+        for (const auto &[blockIndex, hashes] : downloaded)
+        {
+            if (!ready.empty() && blockIndex != lastIndex + 1)
+            {
+                break;
+            }
+
+            bool extended = false;
+
+            for (const auto &hash : hashes)
+            {
+                auto &state = m_blocks.at(hash);
+
+                /* The first block must connect to a block we have, and the
+                   rest must each connect to the block before */
+                const bool connects = ready.empty() ? m_core.hasBlock(state.previousBlockHash)
+                                                    : state.previousBlockHash == lastHash;
+
+                if (connects)
+                {
+                    ready.push_back({std::move(state.rawBlock), std::move(state.blockTemplate), hash, state.peer});
+
+                    lastHash = hash;
+                    lastIndex = blockIndex;
+
+                    /* Keep it in the map until the core has it, so nobody
+                       asks for it again in the meantime */
+                    m_downloadedCount--;
+                    m_downloadedSize -= state.size;
+
+                    state.downloaded = false;
+                    state.adding = true;
+                    state.size = 0;
+
+                    extended = true;
+
+                    break;
+                }
+            }
+
+            if (!ready.empty() && !extended)
+            {
+                break;
+            }
+        }
+
+        return ready;
+    }
+
+    void BlockDownloadScheduler::addingFinished(const std::vector<DownloadedBlock> &blocks)
+    {
+        for (const auto &block : blocks)
+        {
+            const auto it = m_blocks.find(block.hash);
+
+            if (it != m_blocks.end() && it->second.adding)
+            {
+                m_blocks.erase(it);
+            }
+        }
+    }
+
+    void BlockDownloadScheduler::requestSent(const boost::uuids::uuid &peer, const size_t blockCount)
+    {
+        auto &state = m_peers[peer];
+
+        state.requestPending = true;
+        state.requestTime = std::chrono::steady_clock::now();
+        state.requestedCount = blockCount;
+    }
+
+    void BlockDownloadScheduler::responseReceived(const boost::uuids::uuid &peer, const size_t blockCount)
+    {
+        auto &state = m_peers[peer];
+
+        if (state.requestPending && blockCount != 0)
+        {
+            const auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(
+                std::chrono::steady_clock::now() - state.requestTime);
+
+            const double throughput = blockCount * 1000.0 / std::max<int64_t>(1, elapsed.count());
+
+            /* Smooth it out a bit, so one slow response doesn't throw it off */
+            state.throughput = state.throughput == 0 ? throughput : state.throughput * 0.7 + throughput * 0.3;
+        }
+
+        state.requestPending = false;
+    }
+
+    bool BlockDownloadScheduler::isRequestPending(const boost::uuids::uuid &peer) const
+    {
+        const auto it = m_peers.find(peer);
+
+        return it != m_peers.end() && it->second.requestPending;
+    }
+
+    bool BlockDownloadScheduler::hasRequestTimedOut(const boost::uuids::uuid &peer) const
+    {
+        const auto it = m_peers.find(peer);
+
+        if (it == m_peers.end() || !it->second.requestPending)
+        {
+            return false;
+        }
+
+        const auto &state = it->second;
+
+        auto timeout = std::chrono::milliseconds(BLOCKS_SYNCHRONIZING_TIMEOUT * 1000);
+
+        /* A big request to a slow peer can fairly take longer. Give it four
+           times as long as it usually takes. */
+        if (state.throughput != 0 && state.requestedCount != 0)
+        {
+            const auto expected =
+                std::chrono::milliseconds(static_cast<int64_t>(state.requestedCount * 1000 / state.throughput));
+
+            timeout = std::max(timeout, expected * 4);
+        }
+
+        return std::chrono::steady_clock::now() - state.requestTime > timeout;
+    }
+
+    double BlockDownloadScheduler::getPeerThroughput(const boost::uuids::uuid &peer) const
+    {
+        const auto it = m_peers.find(peer);
+
+        return it == m_peers.end() ? 0 : it->second.throughput;
+    }
+
+    void BlockDownloadScheduler::removePeer(const CryptoNoteConnectionContext &context)
+    {
+        for (auto it = m_blocks.begin(); it != m_blocks.end();)
+        {
+            if (!it->second.downloaded && !it->second.adding && it->second.peer == context.m_connection_id)
+            {
+                it = eraseBlock(it);
+            }
+            else
+            {
+                ++it;
+            }
+        }
+
+        /* Work up from the chain to find the downloaded blocks which lead
+           back to it, either directly, through other downloaded blocks, or
+           through blocks we're still waiting on from other peers */
+        std::map<uint32_t, std::vector<Crypto::Hash>> downloaded;
+
+        for (const auto &[hash, state] : m_blocks)
+        {
+            if (state.downloaded)
+            {
+                downloaded[state.blockIndex].push_back(hash);
+            }
+        }
+
+        std::unordered_set<Crypto::Hash> connected;
+
+        for (const auto &[blockIndex, hashes] : downloaded)
+        {
+            for (const auto &hash : hashes)
+            {
+                const auto &previousBlockHash = m_blocks.at(hash).previousBlockHash;
+
+                const auto previousIt = m_blocks.find(previousBlockHash);
+
+                if (connected.count(previousBlockHash) != 0
+                    || (previousIt != m_blocks.end() && !previousIt->second.downloaded)
+                    || m_core.hasBlock(previousBlockHash))
+                {
+                    connected.insert(hash);
+                }
+            }
+        }
+
+        for (auto it = m_blocks.begin(); it != m_blocks.end();)
+        {
+            if (it->second.downloaded && it->second.peer == context.m_connection_id
+                && connected.count(it->first) == 0)
+            {
+                it = eraseBlock(it);
+            }
+            else
+            {
+                ++it;
+            }
+        }
+
+        m_peers.erase(context.m_connection_id);
+    }
+
+    std::unordered_map<Crypto::Hash, BlockDownloadScheduler::BlockState>::iterator
+        BlockDownloadScheduler::eraseBlock(std::unordered_map<Crypto::Hash, BlockState>::iterator it)
+    {
+        if (it->second.downloaded)
+        {
+            m_downloadedCount--;
+            m_downloadedSize -= it->second.size;
+        }
+
+        return m_blocks.erase(it);
+    }
+
+    void BlockDownloadScheduler::enforceBufferLimits()
+    {
+        while (m_downloadedCount > BLOCKS_SYNCHRONIZING_MAX_BUFFERED_COUNT
+               || m_downloadedSize > BLOCKS_SYNCHRONIZING_MAX_BUFFERED_SIZE)
+        {
+            /* The blocks we'll need last */
+            auto furthest = m_blocks.end();
+
+            for (auto it = m_blocks.begin(); it != m_blocks.end(); ++it)
+            {
+                if (it->second.downloaded
+                    && (furthest == m_blocks.end() || it->second.blockIndex > furthest->second.blockIndex))
+                {
+                    furthest = it;
+                }
+            }
+
+            eraseBlock(furthest);
+        }
+    }
+
+    size_t BlockDownloadScheduler::getRequestSize(const boost::uuids::uuid &peer) const
+    {
+        const double throughput = getPeerThroughput(peer);
+
+        double bestThroughput = 0;
+
+        for (const auto &[id, state] : m_peers)
+        {
+            bestThroughput = std::max(bestThroughput, state.throughput);
+        }
+
+        /* Haven't measured this peer yet, give it a full request */
+        if (throughput == 0 || bestThroughput == 0)
+        {
+            return BLOCKS_SYNCHRONIZING_DEFAULT_COUNT;
+        }
+
+        /* Slower peers get smaller requests, so they don't hold up the blocks
+           after them for as long */
+        const auto size = static_cast<size_t>(BLOCKS_SYNCHRONIZING_DEFAULT_COUNT * throughput / bestThroughput);
+
+        return std::clamp<size_t>(size, BLOCKS_SYNCHRONIZING_MIN_COUNT, BLOCKS_SYNCHRONIZING_DEFAULT_COUNT);
+    }
+} // namespace CryptoNote
@@ -0,0 +1,167 @@
+// Copyright (c) 2018-2019, The TurtleCoin Developers
+//
+// Please see the included LICENSE file for more information.
+
+#pragma once
+
+#include "cryptonotecore/ICore.h"
+#include "p2p/ConnectionContext.h"
+
+#include <boost/functional/hash.hpp>
+#include <boost/uuid/uuid.hpp>
+#include <chrono>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+namespace CryptoNote
+{
+    /* Shares out the blocks we need between every peer we are syncing from,
+       and puts the downloaded blocks back into chain order. Peers which
+       respond faster get sent bigger requests, and blocks which a peer
+       doesn't deliver in time can be requested from another peer.
+
+       Only used from the dispatcher thread, so needs no locking. */
+    class BlockDownloadScheduler
+    {
+      public:
+        /* A block which is ready to be added to the chain */
+        struct DownloadedBlock
+        {
+            RawBlock rawBlock;
+
+            BlockTemplate blockTemplate;
+
+            Crypto::Hash hash;
+
+            /* The peer which sent us the block */
+            boost::uuids::uuid peer;
+        };
+
+        /////////////////
+        /* CONSTRUCTOR */
+        /////////////////
+        explicit BlockDownloadScheduler(ICore &core);
+
+        /////////////////////////////
+        /* PUBLIC MEMBER FUNCTIONS */
+        /////////////////////////////
+
+        /* Picks the next blocks to request from this peer, out of the ones
+           it has told us it has in context.m_needed_objects. Blocks which are
+           being downloaded from another peer are skipped, unless that peer
+           has timed out. Returns nothing if there is nothing for this peer
+           to do right now. */
+        std::vector<Crypto::Hash> takeBlocks(CryptoNoteConnectionContext &context);
+
+        /* Stores a block received from a peer. Returns false if we already
+           have it from another peer, didn't ask for it, or it is too far
+           ahead of the chain. If we're holding too many blocks, the ones
+           furthest ahead are dropped, to be requested again later. */
+        bool addDownloadedBlock(const boost::uuids::uuid &peer, RawBlock &&rawBlock, const CachedBlock &cachedBlock);
+
+        /* Blocks we requested from this peer which it did not send us. They
+           will be requested from another peer. */
+        void releaseBlocks(const boost::uuids::uuid &peer, const std::unordered_set<Crypto::Hash> &hashes);
+
+        /* Takes the downloaded blocks which are now next in line to be
+           added to the chain, in the order they should be added. They are
+           marked as being added, so they aren't requested again while the
+           core works through them, until addingFinished is called. */
+        std::vector<DownloadedBlock> takeReadyBlocks();
+
+        /* The core is done with these blocks from takeReadyBlocks, whether
+           or not they were added. Any not added are free to be requested
+           again. */
+        void addingFinished(const std::vector<DownloadedBlock> &blocks);
+
+        /* blockCount is zero for a chain request */
+        void requestSent(const boost::uuids::uuid &peer, const size_t blockCount);
+
+        void responseReceived(const boost::uuids::uuid &peer, const size_t blockCount);
+
+        bool isRequestPending(const boost::uuids::uuid &peer) const;
+
+        /* Whether the peer has had long enough to answer its last request.
+           Gives faster peers less time to answer small requests, but never
+           less than BLOCKS_SYNCHRONIZING_TIMEOUT. */
+        bool hasRequestTimedOut(const boost::uuids::uuid &peer) const;
+
+        /* Blocks per second the peer has been sending us, or zero if we
+           haven't downloaded anything from it yet */
+        double getPeerThroughput(const boost::uuids::uuid &peer) const;
+
+        /* Forget a disconnected peer, and let other peers download any blocks
+           we were waiting on it for. The blocks it sent us which don't lead
+           back to the chain are dropped too. */
+        void removePeer(const CryptoNoteConnectionContext &context);
+
+      private:
+        /* A block we have requested, downloaded, or are adding to the chain.
+           Blocks not in the map are free to be requested. */
+        struct BlockState
+        {
+            /* The peer we requested it from, or downloaded it from */
+            boost::uuids::uuid peer;
+
+            std::chrono::steady_clock::time_point requestTime;
+
+            bool downloaded = false;
+
+            /* Handed to the core by takeReadyBlocks, and not yet added */
+            bool adding = false;
+
+            uint32_t blockIndex = 0;
+
+            Crypto::Hash previousBlockHash;
+
+            /* Bytes of block and transaction blobs */
+            size_t size = 0;
+
+            RawBlock rawBlock;
+
+            BlockTemplate blockTemplate;
+        };
+
+        struct PeerState
+        {
+            bool requestPending = false;
+
+            std::chrono::steady_clock::time_point requestTime;
+
+            /* How many blocks the pending request asked for */
+            size_t requestedCount = 0;
+
+            /* Moving average of blocks per second */
+            double throughput = 0;
+        };
+
+        //////////////////////////////
+        /* PRIVATE MEMBER FUNCTIONS */
+        //////////////////////////////
+        size_t getRequestSize(const boost::uuids::uuid &peer) const;
+
+        /* Keeps the downloaded block totals right */
+        std::unordered_map<Crypto::Hash, BlockState>::iterator
+            eraseBlock(std::unordered_map<Crypto::Hash, BlockState>::iterator it);
+
+        /* Drops the downloaded blocks furthest ahead of the chain until we're
+           back under the buffer limits */
+        void enforceBufferLimits();
+
+        /////////////////////////
+        /* PRIVATE MEMBER VARS */
+        /////////////////////////
+
+        ICore &m_core;
+
+        std::unordered_map<Crypto::Hash, BlockState> m_blocks;
+
+        /* How many of m_blocks are downloaded, and their total size */
+        size_t m_downloadedCount = 0;
+
+        size_t m_downloadedSize = 0;
+
+        std::unordered_map<boost::uuids::uuid, PeerState, boost::hash<boost::uuids::uuid>> m_peers;
+    };
+} // namespace CryptoNote
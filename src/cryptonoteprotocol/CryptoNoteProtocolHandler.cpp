@@ -7,6 +7,7 @@
 #include "CryptoNoteProtocolHandler.h"
 
 #include "common/CryptoNoteTools.h"
+#include "common/ScopeExit.h"
 #include "cryptonotecore/CryptoNoteBasicImpl.h"
 #include "cryptonotecore/CryptoNoteFormatUtils.h"
 #include "cryptonotecore/Currency.h"
@@ -192,6 +193,7 @@ namespace CryptoNote
         m_observedHeight(0),
         m_blockchainHeight(0),
         m_peersCount(0),
+        m_downloadScheduler(rcore),
         logger(log, "protocol")
     {
         if (!m_p2p)
@@ -238,6 +240,8 @@ namespace CryptoNote
             m_observerManager.notify(&ICryptoNoteProtocolObserver::lastKnownBlockHeightUpdated, m_observedHeight);
         }
 
+        m_downloadScheduler.removePeer(context);
+
         if (context.m_state != CryptoNoteConnectionContext::state_befor_handshake)
         {
             m_peersCount--;
@@ -263,6 +267,7 @@ namespace CryptoNote
             r.block_ids = m_core.buildSparseChain();
             logger(Logging::TRACE) << context << "-->>NOTIFY_REQUEST_CHAIN: m_block_ids.size()=" << r.block_ids.size();
             post_notify<NOTIFY_REQUEST_CHAIN>(*m_p2p, r, context);
+            m_downloadScheduler.requestSent(context.m_connection_id, 0);
         }
 
         return true;
@@ -505,6 +510,7 @@ namespace CryptoNote
             r.block_ids = m_core.buildSparseChain();
             logger(Logging::TRACE) << context << "-->>NOTIFY_REQUEST_CHAIN: m_block_ids.size()=" << r.block_ids.size();
             post_notify<NOTIFY_REQUEST_CHAIN>(*m_p2p, r, context);
+            m_downloadScheduler.requestSent(context.m_connection_id, 0);
         }
         else
         {
@@ -617,16 +623,16 @@ namespace CryptoNote
 
         updateObservedHeight(arg.current_blockchain_height, context);
         context.m_remote_blockchain_height = arg.current_blockchain_height;
-        std::vector<BlockTemplate> blockTemplates;
-        std::vector<CachedBlock> cachedBlocks;
-        blockTemplates.resize(arg.blocks.size());
-        cachedBlocks.reserve(arg.blocks.size());
 
         std::vector<RawBlock> rawBlocks = convertRawBlocksLegacyToRawBlocks(arg.blocks);
 
+        size_t receivedCount = 0;
+
         for (size_t index = 0; index < rawBlocks.size(); ++index)
         {
-            if (!fromBinaryArray(blockTemplates[index], rawBlocks[index].block))
+            BlockTemplate blockTemplate;
+
+            if (!fromBinaryArray(blockTemplate, rawBlocks[index].block))
             {
                 logger(Logging::ERROR) << context << "sent wrong block: failed to parse and validate block: \r\n"
                                        << toHex(rawBlocks[index].block) << "\r\n dropping connection";
@@ -634,35 +640,24 @@ namespace CryptoNote
                 return 1;
             }
 
-            cachedBlocks.emplace_back(blockTemplates[index]);
-            if (index == 1)
-            {
-                if (m_core.hasBlock(cachedBlocks.back().getBlockHash()))
-                { // TODO
-                    context.m_state = CryptoNoteConnectionContext::state_idle;
-                    context.m_needed_objects.clear();
-                    context.m_requested_objects.clear();
-                    logger(Logging::DEBUGGING) << context << "Connection set to idle state.";
-                    return 1;
-                }
-            }
+            const CachedBlock cachedBlock(blockTemplate);
 
-            auto req_it = context.m_requested_objects.find(cachedBlocks.back().getBlockHash());
+            auto req_it = context.m_requested_objects.find(cachedBlock.getBlockHash());
             if (req_it == context.m_requested_objects.end())
             {
                 logger(Logging::ERROR) << context << "sent wrong NOTIFY_RESPONSE_GET_OBJECTS: block with id="
-                                       << Common::podToHex(cachedBlocks.back().getBlockHash())
+                                       << Common::podToHex(cachedBlock.getBlockHash())
                                        << " wasn't requested, dropping connection";
                 context.m_state = CryptoNoteConnectionContext::state_shutdown;
                 return 1;
             }
 
-            if (cachedBlocks.back().getBlock().transactionHashes.size() != rawBlocks[index].transactions.size())
+            if (cachedBlock.getBlock().transactionHashes.size() != rawBlocks[index].transactions.size())
             {
                 logger(Logging::ERROR) << context << "sent wrong NOTIFY_RESPONSE_GET_OBJECTS: block with id="
-                                       << Common::podToHex(cachedBlocks.back().getBlockHash())
+                                       << Common::podToHex(cachedBlock.getBlockHash())
                                        << ", transactionHashes.size()="
-                                       << cachedBlocks.back().getBlock().transactionHashes.size()
+                                       << cachedBlock.getBlock().transactionHashes.size()
                                        << " mismatch with block_complete_entry.m_txs.size()="
                                        << rawBlocks[index].transactions.size() << ", dropping connection";
                 context.m_state = CryptoNoteConnectionContext::state_shutdown;
@@ -670,19 +665,39 @@ namespace CryptoNote
             }
 
             context.m_requested_objects.erase(req_it);
+
+            /* We may have got it from another peer in the meantime */
+            if (m_downloadScheduler.addDownloadedBlock(
+                    context.m_connection_id, std::move(rawBlocks[index]), cachedBlock))
+            {
+                receivedCount++;
+            }
         }
 
         if (context.m_requested_objects.size())
         {
-            logger(Logging::ERROR, Logging::BRIGHT_RED)
-                << context << "returned not all requested objects (context.m_requested_objects.size()="
-                << context.m_requested_objects.size() << "), dropping connection";
-            context.m_state = CryptoNoteConnectionContext::state_shutdown;
-            return 1;
+            /* A peer which sends us nothing at all is no use to us */
+            if (rawBlocks.empty())
+            {
+                logger(Logging::ERROR, Logging::BRIGHT_RED)
+                    << context << "returned none of the requested objects (context.m_requested_objects.size()="
+                    << context.m_requested_objects.size() << "), dropping connection";
+                context.m_state = CryptoNoteConnectionContext::state_shutdown;
+                return 1;
+            }
+
+            /* Otherwise, get the rest from whoever can give them to us */
+            logger(Logging::DEBUGGING) << context << "returned not all requested objects, "
+                                       << context.m_requested_objects.size() << " will be requested from other peers";
+
+            m_downloadScheduler.releaseBlocks(context.m_connection_id, context.m_requested_objects);
+            context.m_requested_objects.clear();
         }
 
+        m_downloadScheduler.responseReceived(context.m_connection_id, receivedCount);
+
         {
-            int result = processObjects(context, std::move(rawBlocks), cachedBlocks);
+            int result = processObjects(context);
             if (result != 0)
             {
                 return result;
@@ -698,51 +713,121 @@ namespace CryptoNote
         return 1;
     }
 
-    int CryptoNoteProtocolHandler::processObjects(
-        CryptoNoteConnectionContext &context,
-        std::vector<RawBlock> &&rawBlocks,
-        const std::vector<CachedBlock> &cachedBlocks)
+    int CryptoNoteProtocolHandler::processObjects(CryptoNoteConnectionContext &context)
     {
-        assert(rawBlocks.size() == cachedBlocks.size());
-        for (size_t index = 0; index < rawBlocks.size(); ++index)
+        /* Add whichever of the blocks we have downloaded, from this peer and
+           any other, are now next in line for the chain */
+        auto readyBlocks = m_downloadScheduler.takeReadyBlocks();
+
+        if (readyBlocks.empty())
         {
-            if (m_stop)
-            {
-                break;
-            }
+            return 0;
+        }
 
-            auto addResult = m_core.addBlock(cachedBlocks[index], std::move(rawBlocks[index]));
-            if (addResult == error::AddBlockErrorCondition::BLOCK_VALIDATION_FAILED
-                || addResult == error::AddBlockErrorCondition::TRANSACTION_VALIDATION_FAILED
-                || addResult == error::AddBlockErrorCondition::DESERIALIZATION_FAILED)
-            {
-                logger(Logging::DEBUGGING)
-                    << context << "Block verification failed, dropping connection: " << addResult.message();
-                context.m_state = CryptoNoteConnectionContext::state_shutdown;
-                return 1;
-            }
-            else if (addResult == error::AddBlockErrorCondition::BLOCK_REJECTED)
+        std::vector<RawBlock> rawBlocks;
+        std::vector<CachedBlock> cachedBlocks;
+
+        rawBlocks.reserve(readyBlocks.size());
+        cachedBlocks.reserve(readyBlocks.size());
+
+        for (auto &block : readyBlocks)
+        {
+            rawBlocks.push_back(std::move(block.rawBlock));
+            cachedBlocks.emplace_back(block.blockTemplate);
+        }
+
+        /* Until the core is done with them, the blocks stay marked as being
+           added, so they aren't requested again while we yield */
+        Tools::ScopeExit finishAdding([&]() { m_downloadScheduler.addingFinished(readyBlocks); });
+
+        /* The block might have come from another peer than the one we're
+           handling the response of. Only looked up when a block fails, as we
+           stop adding the batch there - and other connections can come and
+           go while we yield, so we can't look them up beforehand. */
+        const auto findSource = [&](const boost::uuids::uuid &peer)
+        {
+            CryptoNoteConnectionContext *source = nullptr;
+
+            if (peer == context.m_connection_id)
             {
-                logger(Logging::INFO) << context
-                                      << "Block received at sync phase was marked as orphaned, dropping connection: "
-                                      << addResult.message();
-                context.m_state = CryptoNoteConnectionContext::state_shutdown;
-                return 1;
+                return &context;
             }
-            else if (addResult == error::AddBlockErrorCode::ALREADY_EXISTS)
+
+            m_p2p->for_each_connection(
+                [&](CryptoNoteConnectionContext &connection, uint64_t)
+                {
+                    if (connection.m_connection_id == peer)
+                    {
+                        source = &connection;
+                    }
+                });
+
+            return source;
+        };
+
+        int result = 0;
+
+        m_core.addBlocks(
+            cachedBlocks,
+            std::move(rawBlocks),
+            [&](const size_t index, const std::error_code &addResult)
             {
-                logger(Logging::DEBUGGING)
-                    << context << "Block already exists, switching to idle state: " << addResult.message();
-                context.m_state = CryptoNoteConnectionContext::state_idle;
-                context.m_needed_objects.clear();
-                context.m_requested_objects.clear();
-                return 1;
-            }
+                if (addResult == error::AddBlockErrorCondition::BLOCK_VALIDATION_FAILED
+                    || addResult == error::AddBlockErrorCondition::TRANSACTION_VALIDATION_FAILED
+                    || addResult == error::AddBlockErrorCondition::DESERIALIZATION_FAILED)
+                {
+                    logger(Logging::DEBUGGING) << "Block verification failed, dropping connection: "
+                                               << addResult.message();
 
-            m_dispatcher.yield();
-        }
+                    CryptoNoteConnectionContext *source = findSource(readyBlocks[index].peer);
 
-        return 0;
+                    if (source != nullptr)
+                    {
+                        source->m_state = CryptoNoteConnectionContext::state_shutdown;
+                    }
+
+                    result = source == &context ? 1 : result;
+                    return false;
+                }
+                else if (addResult == error::AddBlockErrorCondition::BLOCK_REJECTED)
+                {
+                    logger(Logging::INFO) << "Block received at sync phase was marked as orphaned, dropping connection: "
+                                          << addResult.message();
+
+                    CryptoNoteConnectionContext *source = findSource(readyBlocks[index].peer);
+
+                    if (source != nullptr)
+                    {
+                        source->m_state = CryptoNoteConnectionContext::state_shutdown;
+                    }
+
+                    result = source == &context ? 1 : result;
+                    return false;
+                }
+                else if (addResult == error::AddBlockErrorCode::ALREADY_EXISTS)
+                {
+                    logger(Logging::DEBUGGING) << "Block already exists, switching to idle state: "
+                                               << addResult.message();
+
+                    CryptoNoteConnectionContext *source = findSource(readyBlocks[index].peer);
+
+                    if (source != nullptr)
+                    {
+                        source->m_state = CryptoNoteConnectionContext::state_idle;
+                        source->m_needed_objects.clear();
+                        source->m_requested_objects.clear();
+                    }
+
+                    result = source == &context ? 1 : result;
+                    return false;
+                }
+
+                m_dispatcher.yield();
+
+                return !m_stop;
+            });
+
+        return result;
     }
 
     int CryptoNoteProtocolHandler::doPushLiteBlock(
@@ -858,6 +943,7 @@ namespace CryptoNote
                 logger(Logging::TRACE) << context
                                        << "-->>NOTIFY_REQUEST_CHAIN: m_block_ids.size()=" << r.block_ids.size();
                 post_notify<NOTIFY_REQUEST_CHAIN>(*m_p2p, r, context);
+                m_downloadScheduler.requestSent(context.m_connection_id, 0);
             }
             else
             {
@@ -935,26 +1021,29 @@ namespace CryptoNote
         CryptoNoteConnectionContext &context,
         bool check_having_blocks)
     {
+        std::vector<Crypto::Hash> blocks;
+
         if (context.m_needed_objects.size())
+        {
+            blocks = m_downloadScheduler.takeBlocks(context);
+        }
+
+        if (!blocks.empty())
         {
             // we know objects that we need, request this objects
             NOTIFY_REQUEST_GET_OBJECTS::request req;
-            size_t count = 0;
-            auto it = context.m_needed_objects.begin();
-
-            while (it != context.m_needed_objects.end() && count < BLOCKS_SYNCHRONIZING_DEFAULT_COUNT)
-            {
-                if (!(check_having_blocks && m_core.hasBlock(*it)))
-                {
-                    req.blocks.push_back(*it);
-                    ++count;
-                    context.m_requested_objects.insert(*it);
-                }
-                it = context.m_needed_objects.erase(it);
-            }
+            req.blocks = std::move(blocks);
+            context.m_requested_objects.insert(req.blocks.begin(), req.blocks.end());
             logger(Logging::TRACE) << context << "-->>NOTIFY_REQUEST_GET_OBJECTS: blocks.size()=" << req.blocks.size()
                                    << ", txs.size()=" << req.txs.size();
             post_notify<NOTIFY_REQUEST_GET_OBJECTS>(*m_p2p, req, context);
+            m_downloadScheduler.requestSent(context.m_connection_id, req.blocks.size());
+        }
+        else if (context.m_needed_objects.size())
+        {
+            // everything this peer can give us is being downloaded from other peers, onIdle() will
+            // give it more to do once they are done or time out
+            logger(Logging::TRACE) << context << "Waiting on other peers to send blocks";
         }
         else if (context.m_last_response_height < context.m_remote_blockchain_height - 1)
         { // we have to fetch more objects ids, request blockchain entry
@@ -963,6 +1052,7 @@ namespace CryptoNote
             r.block_ids = m_core.buildSparseChain();
             logger(Logging::TRACE) << context << "-->>NOTIFY_REQUEST_CHAIN: m_block_ids.size()=" << r.block_ids.size();
             post_notify<NOTIFY_REQUEST_CHAIN>(*m_p2p, r, context);
+            m_downloadScheduler.requestSent(context.m_connection_id, 0);
         }
         else
         {
@@ -989,6 +1079,58 @@ namespace CryptoNote
         return true;
     }
 
+    void CryptoNoteProtocolHandler::onIdle()
+    {
+        if (m_stop)
+        {
+            return;
+        }
+
+        std::vector<CryptoNoteConnectionContext *> idlePeers;
+
+        m_p2p->for_each_connection(
+            [&](CryptoNoteConnectionContext &context, uint64_t)
+            {
+                /* Give whatever it was meant to send us to someone else, and
+                   close the connection, so a silent peer doesn't keep its slot */
+                if (context.m_state == CryptoNoteConnectionContext::state_synchronizing
+                    && m_downloadScheduler.hasRequestTimedOut(context.m_connection_id))
+                {
+                    logger(Logging::DEBUGGING) << context << "didn't answer our request in time, dropping connection";
+
+                    m_downloadScheduler.removePeer(context);
+
+                    context.m_requested_objects.clear();
+                    context.m_state = CryptoNoteConnectionContext::state_shutdown;
+
+                    m_p2p->drop_connection(context);
+
+                    return;
+                }
+
+                if (context.m_state == CryptoNoteConnectionContext::state_synchronizing
+                    && !m_downloadScheduler.isRequestPending(context.m_connection_id))
+                {
+                    idlePeers.push_back(&context);
+                }
+            });
+
+        /* Fastest peers first, so they get the blocks we need soonest */
+        std::sort(
+            idlePeers.begin(),
+            idlePeers.end(),
+            [this](const auto a, const auto b)
+            {
+                return m_downloadScheduler.getPeerThroughput(a->m_connection_id)
+                       > m_downloadScheduler.getPeerThroughput(b->m_connection_id);
+            });
+
+        for (auto context : idlePeers)
+        {
+            request_missing_objects(*context, false);
+        }
+    }
+
     bool CryptoNoteProtocolHandler::on_connection_synchronized()
     {
         bool val_expected = false;
@@ -1026,6 +1168,8 @@ namespace CryptoNote
                                << "NOTIFY_RESPONSE_CHAIN_ENTRY: m_block_ids.size()=" << arg.m_block_ids.size()
                                << ", m_start_height=" << arg.start_height << ", m_total_height=" << arg.total_height;
 
+        m_downloadScheduler.responseReceived(context.m_connection_id, 0);
+
         if (!arg.m_block_ids.size())
         {
             logger(Logging::ERROR) << context << "sent empty m_block_ids, dropping connection";
@@ -1041,6 +1185,15 @@ namespace CryptoNote
             return 1;
         }
 
+        /* Once, for the whole chain, rather than for each batch of blocks we
+           download from it */
+        if (!m_core.verifyCheckpointChain(arg.start_height, arg.m_block_ids))
+        {
+            logger(Logging::ERROR) << context << "sent m_block_ids which don't match our checkpoints, dropping connection";
+            context.m_state = CryptoNoteConnectionContext::state_shutdown;
+            return 1;
+        }
+
         context.m_remote_blockchain_height = arg.total_height;
         context.m_last_response_height = arg.start_height + static_cast<uint32_t>(arg.m_block_ids.size()) - 1;
 
@@ -6,6 +6,7 @@
 
 #pragma once
 
+#include "cryptonoteprotocol/BlockDownloadScheduler.h"
 #include "cryptonotecore/ICore.h"
 #include "cryptonoteprotocol/CryptoNoteProtocolDefinitions.h"
 #include "cryptonoteprotocol/CryptoNoteProtocolHandlerCommon.h"
@@ -86,6 +87,10 @@ namespace CryptoNote
 
         void requestMissingPoolTransactions(const CryptoNoteConnectionContext &context);
 
+        /* Called periodically by the node server. Hands out blocks to any
+           syncing peers which aren't currently downloading anything. */
+        void onIdle();
+
       private:
         //----------------- commands handlers ----------------------------------------------
         int handle_notify_new_block(int command, NOTIFY_NEW_BLOCK::request &arg, CryptoNoteConnectionContext &context);
@@ -143,10 +148,7 @@ namespace CryptoNote
 
         void recalculateMaxObservedHeight(const CryptoNoteConnectionContext &context);
 
-        int processObjects(
-            CryptoNoteConnectionContext &context,
-            std::vector<RawBlock> &&rawBlocks,
-            const std::vector<CachedBlock> &cachedBlocks);
+        int processObjects(CryptoNoteConnectionContext &context);
 
         Logging::LoggerRef logger;
 
@@ -182,5 +184,7 @@ namespace CryptoNote
         std::atomic<size_t> m_peersCount;
 
         Tools::ObserverManager<ICryptoNoteProtocolObserver> m_observerManager;
+
+        BlockDownloadScheduler m_downloadScheduler;
     };
 } // namespace CryptoNote
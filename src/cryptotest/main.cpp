@@ -4,15 +4,45 @@
 
 #include "CryptoNote.h"
 #include "CryptoTypes.h"
+#include "common/CryptoNoteTools.h"
+#include "common/FileSystemShim.h"
 #include "common/StringTools.h"
+#include "common/TransactionExtra.h"
+#include "crypto/chukwa.h"
 #include "crypto/crypto.h"
 #include "crypto/multisig.h"
 
 #include <assert.h>
 #include <chrono>
+#include <condition_variable>
 #include <config/CliHeader.h>
+#include <cryptonotecore/BlockchainUtils.h>
+#include <cryptonotecore/Core.h>
+#include <cryptonotecore/DatabaseBlockchainCache.h>
+#include <cryptonotecore/DatabaseBlockchainCacheFactory.h>
+#include <cryptonotecore/KeyImageFilter.h>
+#include <cryptonotecore/LevelDBWrapper.h>
+#include <cryptonotecore/MainChainStorage.h>
+#include <cryptonotecore/Mixins.h>
+#include <cryptonotecore/TransactionApi.h>
+#include <cryptonotecore/TransactionPool.h>
+#include <cryptonotecore/TransactionPoolSnapshot.h>
+#include <cryptonotecore/WalletSyncCache.h>
+#include <cryptonoteprotocol/CryptoNoteProtocolHandler.h>
 #include <cxxopts.hpp>
+#include <future>
 #include <iostream>
+#include <logging/DummyLogger.h>
+#include <map>
+#include <p2p/NetNode.h>
+#include <p2p/NetNodeConfig.h>
+#include <queue>
+#include <set>
+#include <system/Context.h>
+#include <system/Dispatcher.h>
+#include <system/Timer.h>
+#include <thread>
+#include <utilities/ThreadPool.h>
 
 #define PERFORMANCE_ITERATIONS 1000
 #define PERFORMANCE_ITERATIONS_LONG_MULTIPLIER 10
@@ -278,6 +308,1572 @@ void benchmarkGenerateKeyDerivation()
     std::cout << "Time to perform generateKeyDerivation: " << timePerDerivation / 1000.0 << " ms" << std::endl;
 }
 
+/* Builds a block worth of ring signatures, where the decoys are drawn from a
+   shared set of outputs, as they would be on the real chain */
+std::vector<Crypto::RingSignatureBatchEntry> generateRingSignatureBlock(
+    const size_t inputCount,
+    const size_t ringSize,
+    const size_t outputCount)
+{
+    std::vector<Crypto::PublicKey> outputs(outputCount);
+
+    for (auto &output : outputs)
+    {
+        Crypto::SecretKey unused;
+        Crypto::generate_keys(output, unused);
+    }
+
+    Crypto::Hash prefixHash;
+    Crypto::cn_fast_hash(INPUT_DATA.data(), INPUT_DATA.size(), prefixHash);
+
+    std::vector<Crypto::RingSignatureBatchEntry> entries;
+
+    for (size_t i = 0; i < inputCount; i++)
+    {
+        Crypto::PublicKey realPublicKey;
+        Crypto::SecretKey realSecretKey;
+        Crypto::generate_keys(realPublicKey, realSecretKey);
+
+        Crypto::KeyImage keyImage;
+        Crypto::generate_key_image(realPublicKey, realSecretKey, keyImage);
+
+        const uint64_t realOutput = i % ringSize;
+
+        std::vector<Crypto::PublicKey> ring;
+
+        for (size_t j = 0; j < ringSize; j++)
+        {
+            ring.push_back(j == realOutput ? realPublicKey : outputs[(i * 7 + j * 13) % outputCount]);
+        }
+
+        const auto [success, signatures] =
+            Crypto::crypto_ops::generateRingSignatures(prefixHash, keyImage, ring, realSecretKey, realOutput);
+
+        if (!success)
+        {
+            std::cout << "Failed to generate ring signatures!\nTerminating...";
+
+            exit(1);
+        }
+
+        entries.push_back({prefixHash, keyImage, ring, signatures});
+    }
+
+    return entries;
+}
+
+void benchmarkCheckRingSignatures()
+{
+    const auto entries = generateRingSignatureBlock(200, 4, 250);
+
+    const uint64_t loopIterations = 50;
+
+    auto startTimer = std::chrono::high_resolution_clock::now();
+
+    for (uint64_t i = 0; i < loopIterations; i++)
+    {
+        for (const auto &entry : entries)
+        {
+            if (!Crypto::crypto_ops::checkRingSignature(
+                    entry.prefixHash, entry.keyImage, entry.publicKeys, entry.signatures))
+            {
+                std::cout << "Failed to verify ring signature!\nTerminating...";
+
+                exit(1);
+            }
+        }
+    }
+
+    auto elapsedTime = std::chrono::high_resolution_clock::now() - startTimer;
+
+    const auto timePerBlock =
+        std::chrono::duration_cast<std::chrono::microseconds>(elapsedTime).count() / loopIterations;
+
+    std::cout << "Time to perform checkRingSignature for " << entries.size()
+              << " inputs: " << timePerBlock / 1000.0 << " ms" << std::endl;
+
+    startTimer = std::chrono::high_resolution_clock::now();
+
+    for (uint64_t i = 0; i < loopIterations; i++)
+    {
+        const auto [valid, failedIndex] = Crypto::crypto_ops::checkRingSignatures(entries);
+
+        if (!valid)
+        {
+            std::cout << "Failed to batch verify ring signature " << failedIndex << "!\nTerminating...";
+
+            exit(1);
+        }
+    }
+
+    elapsedTime = std::chrono::high_resolution_clock::now() - startTimer;
+
+    const auto timePerBatch =
+        std::chrono::duration_cast<std::chrono::microseconds>(elapsedTime).count() / loopIterations;
+
+    std::cout << "Time to perform checkRingSignatures for " << entries.size()
+              << " inputs: " << timePerBatch / 1000.0 << " ms" << std::endl;
+}
+
+/* Scans a block worth of transactions for several wallets, once one wallet
+   at a time, and once with all the view keys batched together */
+void benchmarkOutputScanning()
+{
+    const size_t walletCount = 8;
+    const size_t transactionCount = 100;
+    const size_t outputsPerTransaction = 4;
+
+    std::vector<Crypto::SecretKey> privateViewKeys(walletCount);
+
+    for (auto &privateViewKey : privateViewKeys)
+    {
+        Crypto::PublicKey unused;
+        Crypto::generate_keys(unused, privateViewKey);
+    }
+
+    std::vector<std::tuple<Crypto::PublicKey, std::vector<Crypto::PublicKey>>> transactions(transactionCount);
+
+    for (auto &[txPublicKey, outputKeys] : transactions)
+    {
+        Crypto::SecretKey unused;
+        Crypto::generate_keys(txPublicKey, unused);
+
+        outputKeys.resize(outputsPerTransaction);
+
+        for (auto &outputKey : outputKeys)
+        {
+            Crypto::generate_keys(outputKey, unused);
+        }
+    }
+
+    const uint64_t outputCount = walletCount * transactionCount * outputsPerTransaction;
+
+    Crypto::KeyDerivation derivation;
+    Crypto::PublicKey spendKey;
+
+    auto startTimer = std::chrono::high_resolution_clock::now();
+
+    for (const auto &privateViewKey : privateViewKeys)
+    {
+        for (const auto &[txPublicKey, outputKeys] : transactions)
+        {
+            Crypto::generate_key_derivation(txPublicKey, privateViewKey, derivation);
+
+            for (size_t i = 0; i < outputKeys.size(); i++)
+            {
+                Crypto::underive_public_key(derivation, i, outputKeys[i], spendKey);
+            }
+        }
+    }
+
+    auto elapsedTime = std::chrono::high_resolution_clock::now() - startTimer;
+
+    std::cout << "Output scanning, " << walletCount << " wallets one at a time: "
+              << outputCount * 1000000 / std::max<int64_t>(
+                     1, std::chrono::duration_cast<std::chrono::microseconds>(elapsedTime).count())
+              << " outputs/s" << std::endl;
+
+    std::vector<Crypto::KeyDerivation> derivations;
+    std::vector<Crypto::PublicKey> spendKeys;
+
+    startTimer = std::chrono::high_resolution_clock::now();
+
+    for (const auto &[txPublicKey, outputKeys] : transactions)
+    {
+        Crypto::crypto_ops::generateKeyDerivations(txPublicKey, privateViewKeys, derivations);
+
+        for (size_t i = 0; i < outputKeys.size(); i++)
+        {
+            Crypto::crypto_ops::underivePublicKeys(derivations, i, outputKeys[i], spendKeys);
+        }
+    }
+
+    elapsedTime = std::chrono::high_resolution_clock::now() - startTimer;
+
+    std::cout << "Output scanning, " << walletCount << " wallets batched: "
+              << outputCount * 1000000 / std::max<int64_t>(
+                     1, std::chrono::duration_cast<std::chrono::microseconds>(elapsedTime).count())
+              << " outputs/s" << std::endl;
+}
+
+/* The thread pool as it was before the work stealing scheduler - one
+   queue behind one mutex, and a promise per job - to compare against */
+class LegacyThreadPool
+{
+  public:
+    LegacyThreadPool(): m_shouldStop(false)
+    {
+        for (uint64_t i = 0; i < std::max(1u, std::thread::hardware_concurrency()); i++)
+        {
+            m_threads.push_back(std::thread(&LegacyThreadPool::waitForJob, this));
+        }
+    }
+
+    ~LegacyThreadPool()
+    {
+        {
+            std::scoped_lock<std::mutex> lock(m_mutex);
+            m_shouldStop = true;
+        }
+
+        m_haveJob.notify_all();
+
+        for (auto &thread : m_threads)
+        {
+            thread.join();
+        }
+    }
+
+    std::future<void> addJob(const std::function<void()> job)
+    {
+        std::promise<void> promise;
+
+        std::future<void> result = promise.get_future();
+
+        std::unique_lock<std::mutex> lock(m_mutex);
+
+        m_queue.push({job, std::move(promise)});
+
+        lock.unlock();
+
+        m_haveJob.notify_one();
+
+        return result;
+    }
+
+  private:
+    void waitForJob()
+    {
+        while (true)
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+
+            m_haveJob.wait(lock, [&] { return m_shouldStop || !m_queue.empty(); });
+
+            if (m_shouldStop)
+            {
+                return;
+            }
+
+            auto [job, result] = std::move(m_queue.front());
+
+            m_queue.pop();
+
+            lock.unlock();
+
+            job();
+
+            result.set_value();
+        }
+    }
+
+    std::vector<std::thread> m_threads;
+
+    bool m_shouldStop;
+
+    std::condition_variable m_haveJob;
+
+    std::mutex m_mutex;
+
+    std::queue<std::tuple<std::function<void()>, std::promise<void>>> m_queue;
+};
+
+void benchmarkThreadPool()
+{
+    const uint64_t jobCount = 1000000;
+
+    std::atomic<uint64_t> counter(0);
+
+    auto startTimer = std::chrono::high_resolution_clock::now();
+
+    {
+        LegacyThreadPool legacyThreadPool;
+
+        std::vector<std::future<void>> futures;
+
+        futures.reserve(jobCount);
+
+        for (uint64_t i = 0; i < jobCount; i++)
+        {
+            futures.push_back(legacyThreadPool.addJob([&counter] { counter++; }));
+        }
+
+        for (auto &future : futures)
+        {
+            future.get();
+        }
+    }
+
+    auto elapsedTime = std::chrono::high_resolution_clock::now() - startTimer;
+
+    std::cout << "Old ThreadPool addJob throughput: "
+              << jobCount * 1000 / std::max<int64_t>(
+                     1, std::chrono::duration_cast<std::chrono::milliseconds>(elapsedTime).count())
+              << " jobs/s" << std::endl;
+
+    Utilities::ThreadPool threadPool;
+
+    startTimer = std::chrono::high_resolution_clock::now();
+
+    /* One future per job - the pattern the pool was previously limited to */
+    std::vector<std::future<void>> futures;
+
+    futures.reserve(jobCount);
+
+    for (uint64_t i = 0; i < jobCount; i++)
+    {
+        futures.push_back(threadPool.addJob([&counter] { counter++; }));
+    }
+
+    for (auto &future : futures)
+    {
+        future.get();
+    }
+
+    elapsedTime = std::chrono::high_resolution_clock::now() - startTimer;
+
+    std::cout << "ThreadPool addJob throughput: "
+              << jobCount * 1000 / std::max<int64_t>(
+                     1, std::chrono::duration_cast<std::chrono::milliseconds>(elapsedTime).count())
+              << " jobs/s" << std::endl;
+
+    startTimer = std::chrono::high_resolution_clock::now();
+
+    Utilities::JobGroup group;
+
+    for (uint64_t i = 0; i < jobCount; i++)
+    {
+        threadPool.addJob(group, [&counter] { counter++; });
+    }
+
+    threadPool.wait(group);
+
+    elapsedTime = std::chrono::high_resolution_clock::now() - startTimer;
+
+    std::cout << "ThreadPool JobGroup throughput: "
+              << jobCount * 1000 / std::max<int64_t>(
+                     1, std::chrono::duration_cast<std::chrono::milliseconds>(elapsedTime).count())
+              << " jobs/s" << std::endl;
+
+    startTimer = std::chrono::high_resolution_clock::now();
+
+    threadPool.parallelFor(0, jobCount, [&counter](const size_t) { counter++; });
+
+    elapsedTime = std::chrono::high_resolution_clock::now() - startTimer;
+
+    std::cout << "ThreadPool parallelFor throughput: "
+              << jobCount * 1000 / std::max<int64_t>(
+                     1, std::chrono::duration_cast<std::chrono::milliseconds>(elapsedTime).count())
+              << " jobs/s" << std::endl;
+
+    if (counter != jobCount * 4)
+    {
+        std::cout << "ThreadPool lost jobs!\nTerminating...";
+
+        exit(1);
+    }
+}
+
+/* Key images are as good as random bytes, which are a lot quicker to make */
+Crypto::KeyImage makeKeyImage(const uint64_t i)
+{
+    const Crypto::Hash hash = Crypto::cn_fast_hash(&i, sizeof(i));
+
+    Crypto::KeyImage keyImage;
+    std::copy(std::begin(hash.data), std::end(hash.data), std::begin(keyImage.data));
+
+    return keyImage;
+}
+
+void benchmarkKeyImageFilter()
+{
+    const uint64_t spentCount = 1000000;
+    const uint64_t keyImagesPerBlock = 100;
+
+    CryptoNote::KeyImageFilter filter;
+
+    auto startTimer = std::chrono::high_resolution_clock::now();
+
+    for (uint64_t i = 0; i < spentCount; i++)
+    {
+        filter.add(static_cast<uint32_t>(i / keyImagesPerBlock), makeKeyImage(i));
+    }
+
+    auto elapsedTime = std::chrono::high_resolution_clock::now() - startTimer;
+
+    std::cout << "Key image filter add: "
+              << spentCount * 1000 / std::max<int64_t>(
+                     1, std::chrono::duration_cast<std::chrono::milliseconds>(elapsedTime).count())
+              << " key images/s" << std::endl;
+
+    /* Nearly every key image validation checks hasn't been spent */
+    uint64_t maybeSpent = 0;
+
+    startTimer = std::chrono::high_resolution_clock::now();
+
+    for (uint64_t i = spentCount; i < spentCount * 2; i++)
+    {
+        if (filter.mayContain(makeKeyImage(i)))
+        {
+            maybeSpent++;
+        }
+    }
+
+    elapsedTime = std::chrono::high_resolution_clock::now() - startTimer;
+
+    std::cout << "Key image filter unspent lookup: "
+              << spentCount * 1000 / std::max<int64_t>(
+                     1, std::chrono::duration_cast<std::chrono::milliseconds>(elapsedTime).count())
+              << " key images/s, " << maybeSpent << " of " << spentCount
+              << " would still read the database (estimated " << filter.falsePositiveRate() * spentCount
+              << "), " << filter.memoryUsage() / 1024 << "KB for " << filter.size() << " key images" << std::endl;
+
+    for (uint64_t i = 0; i < spentCount; i++)
+    {
+        if (!filter.mayContain(makeKeyImage(i)))
+        {
+            std::cout << "Key image filter lost a spent key image!\nTerminating...";
+
+            exit(1);
+        }
+    }
+
+    /* Pop the top half of the blocks, as a deep reorg would */
+    for (uint64_t i = spentCount; i-- > spentCount / 2;)
+    {
+        filter.remove(static_cast<uint32_t>(i / keyImagesPerBlock), makeKeyImage(i));
+    }
+
+    filter.truncate(static_cast<uint32_t>(spentCount / 2 / keyImagesPerBlock));
+
+    for (uint64_t i = 0; i < spentCount / 2; i++)
+    {
+        if (!filter.mayContain(makeKeyImage(i)))
+        {
+            std::cout << "Key image filter lost a spent key image after removing blocks!\nTerminating...";
+
+            exit(1);
+        }
+    }
+}
+
+void benchmarkPoolConflicts()
+{
+    const uint64_t poolSize = 50000;
+    const uint64_t blockInputs = 200;
+    const uint64_t height = CryptoNote::parameters::MIXIN_LIMITS_V3_HEIGHT;
+    const uint64_t maxTransactionSize = CryptoNote::parameters::CRYPTONOTE_BLOCK_GRANTED_FULL_REWARD_ZONE;
+
+    const auto [minMixin, maxMixin, defaultMixin] = Utilities::getMixinAllowableRange(height);
+
+    CryptoNote::TransactionPool pool(std::make_shared<Logging::DummyLogger>());
+
+    for (uint64_t i = 0; i < poolSize; i++)
+    {
+        /* One in a hundred was fine before the mixin limits changed */
+        const uint64_t ringSize = i % 100 == 0 ? 1 : defaultMixin + 1;
+
+        CryptoNote::KeyInput input;
+        input.amount = 1000;
+        input.keyImage = makeKeyImage(i);
+
+        for (uint32_t j = 0; j < ringSize; j++)
+        {
+            input.outputIndexes.push_back(j + 1);
+        }
+
+        CryptoNote::TransactionOutput output;
+        output.amount = 900;
+        output.target = CryptoNote::KeyOutput {};
+
+        CryptoNote::Transaction transaction;
+        transaction.version = 1;
+        transaction.unlockTime = 0;
+        transaction.inputs.push_back(input);
+        transaction.outputs.push_back(output);
+        transaction.signatures.emplace_back(ringSize);
+
+        CryptoNote::TransactionValidatorState state;
+        state.spentKeyImages.insert(input.keyImage);
+
+        pool.pushTransaction(CryptoNote::CachedTransaction(std::move(transaction)), std::move(state));
+    }
+
+    /* Half of the block conflicts with the pool */
+    CryptoNote::TransactionValidatorState blockState;
+
+    for (uint64_t i = 0; i < blockInputs; i++)
+    {
+        blockState.spentKeyImages.insert(makeKeyImage(i % 2 == 0 ? i : poolSize + i));
+    }
+
+    /* Checking every transaction in the pool against the block */
+    auto startTimer = std::chrono::high_resolution_clock::now();
+
+    size_t invalidCount = 0;
+
+    for (const auto &hash : pool.getTransactionHashes())
+    {
+        const auto transaction = pool.tryGetTransaction(hash);
+
+        CryptoNote::TransactionValidatorState state;
+
+        for (const auto &input : transaction->getTransaction().inputs)
+        {
+            state.spentKeyImages.insert(boost::get<CryptoNote::KeyInput>(input).keyImage);
+        }
+
+        const auto [mixinSuccess, error] = CryptoNote::Mixins::validate({*transaction}, height);
+
+        if (!mixinSuccess || transaction->getTransactionBinaryArray().size() > maxTransactionSize
+            || CryptoNote::hasIntersections(blockState, state))
+        {
+            invalidCount++;
+        }
+    }
+
+    auto elapsedTime = std::chrono::high_resolution_clock::now() - startTimer;
+
+    std::cout << "Pool conflicts, checking all " << poolSize << " transactions: "
+              << std::chrono::duration_cast<std::chrono::microseconds>(elapsedTime).count() << " us, "
+              << invalidCount << " invalid" << std::endl;
+
+    /* Looking the block's key images, and the limits, up in the pool's indexes */
+    startTimer = std::chrono::high_resolution_clock::now();
+
+    std::unordered_set<Crypto::Hash> invalidTransactions;
+
+    for (const auto &hash : pool.getTransactionHashesByKeyImages(blockState.spentKeyImages))
+    {
+        invalidTransactions.insert(hash);
+    }
+
+    for (const auto &hash : pool.getTransactionHashesOutsideLimits(maxTransactionSize, minMixin, maxMixin))
+    {
+        invalidTransactions.insert(hash);
+    }
+
+    elapsedTime = std::chrono::high_resolution_clock::now() - startTimer;
+
+    std::cout << "Pool conflicts, using the pool indexes: "
+              << std::chrono::duration_cast<std::chrono::microseconds>(elapsedTime).count() << " us, "
+              << invalidTransactions.size() << " invalid" << std::endl;
+
+    if (invalidTransactions.size() != invalidCount)
+    {
+        std::cout << "Pool indexes found a different set of invalid transactions!\nTerminating...";
+
+        exit(1);
+    }
+}
+
+void benchmarkMainChainStorage()
+{
+    const uint32_t blockCount = 2000;
+    const uint32_t readsPerThread = 50000;
+    const std::string blocksFilename = "mainchain_benchmark_blocks.bin";
+    const std::string indexesFilename = "mainchain_benchmark_indexes.bin";
+
+    {
+        CryptoNote::MainChainStorage storage(blocksFilename, indexesFilename);
+
+        for (uint32_t i = 0; i < blockCount; i++)
+        {
+            CryptoNote::RawBlock rawBlock;
+
+            rawBlock.block.resize(500, static_cast<uint8_t>(i));
+            rawBlock.transactions.resize(i % 10, CryptoNote::BinaryArray(1500, static_cast<uint8_t>(i)));
+
+            storage.pushBlock(rawBlock);
+        }
+
+        /* Same as the RPC and P2P threads reading blocks while the core is
+           adding them */
+        for (const uint32_t threadCount : {1, 4})
+        {
+            std::vector<std::thread> readers;
+
+            std::atomic<uint64_t> bytesRead = 0;
+
+            const auto startTimer = std::chrono::high_resolution_clock::now();
+
+            for (uint32_t i = 0; i < threadCount; i++)
+            {
+                readers.emplace_back([&, i]() {
+                    uint64_t bytes = 0;
+
+                    for (uint32_t j = 0; j < readsPerThread; j++)
+                    {
+                        bytes += storage.getBlockByIndex((j * 7919 + i) % blockCount).block.size();
+                    }
+
+                    bytesRead += bytes;
+                });
+            }
+
+            for (auto &reader : readers)
+            {
+                reader.join();
+            }
+
+            const auto elapsedTime = std::chrono::high_resolution_clock::now() - startTimer;
+
+            const auto timePerRead = std::chrono::duration_cast<std::chrono::nanoseconds>(elapsedTime).count()
+                                     / (readsPerThread * threadCount);
+
+            std::cout << "Main chain storage reads, " << threadCount << " thread(s): " << 1000000000 / timePerRead
+                      << " blocks/s" << std::endl;
+
+            if (bytesRead != uint64_t(500) * readsPerThread * threadCount)
+            {
+                std::cout << "Main chain storage returned the wrong block!\nTerminating...";
+
+                exit(1);
+            }
+        }
+
+        /* The pooled handles have read the old last block, which is written
+           over by its replacement */
+        CryptoNote::RawBlock replacement;
+
+        replacement.block.resize(700, 0xff);
+
+        storage.popBlock();
+        storage.pushBlock(replacement);
+
+        if (storage.getBlockByIndex(blockCount - 1).block != replacement.block)
+        {
+            std::cout << "Main chain storage returned a popped block!\nTerminating...";
+
+            exit(1);
+        }
+    }
+
+    std::remove(blocksFilename.c_str());
+    std::remove(indexesFilename.c_str());
+}
+
+void benchmarkWalletSyncCache()
+{
+    const uint64_t blockCount = 1000;
+    const uint64_t transactionsPerBlock = 10;
+
+    /* What the node reads out of the main chain storage for a /sync request */
+    std::vector<CryptoNote::RawBlock> rawBlocks;
+
+    for (uint64_t height = 0; height < blockCount; height++)
+    {
+        CryptoNote::BlockTemplate block;
+        block.majorVersion = CryptoNote::BLOCK_MAJOR_VERSION_1;
+        block.timestamp = height;
+        block.baseTransaction.version = 1;
+        block.baseTransaction.unlockTime = height + CryptoNote::parameters::CRYPTONOTE_MINED_MONEY_UNLOCK_WINDOW;
+        block.baseTransaction.inputs.push_back(CryptoNote::BaseInput {static_cast<uint32_t>(height)});
+        block.baseTransaction.extra.resize(33, static_cast<uint8_t>(height));
+        block.baseTransaction.extra[0] = TX_EXTRA_TAG_PUBKEY;
+
+        for (uint64_t i = 0; i < 5; i++)
+        {
+            CryptoNote::TransactionOutput output;
+            output.amount = 1000;
+            output.target = CryptoNote::KeyOutput {Crypto::PublicKey()};
+
+            block.baseTransaction.outputs.push_back(output);
+        }
+
+        CryptoNote::RawBlock rawBlock;
+
+        for (uint64_t i = 0; i < transactionsPerBlock; i++)
+        {
+            CryptoNote::Transaction transaction;
+            transaction.version = 1;
+            transaction.unlockTime = 0;
+            transaction.extra.resize(33, static_cast<uint8_t>(i));
+            transaction.extra[0] = TX_EXTRA_TAG_PUBKEY;
+
+            for (uint64_t j = 0; j < 2; j++)
+            {
+                CryptoNote::KeyInput input;
+                input.amount = 1000;
+                input.keyImage = makeKeyImage((height * transactionsPerBlock + i) * 2 + j);
+                input.outputIndexes = {1, 2, 3, 4};
+
+                transaction.inputs.push_back(input);
+                transaction.signatures.emplace_back(4);
+            }
+
+            for (uint64_t j = 0; j < 2; j++)
+            {
+                CryptoNote::TransactionOutput output;
+                output.amount = 900;
+                output.target = CryptoNote::KeyOutput {Crypto::PublicKey()};
+
+                transaction.outputs.push_back(output);
+            }
+
+            block.transactionHashes.push_back(CryptoNote::getObjectHash(transaction));
+            rawBlock.transactions.push_back(CryptoNote::toBinaryArray(transaction));
+        }
+
+        rawBlock.block = CryptoNote::toBinaryArray(block);
+
+        rawBlocks.push_back(std::move(rawBlock));
+    }
+
+    CryptoNote::WalletSyncCache cache(CryptoNote::WALLET_SYNC_CACHE_MAX_SIZE);
+
+    /* The first wallet to ask for a block, which has to decode it */
+    auto startTimer = std::chrono::high_resolution_clock::now();
+
+    std::vector<WalletTypes::WalletBlockInfo> walletBlocks;
+
+    for (uint64_t height = 0; height < blockCount; height++)
+    {
+        CryptoNote::BlockTemplate block;
+
+        CryptoNote::fromBinaryArray(block, rawBlocks[height].block);
+
+        CryptoNote::CachedBlock cachedBlock(block);
+
+        WalletTypes::WalletBlockInfo walletBlock;
+        walletBlock.blockHeight = cachedBlock.getBlockIndex();
+        walletBlock.blockHash = cachedBlock.getBlockHash();
+        walletBlock.blockTimestamp = block.timestamp;
+        walletBlock.coinbaseTransaction = CryptoNote::Core::getRawCoinbaseTransaction(block.baseTransaction);
+
+        for (const auto &transaction : rawBlocks[height].transactions)
+        {
+            walletBlock.transactions.push_back(CryptoNote::Core::getRawTransaction(transaction));
+        }
+
+        auto cachedSyncBlock = std::make_shared<CryptoNote::WalletSyncCache::Block>();
+        cachedSyncBlock->rawBlock = rawBlocks[height];
+        cachedSyncBlock->walletBlock = walletBlock;
+
+        cache.addBlock(height, cachedSyncBlock, cache.getGeneration());
+
+        walletBlocks.push_back(std::move(walletBlock));
+    }
+
+    auto elapsedTime = std::chrono::high_resolution_clock::now() - startTimer;
+
+    std::cout << "Wallet sync, decoding " << blockCount << " blocks: "
+              << std::chrono::duration_cast<std::chrono::microseconds>(elapsedTime).count() << " us" << std::endl;
+
+    /* Every wallet after that */
+    startTimer = std::chrono::high_resolution_clock::now();
+
+    std::vector<WalletTypes::WalletBlockInfo> cachedWalletBlocks;
+
+    for (uint64_t height = 0; height < blockCount; height++)
+    {
+        if (const auto block = cache.getBlock(height))
+        {
+            cachedWalletBlocks.push_back(*block->walletBlock);
+        }
+    }
+
+    elapsedTime = std::chrono::high_resolution_clock::now() - startTimer;
+
+    std::cout << "Wallet sync, " << blockCount << " blocks from the cache: "
+              << std::chrono::duration_cast<std::chrono::microseconds>(elapsedTime).count() << " us" << std::endl;
+
+    if (cachedWalletBlocks.size() != blockCount)
+    {
+        std::cout << "Wallet sync cache lost blocks!\nTerminating...";
+
+        exit(1);
+    }
+
+    for (uint64_t height = 0; height < blockCount; height++)
+    {
+        if (cachedWalletBlocks[height].blockHash != walletBlocks[height].blockHash
+            || cachedWalletBlocks[height].transactions.size() != transactionsPerBlock)
+        {
+            std::cout << "Wallet sync cache returned the wrong block!\nTerminating...";
+
+            exit(1);
+        }
+    }
+}
+
+/* A chain of our own, set up like the daemon does it, for testing the core
+   against blocks and transactions we make ourselves. Mined money unlocks after
+   a block, and we space the blocks out, so the difficulty stays low and mining
+   is cheap. */
+struct TestChain
+{
+    /* With checkpoints given, blocks below them are imported in trusted mode */
+    TestChain(
+        System::Dispatcher &dispatcher,
+        const std::string &dataDirectory,
+        const std::map<uint32_t, Crypto::Hash> &checkpointHashes = {}):
+        logger(std::make_shared<Logging::DummyLogger>()),
+        currency(CryptoNote::CurrencyBuilder(logger).minedMoneyUnlockWindow(1).zawyDifficultyBlockVersion(0).currency()),
+        dispatcher(dispatcher),
+        dataDir(dataDirectory),
+        dbConfig(dataDirectory, 2, 100, 8, 8, 8, false),
+        database(logger),
+        poolSnapshotFilename(dataDirectory + "/" + CryptoNote::parameters::CRYPTONOTE_POOLDATA_FILENAME),
+        checkpointHashes(checkpointHashes)
+    {
+        Crypto::generate_keys(miner.address.spendPublicKey, miner.spendSecretKey);
+        Crypto::generate_keys(miner.address.viewPublicKey, miner.viewSecretKey);
+
+        fs::remove_all(dataDir);
+        fs::create_directories(dataDir);
+
+        database.init(dbConfig);
+
+        CryptoNote::DatabaseBlockchainCache::checkDBSchemeVersion(database, logger);
+
+        openCore();
+    }
+
+    ~TestChain()
+    {
+        core.reset();
+
+        database.shutdown();
+
+        fs::remove_all(dataDir);
+    }
+
+    /* Shuts the core down and starts another on the same chain, like
+       restarting the node */
+    void restartCore()
+    {
+        core.reset();
+
+        openCore();
+    }
+
+    void openCore()
+    {
+        auto mainChainStorage = CryptoNote::createSwappedMainChainStorage(dataDir, currency);
+
+        const CryptoNote::IMainChainStorage &storage = *mainChainStorage;
+
+        CryptoNote::Checkpoints checkpoints(logger);
+
+        for (const auto &[index, hash] : checkpointHashes)
+        {
+            checkpoints.addCheckpoint(index, Common::podToHex(hash));
+        }
+
+        core = std::make_unique<CryptoNote::Core>(
+            currency,
+            logger,
+            std::move(checkpoints),
+            dispatcher,
+            std::make_unique<CryptoNote::DatabaseBlockchainCacheFactory>(
+                database,
+                storage,
+                dataDir + "/" + CryptoNote::parameters::CRYPTONOTE_BLOCK_METADATA_DIRNAME,
+                logger),
+            std::move(mainChainStorage),
+            1,
+            false,
+            !checkpointHashes.empty(),
+            poolSnapshotFilename);
+
+        core->load();
+    }
+
+    /* Mines the current block template, with the timestamp given, like the
+       miner does it */
+    void mineBlock(const uint64_t timestamp)
+    {
+        CryptoNote::BlockTemplate block;
+        uint64_t difficulty;
+        uint32_t height;
+
+        const auto [success, error] = core->getBlockTemplate(
+            block, miner.address.viewPublicKey, miner.address.spendPublicKey, {}, difficulty, height);
+
+        if (!success)
+        {
+            std::cout << "Could not get a block template: " << error << "\nTerminating...";
+
+            exit(1);
+        }
+
+        block.timestamp = timestamp;
+
+        if (block.majorVersion >= CryptoNote::BLOCK_MAJOR_VERSION_2)
+        {
+            CryptoNote::TransactionExtraMergeMiningTag mmTag;
+            mmTag.depth = 0;
+            mmTag.merkleRoot = CryptoNote::CachedBlock(block).getAuxiliaryBlockHeaderHash();
+
+            block.parentBlock.baseTransaction.extra.clear();
+            CryptoNote::appendMergeMiningTagToExtra(block.parentBlock.baseTransaction.extra, mmTag);
+        }
+
+        while (!currency.checkProofOfWork(CryptoNote::CachedBlock(block), difficulty))
+        {
+            block.nonce++;
+        }
+
+        const auto submitResult = core->submitBlock(CryptoNote::toBinaryArray(block));
+
+        if (submitResult != CryptoNote::error::AddBlockErrorCode::ADDED_TO_MAIN)
+        {
+            std::cout << "Could not submit a mined block: " << submitResult.message() << "\nTerminating...";
+
+            exit(1);
+        }
+    }
+
+    /* Mines count blocks, a block interval apart, ending about now */
+    void mineBlocks(const uint32_t count)
+    {
+        const uint64_t now = time(nullptr);
+
+        for (uint32_t i = 0; i < count; i++)
+        {
+            mineBlock(now - (count - i) * currency.difficultyTarget());
+        }
+    }
+
+    /* A transaction sending one of our mined outputs back to ourselves,
+       less the fee */
+    CryptoNote::BinaryArray spendMinedOutput(const uint32_t blockIndex, const size_t outputIndex, const uint64_t fee)
+    {
+        const auto coinbase = core->getBlockByIndex(blockIndex).baseTransaction;
+        const auto &output = coinbase.outputs[outputIndex];
+
+        std::vector<uint32_t> globalIndexes;
+
+        core->getTransactionGlobalIndexes(CryptoNote::CachedTransaction(coinbase).getTransactionHash(), globalIndexes);
+
+        CryptoNote::TransactionTypes::InputKeyInfo input;
+        input.amount = output.amount;
+        input.outputs.push_back({boost::get<CryptoNote::KeyOutput>(output.target).key, globalIndexes[outputIndex]});
+        input.realOutput.transactionPublicKey = CryptoNote::getTransactionPublicKeyFromExtra(coinbase.extra);
+        input.realOutput.transactionIndex = 0;
+        input.realOutput.outputInTransaction = outputIndex;
+
+        auto transaction = CryptoNote::createTransaction();
+
+        CryptoNote::KeyPair ephemeralKeys;
+
+        transaction->addInput(miner, input, ephemeralKeys);
+        transaction->addOutput(output.amount - fee, miner.address);
+        transaction->signInputKey(0, input, ephemeralKeys);
+
+        return transaction->getTransactionData();
+    }
+
+    std::shared_ptr<Logging::ILogger> logger;
+
+    CryptoNote::Currency currency;
+
+    System::Dispatcher &dispatcher;
+
+    const std::string dataDir;
+
+    CryptoNote::DataBaseConfig dbConfig;
+
+    CryptoNote::LevelDBWrapper database;
+
+    const std::string poolSnapshotFilename;
+
+    const std::map<uint32_t, Crypto::Hash> checkpointHashes;
+
+    std::unique_ptr<CryptoNote::Core> core;
+
+    CryptoNote::AccountKeys miner;
+};
+
+/* A p2p node for a TestChain, talking only to the nodes given, over loopback */
+struct TestNode
+{
+    TestNode(TestChain &chain, const uint16_t port, const std::vector<std::string> &exclusiveNodes):
+        protocol(chain.currency, chain.dispatcher, *chain.core, nullptr, chain.logger),
+        server(chain.dispatcher, protocol, chain.logger)
+    {
+        CryptoNote::NetNodeConfig config;
+
+        config.init("127.0.0.1", port, 0, true, false, chain.dataDir, {}, exclusiveNodes, {}, {}, false);
+
+        protocol.set_p2p_endpoint(&server);
+
+        if (!server.init(config))
+        {
+            std::cout << "Could not start a p2p node on port " << port << "\nTerminating...";
+
+            exit(1);
+        }
+    }
+
+    ~TestNode()
+    {
+        server.deinit();
+
+        protocol.set_p2p_endpoint(nullptr);
+    }
+
+    CryptoNote::CryptoNoteProtocolHandler protocol;
+
+    CryptoNote::NodeServer server;
+};
+
+void benchmarkBlockTemplate()
+{
+    const uint32_t blockCount = 100;
+    const uint64_t fee = 10;
+    const uint64_t cachedIterations = 1000;
+
+    System::Dispatcher dispatcher;
+
+    TestChain chain(dispatcher, "blocktemplate_benchmark");
+
+    chain.mineBlocks(blockCount);
+
+    for (uint32_t blockIndex = 1; blockIndex < blockCount; blockIndex++)
+    {
+        const auto outputs = chain.core->getBlockByIndex(blockIndex).baseTransaction.outputs;
+
+        for (size_t i = 0; i < outputs.size(); i++)
+        {
+            if (outputs[i].amount > fee)
+            {
+                chain.core->addTransactionToPool(chain.spendMinedOutput(blockIndex, i, fee));
+            }
+        }
+    }
+
+    const size_t poolSize = chain.core->getPoolTransactionHashes().size();
+
+    CryptoNote::BlockTemplate block;
+    uint64_t difficulty;
+    uint32_t height;
+
+    /* The first call after a new block builds the template from the pool */
+    auto startTimer = std::chrono::high_resolution_clock::now();
+
+    chain.core->getBlockTemplate(
+        block, chain.miner.address.viewPublicKey, chain.miner.address.spendPublicKey, {}, difficulty, height);
+
+    auto elapsedTime = std::chrono::high_resolution_clock::now() - startTimer;
+
+    std::cout << "Block template build, " << poolSize << " pool transactions: "
+              << std::chrono::duration_cast<std::chrono::microseconds>(elapsedTime).count() << " us" << std::endl;
+
+    const size_t transactionCount = block.transactionHashes.size();
+
+    startTimer = std::chrono::high_resolution_clock::now();
+
+    for (uint64_t i = 0; i < cachedIterations; i++)
+    {
+        chain.core->getBlockTemplate(
+            block, chain.miner.address.viewPublicKey, chain.miner.address.spendPublicKey, {}, difficulty, height);
+    }
+
+    elapsedTime = std::chrono::high_resolution_clock::now() - startTimer;
+
+    std::cout << "Block template from the cache: "
+              << std::chrono::duration_cast<std::chrono::microseconds>(elapsedTime).count() / cachedIterations
+              << " us" << std::endl;
+
+    if (transactionCount == 0 || block.transactionHashes.size() != transactionCount)
+    {
+        std::cout << "Block template cache returned the wrong template!\nTerminating...";
+
+        exit(1);
+    }
+}
+
+void benchmarkPoolSnapshot()
+{
+    const uint64_t poolSize = 10000;
+    const uint64_t inputsPerTransaction = 2;
+
+    System::Dispatcher dispatcher;
+
+    TestChain chain(dispatcher, "poolsnapshot_benchmark");
+
+    const uint32_t topBlockIndex = chain.core->getTopBlockIndex();
+
+    const auto [minMixin, maxMixin, defaultMixin] = Utilities::getMixinAllowableRange(topBlockIndex + 1);
+
+    const uint64_t now = time(nullptr);
+
+    /* Never valid on chain, but the snapshot's block is still our top block,
+       so loading it doesn't check the ring signatures */
+    std::vector<CryptoNote::PoolSnapshotTransaction> snapshot;
+
+    for (uint64_t i = 0; i < poolSize; i++)
+    {
+        CryptoNote::Transaction transaction;
+        transaction.version = 1;
+        transaction.unlockTime = 0;
+        transaction.extra.resize(33, static_cast<uint8_t>(i));
+
+        for (uint64_t j = 0; j < inputsPerTransaction; j++)
+        {
+            CryptoNote::KeyInput input;
+            input.amount = 1000;
+            input.keyImage = makeKeyImage(i * inputsPerTransaction + j);
+
+            for (uint32_t k = 0; k <= defaultMixin; k++)
+            {
+                input.outputIndexes.push_back(k + 1);
+            }
+
+            transaction.inputs.push_back(input);
+            transaction.signatures.emplace_back(defaultMixin + 1);
+        }
+
+        for (uint64_t j = 0; j < 2; j++)
+        {
+            CryptoNote::TransactionOutput output;
+            output.amount = 900;
+            output.target = CryptoNote::KeyOutput {};
+
+            transaction.outputs.push_back(output);
+        }
+
+        snapshot.push_back({now - i, CryptoNote::toBinaryArray(transaction)});
+    }
+
+    auto startTimer = std::chrono::high_resolution_clock::now();
+
+    CryptoNote::TransactionPoolSnapshot::save(
+        chain.poolSnapshotFilename, topBlockIndex, chain.core->getTopBlockHash(), snapshot);
+
+    auto elapsedTime = std::chrono::high_resolution_clock::now() - startTimer;
+
+    std::cout << "Pool snapshot save, " << poolSize << " transactions: "
+              << std::chrono::duration_cast<std::chrono::milliseconds>(elapsedTime).count() << " ms" << std::endl;
+
+    /* What the node does on startup, which on this short chain is mostly
+       loading the snapshot */
+    startTimer = std::chrono::high_resolution_clock::now();
+
+    chain.restartCore();
+
+    elapsedTime = std::chrono::high_resolution_clock::now() - startTimer;
+
+    std::cout << "Core load with a pool snapshot, " << poolSize << " transactions: "
+              << std::chrono::duration_cast<std::chrono::milliseconds>(elapsedTime).count() << " ms" << std::endl;
+
+    if (chain.core->getPoolTransactionCount() != poolSize)
+    {
+        std::cout << "Pool snapshot lost transactions!\nTerminating...";
+
+        exit(1);
+    }
+
+    /* Saved again by the core, so we can see the receive times it kept */
+    chain.core->save();
+
+    std::vector<CryptoNote::PoolSnapshotTransaction> saved;
+    uint32_t blockIndex;
+    Crypto::Hash blockHash;
+
+    CryptoNote::TransactionPoolSnapshot::load(chain.poolSnapshotFilename, blockIndex, blockHash, saved);
+
+    std::unordered_map<Crypto::Hash, uint64_t> receiveTimes;
+
+    for (const auto &transaction : snapshot)
+    {
+        receiveTimes[Crypto::cn_fast_hash(transaction.transaction.data(), transaction.transaction.size())] =
+            transaction.receiveTime;
+    }
+
+    for (const auto &transaction : saved)
+    {
+        if (receiveTimes[Crypto::cn_fast_hash(transaction.transaction.data(), transaction.transaction.size())]
+            != transaction.receiveTime)
+        {
+            std::cout << "Pool snapshot lost a receive time!\nTerminating...";
+
+            exit(1);
+        }
+    }
+
+    /* Without our key, as if the snapshot had been copied from another node */
+    std::remove((chain.poolSnapshotFilename + ".key").c_str());
+
+    chain.restartCore();
+
+    if (chain.core->getPoolTransactionCount() != 0)
+    {
+        std::cout << "Loaded a pool snapshot we didn't write!\nTerminating...";
+
+        exit(1);
+    }
+}
+
+void benchmarkRandomOutputs()
+{
+    const uint32_t blockCount = 200;
+    const size_t outputsPerAmount = 4;
+    const uint64_t iterations = 200;
+
+    System::Dispatcher dispatcher;
+
+    TestChain chain(dispatcher, "randomouts_benchmark");
+
+    chain.mineBlocks(blockCount);
+
+    std::set<uint64_t> uniqueAmounts;
+
+    for (uint32_t blockIndex = 1; blockIndex <= blockCount; blockIndex++)
+    {
+        for (const auto &output : chain.core->getBlockByIndex(blockIndex).baseTransaction.outputs)
+        {
+            uniqueAmounts.insert(output.amount);
+        }
+    }
+
+    const std::vector<uint64_t> amounts(uniqueAmounts.begin(), uniqueAmounts.end());
+
+    /* The core doesn't hand out its blockchain cache, so close it and read
+       the chain back with a cache of our own */
+    chain.core.reset();
+
+    const auto mainChainStorage = CryptoNote::createSwappedMainChainStorage(chain.dataDir, chain.currency);
+
+    CryptoNote::DatabaseBlockchainCacheFactory factory(
+        chain.database,
+        *mainChainStorage,
+        chain.dataDir + "/" + CryptoNote::parameters::CRYPTONOTE_BLOCK_METADATA_DIRNAME,
+        chain.logger);
+
+    const auto cache = factory.createRootBlockchainCache(chain.currency);
+
+    const uint32_t topIndex = cache->getTopBlockIndex();
+
+    size_t batchedCount = 0;
+    size_t oneAtATimeCount = 0;
+
+    auto startTimer = std::chrono::high_resolution_clock::now();
+
+    for (uint64_t i = 0; i < iterations; i++)
+    {
+        for (const auto &outputs : cache->getRandomOutsByAmounts(amounts, outputsPerAmount, topIndex))
+        {
+            batchedCount += outputs.size();
+        }
+    }
+
+    auto elapsedTime = std::chrono::high_resolution_clock::now() - startTimer;
+
+    std::cout << "Random outputs, " << amounts.size() << " amounts in one read: "
+              << std::chrono::duration_cast<std::chrono::microseconds>(elapsedTime).count() / iterations << " us"
+              << std::endl;
+
+    startTimer = std::chrono::high_resolution_clock::now();
+
+    for (uint64_t i = 0; i < iterations; i++)
+    {
+        for (const auto &outputs :
+             CryptoNote::Utils::getRandomOutsOneAmountAtATime(*cache, amounts, outputsPerAmount, topIndex))
+        {
+            oneAtATimeCount += outputs.size();
+        }
+    }
+
+    elapsedTime = std::chrono::high_resolution_clock::now() - startTimer;
+
+    std::cout << "Random outputs, " << amounts.size() << " amounts one at a time: "
+              << std::chrono::duration_cast<std::chrono::microseconds>(elapsedTime).count() / iterations << " us"
+              << std::endl;
+
+    if (batchedCount == 0 || batchedCount != oneAtATimeCount)
+    {
+        std::cout << "Random outputs returned the wrong number of outputs!\nTerminating...";
+
+        exit(1);
+    }
+}
+
+void TestCheckRingSignatures()
+{
+    auto entries = generateRingSignatureBlock(20, 4, 30);
+
+    auto [valid, failedIndex] = Crypto::crypto_ops::checkRingSignatures(entries);
+
+    if (!valid)
+    {
+        std::cout << "Could not batch verify valid ring signatures!\nTerminating.";
+
+        exit(1);
+    }
+
+    /* Corrupt a single signature, and make sure we find the right one */
+    entries[13].signatures[2].data[0] ^= 0x01;
+
+    std::tie(valid, failedIndex) = Crypto::crypto_ops::checkRingSignatures(entries);
+
+    if (valid || failedIndex != 13)
+    {
+        std::cout << "Batch verification did not detect invalid ring signature!\nTerminating.";
+
+        exit(1);
+    }
+}
+
+/* A template is cached between calls, so make sure a transaction which has
+   left the pool doesn't stay in it, else submitBlock() rejects the block */
+void TestBlockTemplatePoolRemoval()
+{
+    const uint64_t fee = 10;
+
+    System::Dispatcher dispatcher;
+
+    TestChain chain(dispatcher, "blocktemplate_test");
+
+    chain.mineBlocks(3);
+
+    const auto outputs = chain.core->getBlockByIndex(1).baseTransaction.outputs;
+
+    const size_t outputIndex = std::distance(
+        outputs.begin(),
+        std::max_element(
+            outputs.begin(), outputs.end(), [](const auto &a, const auto &b) { return a.amount < b.amount; }));
+
+    /* Two transactions spending the same output */
+    const auto poolTransaction = chain.spendMinedOutput(1, outputIndex, fee);
+    const auto conflictingTransaction = chain.spendMinedOutput(1, outputIndex, fee * 2);
+
+    const Crypto::Hash poolTransactionHash = CryptoNote::getBinaryArrayHash(poolTransaction);
+
+    if (!std::get<0>(chain.core->addTransactionToPool(poolTransaction)))
+    {
+        std::cout << "Could not add a transaction to the pool!\nTerminating...";
+
+        exit(1);
+    }
+
+    CryptoNote::BlockTemplate block;
+    uint64_t difficulty;
+    uint32_t height;
+
+    chain.core->getBlockTemplate(
+        block, chain.miner.address.viewPublicKey, chain.miner.address.spendPublicKey, {}, difficulty, height);
+
+    if (block.transactionHashes != std::vector<Crypto::Hash> {poolTransactionHash})
+    {
+        std::cout << "Block template is missing the pool transaction!\nTerminating...";
+
+        exit(1);
+    }
+
+    /* A block spending the output before the pool transaction does. The pool
+       transaction is now invalid, so the core drops it from the pool, and the
+       top block doesn't change */
+    block.transactionHashes = {CryptoNote::getBinaryArrayHash(conflictingTransaction), poolTransactionHash};
+
+    CryptoNote::RawBlock rawBlock;
+    rawBlock.block = CryptoNote::toBinaryArray(block);
+    rawBlock.transactions = {conflictingTransaction, poolTransaction};
+
+    const auto topBlockHash = chain.core->getTopBlockHash();
+
+    if (chain.core->addBlock(CryptoNote::CachedBlock(block), std::move(rawBlock))
+            == CryptoNote::error::AddBlockErrorCondition::BLOCK_ADDED
+        || chain.core->getTopBlockHash() != topBlockHash
+        || std::get<0>(chain.core->getPoolTransaction(poolTransactionHash)))
+    {
+        std::cout << "Invalid pool transaction was not removed!\nTerminating...";
+
+        exit(1);
+    }
+
+    /* Straight after, well within the template refresh interval */
+    chain.mineBlock(time(nullptr));
+}
+
+/* Imports a chain below a checkpoint in trusted mode, in batches much
+   smaller than the gap up to the checkpoint, like a syncing node gets them */
+void TestTrustedCheckpointImport()
+{
+    const uint32_t blockCount = 30;
+    const uint32_t batchSize = 10;
+
+    System::Dispatcher dispatcher;
+
+    TestChain source(dispatcher, "trusted_import_source");
+
+    source.mineBlocks(blockCount);
+
+    std::vector<Crypto::Hash> blockIds;
+
+    for (uint32_t i = 0; i <= blockCount; i++)
+    {
+        blockIds.push_back(source.core->getBlockHashByIndex(i));
+    }
+
+    TestChain chain(dispatcher, "trusted_import_test", {{blockCount, blockIds.back()}});
+
+    auto wrongBlockIds = blockIds;
+    wrongBlockIds.back() = wrongBlockIds.front();
+
+    if (chain.core->verifyCheckpointChain(0, wrongBlockIds))
+    {
+        std::cout << "Block ids not matching the checkpoint were accepted!\nTerminating...";
+
+        exit(1);
+    }
+
+    if (!chain.core->verifyCheckpointChain(0, blockIds))
+    {
+        std::cout << "Block ids matching the checkpoint were rejected!\nTerminating...";
+
+        exit(1);
+    }
+
+    for (uint32_t start = 1; start <= blockCount; start += batchSize)
+    {
+        /* CachedBlock keeps a reference to its block */
+        std::vector<CryptoNote::BlockTemplate> blocks;
+        std::vector<CryptoNote::RawBlock> rawBlocks;
+
+        for (uint32_t i = start; i < start + batchSize && i <= blockCount; i++)
+        {
+            blocks.push_back(source.core->getBlockByIndex(i));
+            rawBlocks.push_back(source.core->getRawBlock(i));
+        }
+
+        const std::vector<CryptoNote::CachedBlock> cachedBlocks(blocks.begin(), blocks.end());
+
+        chain.core->addBlocks(
+            cachedBlocks,
+            std::move(rawBlocks),
+            [](const size_t, const std::error_code &result)
+            {
+                if (result != CryptoNote::error::AddBlockErrorCode::ADDED_TO_MAIN)
+                {
+                    std::cout << "Could not import a checkpointed block: " << result.message() << "\nTerminating...";
+
+                    exit(1);
+                }
+
+                return true;
+            });
+    }
+
+    if (chain.core->getTopBlockHash() != source.core->getTopBlockHash())
+    {
+        std::cout << "Trusted import did not reach the checkpoint!\nTerminating...";
+
+        exit(1);
+    }
+}
+
+/* Syncs an empty node from two others with the same chain, each a
+   NodeServer in this process, connected over loopback */
+void TestSyncFromSeveralPeers()
+{
+    const uint32_t blockCount = 300;
+    const auto timeout = std::chrono::seconds(120);
+
+    System::Dispatcher dispatcher;
+
+    TestChain first(dispatcher, "sync_test_first");
+    TestChain second(dispatcher, "sync_test_second");
+    TestChain syncing(dispatcher, "sync_test_syncing");
+
+    first.mineBlocks(blockCount);
+
+    for (uint32_t i = 1; i <= blockCount; i++)
+    {
+        const auto block = CryptoNote::toBinaryArray(first.core->getBlockByIndex(i));
+
+        if (second.core->submitBlock(block) != CryptoNote::error::AddBlockErrorCode::ADDED_TO_MAIN)
+        {
+            std::cout << "Could not copy a block to the second node!\nTerminating...";
+
+            exit(1);
+        }
+    }
+
+    TestNode firstNode(first, 38090, {"127.0.0.1:38091"});
+    TestNode secondNode(second, 38091, {"127.0.0.1:38090"});
+    TestNode syncingNode(syncing, 38092, {"127.0.0.1:38090", "127.0.0.1:38091"});
+
+    System::Context<> firstContext(dispatcher, [&] { firstNode.server.run(); });
+    System::Context<> secondContext(dispatcher, [&] { secondNode.server.run(); });
+    System::Context<> syncingContext(dispatcher, [&] { syncingNode.server.run(); });
+
+    System::Timer timer(dispatcher);
+
+    const auto start = std::chrono::steady_clock::now();
+
+    while (syncing.core->getTopBlockHash() != first.core->getTopBlockHash()
+           && std::chrono::steady_clock::now() - start < timeout)
+    {
+        timer.sleep(std::chrono::milliseconds(100));
+    }
+
+    const bool synced = syncing.core->getTopBlockHash() == first.core->getTopBlockHash();
+
+    firstNode.server.sendStopSignal();
+    secondNode.server.sendStopSignal();
+    syncingNode.server.sendStopSignal();
+
+    firstContext.get();
+    secondContext.get();
+    syncingContext.get();
+
+    if (!synced)
+    {
+        std::cout << "Node only synced " << syncing.core->getTopBlockIndex() << " of " << blockCount
+                  << " blocks!\nTerminating...";
+
+        exit(1);
+    }
+}
+
+void TestGenerateKeyDerivations()
+{
+    std::vector<Crypto::SecretKey> privateViewKeys(5);
+
+    for (auto &privateViewKey : privateViewKeys)
+    {
+        Crypto::PublicKey unused;
+        Crypto::generate_keys(unused, privateViewKey);
+    }
+
+    Crypto::PublicKey txPublicKey;
+    Crypto::PublicKey outputKey;
+    Crypto::SecretKey unused;
+
+    Crypto::generate_keys(txPublicKey, unused);
+    Crypto::generate_keys(outputKey, unused);
+
+    std::vector<Crypto::KeyDerivation> derivations;
+    std::vector<Crypto::PublicKey> spendKeys;
+
+    if (!Crypto::crypto_ops::generateKeyDerivations(txPublicKey, privateViewKeys, derivations)
+        || !Crypto::crypto_ops::underivePublicKeys(derivations, 3, outputKey, spendKeys))
+    {
+        std::cout << "Could not batch generate key derivations!\nTerminating.";
+
+        exit(1);
+    }
+
+    for (size_t i = 0; i < privateViewKeys.size(); i++)
+    {
+        Crypto::KeyDerivation derivation;
+        Crypto::PublicKey spendKey;
+
+        Crypto::generate_key_derivation(txPublicKey, privateViewKeys[i], derivation);
+        Crypto::underive_public_key(derivation, 3, outputKey, spendKey);
+
+        if (derivation != derivations[i] || spendKey != spendKeys[i])
+        {
+            std::cout << "Batched key derivations do not match!\nTerminating.";
+
+            exit(1);
+        }
+    }
+}
+
 void TestDeterministicSubwalletCreation(
     const std::string baseSpendKey,
     const uint64_t subWalletIndex,
@@ -449,6 +2045,22 @@ int main(int argc, char **argv)
             std::cout << "passed" << std::endl;
         }
 
+        {
+            std::cout << "Crypto::crypto_ops::checkRingSignatures: ";
+
+            TestCheckRingSignatures();
+
+            std::cout << "passed" << std::endl;
+        }
+
+        {
+            std::cout << "Crypto::crypto_ops::generateKeyDerivations: ";
+
+            TestGenerateKeyDerivations();
+
+            std::cout << "passed" << std::endl;
+        }
+
         {
             std::cout << "Crypto::generate_deterministic_subwallet_keys: ";
 
@@ -663,6 +2275,32 @@ int main(int argc, char **argv)
             std::cout << "passed" << std::endl;
         }
 
+        std::cout << std::endl << "Test Core" << std::endl << std::endl;
+
+        {
+            std::cout << "CryptoNote::Core::getBlockTemplate: ";
+
+            TestBlockTemplatePoolRemoval();
+
+            std::cout << "passed" << std::endl;
+        }
+
+        {
+            std::cout << "CryptoNote::Core::verifyCheckpointChain: ";
+
+            TestTrustedCheckpointImport();
+
+            std::cout << "passed" << std::endl;
+        }
+
+        {
+            std::cout << "CryptoNote::CryptoNoteProtocolHandler sync: ";
+
+            TestSyncFromSeveralPeers();
+
+            std::cout << "passed" << std::endl;
+        }
+
         std::cout << std::endl << "Input: " << INPUT_DATA << std::endl << std::endl;
 
         TEST_HASH_FUNCTION(cn_slow_hash_v0, CN_SLOW_HASH_V0);
@@ -704,6 +2342,20 @@ int main(int argc, char **argv)
         TEST_HASH_FUNCTION(chukwa_slow_hash_v1, CHUKWA_V1);
         TEST_HASH_FUNCTION(chukwa_slow_hash_v2, CHUKWA_V2);
 
+        /* The miner's path, reusing the same Argon2 memory for each hash */
+        Crypto::ChukwaContext chukwaContext;
+
+        const auto chukwa_slow_hash_v1_context = [&chukwaContext](const void *data, size_t length, Hash &hash) {
+            chukwaContext.hashV1(data, length, hash);
+        };
+
+        const auto chukwa_slow_hash_v2_context = [&chukwaContext](const void *data, size_t length, Hash &hash) {
+            chukwaContext.hashV2(data, length, hash);
+        };
+
+        TEST_HASH_FUNCTION(chukwa_slow_hash_v1_context, CHUKWA_V1);
+        TEST_HASH_FUNCTION(chukwa_slow_hash_v2_context, CHUKWA_V2);
+
         std::cout << std::endl;
 
         for (uint64_t height = 0; height <= 8192; height += 512)
@@ -731,6 +2383,16 @@ int main(int argc, char **argv)
 
             benchmarkUnderivePublicKey();
             benchmarkGenerateKeyDerivation();
+            benchmarkCheckRingSignatures();
+            benchmarkOutputScanning();
+            benchmarkThreadPool();
+            benchmarkKeyImageFilter();
+            benchmarkPoolConflicts();
+            benchmarkPoolSnapshot();
+            benchmarkMainChainStorage();
+            benchmarkWalletSyncCache();
+            benchmarkBlockTemplate();
+            benchmarkRandomOutputs();
 
             BENCHMARK(cn_slow_hash_v0, o_iterations);
             BENCHMARK(cn_slow_hash_v1, o_iterations);
@@ -758,6 +2420,12 @@ int main(int argc, char **argv)
 
             BENCHMARK(chukwa_slow_hash_v1, o_iterations_long);
             BENCHMARK(chukwa_slow_hash_v2, o_iterations_long);
+
+            std::cout << "\nChukwa context "
+                      << (chukwaContext.usingHugePages() ? "is" : "is not") << " using huge pages\n";
+
+            BENCHMARK(chukwa_slow_hash_v1_context, o_iterations_long);
+            BENCHMARK(chukwa_slow_hash_v2_context, o_iterations_long);
         }
     }
     catch (std::exception &e)
@@ -189,6 +189,8 @@ int main(int argc, char *argv[])
             config.dataDirectory + "/" + CryptoNote::parameters::CRYPTONOTE_BLOCKS_FILENAME,
             config.dataDirectory + "/" + CryptoNote::parameters::CRYPTONOTE_BLOCKINDEXES_FILENAME,
             config.dataDirectory + "/" + CryptoNote::parameters::P2P_NET_DATA_FILENAME,
+            config.dataDirectory + "/" + CryptoNote::parameters::CRYPTONOTE_POOLDATA_FILENAME,
+            config.dataDirectory + "/" + CryptoNote::parameters::CRYPTONOTE_BLOCK_METADATA_DIRNAME,
             config.dataDirectory + "/DB"};
 
         for (const auto &path : removablePaths)
@@ -403,14 +405,24 @@ int main(int argc, char *argv[])
         std::unique_ptr<IMainChainStorage> tmainChainStorage =
             createSwappedMainChainStorage(config.dataDirectory, currency);
 
+        /* The core owns the storage, the blockchain cache reads raw blocks from it */
+        const IMainChainStorage &mainChainStorage = *tmainChainStorage;
+
         const auto ccore = std::make_shared<CryptoNote::Core>(
             currency,
             logManager,
             std::move(checkpoints),
             dispatcher,
-            std::unique_ptr<IBlockchainCacheFactory>(new DatabaseBlockchainCacheFactory(*database, logger.getLogger())),
+            std::unique_ptr<IBlockchainCacheFactory>(new DatabaseBlockchainCacheFactory(
+                *database,
+                mainChainStorage,
+                config.dataDirectory + "/" + CryptoNote::parameters::CRYPTONOTE_BLOCK_METADATA_DIRNAME,
+                logger.getLogger())),
             std::move(tmainChainStorage),
-            config.transactionValidationThreads);
+            config.transactionValidationThreads,
+            config.batchSignatureVerification,
+            config.trustedCheckpointImport,
+            config.dataDirectory + "/" + currency.txPoolFileName());
 
         ccore->load();
 
@@ -176,7 +176,13 @@ namespace DaemonConfig
             "transaction-validation-threads",
             "Number of threads to use to validate a transaction's inputs in parallel",
             cxxopts::value<uint32_t>()->default_value(std::to_string(config.transactionValidationThreads)),
-            "#");
+            "#")(
+            "batch-signature-verification",
+            "Verify the ring signatures of each block in one batch, sharing work between rings",
+            cxxopts::value<bool>()->default_value("false")->implicit_value("true"))(
+            "trusted-checkpoint-import",
+            "Skip block and transaction validation below the last checkpoint, only checking blocks link up to the checkpoints",
+            cxxopts::value<bool>()->default_value("false")->implicit_value("true"));
 
         try
         {
@@ -392,6 +398,16 @@ namespace DaemonConfig
                 config.transactionValidationThreads = cli["transaction-validation-threads"].as<uint32_t>();
             }
 
+            if (cli.count("batch-signature-verification") > 0)
+            {
+                config.batchSignatureVerification = cli["batch-signature-verification"].as<bool>();
+            }
+
+            if (cli.count("trusted-checkpoint-import") > 0)
+            {
+                config.trustedCheckpointImport = cli["trusted-checkpoint-import"].as<bool>();
+            }
+
             if (config.help) // Do we want to display the help message?
             {
                 std::cout << options.help({}) << std::endl;
@@ -666,6 +682,16 @@ namespace DaemonConfig
                         throw std::runtime_error(std::string(e.what()) + " - Invalid value for " + cfgKey);
                     }
                 }
+                else if (cfgKey.compare("batch-signature-verification") == 0)
+                {
+                    config.batchSignatureVerification = cfgValue.at(0) == '1';
+                    updated = true;
+                }
+                else if (cfgKey.compare("trusted-checkpoint-import") == 0)
+                {
+                    config.trustedCheckpointImport = cfgValue.at(0) == '1';
+                    updated = true;
+                }
                 else
                 {
                     for (auto c : cfgKey)
@@ -892,6 +918,16 @@ namespace DaemonConfig
         {
             config.transactionValidationThreads = j["transaction-validation-threads"].GetInt();
         }
+
+        if (j.HasMember("batch-signature-verification"))
+        {
+            config.batchSignatureVerification = j["batch-signature-verification"].GetBool();
+        }
+
+        if (j.HasMember("trusted-checkpoint-import"))
+        {
+            config.trustedCheckpointImport = j["trusted-checkpoint-import"].GetBool();
+        }
     }
 
     Document asJSON(const DaemonConfiguration &config)
@@ -962,6 +998,8 @@ namespace DaemonConfig
         j.AddMember("fee-address", config.feeAddress, alloc);
         j.AddMember("fee-amount", config.feeAmount, alloc);
         j.AddMember("transaction-validation-threads", config.transactionValidationThreads, alloc);
+        j.AddMember("batch-signature-verification", config.batchSignatureVerification, alloc);
+        j.AddMember("trusted-checkpoint-import", config.trustedCheckpointImport, alloc);
 
         return j;
     }
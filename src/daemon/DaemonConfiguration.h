@@ -33,6 +33,8 @@ namespace DaemonConfig
             p2pPort = CryptoNote::P2P_DEFAULT_PORT;
             p2pExternalPort = 0;
             transactionValidationThreads = std::thread::hardware_concurrency();
+            batchSignatureVerification = false;
+            trustedCheckpointImport = false;
             rpcInterface = "127.0.0.1";
             rpcPort = CryptoNote::RPC_DEFAULT_PORT;
             noConsole = false;
@@ -84,6 +86,10 @@ namespace DaemonConfig
 
         uint32_t transactionValidationThreads;
 
+        bool batchSignatureVerification;
+
+        bool trustedCheckpointImport;
+
         uint64_t dbThreads;
 
         uint64_t dbMaxOpenFiles;
@@ -0,0 +1,114 @@
+// Copyright (c) 2012-2017, The CryptoNote developers, The Bytecoin developers
+// Copyright (c) 2018-2019, The TurtleCoin Developers
+//
+// Please see the included LICENSE file for more information.
+
+/* Migrates the blockchain DB to the current scheme without starting the
+   daemon, which would otherwise do the same the next time it starts. The
+   daemon must not be running. */
+
+#include "common/Util.h"
+#include "cryptonotecore/DatabaseBlockchainCache.h"
+#include "cryptonotecore/LevelDBWrapper.h"
+#include "cryptonotecore/RocksDBWrapper.h"
+
+#include <config/CliHeader.h>
+#include <config/CryptoNoteConfig.h>
+#include <cxxopts.hpp>
+#include <iostream>
+#include <logging/ConsoleLogger.h>
+#include <memory>
+#include <utilities/ColouredMsg.h>
+
+int main(int argc, char **argv)
+{
+    std::string dataDirectory = Tools::getDefaultDataDirectory();
+
+    bool enableLevelDB = false;
+
+    bool enableDbCompression = false;
+
+    bool help = false;
+
+    cxxopts::Options options(argv[0], CryptoNote::getProjectCLIHeader());
+
+    options.add_options("Core")(
+        "help", "Display this help message", cxxopts::value<bool>(help)->implicit_value("true"));
+
+    options.add_options("Database")(
+        "data-dir",
+        "Specify the <path> to the Blockchain data directory",
+        cxxopts::value<std::string>(dataDirectory)->default_value(dataDirectory),
+        "<path>")(
+        "db-enable-level-db",
+        "Use LevelDB instead of RocksDB",
+        cxxopts::value<bool>(enableLevelDB)->default_value("false")->implicit_value("true"))(
+        "db-enable-compression",
+        "Enable database compression",
+        cxxopts::value<bool>(enableDbCompression)->default_value("false")->implicit_value("true"));
+
+    try
+    {
+        auto result = options.parse(argc, argv);
+    }
+    catch (const cxxopts::OptionException &e)
+    {
+        std::cout << WarningMsg("Error: Unable to parse command line argument options: ") << WarningMsg(e.what())
+                  << "\n\n";
+        std::cout << options.help({}) << std::endl;
+        return 1;
+    }
+
+    if (help)
+    {
+        std::cout << options.help({}) << std::endl;
+        return 0;
+    }
+
+    const auto logger = std::make_shared<Logging::ConsoleLogger>(Logging::INFO);
+
+    std::unique_ptr<CryptoNote::IDataBase> database;
+
+    if (enableLevelDB)
+    {
+        database = std::make_unique<CryptoNote::LevelDBWrapper>(logger);
+    }
+    else
+    {
+        database = std::make_unique<CryptoNote::RocksDBWrapper>(logger);
+    }
+
+    const CryptoNote::DataBaseConfig dbConfig(
+        dataDirectory,
+        CryptoNote::ROCKSDB_BACKGROUND_THREADS,
+        enableLevelDB ? CryptoNote::LEVELDB_MAX_OPEN_FILES : CryptoNote::ROCKSDB_MAX_OPEN_FILES,
+        enableLevelDB ? CryptoNote::LEVELDB_WRITE_BUFFER_MB : CryptoNote::ROCKSDB_WRITE_BUFFER_MB,
+        enableLevelDB ? CryptoNote::LEVELDB_READ_BUFFER_MB : CryptoNote::ROCKSDB_READ_BUFFER_MB,
+        CryptoNote::LEVELDB_MAX_FILE_SIZE_MB,
+        enableDbCompression);
+
+    try
+    {
+        database->init(dbConfig);
+
+        const bool current = CryptoNote::DatabaseBlockchainCache::checkDBSchemeVersion(*database, logger);
+
+        database->shutdown();
+
+        if (!current)
+        {
+            std::cout << WarningMsg("The DB is too old to migrate. Start the daemon to rebuild it from blocks.bin.")
+                      << std::endl;
+            return 1;
+        }
+    }
+    catch (const std::exception &e)
+    {
+        std::cout << WarningMsg("DB migration failed: ") << WarningMsg(e.what()) << std::endl;
+        return 1;
+    }
+
+    std::cout << SuccessMsg("The DB is up to date.") << std::endl;
+
+    return 0;
+}
@@ -8,6 +8,7 @@
 
 #include <common/CryptoNoteTools.h>
 #include <common/Varint.h>
+#include <cstring>
 #include <serialization/CryptoNoteSerialization.h>
 #include <serialization/SerializationTools.h>
 
@@ -83,9 +84,7 @@ Crypto::Hash getMerkleRoot(const CryptoNote::BlockTemplate &block)
 
 Crypto::Hash getBlockLongHash(const CryptoNote::BlockTemplate &block)
 {
-    const std::vector<uint8_t> rawHashingBlock = block.majorVersion == CryptoNote::BLOCK_MAJOR_VERSION_1
-                                                     ? getBlockHashingBinaryArray(block)
-                                                     : getParentBlockHashingBinaryArray(block, true);
+    const std::vector<uint8_t> rawHashingBlock = getBlockLongHashingBinaryArray(block);
 
     Crypto::Hash hash;
 
@@ -102,3 +101,31 @@ Crypto::Hash getBlockLongHash(const CryptoNote::BlockTemplate &block)
         throw std::runtime_error("Unknown block major version.");
     }
 }
+
+std::vector<uint8_t> getBlockLongHashingBinaryArray(const CryptoNote::BlockTemplate &block)
+{
+    return block.majorVersion == CryptoNote::BLOCK_MAJOR_VERSION_1 ? getBlockHashingBinaryArray(block)
+                                                                    : getParentBlockHashingBinaryArray(block, true);
+}
+
+size_t getNonceOffset(const CryptoNote::BlockTemplate &block, const std::vector<uint8_t> &hashingBinaryArray)
+{
+    /* Both layouts are major version, minor version, timestamp, previous
+       block hash, then the nonce. From v2 the versions and previous hash are
+       the parent block's. */
+    size_t offset = block.majorVersion == CryptoNote::BLOCK_MAJOR_VERSION_1
+                        ? Tools::get_varint_data(block.majorVersion).size()
+                              + Tools::get_varint_data(block.minorVersion).size()
+                        : Tools::get_varint_data(block.parentBlock.majorVersion).size()
+                              + Tools::get_varint_data(block.parentBlock.minorVersion).size();
+
+    offset += Tools::get_varint_data(block.timestamp).size() + sizeof(Crypto::Hash);
+
+    if (offset + sizeof(block.nonce) > hashingBinaryArray.size()
+        || std::memcmp(hashingBinaryArray.data() + offset, &block.nonce, sizeof(block.nonce)) != 0)
+    {
+        throw std::runtime_error("Can't find the nonce in the block hashing blob");
+    }
+
+    return offset;
+}
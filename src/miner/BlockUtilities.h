@@ -24,3 +24,11 @@ Crypto::Hash getBlockHash(const CryptoNote::BlockTemplate &block);
 Crypto::Hash getMerkleRoot(const CryptoNote::BlockTemplate &block);
 
 Crypto::Hash getBlockLongHash(const CryptoNote::BlockTemplate &block);
+
+/* The data getBlockLongHash() hashes */
+std::vector<uint8_t> getBlockLongHashingBinaryArray(const CryptoNote::BlockTemplate &block);
+
+/* Where the 4 nonce bytes are in the array returned by
+   getBlockLongHashingBinaryArray(), so they can be changed in place without
+   serializing the block again */
+size_t getNonceOffset(const CryptoNote::BlockTemplate &block, const std::vector<uint8_t> &hashingBinaryArray);
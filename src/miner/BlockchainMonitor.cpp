@@ -7,23 +7,39 @@
 
 #include "common/StringTools.h"
 
+#include <config/CryptoNoteConfig.h>
 #include <iostream>
 #include <system/EventLock.h>
 #include <system/InterruptedException.h>
+#include <system/RemoteContext.h>
 #include <system/Timer.h>
 #include <utilities/ColouredMsg.h>
 #include <version.h>
 
+namespace
+{
+    /* How long we ask the daemon to hold on to a long poll */
+    const uint64_t LONG_POLL_TIMEOUT = 10;
+
+    /* Every new template restarts the miners, so only get one for new pool
+       transactions once they add up to this much in fees */
+    const uint64_t MINIMUM_FEE_CHANGE = 100 * CryptoNote::parameters::MINIMUM_FEE;
+} // namespace
+
 BlockchainMonitor::BlockchainMonitor(
     System::Dispatcher &dispatcher,
     const size_t pollingInterval,
-    const std::shared_ptr<httplib::Client> httpClient):
+    const std::shared_ptr<httplib::Client> httpClient,
+    const std::string &daemonHost,
+    const uint16_t daemonPort):
 
     m_dispatcher(dispatcher),
     m_pollingInterval(pollingInterval),
     m_stopped(false),
     m_sleepingContext(dispatcher),
-    m_httpClient(httpClient)
+    m_httpClient(httpClient),
+    m_daemonHost(daemonHost),
+    m_daemonPort(daemonPort)
 {
     std::stringstream userAgent;
     userAgent << "SoloMiner/" << PROJECT_VERSION_LONG;
@@ -31,44 +47,71 @@ BlockchainMonitor::BlockchainMonitor(
     m_requestHeaders = {{"User-Agent", userAgent.str()}};
 }
 
-void BlockchainMonitor::waitBlockchainUpdate()
+void BlockchainMonitor::waitBlockchainUpdate(const Crypto::Hash &previousBlockHash)
 {
     m_stopped = false;
 
-    auto lastBlockHash = requestLastBlockHash();
+    const uint64_t generation = m_generation;
 
-    while (!lastBlockHash && !m_stopped)
-    {
-        std::this_thread::sleep_for(std::chrono::seconds(m_pollingInterval));
-        lastBlockHash = requestLastBlockHash();
-    }
+    m_lastUpdateTimestamp.reset();
 
-    while (!m_stopped)
+    /* Start from the template, not from whatever the daemon has by the time
+       we first ask, so a block found in between isn't missed */
+    BlockchainState knownState {previousBlockHash, std::nullopt, 0, false};
+
+    const auto longPollClient =
+        std::make_shared<httplib::Client>(m_daemonHost.c_str(), m_daemonPort, LONG_POLL_TIMEOUT + 10);
+
+    /* Let the daemon tell us when something changes, rather than asking it
+       every m_pollingInterval seconds */
+    while (m_longPollSupported && !isStopped(generation))
     {
-        m_sleepingContext.spawn(
-            [this]()
+        const auto state = waitForBlockchainState(knownState, longPollClient);
+
+        if (isStopped(generation))
+        {
+            break;
+        }
+
+        if (!state)
+        {
+            if (m_longPollSupported)
             {
-                System::Timer timer(m_dispatcher);
-                timer.sleep(std::chrono::seconds(m_pollingInterval));
-            });
+                sleep();
+            }
+
+            continue;
+        }
+
+        if (state->changed)
+        {
+            m_lastUpdateTimestamp = state->changedAt;
+            return;
+        }
+
+        knownState = *state;
+    }
 
-        m_sleepingContext.wait();
+    /* Older daemons - fall back to polling */
+    while (!isStopped(generation))
+    {
+        sleep();
 
         auto nextBlockHash = requestLastBlockHash();
 
-        while (!nextBlockHash && !m_stopped)
+        while (!nextBlockHash && !isStopped(generation))
         {
             std::this_thread::sleep_for(std::chrono::seconds(m_pollingInterval));
             nextBlockHash = requestLastBlockHash();
         }
 
-        if (*lastBlockHash != *nextBlockHash)
+        if (nextBlockHash && previousBlockHash != *nextBlockHash)
         {
             break;
         }
     }
 
-    if (m_stopped)
+    if (isStopped(generation))
     {
         throw System::InterruptedException();
     }
@@ -77,11 +120,117 @@ void BlockchainMonitor::waitBlockchainUpdate()
 void BlockchainMonitor::stop()
 {
     m_stopped = true;
+    m_generation++;
 
     m_sleepingContext.interrupt();
     m_sleepingContext.wait();
 }
 
+std::optional<uint64_t> BlockchainMonitor::getLastUpdateTimestamp() const
+{
+    return m_lastUpdateTimestamp;
+}
+
+bool BlockchainMonitor::isStopped(const uint64_t generation) const
+{
+    return m_stopped || generation != m_generation;
+}
+
+void BlockchainMonitor::sleep()
+{
+    m_sleepingContext.spawn(
+        [this]()
+        {
+            System::Timer timer(m_dispatcher);
+            timer.sleep(std::chrono::seconds(m_pollingInterval));
+        });
+
+    m_sleepingContext.wait();
+}
+
+std::optional<BlockchainMonitor::BlockchainState> BlockchainMonitor::waitForBlockchainState(
+    const BlockchainState &knownState,
+    const std::shared_ptr<httplib::Client> &longPollClient)
+{
+    rapidjson::StringBuffer sb;
+
+    rapidjson::Writer<rapidjson::StringBuffer> writer(sb);
+
+    writer.StartObject();
+    {
+        writer.Key("topBlockHash");
+        knownState.topBlockHash.toJSON(writer);
+
+        /* Older daemons don't know about these, and will only wake us for a
+           new block. Until we know the daemon's total, so do we. */
+        if (knownState.poolFees)
+        {
+            writer.Key("poolFees");
+            writer.Uint64(*knownState.poolFees);
+
+            writer.Key("minimumFeeChange");
+            writer.Uint64(MINIMUM_FEE_CHANGE);
+        }
+
+        writer.Key("timeout");
+        writer.Uint64(LONG_POLL_TIMEOUT);
+    }
+    writer.EndObject();
+
+    const std::string body = sb.GetString();
+
+    /* Make the request on another thread, so the dispatcher can carry on
+       running the miner while the daemon holds on to it */
+    /* The client is captured by value, so it lives until the request
+       returns, even if we've been stopped and moved on by then */
+    System::RemoteContext<std::shared_ptr<httplib::Response>> request(
+        m_dispatcher,
+        [this, longPollClient, body]()
+        { return longPollClient->Post("/block/template/wait", m_requestHeaders, body, "application/json"); });
+
+    const auto res = request.get();
+
+    if (!res)
+    {
+        std::cout << WarningMsg("Failed to get blockchain updates - Is your daemon open?\n");
+
+        return std::nullopt;
+    }
+
+    if (res->status == 404)
+    {
+        m_longPollSupported = false;
+
+        return std::nullopt;
+    }
+
+    rapidjson::Document jsonBody;
+
+    if (res->status != 200 || jsonBody.Parse(res->body.c_str()).HasParseError())
+    {
+        std::stringstream stream;
+
+        stream << "Failed to get blockchain updates from daemon. Received data:\n" << res->body << std::endl;
+
+        std::cout << WarningMsg(stream.str());
+
+        return std::nullopt;
+    }
+
+    BlockchainState state;
+
+    state.topBlockHash.fromJSON(getJsonValue(jsonBody, "topBlockHash"));
+    state.changedAt = getUint64FromJSON(jsonBody, "changedAt");
+    state.changed = getBoolFromJSON(jsonBody, "changed");
+
+    if (hasMember(jsonBody, "poolFees"))
+    {
+        state.poolFees = getUint64FromJSON(jsonBody, "poolFees");
+    }
+
+    return state;
+}
+
 std::optional<Crypto::Hash> BlockchainMonitor::requestLastBlockHash()
 {
     auto res = m_httpClient->Get("/block/last", m_requestHeaders);
@@ -19,25 +19,74 @@ class BlockchainMonitor
     BlockchainMonitor(
         System::Dispatcher &dispatcher,
         const size_t pollingInterval,
-        const std::shared_ptr<httplib::Client> httpClient);
+        const std::shared_ptr<httplib::Client> httpClient,
+        const std::string &daemonHost,
+        const uint16_t daemonPort);
 
-    void waitBlockchainUpdate();
+    /* Returns once the chain has moved on from previousBlockHash, the block
+       the template being mined builds on, or the pool has changed enough */
+    void waitBlockchainUpdate(const Crypto::Hash &previousBlockHash);
 
     void stop();
 
+    /* When the daemon saw the change that ended the last wait, in
+       milliseconds since the epoch, if it told us */
+    std::optional<uint64_t> getLastUpdateTimestamp() const;
+
   private:
+    struct BlockchainState
+    {
+        Crypto::Hash topBlockHash;
+
+        /* Fees added to the pool since the top block changed. Not known
+           until the daemon has told us. */
+        std::optional<uint64_t> poolFees;
+
+        uint64_t changedAt;
+
+        bool changed;
+    };
+
     System::Dispatcher &m_dispatcher;
 
     size_t m_pollingInterval;
 
     bool m_stopped;
 
+    /* Bumped by stop(), so a wait that was started before the last stop()
+       doesn't report an update once its request returns */
+    uint64_t m_generation = 0;
+
     System::ContextGroup m_sleepingContext;
 
     std::optional<Crypto::Hash> requestLastBlockHash();
 
+    /* Blocks until the daemon sees a new block, or enough new pool fees to
+       be worth restarting the miners for, or the timeout passes. Returns
+       nothing if the daemon doesn't support it. */
+    std::optional<BlockchainState> waitForBlockchainState(
+        const BlockchainState &knownState,
+        const std::shared_ptr<httplib::Client> &longPollClient);
+
+    bool isStopped(const uint64_t generation) const;
+
+    void sleep();
+
     std::shared_ptr<httplib::Client> m_httpClient = nullptr;
 
+    /* Each wait makes its own connection for its long polls, so they don't
+       hold up block submissions, which share a lock in the client. A poll
+       abandoned by stop() can hold its client's lock until the daemon
+       answers it, so the next wait can't reuse it. */
+    std::string m_daemonHost;
+
+    uint16_t m_daemonPort;
+
+    /* Set to false if the daemon doesn't have /block/template/wait */
+    bool m_longPollSupported = true;
+
+    std::optional<uint64_t> m_lastUpdateTimestamp;
+
     /* Stores the HTTP headers included in all Nigel requests */
     httplib::Headers m_requestHeaders;
 };
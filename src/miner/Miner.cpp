@@ -10,7 +10,10 @@
 
 #include <common/CheckDifficulty.h>
 #include <common/StringTools.h>
+#include <config/CryptoNoteConfig.h>
+#include <crypto/chukwa.h>
 #include <crypto/crypto.h>
+#include <cstring>
 #include <crypto/random.h>
 #include <iostream>
 #include <miner/BlockUtilities.h>
@@ -101,9 +104,52 @@ namespace CryptoNote
         {
             BlockTemplate block = blockTemplate;
 
+            /* Only the nonce changes between hashes, so serialize the block
+               once, and write each new nonce straight into the blob */
+            std::vector<uint8_t> hashingBlob = getBlockLongHashingBinaryArray(block);
+
+            const size_t nonceOffset = getNonceOffset(block, hashingBlob);
+
+            /* Kept for as long as this thread mines, so we aren't allocating
+               the Argon2 memory for every hash */
+            Crypto::ChukwaContext chukwaContext;
+
+            const auto algorithm = HASHING_ALGORITHMS_BY_BLOCK_VERSION.find(block.majorVersion);
+
+            if (algorithm == HASHING_ALGORITHMS_BY_BLOCK_VERSION.end())
+            {
+                throw std::runtime_error("Unknown block major version.");
+            }
+
+            std::function<void(const void *, size_t, Crypto::Hash &)> hashingAlgorithm = algorithm->second;
+
+            /* The Chukwa hashes in the table allocate their memory every time,
+               so swap them for the same hash through our context */
+            using HashFunction = void (*)(const void *, size_t, Crypto::Hash &);
+
+            if (const auto function = algorithm->second.target<HashFunction>())
+            {
+                if (*function == Crypto::chukwa_slow_hash_v1)
+                {
+                    hashingAlgorithm = [&chukwaContext](const void *data, size_t length, Crypto::Hash &hash) {
+                        chukwaContext.hashV1(data, length, hash);
+                    };
+                }
+                else if (*function == Crypto::chukwa_slow_hash_v2)
+                {
+                    hashingAlgorithm = [&chukwaContext](const void *data, size_t length, Crypto::Hash &hash) {
+                        chukwaContext.hashV2(data, length, hash);
+                    };
+                }
+            }
+
+            Crypto::Hash hash;
+
             while (m_state == MiningState::MINING_IN_PROGRESS)
             {
-                Crypto::Hash hash = getBlockLongHash(block);
+                std::memcpy(hashingBlob.data() + nonceOffset, &block.nonce, sizeof(block.nonce));
+
+                hashingAlgorithm(hashingBlob.data(), hashingBlob.size(), hash);
 
                 if (check_hash(hash, difficulty))
                 {
@@ -64,7 +64,7 @@ namespace Miner
         m_contextGroup(dispatcher),
         m_config(config),
         m_miner(dispatcher),
-        m_blockchainMonitor(dispatcher, m_config.scanPeriod, httpClient),
+        m_blockchainMonitor(dispatcher, m_config.scanPeriod, httpClient, m_config.daemonHost, m_config.daemonPort),
         m_eventOccurred(dispatcher),
         m_lastBlockTimestamp(0),
         m_httpClient(httpClient)
@@ -78,7 +78,7 @@ namespace Miner
 
         isRunning = true;
 
-        startBlockchainMonitoring();
+        startBlockchainMonitoring(params.blockTemplate.previousBlockHash);
         std::thread reporter(std::bind(&MinerManager ::printHashRate, this));
         startMining(params);
 
@@ -133,24 +133,49 @@ namespace Miner
                     CryptoNote::BlockMiningParameters params = requestMiningParameters();
                     adjustBlockTemplate(params.blockTemplate);
 
-                    startBlockchainMonitoring();
+                    startBlockchainMonitoring(params.blockTemplate.previousBlockHash);
                     startMining(params);
                     break;
                 }
                 case MinerEventType::BLOCKCHAIN_UPDATED:
                 {
+                    const auto updateTimestamp = m_blockchainMonitor.getLastUpdateTimestamp();
+
                     stopMining();
                     stopBlockchainMonitoring();
                     CryptoNote::BlockMiningParameters params = requestMiningParameters();
                     adjustBlockTemplate(params.blockTemplate);
-                    startBlockchainMonitoring();
+                    startBlockchainMonitoring(params.blockTemplate.previousBlockHash);
                     startMining(params);
+
+                    printTemplateLatency(updateTimestamp);
                     break;
                 }
             }
         }
     }
 
+    void MinerManager::printTemplateLatency(const std::optional<uint64_t> updateTimestamp) const
+    {
+        if (!updateTimestamp)
+        {
+            return;
+        }
+
+        const uint64_t now = std::chrono::duration_cast<std::chrono::milliseconds>(
+                                 std::chrono::system_clock::now().time_since_epoch())
+                                 .count();
+
+        /* Only meaningful if our clock agrees with the daemon's */
+        if (now < *updateTimestamp)
+        {
+            return;
+        }
+
+        std::cout << InformationMsg("Mining new block template ") << InformationMsg(now - *updateTimestamp)
+                  << InformationMsg("ms after the daemon saw the change\n");
+    }
+
     MinerEvent MinerManager::waitEvent()
     {
         while (m_events.empty())
@@ -192,14 +217,14 @@ namespace Miner
         m_miner.stop();
     }
 
-    void MinerManager::startBlockchainMonitoring()
+    void MinerManager::startBlockchainMonitoring(const Crypto::Hash &previousBlockHash)
     {
         m_contextGroup.spawn(
-            [this]()
+            [this, previousBlockHash]()
             {
                 try
                 {
-                    m_blockchainMonitor.waitBlockchainUpdate();
+                    m_blockchainMonitor.waitBlockchainUpdate(previousBlockHash);
                     pushEvent(BlockchainUpdatedEvent());
                 }
                 catch (const std::exception &)
@@ -62,11 +62,15 @@ namespace Miner
 
         void printHashRate();
 
+        /* Time from the daemon seeing a new block or transaction, to us
+           mining the template that includes it */
+        void printTemplateLatency(const std::optional<uint64_t> updateTimestamp) const;
+
         void startMining(const CryptoNote::BlockMiningParameters &params);
 
         void stopMining();
 
-        void startBlockchainMonitoring();
+        void startBlockchainMonitoring(const Crypto::Hash &previousBlockHash);
 
         void stopBlockchainMonitoring();
 
@@ -59,7 +59,8 @@ namespace CryptoNote
             cxxopts::value<uint16_t>(daemonPort)->default_value(std::to_string(CryptoNote::RPC_DEFAULT_PORT)),
             "#")(
             "scan-time",
-            "Blockchain polling interval (seconds). How often miner will check the Blockchain for updates",
+            "Blockchain polling interval (seconds). How often miner will check the Blockchain for updates, if the "
+            "daemon can't notify it of them",
             cxxopts::value<size_t>(scanPeriod)->default_value("1"),
             "#");
 
@@ -12,6 +12,7 @@
 #include <cryptonotecore/CachedBlock.h>
 #include <cryptonotecore/Core.h>
 #include <errors/ValidateParameters.h>
+#include <serialization/RawBlockStream.h>
 #include <utilities/Utilities.h>
 #include <version.h>
 
@@ -25,18 +26,55 @@ inline std::shared_ptr<httplib::Client> getClient(
     const bool daemonSSL,
     const std::chrono::seconds timeout)
 {
+    std::shared_ptr<httplib::Client> client;
+
 #ifdef CPPHTTPLIB_OPENSSL_SUPPORT
     if (daemonSSL)
     {
-        return std::make_shared<httplib::SSLClient>(daemonHost.c_str(), daemonPort, timeout.count());
+        client = std::make_shared<httplib::SSLClient>(daemonHost.c_str(), daemonPort, timeout.count());
     }
     else
     {
 #endif
-        return std::make_shared<httplib::Client>(daemonHost.c_str(), daemonPort, timeout.count());
+        client = std::make_shared<httplib::Client>(daemonHost.c_str(), daemonPort, timeout.count());
 #ifdef CPPHTTPLIB_OPENSSL_SUPPORT
     }
 #endif
+
+    /* Give up on a daemon which stops sending us a response part way through */
+    client->set_read_timeout(timeout.count());
+
+    return client;
+}
+
+inline WalletTypes::WalletBlockInfo
+    toWalletBlock(const CryptoNote::RawBlock &rawBlock, const bool skipCoinbaseTransactions)
+{
+    CryptoNote::BlockTemplate blockTemplate;
+
+    fromBinaryArray(blockTemplate, rawBlock.block);
+
+    WalletTypes::WalletBlockInfo walletBlock;
+
+    CryptoNote::CachedBlock cachedBlock(blockTemplate);
+
+    walletBlock.blockHeight = cachedBlock.getBlockIndex();
+
+    walletBlock.blockHash = cachedBlock.getBlockHash();
+
+    walletBlock.blockTimestamp = blockTemplate.timestamp;
+
+    if (!skipCoinbaseTransactions)
+    {
+        walletBlock.coinbaseTransaction = CryptoNote::Core::getRawCoinbaseTransaction(blockTemplate.baseTransaction);
+    }
+
+    for (const auto &transaction : rawBlock.transactions)
+    {
+        walletBlock.transactions.push_back(CryptoNote::Core::getRawTransaction(transaction));
+    }
+
+    return walletBlock;
 }
 
 ////////////////////////////////
@@ -105,12 +143,12 @@ void Nigel::resetRequestedBlockCount()
     m_blockCount = CryptoNote::BLOCKS_SYNCHRONIZING_DEFAULT_COUNT;
 }
 
-std::tuple<bool, std::vector<WalletTypes::WalletBlockInfo>, std::optional<WalletTypes::TopBlock>>
-    Nigel::getWalletSyncData(
-        const std::vector<Crypto::Hash> blockHashCheckpoints,
-        const uint64_t startHeight,
-        const uint64_t startTimestamp,
-        const bool skipCoinbaseTransactions)
+std::tuple<bool, std::optional<WalletTypes::TopBlock>> Nigel::getWalletSyncData(
+    const std::vector<Crypto::Hash> blockHashCheckpoints,
+    const uint64_t startHeight,
+    const uint64_t startTimestamp,
+    const bool skipCoinbaseTransactions,
+    const std::function<bool(WalletTypes::WalletBlockInfo block)> &blockHandler)
 {
     rapidjson::StringBuffer sb;
 
@@ -148,48 +186,76 @@ std::tuple<bool, std::vector<WalletTypes::WalletBlockInfo>, std::optional<Wallet
 
     Logger::logger.log("Sending /sync/raw request to daemon: " + dump, Logger::TRACE, {Logger::SYNC, Logger::DAEMON});
 
-    const auto res = m_nodeClient->Post("/sync/raw", m_requestHeaders, sb.GetString(), "application/json");
+    /* Ask for the binary format, and decode the blocks as they arrive.
+       Older daemons don't know about it, and will just send JSON. */
+    auto headers = m_requestHeaders;
 
-    const auto body = getJsonBody(res, "Failed to fetch blocks from daemon");
+    headers.emplace("Accept", CryptoNote::RawBlockStream::CONTENT_TYPE + ", application/json");
+    headers.emplace(CryptoNote::RawBlockStream::COMPRESSION_HEADER, "zstd");
 
-    if (body)
-    {
-        if (!hasMember(body.value(), "error"))
+    CryptoNote::RawBlockStream::Decoder decoder;
+
+    /* Blocks are passed on as soon as they're decoded, so the wallet can
+       start processing them while the rest of the response arrives */
+    const auto receiver = [&](const char *data, size_t length) {
+        if (!decoder.addData(data, length))
         {
-            std::vector<WalletTypes::WalletBlockInfo> items;
+            return false;
+        }
 
-            for (const auto &block : getArrayFromJSON(body.value(), "blocks"))
+        for (const auto &rawBlock : decoder.takeBlocks())
+        {
+            if (!blockHandler(toWalletBlock(rawBlock, skipCoinbaseTransactions)))
             {
-                CryptoNote::RawBlock rawBlock;
+                return false;
+            }
+        }
 
-                rawBlock.fromJSON(block);
+        return true;
+    };
 
-                CryptoNote::BlockTemplate blockTemplate;
+    /* Only a chunked response is passed to the receiver, the JSON a daemon
+       which doesn't know the binary format sends ends up in the body */
+    auto res = m_nodeClient->Post("/sync/raw", headers, sb.GetString(), "application/json", receiver);
 
-                fromBinaryArray(blockTemplate, rawBlock.block);
+    if (res && res->get_header_value("Content-Type") == CryptoNote::RawBlockStream::CONTENT_TYPE)
+    {
+        if (res->status != 200 || !decoder.isComplete())
+        {
+            Logger::logger.log(
+                "Failed to fetch blocks from daemon - incomplete block stream.",
+                Logger::INFO,
+                {Logger::SYNC, Logger::DAEMON});
 
-                WalletTypes::WalletBlockInfo walletBlock;
+            return {false, std::nullopt};
+        }
 
-                CryptoNote::CachedBlock cachedBlock(blockTemplate);
+        std::optional<WalletTypes::TopBlock> topBlock;
 
-                walletBlock.blockHeight = cachedBlock.getBlockIndex();
+        if (decoder.isSynced())
+        {
+            topBlock = decoder.getTopBlock();
+        }
 
-                walletBlock.blockHash = cachedBlock.getBlockHash();
+        return {true, topBlock};
+    }
 
-                walletBlock.blockTimestamp = blockTemplate.timestamp;
+    const auto body = getJsonBody(res, "Failed to fetch blocks from daemon");
 
-                if (!skipCoinbaseTransactions)
-                {
-                    walletBlock.coinbaseTransaction =
-                        CryptoNote::Core::getRawCoinbaseTransaction(blockTemplate.baseTransaction);
-                }
+    if (body)
+    {
+        if (!hasMember(body.value(), "error"))
+        {
+            for (const auto &block : getArrayFromJSON(body.value(), "blocks"))
+            {
+                CryptoNote::RawBlock rawBlock;
 
-                for (const auto &transaction : rawBlock.transactions)
+                rawBlock.fromJSON(block);
+
+                if (!blockHandler(toWalletBlock(rawBlock, skipCoinbaseTransactions)))
                 {
-                    walletBlock.transactions.push_back(CryptoNote::Core::getRawTransaction(transaction));
+                    return {false, std::nullopt};
                 }
-
-                items.push_back(walletBlock);
             }
 
             std::optional<WalletTypes::TopBlock> topBlock;
@@ -206,11 +272,11 @@ std::tuple<bool, std::vector<WalletTypes::WalletBlockInfo>, std::optional<Wallet
                 }
             }
 
-            return {true, items, topBlock};
+            return {true, topBlock};
         }
     }
 
-    return {false, {}, std::nullopt};
+    return {false, std::nullopt};
 }
 
 void Nigel::stop()
@@ -445,6 +511,58 @@ bool Nigel::getTransactionsStatus(
     return body.has_value();
 }
 
+bool Nigel::getPoolChanges(
+    uint64_t &epoch,
+    uint64_t &cursor,
+    bool &fullSnapshot,
+    std::vector<Crypto::Hash> &addedTransactions,
+    std::vector<Crypto::Hash> &deletedTransactions) const
+{
+    const std::string path = "/transaction/pool/delta/" + std::to_string(epoch) + "/" + std::to_string(cursor);
+
+    Logger::logger.log("Sending " + path + " request to daemon", Logger::TRACE, {Logger::SYNC, Logger::DAEMON});
+
+    auto res = m_nodeClient->Get(path.c_str(), m_requestHeaders);
+
+    const auto body = getJsonBody(res, "Failed to get pool changes");
+
+    /* Older daemons don't have this */
+    if (!body || res->status != 200 || !body->IsObject() || hasMember(body.value(), "error"))
+    {
+        return false;
+    }
+
+    epoch = getUint64FromJSON(body.value(), "epoch");
+
+    cursor = getUint64FromJSON(body.value(), "cursor");
+
+    fullSnapshot = getBoolFromJSON(body.value(), "full");
+
+    addedTransactions.clear();
+
+    for (const auto &val : getArrayFromJSON(body.value(), "added"))
+    {
+        Crypto::Hash hash;
+
+        hash.fromJSON(val);
+
+        addedTransactions.push_back(hash);
+    }
+
+    deletedTransactions.clear();
+
+    for (const auto &val : getArrayFromJSON(body.value(), "deleted"))
+    {
+        Crypto::Hash hash;
+
+        hash.fromJSON(val);
+
+        deletedTransactions.push_back(hash);
+    }
+
+    return true;
+}
+
 std::tuple<bool, std::vector<WalletTypes::RandomOuts>>
     Nigel::getRandomOutsByAmounts(const std::vector<uint64_t> amounts, const uint64_t requestedOuts) const
 {
@@ -12,6 +12,7 @@
 
 #include <atomic>
 #include <config/CryptoNoteConfig.h>
+#include <functional>
 #include <logger/Logger.h>
 #include <string>
 #include <thread>
@@ -61,11 +62,15 @@ class Nigel
 
     std::tuple<std::string, uint16_t, bool> nodeAddress() const;
 
-    std::tuple<bool, std::vector<WalletTypes::WalletBlockInfo>, std::optional<WalletTypes::TopBlock>> getWalletSyncData(
+    /* Each block is passed to blockHandler as soon as it is received. If the
+       handler returns false, the rest of the response is abandoned. Returns
+       success, and the top block if the daemon says we're synced. */
+    std::tuple<bool, std::optional<WalletTypes::TopBlock>> getWalletSyncData(
         const std::vector<Crypto::Hash> blockHashCheckpoints,
         const uint64_t startHeight,
         const uint64_t startTimestamp,
-        const bool skipCoinbaseTransactions);
+        const bool skipCoinbaseTransactions,
+        const std::function<bool(WalletTypes::WalletBlockInfo block)> &blockHandler);
 
     /* Returns a bool on success or not */
     bool getTransactionsStatus(
@@ -74,6 +79,17 @@ class Nigel
         std::unordered_set<Crypto::Hash> &transactionsInBlock,
         std::unordered_set<Crypto::Hash> &transactionsUnknown) const;
 
+    /* The transactions added to and deleted from the daemon's pool since the
+       epoch and cursor, which are updated. If fullSnapshot is set, the cursor
+       was too old, or from before the daemon restarted, and addedTransactions
+       is the whole pool. Returns a bool on success or not. */
+    bool getPoolChanges(
+        uint64_t &epoch,
+        uint64_t &cursor,
+        bool &fullSnapshot,
+        std::vector<Crypto::Hash> &addedTransactions,
+        std::vector<Crypto::Hash> &deletedTransactions) const;
+
     std::tuple<bool, std::vector<WalletTypes::RandomOuts>>
         getRandomOutsByAmounts(const std::vector<uint64_t> amounts, const uint64_t requestedOuts) const;
 
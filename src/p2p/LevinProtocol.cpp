@@ -52,15 +52,7 @@ void LevinProtocol::sendMessage(uint32_t command, const BinaryArray &out, bool n
     head.m_protocol_version = LEVIN_PROTOCOL_VER_1;
     head.m_flags = LEVIN_PACKET_REQUEST;
 
-    // write header and body in one operation
-    BinaryArray writeBuffer;
-    writeBuffer.reserve(sizeof(head) + out.size());
-
-    Common::VectorOutputStream stream(writeBuffer);
-    stream.writeSome(&head, sizeof(head));
-    stream.writeSome(out.data(), out.size());
-
-    writeStrict(writeBuffer.data(), writeBuffer.size());
+    writeStrict(reinterpret_cast<const uint8_t *>(&head), sizeof(head), out);
 }
 
 bool LevinProtocol::readCommand(Command &cmd)
@@ -112,14 +104,7 @@ void LevinProtocol::sendReply(uint32_t command, const BinaryArray &out, int32_t
     head.m_flags = LEVIN_PACKET_RESPONSE;
     head.m_return_code = returnCode;
 
-    BinaryArray writeBuffer;
-    writeBuffer.reserve(sizeof(head) + out.size());
-
-    Common::VectorOutputStream stream(writeBuffer);
-    stream.writeSome(&head, sizeof(head));
-    stream.writeSome(out.data(), out.size());
-
-    writeStrict(writeBuffer.data(), writeBuffer.size());
+    writeStrict(reinterpret_cast<const uint8_t *>(&head), sizeof(head), out);
 }
 
 void LevinProtocol::writeStrict(const uint8_t *ptr, size_t size)
@@ -131,6 +116,34 @@ void LevinProtocol::writeStrict(const uint8_t *ptr, size_t size)
     }
 }
 
+void LevinProtocol::writeStrict(const uint8_t *header, size_t headerSize, const BinaryArray &body)
+{
+#if defined(__linux__)
+    size_t offset = 0;
+
+    /* Keep going until the header is out, then whatever is left of the
+       body can go on its own */
+    while (offset < headerSize)
+    {
+        offset += m_conn.write(header + offset, headerSize - offset, body.data(), body.size());
+    }
+
+    const size_t bodyOffset = offset - headerSize;
+
+    writeStrict(body.data() + bodyOffset, body.size() - bodyOffset);
+#else
+    // write header and body in one operation
+    BinaryArray writeBuffer;
+    writeBuffer.reserve(headerSize + body.size());
+
+    Common::VectorOutputStream stream(writeBuffer);
+    stream.writeSome(header, headerSize);
+    stream.writeSome(body.data(), body.size());
+
+    writeStrict(writeBuffer.data(), writeBuffer.size());
+#endif
+}
+
 bool LevinProtocol::readStrict(uint8_t *ptr, size_t size)
 {
     size_t offset = 0;
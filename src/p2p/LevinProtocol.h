@@ -109,6 +109,10 @@ namespace CryptoNote
 
         void writeStrict(const uint8_t *ptr, size_t size);
 
+        /* Writes the header followed by the body, without copying them into
+           one buffer first where the platform lets us */
+        void writeStrict(const uint8_t *header, size_t headerSize, const BinaryArray &body);
+
         System::TcpConnection &m_conn;
     };
 
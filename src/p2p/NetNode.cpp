@@ -385,14 +385,29 @@ namespace CryptoNote
         }
     }
 
+    //-----------------------------------------------------------------------------------
+    void NodeServer::drop_connection(const CryptoNoteConnectionContext &context)
+    {
+        const auto it = m_connections.find(context.m_connection_id);
+
+        if (it != m_connections.end())
+        {
+            /* The connection handler closes the connection and erases it once
+               it next runs, so this is safe inside for_each_connection() */
+            safeInterrupt(it->second);
+        }
+    }
+
     //-----------------------------------------------------------------------------------
     void NodeServer::externalRelayNotifyToAll(
         int command,
         const BinaryArray &data_buff,
         const boost::uuids::uuid *excludeConnection)
     {
-        m_dispatcher.remoteSpawn([this, command, data_buff, excludeConnection]
-                                 { relay_notify_to_all(command, data_buff, excludeConnection); });
+        const auto buffer = std::make_shared<const BinaryArray>(data_buff);
+
+        m_dispatcher.remoteSpawn([this, command, buffer, excludeConnection]
+                                 { relayNotifyToAll(command, buffer, excludeConnection); });
     }
 
     //-----------------------------------------------------------------------------------
@@ -401,8 +416,10 @@ namespace CryptoNote
         const BinaryArray &data_buff,
         const std::list<boost::uuids::uuid> relayList)
     {
+        const auto buffer = std::make_shared<const BinaryArray>(data_buff);
+
         m_dispatcher.remoteSpawn(
-            [this, command, data_buff, relayList]
+            [this, command, buffer, relayList]
             {
                 forEachConnection(
                     [&](P2pConnectionContext &conn)
@@ -413,7 +430,7 @@ namespace CryptoNote
                                 && (conn.m_state == CryptoNoteConnectionContext::state_normal
                                     || conn.m_state == CryptoNoteConnectionContext::state_synchronizing))
                             {
-                                conn.pushMessage(P2pMessage(P2pMessage::NOTIFY, command, data_buff));
+                                conn.pushMessage(P2pMessage(P2pMessage::NOTIFY, command, buffer));
                             }
                         }
                     });
@@ -715,7 +732,8 @@ namespace CryptoNote
     {
         COMMAND_TIMED_SYNC::request arg = boost::value_initialized<COMMAND_TIMED_SYNC::request>();
         m_payload_handler.get_payload_sync_data(arg.payload_data);
-        auto cmdBuf = LevinProtocol::encode<COMMAND_TIMED_SYNC::request>(arg);
+        const auto cmdBuf =
+            std::make_shared<const BinaryArray>(LevinProtocol::encode<COMMAND_TIMED_SYNC::request>(arg));
 
         forEachConnection(
             [&](P2pConnectionContext &conn)
@@ -1119,6 +1137,7 @@ namespace CryptoNote
         {
             m_connections_maker_interval.call(std::bind(&NodeServer::connections_maker, this));
             m_peerlist_store_interval.call(std::bind(&NodeServer::store_config, this));
+            m_payload_handler.onIdle();
         }
         catch (std::exception &e)
         {
@@ -1294,6 +1313,15 @@ namespace CryptoNote
         int command,
         const BinaryArray &data_buff,
         const boost::uuids::uuid *excludeConnection)
+    {
+        relayNotifyToAll(command, std::make_shared<const BinaryArray>(data_buff), excludeConnection);
+    }
+
+    //-----------------------------------------------------------------------------------
+    void NodeServer::relayNotifyToAll(
+        int command,
+        const SharedBuffer &buffer,
+        const boost::uuids::uuid *excludeConnection)
     {
         boost::uuids::uuid excludeId =
             excludeConnection ? *excludeConnection : boost::value_initialized<boost::uuids::uuid>();
@@ -1305,7 +1333,7 @@ namespace CryptoNote
                     && (conn.m_state == CryptoNoteConnectionContext::state_normal
                         || conn.m_state == CryptoNoteConnectionContext::state_synchronizing))
                 {
-                    conn.pushMessage(P2pMessage(P2pMessage::NOTIFY, command, data_buff));
+                    conn.pushMessage(P2pMessage(P2pMessage::NOTIFY, command, buffer));
                 }
             });
     }
@@ -1799,13 +1827,13 @@ namespace CryptoNote
                     switch (msg.type)
                     {
                         case P2pMessage::COMMAND:
-                            proto.sendMessage(msg.command, msg.buffer, true);
+                            proto.sendMessage(msg.command, *msg.buffer, true);
                             break;
                         case P2pMessage::NOTIFY:
-                            proto.sendMessage(msg.command, msg.buffer, false);
+                            proto.sendMessage(msg.command, *msg.buffer, false);
                             break;
                         case P2pMessage::REPLY:
-                            proto.sendReply(msg.command, msg.buffer, msg.returnCode);
+                            proto.sendReply(msg.command, *msg.buffer, msg.returnCode);
                             break;
                         default:
                             assert(false);
@@ -19,6 +19,7 @@
 #include <boost/functional/hash.hpp>
 #include <boost/uuid/uuid.hpp>
 #include <functional>
+#include <memory>
 #include <system/Context.h>
 #include <system/ContextGroup.h>
 #include <system/Dispatcher.h>
@@ -39,6 +40,10 @@ namespace CryptoNote
 
     class ISerializer;
 
+    /* An encoded message body which is never modified once created, so one
+       copy can sit in the write queue of every connection it is relayed to */
+    using SharedBuffer = std::shared_ptr<const BinaryArray>;
+
     struct P2pMessage
     {
         enum Type
@@ -49,6 +54,19 @@ namespace CryptoNote
         };
 
         P2pMessage(Type type, uint32_t command, const BinaryArray &buffer, int32_t returnCode = 0):
+            type(type), command(command), buffer(std::make_shared<const BinaryArray>(buffer)), returnCode(returnCode)
+        {
+        }
+
+        P2pMessage(Type type, uint32_t command, BinaryArray &&buffer, int32_t returnCode = 0):
+            type(type),
+            command(command),
+            buffer(std::make_shared<const BinaryArray>(std::move(buffer))),
+            returnCode(returnCode)
+        {
+        }
+
+        P2pMessage(Type type, uint32_t command, const SharedBuffer &buffer, int32_t returnCode = 0):
             type(type), command(command), buffer(buffer), returnCode(returnCode)
         {
         }
@@ -60,14 +78,14 @@ namespace CryptoNote
 
         size_t size()
         {
-            return buffer.size();
+            return buffer->size();
         }
 
         Type type;
 
         uint32_t command;
 
-        const BinaryArray buffer;
+        const SharedBuffer buffer;
 
         int32_t returnCode;
     };
@@ -251,6 +269,8 @@ namespace CryptoNote
         virtual void
             for_each_connection(std::function<void(CryptoNote::CryptoNoteConnectionContext &, uint64_t)> f) override;
 
+        virtual void drop_connection(const CryptoNote::CryptoNoteConnectionContext &context) override;
+
         virtual void externalRelayNotifyToAll(
             int command,
             const BinaryArray &data_buff,
@@ -315,6 +335,10 @@ namespace CryptoNote
 
         void writeHandler(P2pConnectionContext &ctx);
 
+        /* Queues the same buffer on every connection, rather than a copy of
+           it per connection */
+        void relayNotifyToAll(int command, const SharedBuffer &buffer, const boost::uuids::uuid *excludeConnection);
+
         void onIdle();
 
         void timedSyncLoop();
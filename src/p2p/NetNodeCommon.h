@@ -33,6 +33,9 @@ namespace CryptoNote
         virtual void
             for_each_connection(std::function<void(CryptoNote::CryptoNoteConnectionContext &, uint64_t)> f) = 0;
 
+        /* Closes the connection now, rather than when it next sends us something */
+        virtual void drop_connection(const CryptoNote::CryptoNoteConnectionContext &context) = 0;
+
         // can be called from external threads
         virtual void externalRelayNotifyToAll(
             int command,
@@ -69,6 +72,10 @@ namespace CryptoNote
         {
         }
 
+        virtual void drop_connection(const CryptoNote::CryptoNoteConnectionContext &context) override
+        {
+        }
+
         virtual uint64_t get_connections_count() override
         {
             return 0;
@@ -10,6 +10,8 @@
 #include <cstdint>
 #include <stdexcept>
 #include <sys/epoll.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
 #include <system/ErrorMessage.h>
 #include <system/InterruptedException.h>
 #include <system/Ipv4Address.h>
@@ -201,7 +203,6 @@ namespace System
             throw InterruptedException();
         }
 
-        std::string message;
         if (size == 0)
         {
             if (shutdown(connection, SHUT_WR) == -1)
@@ -212,7 +213,44 @@ namespace System
             return 0;
         }
 
-        ssize_t transferred = ::send(connection, (void *)data, size, MSG_NOSIGNAL);
+        iovec buffer;
+        buffer.iov_base = const_cast<uint8_t *>(data);
+        buffer.iov_len = size;
+
+        return writeVectored(&buffer, 1, size);
+    }
+
+    std::size_t TcpConnection::write(
+        const uint8_t *header,
+        std::size_t headerSize,
+        const uint8_t *data,
+        std::size_t size)
+    {
+        assert(dispatcher != nullptr);
+        assert(contextPair.writeContext == nullptr);
+        if (dispatcher->interrupted())
+        {
+            throw InterruptedException();
+        }
+
+        iovec buffers[2];
+        buffers[0].iov_base = const_cast<uint8_t *>(header);
+        buffers[0].iov_len = headerSize;
+        buffers[1].iov_base = const_cast<uint8_t *>(data);
+        buffers[1].iov_len = size;
+
+        return writeVectored(buffers, 2, headerSize + size);
+    }
+
+    std::size_t TcpConnection::writeVectored(const iovec *buffers, std::size_t count, std::size_t size)
+    {
+        msghdr header {};
+        header.msg_iov = const_cast<iovec *>(buffers);
+        header.msg_iovlen = count;
+
+        std::string message;
+
+        ssize_t transferred = ::sendmsg(connection, &header, MSG_NOSIGNAL);
         if (transferred == -1)
         {
             bool knownError = false;
@@ -304,7 +342,7 @@ namespace System
                         throw std::runtime_error("TcpConnection::write, events & (EPOLLERR | EPOLLHUP) != 0");
                     }
 
-                    ssize_t transferred = ::send(connection, (void *)data, size, 0);
+                    ssize_t transferred = ::sendmsg(connection, &header, MSG_NOSIGNAL);
                     if (transferred == -1)
                     {
                         message = "send failed, " + lastErrorMessage();
@@ -11,6 +11,8 @@
 #include <cstdint>
 #include <string>
 
+struct iovec;
+
 namespace System
 {
     class Ipv4Address;
@@ -34,6 +36,10 @@ namespace System
 
         std::size_t write(const uint8_t *data, std::size_t size);
 
+        /* Sends the header then the data in one call, without joining them
+           into one buffer. Returns the number of bytes sent from both. */
+        std::size_t write(const uint8_t *header, std::size_t headerSize, const uint8_t *data, std::size_t size);
+
         std::pair<Ipv4Address, uint16_t> getPeerAddressAndPort() const;
 
       private:
@@ -48,6 +54,8 @@ namespace System
         ContextPair contextPair;
 
         TcpConnection(Dispatcher &dispatcher, int socket);
+
+        std::size_t writeVectored(const iovec *buffers, std::size_t count, std::size_t size);
     };
 
 } // namespace System
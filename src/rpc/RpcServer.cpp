@@ -13,6 +13,7 @@
 #include <errors/ValidateParameters.h>
 #include <iostream>
 #include <logger/Logger.h>
+#include <serialization/RawBlockStream.h>
 #include <serialization/SerializationTools.h>
 #include <utilities/Addresses.h>
 #include <utilities/ColouredMsg.h>
@@ -107,6 +108,10 @@ RpcServer::RpcServer(
 
         .Post("/block/template", router(&RpcServer::getBlockTemplate, RpcMode::Default, bodyRequired, syncNotRequired))
 
+        .Post(
+            "/block/template/wait",
+            router(&RpcServer::waitForBlockchainUpdate, RpcMode::Default, bodyRequired, syncNotRequired))
+
         .Get("/fee", router(&RpcServer::fee, RpcMode::Default, bodyNotRequired, syncNotRequired))
 
         .Get("/height", router(&RpcServer::height, RpcMode::Default, bodyNotRequired, syncNotRequired))
@@ -148,6 +153,10 @@ RpcServer::RpcServer(
             "/transaction/pool/delta",
             router(&RpcServer::getPoolChanges, RpcMode::Default, bodyRequired, syncNotRequired))
 
+        .Get(
+            "/transaction/pool/delta/(\\d+)/(\\d+)", /* /transaction/pool/delta/{epoch}/{cursor} */
+            router(&RpcServer::getPoolChangesSince, RpcMode::Default, bodyNotRequired, syncNotRequired))
+
         .Get(
             "/transaction/pool/raw",
             router(
@@ -169,6 +178,16 @@ RpcServer::~RpcServer()
 
 void RpcServer::start()
 {
+    {
+        std::scoped_lock lock(m_blockchainStateMutex);
+
+        m_topBlockHash = m_core->getTopBlockHash();
+        m_topBlockIndex = m_core->getTopBlockIndex();
+        m_blockchainMonitorStopped = false;
+    }
+
+    m_blockchainMonitorThread = std::thread(&RpcServer::monitorBlockchain, this);
+
     m_serverThread = std::thread(&RpcServer::listen, this);
 }
 
@@ -187,12 +206,140 @@ void RpcServer::listen()
 
 void RpcServer::stop()
 {
+    {
+        std::scoped_lock lock(m_blockchainStateMutex);
+
+        m_blockchainMonitorStopped = true;
+
+        if (m_blockchainMessages != nullptr)
+        {
+            const auto messageQueue = m_blockchainMessages;
+
+            m_blockchainMonitorDispatcher->remoteSpawn([messageQueue]() { messageQueue->stop(); });
+        }
+    }
+
+    /* Let any long polls return before we stop the server */
+    m_blockchainStateChanged.notify_all();
+
     m_server.stop();
 
     if (m_serverThread.joinable())
     {
         m_serverThread.join();
     }
+
+    if (m_blockchainMonitorThread.joinable())
+    {
+        m_blockchainMonitorThread.join();
+    }
+}
+
+void RpcServer::monitorBlockchain()
+{
+    System::Dispatcher dispatcher;
+
+    CryptoNote::MessageQueue<CryptoNote::BlockchainMessage> messageQueue(dispatcher);
+
+    CryptoNote::MesageQueueGuard<CryptoNote::Core, CryptoNote::BlockchainMessage> messageQueueGuard(
+        *m_core, messageQueue);
+
+    {
+        std::scoped_lock lock(m_blockchainStateMutex);
+
+        if (m_blockchainMonitorStopped)
+        {
+            return;
+        }
+
+        m_blockchainMonitorDispatcher = &dispatcher;
+        m_blockchainMessages = &messageQueue;
+
+        /* Anything added between start() and the queue being registered */
+        m_topBlockHash = m_core->getTopBlockHash();
+        m_topBlockIndex = m_core->getTopBlockIndex();
+    }
+
+    try
+    {
+        while (true)
+        {
+            const CryptoNote::BlockchainMessage message = messageQueue.front();
+
+            messageQueue.pop();
+
+            handleBlockchainMessage(message);
+        }
+    }
+    catch (const System::InterruptedException &)
+    {
+    }
+
+    std::scoped_lock lock(m_blockchainStateMutex);
+
+    m_blockchainMonitorDispatcher = nullptr;
+    m_blockchainMessages = nullptr;
+}
+
+void RpcServer::handleBlockchainMessage(const CryptoNote::BlockchainMessage &message)
+{
+    /* Looked up before taking the lock, so waiting requests aren't held up */
+    uint64_t addedFees = 0;
+
+    if (message.getType() == CryptoNote::BlockchainMessage::Type::AddTransaction)
+    {
+        for (const auto &hash : message.getAddTransaction().hashes)
+        {
+            const auto [found, transaction] = m_core->getPoolTransaction(hash);
+
+            if (found)
+            {
+                addedFees += CryptoNote::CachedTransaction(transaction).getTransactionFee();
+            }
+        }
+    }
+
+    {
+        std::scoped_lock lock(m_blockchainStateMutex);
+
+        switch (message.getType())
+        {
+            case CryptoNote::BlockchainMessage::Type::NewBlock:
+            {
+                m_topBlockHash = message.getNewBlock().blockHash;
+                m_topBlockIndex = message.getNewBlock().blockIndex;
+                m_poolFees = 0;
+                break;
+            }
+            case CryptoNote::BlockchainMessage::Type::ChainSwitch:
+            {
+                const auto &chainSwitch = message.getChainSwitch();
+
+                /* The hashes start with the common root */
+                m_topBlockHash = chainSwitch.blocksFromCommonRoot.back();
+                m_topBlockIndex =
+                    chainSwitch.commonRootIndex + static_cast<uint32_t>(chainSwitch.blocksFromCommonRoot.size()) - 1;
+                m_poolFees = 0;
+                break;
+            }
+            case CryptoNote::BlockchainMessage::Type::AddTransaction:
+            {
+                m_poolRevision++;
+                m_poolFees += addedFees;
+                break;
+            }
+            default:
+            {
+                return;
+            }
+        }
+
+        m_blockchainStateTimestamp = std::chrono::duration_cast<std::chrono::milliseconds>(
+                                         std::chrono::system_clock::now().time_since_epoch())
+                                         .count();
+    }
+
+    m_blockchainStateChanged.notify_all();
 }
 
 std::tuple<std::string, uint16_t> RpcServer::getConnectionInfo()
@@ -488,6 +635,25 @@ std::tuple<Error, uint16_t>
         writer.Key("version");
         writer.String(PROJECT_VERSION);
 
+        const auto syncCacheStatistics = m_core->getWalletSyncCacheStatistics();
+
+        writer.Key("walletSyncCache");
+        writer.StartObject();
+        {
+            writer.Key("blocks");
+            writer.Uint64(syncCacheStatistics.blockCount);
+
+            writer.Key("size");
+            writer.Uint64(syncCacheStatistics.size);
+
+            writer.Key("hits");
+            writer.Uint64(syncCacheStatistics.hits);
+
+            writer.Key("misses");
+            writer.Uint64(syncCacheStatistics.misses);
+        }
+        writer.EndObject();
+
         writer.Key("whitePeerlistSize");
         writer.Uint64(m_p2p->getPeerlistManager().get_white_peers_count());
     }
@@ -644,25 +810,37 @@ std::tuple<Error, uint16_t>
 
     const uint64_t numOutputs = getUint64FromJSON(body, "count");
 
+    std::vector<uint64_t> amounts;
+
+    for (const auto &jsonAmount : getArrayFromJSON(body, "amounts"))
+    {
+        amounts.push_back(jsonAmount.GetUint64());
+    }
+
+    /* Every amount is looked up together, rather than one at a time */
+    std::vector<std::vector<uint32_t>> allGlobalIndexes;
+
+    std::vector<std::vector<Crypto::PublicKey>> allPublicKeys;
+
+    const auto [success, error] =
+        m_core->getRandomOutputs(amounts, static_cast<uint16_t>(numOutputs), allGlobalIndexes, allPublicKeys);
+
+    if (!success)
+    {
+        return {Error(CANT_GET_FAKE_OUTPUTS, error), 500};
+    }
+
     writer.StartArray();
     {
-        for (const auto &jsonAmount : getArrayFromJSON(body, "amounts"))
+        for (size_t amountIndex = 0; amountIndex < amounts.size(); amountIndex++)
         {
             writer.StartObject();
 
-            const uint64_t amount = jsonAmount.GetUint64();
-
-            std::vector<uint32_t> globalIndexes;
-
-            std::vector<Crypto::PublicKey> publicKeys;
+            const uint64_t amount = amounts[amountIndex];
 
-            const auto [success, error] =
-                m_core->getRandomOutputs(amount, static_cast<uint16_t>(numOutputs), globalIndexes, publicKeys);
+            const auto &globalIndexes = allGlobalIndexes[amountIndex];
 
-            if (!success)
-            {
-                return {Error(CANT_GET_FAKE_OUTPUTS, error), 500};
-            }
+            const auto &publicKeys = allPublicKeys[amountIndex];
 
             if (globalIndexes.size() != numOutputs)
             {
@@ -1123,152 +1301,174 @@ std::tuple<Error, uint16_t>
     return {SUCCESS, 202};
 }
 
-std::tuple<Error, uint16_t>
-    RpcServer::getBlockCount(const httplib::Request &req, httplib::Response &res, const rapidjson::Document &body)
+std::tuple<Error, uint16_t> RpcServer::waitForBlockchainUpdate(
+    const httplib::Request &req,
+    httplib::Response &res,
+    const rapidjson::Document &body)
 {
     rapidjson::StringBuffer sb;
 
     rapidjson::Writer<rapidjson::StringBuffer> writer(sb);
 
-    writer.Uint64(m_core->getTopBlockIndex() + 1);
+    Crypto::Hash knownTopBlockHash;
 
-    res.body = sb.GetString();
+    if (!Common::podFromHex(getStringFromJSON(body, "topBlockHash"), knownTopBlockHash))
+    {
+        return {Error(API_INVALID_ARGUMENT, "topBlockHash is not a valid hash."), 400};
+    }
 
-    return {SUCCESS, 200};
-}
+    /* Pool changes only end the wait if the caller tells us which pool it
+       last saw */
+    const bool waitForPool = hasMember(body, "poolRevision");
 
-uint64_t RpcServer::calculateTotalFeeAmount(const std::vector<Crypto::Hash> &transactionHashes)
-{
-    uint64_t totalFeeAmount = 0;
+    const uint64_t knownPoolRevision = waitForPool ? getUint64FromJSON(body, "poolRevision") : 0;
 
-    std::vector<Crypto::Hash> ignore;
+    /* Or only once the pool's fees have gone up by this much since the
+       total the caller last saw */
+    const bool waitForFees = hasMember(body, "minimumFeeChange");
 
-    std::vector<std::vector<uint8_t>> transactions;
+    const uint64_t minimumFeeChange = waitForFees ? getUint64FromJSON(body, "minimumFeeChange") : 0;
 
-    m_core->getTransactions(transactionHashes, transactions, ignore);
+    const uint64_t knownPoolFees = hasMember(body, "poolFees") ? getUint64FromJSON(body, "poolFees") : 0;
 
-    for (const std::vector<uint8_t> rawTX : transactions)
-    {
-        {
-            CryptoNote::Transaction tx;
+    const uint64_t timeout = std::min(
+        hasMember(body, "timeout") ? getUint64FromJSON(body, "timeout")
+                                   : CryptoNote::RPC_BLOCKCHAIN_UPDATE_DEFAULT_TIMEOUT,
+        CryptoNote::RPC_BLOCKCHAIN_UPDATE_MAX_TIMEOUT);
 
-            fromBinaryArray(tx, rawTX);
+    std::unique_lock lock(m_blockchainStateMutex);
 
-            const uint64_t outputAmount = std::accumulate(
-                tx.outputs.begin(),
-                tx.outputs.end(),
-                0ull,
-                [](const auto acc, const auto out) { return acc + out.amount; });
+    const auto changed = [&]() {
+        return m_topBlockHash != knownTopBlockHash || (waitForPool && m_poolRevision != knownPoolRevision)
+               || (waitForFees && m_poolFees >= knownPoolFees + minimumFeeChange);
+    };
 
-            const uint64_t inputAmount = std::accumulate(
-                tx.inputs.begin(),
-                tx.inputs.end(),
-                0ull,
-                [](const auto acc, const auto in)
-                {
-                    if (in.type() == typeid(CryptoNote::KeyInput))
-                    {
-                        return acc + boost::get<CryptoNote::KeyInput>(in).amount;
-                    }
+    m_blockchainStateChanged.wait_for(
+        lock, std::chrono::seconds(timeout), [&]() { return m_blockchainMonitorStopped || changed(); });
 
-                    return acc;
-                });
+    writer.StartObject();
+    {
+        writer.Key("changed");
+        writer.Bool(changed());
 
-            const uint64_t fee = inputAmount - outputAmount;
+        writer.Key("topBlockHash");
+        m_topBlockHash.toJSON(writer);
 
-            totalFeeAmount += fee;
-        }
+        writer.Key("height");
+        writer.Uint(m_topBlockIndex + 1);
+
+        writer.Key("poolRevision");
+        writer.Uint64(m_poolRevision);
+
+        writer.Key("poolFees");
+        writer.Uint64(m_poolFees);
+
+        /* So clients can measure how long it took them to react */
+        writer.Key("changedAt");
+        writer.Uint64(m_blockchainStateTimestamp);
     }
+    writer.EndObject();
+
+    res.body = sb.GetString();
 
-    return totalFeeAmount;
+    return {SUCCESS, 200};
 }
 
-void RpcServer::generateBlockHeader(
-    const Crypto::Hash &blockHash,
-    rapidjson::Writer<rapidjson::StringBuffer> &writer,
-    const bool headerOnly)
+std::tuple<Error, uint16_t>
+    RpcServer::getBlockCount(const httplib::Request &req, httplib::Response &res, const rapidjson::Document &body)
 {
-    const auto topHeight = m_core->getTopBlockIndex();
-
-    CryptoNote::BlockTemplate block = m_core->getBlockByHash(blockHash);
+    rapidjson::StringBuffer sb;
 
-    CryptoNote::CachedBlock cachedBlock(block);
+    rapidjson::Writer<rapidjson::StringBuffer> writer(sb);
 
-    const auto height = cachedBlock.getBlockIndex();
+    writer.Uint64(m_core->getTopBlockIndex() + 1);
 
-    const auto outputs = block.baseTransaction.outputs;
+    res.body = sb.GetString();
 
-    const auto extraDetails = m_core->getBlockDetails(blockHash);
+    return {SUCCESS, 200};
+}
 
-    const uint64_t reward = std::accumulate(
-        outputs.begin(), outputs.end(), 0ull, [](const auto acc, const auto out) { return acc + out.amount; });
+void RpcServer::generateBlockHeader(
+    const Crypto::Hash &blockHash,
+    rapidjson::Writer<rapidjson::StringBuffer> &writer,
+    const bool headerOnly)
+{
+    const auto topHeight = m_core->getTopBlockIndex();
 
-    const uint64_t totalFeeAmount = calculateTotalFeeAmount(block.transactionHashes);
+    const auto summary = m_core->getBlockSummary(blockHash);
 
-    std::vector<Crypto::Hash> ignore;
+    const bool orphan = summary.blockIndex > topHeight || m_core->getBlockHashByIndex(summary.blockIndex) != blockHash;
 
-    std::vector<std::vector<uint8_t>> transactions;
+    generateBlockHeader(summary, topHeight, orphan, writer, headerOnly);
+}
 
-    m_core->getTransactions(block.transactionHashes, transactions, ignore);
+void RpcServer::generateBlockHeader(
+    const CryptoNote::BlockSummary &summary,
+    const uint64_t topHeight,
+    const bool orphan,
+    rapidjson::Writer<rapidjson::StringBuffer> &writer,
+    const bool headerOnly)
+{
+    const auto height = summary.blockIndex;
 
     writer.StartObject();
     {
         writer.Key("alreadyGeneratedCoins");
-        writer.String(std::to_string(extraDetails.alreadyGeneratedCoins));
+        writer.String(std::to_string(summary.alreadyGeneratedCoins));
 
         writer.Key("alreadyGeneratedTransactions");
-        writer.Uint64(extraDetails.alreadyGeneratedTransactions);
+        writer.Uint64(summary.alreadyGeneratedTransactions);
 
         writer.Key("baseReward");
-        writer.Uint64(extraDetails.baseReward);
+        writer.Uint64(summary.baseReward);
 
         writer.Key("depth");
         writer.Uint64(topHeight - height);
 
         writer.Key("difficulty");
-        writer.Uint64(m_core->getBlockDifficulty(height));
+        writer.Uint64(summary.difficulty);
 
         writer.Key("hash");
-        blockHash.toJSON(writer);
+        summary.blockHash.toJSON(writer);
 
         writer.Key("height");
         writer.Uint64(height);
 
         writer.Key("majorVersion");
-        writer.Uint64(block.majorVersion);
+        writer.Uint64(summary.majorVersion);
 
         writer.Key("minorVersion");
-        writer.Uint64(block.minorVersion);
+        writer.Uint64(summary.minorVersion);
 
         writer.Key("nonce");
-        writer.Uint64(block.nonce);
+        writer.Uint64(summary.nonce);
 
         writer.Key("orphan");
-        writer.Bool(extraDetails.isAlternative);
+        writer.Bool(orphan);
 
         writer.Key("penalty");
-        writer.Uint64(extraDetails.penalty);
+        writer.Uint64(summary.getPenalty());
 
         writer.Key("prevHash");
-        block.previousBlockHash.toJSON(writer);
+        summary.previousBlockHash.toJSON(writer);
 
         writer.Key("reward");
-        writer.Uint64(reward);
+        writer.Uint64(summary.reward);
 
         writer.Key("size");
-        writer.Uint64(extraDetails.blockSize);
+        writer.Uint64(summary.blockSize);
 
         writer.Key("sizeMedian");
-        writer.Uint64(extraDetails.sizeMedian);
+        writer.Uint64(summary.sizeMedian);
 
         writer.Key("timestamp");
-        writer.Uint64(block.timestamp);
+        writer.Uint64(summary.timestamp);
 
         writer.Key("totalFeeAmount");
-        writer.Uint64(totalFeeAmount);
+        writer.Uint64(summary.totalFeeAmount);
 
         writer.Key("transactionCount");
-        writer.Uint64(extraDetails.transactions.size());
+        writer.Uint64(summary.transactions.size());
 
         /* If we are not part of a sub-object (such as /transaction) then we can
          * include basic information about the transactions */
@@ -1277,74 +1477,22 @@ void RpcServer::generateBlockHeader(
             writer.Key("transactions");
             writer.StartArray();
             {
-                /* Coinbase transaction */
-                writer.StartObject();
-                {
-                    const auto txOutputs = block.baseTransaction.outputs;
-
-                    const uint64_t outputAmount = std::accumulate(
-                        txOutputs.begin(),
-                        txOutputs.end(),
-                        0ull,
-                        [](const auto acc, const auto out) { return acc + out.amount; });
-
-                    writer.Key("amountOut");
-                    writer.Uint64(outputAmount);
-
-                    writer.Key("fee");
-                    writer.Uint64(0);
-
-                    writer.Key("hash");
-                    const auto baseTransactionBranch = getObjectHash(block.baseTransaction);
-                    baseTransactionBranch.toJSON(writer);
-
-                    writer.Key("size");
-                    writer.Uint64(getObjectBinarySize(block.baseTransaction));
-                }
-                writer.EndObject();
-
-                for (const std::vector<uint8_t> rawTX : transactions)
+                /* Coinbase transaction first */
+                for (const auto &transaction : summary.transactions)
                 {
                     writer.StartObject();
                     {
-                        CryptoNote::Transaction tx;
-
-                        fromBinaryArray(tx, rawTX);
-
-                        const uint64_t outputAmount = std::accumulate(
-                            tx.outputs.begin(),
-                            tx.outputs.end(),
-                            0ull,
-                            [](const auto acc, const auto out) { return acc + out.amount; });
-
-                        const uint64_t inputAmount = std::accumulate(
-                            tx.inputs.begin(),
-                            tx.inputs.end(),
-                            0ull,
-                            [](const auto acc, const auto in)
-                            {
-                                if (in.type() == typeid(CryptoNote::KeyInput))
-                                {
-                                    return acc + boost::get<CryptoNote::KeyInput>(in).amount;
-                                }
-
-                                return acc;
-                            });
-
-                        const uint64_t fee = inputAmount - outputAmount;
-
                         writer.Key("amountOut");
-                        writer.Uint64(outputAmount);
+                        writer.Uint64(transaction.amountOut);
 
                         writer.Key("fee");
-                        writer.Uint64(fee);
+                        writer.Uint64(transaction.fee);
 
                         writer.Key("hash");
-                        const auto txHash = getObjectHash(tx);
-                        txHash.toJSON(writer);
+                        transaction.transactionHash.toJSON(writer);
 
                         writer.Key("size");
-                        writer.Uint64(getObjectBinarySize(tx));
+                        writer.Uint64(transaction.size);
                     }
                     writer.EndObject();
                 }
@@ -1353,7 +1501,7 @@ void RpcServer::generateBlockHeader(
         }
 
         writer.Key("transactionsCumulativeSize");
-        writer.Uint64(extraDetails.transactionsCumulativeSize);
+        writer.Uint64(summary.transactionsCumulativeSize);
     }
     writer.EndObject();
 }
@@ -1503,15 +1651,15 @@ std::tuple<Error, uint16_t>
 
     const uint64_t startHeight = height < MAX_BLOCKS_COUNT ? 0 : height - MAX_BLOCKS_COUNT;
 
+    const auto summaries =
+        m_core->getBlockSummaries(static_cast<uint32_t>(startHeight), static_cast<uint32_t>(height - startHeight + 1));
+
     writer.StartArray();
     {
-        /* Loop through the blocks in descending order and throw their resulting
-         * headers into the array for the response */
-        for (uint64_t i = height; i >= startHeight && i <= height; i--)
+        /* Throw the headers into the array in descending order */
+        for (auto it = summaries.rbegin(); it != summaries.rend(); it++)
         {
-            const auto hash = m_core->getBlockHashByIndex(i);
-
-            generateBlockHeader(hash, writer);
+            generateBlockHeader(*it, topHeight, false, writer);
         }
     }
     writer.EndArray();
@@ -1898,6 +2046,90 @@ std::tuple<Error, uint16_t>
     return {SUCCESS, 200};
 }
 
+/* Rather than the client sending every pool transaction it knows about, it
+   sends the epoch and cursor we gave it last time, and gets back what has
+   changed since. If the epoch isn't ours, as we've restarted, or we don't
+   remember that far back, it gets the whole pool, with full set to true, and
+   should forget what it had. */
+std::tuple<Error, uint16_t>
+    RpcServer::getPoolChangesSince(const httplib::Request &req, httplib::Response &res, const rapidjson::Document &body)
+{
+    rapidjson::StringBuffer sb;
+
+    rapidjson::Writer<rapidjson::StringBuffer> writer(sb);
+
+    uint64_t epoch = 0;
+
+    uint64_t cursor = 0;
+
+    try
+    {
+        std::string epochStr = req.matches[1];
+
+        epoch = std::stoull(epochStr);
+
+        std::string cursorStr = req.matches[2];
+
+        cursor = std::stoull(cursorStr);
+    }
+    catch (const std::out_of_range &)
+    {
+        return {Error(API_INVALID_ARGUMENT), 400};
+    }
+    catch (const std::invalid_argument &)
+    {
+        return {Error(API_INVALID_ARGUMENT), 400};
+    }
+
+    std::vector<Crypto::Hash> addedTransactions;
+
+    std::vector<Crypto::Hash> deletedTransactions;
+
+    uint64_t newEpoch = 0;
+
+    uint64_t newCursor = 0;
+
+    const bool isDelta = m_core->getPoolChangesSince(
+        epoch, cursor, addedTransactions, deletedTransactions, newEpoch, newCursor);
+
+    writer.StartObject();
+    {
+        writer.Key("epoch");
+        writer.Uint64(newEpoch);
+
+        writer.Key("cursor");
+        writer.Uint64(newCursor);
+
+        writer.Key("full");
+        writer.Bool(!isDelta);
+
+        writer.Key("added");
+        writer.StartArray();
+        {
+            for (const auto &hash : addedTransactions)
+            {
+                hash.toJSON(writer);
+            }
+        }
+        writer.EndArray();
+
+        writer.Key("deleted");
+        writer.StartArray();
+        {
+            for (const auto &hash : deletedTransactions)
+            {
+                hash.toJSON(writer);
+            }
+        }
+        writer.EndArray();
+    }
+    writer.EndObject();
+
+    res.body = sb.GetString();
+
+    return {SUCCESS, 200};
+}
+
 std::tuple<Error, uint16_t>
     RpcServer::getRawBlocks(const httplib::Request &req, httplib::Response &res, const rapidjson::Document &body)
 {
@@ -1950,6 +2182,25 @@ std::tuple<Error, uint16_t>
             return {Error(API_INTERNAL_ERROR, "Failed to retrieve raw blocks from underlying storage."), 500};
         }
 
+        /* Newer wallets can take the blocks in a compact binary format, which
+           we send a frame at a time as it is encoded */
+        if (req.get_header_value("Accept").find(CryptoNote::RawBlockStream::CONTENT_TYPE) != std::string::npos)
+        {
+            const bool compress = req.get_header_value(CryptoNote::RawBlockStream::COMPRESSION_HEADER) == "zstd";
+
+            const bool synced = rawBlocks.empty();
+
+            const auto encoder = std::make_shared<CryptoNote::RawBlockStream::Encoder>(
+                std::move(rawBlocks), synced, topBlockInfo, compress);
+
+            res.headers.erase("Content-Type");
+            res.set_header("Content-Type", CryptoNote::RawBlockStream::CONTENT_TYPE);
+
+            res.streamcb = [encoder](uint64_t offset) { return encoder->nextFrame(); };
+
+            return {SUCCESS, 200};
+        }
+
         writer.Key("blocks");
         writer.StartArray();
         {
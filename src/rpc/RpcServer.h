@@ -9,14 +9,18 @@
 #include "rapidjson/stringbuffer.h"
 #include "rapidjson/writer.h"
 
+#include <condition_variable>
 #include <cryptonotecore/Core.h>
 #include <cryptonoteprotocol/CryptoNoteProtocolHandlerCommon.h>
 #include <errors/Errors.h>
 #include <future>
 #include <memory>
+#include <mutex>
 #include <optional>
 #include <p2p/NetNode.h>
 #include <string>
+#include <system/Dispatcher.h>
+#include <thread>
 
 enum class RpcMode
 {
@@ -65,6 +69,12 @@ class RpcServer
     /* Starts listening for requests on the server */
     void listen();
 
+    /* Reads the core's blockchain messages, waking up anyone waiting in
+       waitForBlockchainUpdate() when the top block or the pool changes */
+    void monitorBlockchain();
+
+    void handleBlockchainMessage(const CryptoNote::BlockchainMessage &message);
+
     std::optional<rapidjson::Document>
         getJsonBody(const httplib::Request &req, httplib::Response &res, const bool bodyRequired);
 
@@ -82,13 +92,18 @@ class RpcServer
 
     void failRequest(const Error error, httplib::Response &res);
 
-    uint64_t calculateTotalFeeAmount(const std::vector<Crypto::Hash> &transactionHashes);
-
     void generateBlockHeader(
         const Crypto::Hash &blockHash,
         rapidjson::Writer<rapidjson::StringBuffer> &writer,
         const bool headerOnly = false);
 
+    void generateBlockHeader(
+        const CryptoNote::BlockSummary &summary,
+        const uint64_t topHeight,
+        const bool orphan,
+        rapidjson::Writer<rapidjson::StringBuffer> &writer,
+        const bool headerOnly = false);
+
     void generateTransactionPrefix(
         const CryptoNote::Transaction &tx,
         rapidjson::Writer<rapidjson::StringBuffer> &writer);
@@ -175,6 +190,9 @@ class RpcServer
     std::tuple<Error, uint16_t>
         getPoolChanges(const httplib::Request &req, httplib::Response &res, const rapidjson::Document &body);
 
+    std::tuple<Error, uint16_t>
+        getPoolChangesSince(const httplib::Request &req, httplib::Response &res, const rapidjson::Document &body);
+
     std::tuple<Error, uint16_t>
         getRawBlocks(const httplib::Request &req, httplib::Response &res, const rapidjson::Document &body);
 
@@ -184,6 +202,9 @@ class RpcServer
     std::tuple<Error, uint16_t>
         submitBlock(const httplib::Request &req, httplib::Response &res, const rapidjson::Document &body);
 
+    std::tuple<Error, uint16_t>
+        waitForBlockchainUpdate(const httplib::Request &req, httplib::Response &res, const rapidjson::Document &body);
+
     //////////////////////////////
     /* Private member variables */
     //////////////////////////////
@@ -222,4 +243,37 @@ class RpcServer
     const std::shared_ptr<CryptoNote::ICryptoNoteProtocolHandler> m_syncManager;
 
     const std::string m_hashRegex = "([a-fA-F0-9]{64})";
+
+    /* The thread reading the core's blockchain messages */
+    std::thread m_blockchainMonitorThread;
+
+    /* Guards everything below, and the message queue pointers */
+    std::mutex m_blockchainStateMutex;
+
+    /* Signalled whenever the top block or the pool changes */
+    std::condition_variable m_blockchainStateChanged;
+
+    Crypto::Hash m_topBlockHash;
+
+    uint32_t m_topBlockIndex = 0;
+
+    /* Incremented every time a transaction is added to the pool. Removals
+       don't count, a template with fewer transactions available is still
+       worth mining. */
+    uint64_t m_poolRevision = 0;
+
+    /* Total fee of the transactions added to the pool since the top block
+       last changed, so miners can wait for the pool to be worth a new
+       template rather than restarting for every transaction */
+    uint64_t m_poolFees = 0;
+
+    /* Milliseconds since the epoch of the last change to the above */
+    uint64_t m_blockchainStateTimestamp = 0;
+
+    bool m_blockchainMonitorStopped = false;
+
+    /* Owned by the monitor thread, only valid while it is running */
+    System::Dispatcher *m_blockchainMonitorDispatcher = nullptr;
+
+    CryptoNote::MessageQueue<CryptoNote::BlockchainMessage> *m_blockchainMessages = nullptr;
 };
@@ -0,0 +1,342 @@
+// Copyright (c) 2018-2019, The TurtleCoin Developers
+//
+// Please see the included LICENSE file for more information.
+
+#include "RawBlockStream.h"
+
+#include <common/Varint.h>
+#include <cstring>
+#include <iterator>
+#include <lib/zstd.h>
+
+namespace
+{
+    /* Favour speed, we're compressing these on the fly for every request */
+    const int COMPRESSION_LEVEL = 1;
+
+    void writeBlob(std::string &out, const CryptoNote::BinaryArray &blob)
+    {
+        Tools::write_varint(std::back_inserter(out), blob.size());
+        out.append(reinterpret_cast<const char *>(blob.data()), blob.size());
+    }
+
+    bool readVarint(const char *&pos, const char *end, uint64_t &value)
+    {
+        /* A varint cut off by the end of the data still reports the bytes
+           it read, so check the last one actually finished it */
+        return Tools::read_varint<64>(pos, end, value) > 0 && (static_cast<uint8_t>(pos[-1]) & 0x80) == 0;
+    }
+
+    bool readBlob(const char *&pos, const char *end, CryptoNote::BinaryArray &blob)
+    {
+        uint64_t length = 0;
+
+        if (!readVarint(pos, end, length) || length > static_cast<uint64_t>(end - pos))
+        {
+            return false;
+        }
+
+        blob.assign(pos, pos + length);
+        pos += length;
+
+        return true;
+    }
+} // namespace
+
+namespace CryptoNote::RawBlockStream
+{
+    Encoder::Encoder(
+        std::vector<RawBlock> blocks,
+        const bool synced,
+        const std::optional<WalletTypes::TopBlock> topBlock,
+        const bool compress):
+        m_blocks(std::move(blocks)),
+        m_synced(synced),
+        m_topBlock(topBlock),
+        m_compress(compress)
+    {
+    }
+
+    std::string Encoder::nextFrame()
+    {
+        if (m_nextBlock < m_blocks.size())
+        {
+            std::string blockData;
+            uint64_t count = 0;
+
+            while (m_nextBlock < m_blocks.size() && blockData.size() < TARGET_FRAME_SIZE)
+            {
+                auto &block = m_blocks[m_nextBlock++];
+
+                writeBlob(blockData, block.block);
+
+                Tools::write_varint(std::back_inserter(blockData), block.transactions.size());
+
+                for (const auto &transaction : block.transactions)
+                {
+                    writeBlob(blockData, transaction);
+                }
+
+                /* Don't need it any more, no point holding onto it while we
+                   send the rest */
+                block = RawBlock();
+
+                count++;
+            }
+
+            std::string payload;
+            Tools::write_varint(std::back_inserter(payload), count);
+            payload += blockData;
+
+            return makeFrame(FRAME_BLOCKS, payload);
+        }
+
+        if (!m_sentEnd)
+        {
+            m_sentEnd = true;
+
+            std::string payload;
+
+            payload += static_cast<char>(m_synced);
+            payload += static_cast<char>(m_topBlock.has_value());
+
+            if (m_topBlock)
+            {
+                payload.append(reinterpret_cast<const char *>(m_topBlock->hash.data), sizeof(m_topBlock->hash.data));
+                Tools::write_varint(std::back_inserter(payload), m_topBlock->height);
+            }
+
+            return makeFrame(FRAME_END, payload);
+        }
+
+        return std::string();
+    }
+
+    std::string Encoder::makeFrame(const FrameType type, const std::string &payload) const
+    {
+        uint8_t flags = 0;
+
+        std::string compressed;
+
+        if (m_compress)
+        {
+            compressed.resize(ZSTD_compressBound(payload.size()));
+
+            const size_t compressedSize = ZSTD_compress(
+                &compressed[0], compressed.size(), payload.data(), payload.size(), COMPRESSION_LEVEL);
+
+            /* Only use it if it's actually smaller */
+            if (!ZSTD_isError(compressedSize) && compressedSize < payload.size())
+            {
+                compressed.resize(compressedSize);
+                flags |= FLAG_COMPRESSED;
+            }
+        }
+
+        const std::string &body = (flags & FLAG_COMPRESSED) ? compressed : payload;
+
+        const uint32_t length = static_cast<uint32_t>(body.size());
+
+        std::string frame;
+        frame.reserve(FRAME_HEADER_SIZE + body.size());
+
+        for (int i = 0; i < 4; i++)
+        {
+            frame += static_cast<char>((length >> (i * 8)) & 0xff);
+        }
+
+        frame += static_cast<char>(type);
+        frame += static_cast<char>(flags);
+        frame += body;
+
+        return frame;
+    }
+
+    bool Decoder::addData(const char *data, const size_t length)
+    {
+        if (m_complete)
+        {
+            return false;
+        }
+
+        m_buffer.append(data, length);
+
+        size_t offset = 0;
+
+        while (m_buffer.size() - offset >= FRAME_HEADER_SIZE)
+        {
+            const auto header = reinterpret_cast<const uint8_t *>(m_buffer.data() + offset);
+
+            const uint32_t payloadLength = header[0] | (header[1] << 8) | (header[2] << 16)
+                                           | (static_cast<uint32_t>(header[3]) << 24);
+
+            if (payloadLength > MAX_FRAME_SIZE)
+            {
+                return false;
+            }
+
+            /* Rest of the frame hasn't arrived yet */
+            if (m_buffer.size() - offset < FRAME_HEADER_SIZE + payloadLength)
+            {
+                break;
+            }
+
+            const auto type = static_cast<FrameType>(header[4]);
+            const uint8_t flags = header[5];
+
+            std::string payload = m_buffer.substr(offset + FRAME_HEADER_SIZE, payloadLength);
+
+            offset += FRAME_HEADER_SIZE + payloadLength;
+
+            if (flags & FLAG_COMPRESSED)
+            {
+                const auto decompressedSize = ZSTD_getFrameContentSize(payload.data(), payload.size());
+
+                if (decompressedSize == ZSTD_CONTENTSIZE_UNKNOWN || decompressedSize == ZSTD_CONTENTSIZE_ERROR
+                    || decompressedSize > MAX_FRAME_SIZE)
+                {
+                    return false;
+                }
+
+                std::string decompressed(decompressedSize, '\0');
+
+                const size_t result =
+                    ZSTD_decompress(&decompressed[0], decompressed.size(), payload.data(), payload.size());
+
+                if (ZSTD_isError(result) || result != decompressedSize)
+                {
+                    return false;
+                }
+
+                payload = std::move(decompressed);
+            }
+
+            if (!decodeFrame(type, payload))
+            {
+                return false;
+            }
+
+            if (m_complete)
+            {
+                /* Nothing should come after the end frame */
+                return offset == m_buffer.size();
+            }
+        }
+
+        m_buffer.erase(0, offset);
+
+        return true;
+    }
+
+    bool Decoder::decodeFrame(const FrameType type, const std::string &payload)
+    {
+        const char *pos = payload.data();
+        const char *end = payload.data() + payload.size();
+
+        if (type == FRAME_BLOCKS)
+        {
+            uint64_t blockCount = 0;
+
+            if (!readVarint(pos, end, blockCount))
+            {
+                return false;
+            }
+
+            for (uint64_t i = 0; i < blockCount; i++)
+            {
+                RawBlock block;
+
+                uint64_t transactionCount = 0;
+
+                if (!readBlob(pos, end, block.block) || !readVarint(pos, end, transactionCount))
+                {
+                    return false;
+                }
+
+                /* Every transaction takes at least a byte, so this stops a
+                   bogus count from making us reserve a silly amount */
+                if (transactionCount > static_cast<uint64_t>(end - pos))
+                {
+                    return false;
+                }
+
+                block.transactions.resize(transactionCount);
+
+                for (auto &transaction : block.transactions)
+                {
+                    if (!readBlob(pos, end, transaction))
+                    {
+                        return false;
+                    }
+                }
+
+                m_blocks.push_back(std::move(block));
+            }
+
+            return pos == end;
+        }
+
+        if (type == FRAME_END)
+        {
+            if (end - pos < 2)
+            {
+                return false;
+            }
+
+            m_synced = *pos++ != 0;
+
+            const bool hasTopBlock = *pos++ != 0;
+
+            if (hasTopBlock)
+            {
+                WalletTypes::TopBlock topBlock;
+
+                if (end - pos < static_cast<ptrdiff_t>(sizeof(topBlock.hash.data)))
+                {
+                    return false;
+                }
+
+                std::memcpy(topBlock.hash.data, pos, sizeof(topBlock.hash.data));
+                pos += sizeof(topBlock.hash.data);
+
+                if (!readVarint(pos, end, topBlock.height))
+                {
+                    return false;
+                }
+
+                m_topBlock = topBlock;
+            }
+
+            m_complete = true;
+
+            return pos == end;
+        }
+
+        /* Unknown frame type */
+        return false;
+    }
+
+    std::vector<RawBlock> Decoder::takeBlocks()
+    {
+        std::vector<RawBlock> blocks;
+
+        blocks.swap(m_blocks);
+
+        return blocks;
+    }
+
+    bool Decoder::isComplete() const
+    {
+        return m_complete;
+    }
+
+    bool Decoder::isSynced() const
+    {
+        return m_synced;
+    }
+
+    std::optional<WalletTypes::TopBlock> Decoder::getTopBlock() const
+    {
+        return m_topBlock;
+    }
+} // namespace CryptoNote::RawBlockStream
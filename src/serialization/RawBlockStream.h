@@ -0,0 +1,146 @@
+// Copyright (c) 2018-2019, The TurtleCoin Developers
+//
+// Please see the included LICENSE file for more information.
+
+#pragma once
+
+#include <CryptoNote.h>
+#include <WalletTypes.h>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <vector>
+
+/* A compact binary alternative to the JSON response of /sync/raw. Blocks
+   and transactions are sent as length prefixed binary, rather than hex
+   inside JSON, and are split into frames which can be optionally zstd
+   compressed, and handled by the wallet as they arrive.
+
+   Each frame is:
+
+   [uint32 LE payload length][uint8 frame type][uint8 flags][payload]
+
+   A blocks frame payload is a varint block count, followed by each block as
+   a varint length and the block blob, then a varint transaction count and
+   each transaction as a varint length and the transaction blob.
+
+   The end frame payload is a byte for whether the wallet is synced, and a
+   byte for whether the top block follows, then the top block hash and a
+   varint top block height. It is always the last frame in the stream. */
+namespace CryptoNote::RawBlockStream
+{
+    /* The wallet puts this in the Accept header if it wants the binary format,
+       and the daemon returns it as the Content-Type if it sent it */
+    const std::string CONTENT_TYPE = "application/x-turtlecoin-raw-blocks";
+
+    /* Request header the wallet sets to "zstd" if it wants compressed frames */
+    const std::string COMPRESSION_HEADER = "X-Raw-Blocks-Compression";
+
+    enum FrameType : uint8_t
+    {
+        FRAME_BLOCKS = 1,
+        FRAME_END = 2,
+    };
+
+    enum FrameFlags : uint8_t
+    {
+        FLAG_COMPRESSED = 1,
+    };
+
+    /* Length, type and flags */
+    const size_t FRAME_HEADER_SIZE = 6;
+
+    /* Rough amount of block data to put in each frame, before compressing */
+    const size_t TARGET_FRAME_SIZE = 128 * 1024;
+
+    /* Don't let a dodgy frame get us to allocate an absurd amount of memory */
+    const size_t MAX_FRAME_SIZE = 64 * 1024 * 1024;
+
+    class Encoder
+    {
+      public:
+        /////////////////
+        /* CONSTRUCTOR */
+        /////////////////
+        Encoder(
+            std::vector<RawBlock> blocks,
+            const bool synced,
+            const std::optional<WalletTypes::TopBlock> topBlock,
+            const bool compress);
+
+        /////////////////////////////
+        /* PUBLIC MEMBER FUNCTIONS */
+        /////////////////////////////
+
+        /* Returns the next frame to send, or an empty string once the stream
+           is finished */
+        std::string nextFrame();
+
+      private:
+        //////////////////////////////
+        /* PRIVATE MEMBER FUNCTIONS */
+        //////////////////////////////
+        std::string makeFrame(const FrameType type, const std::string &payload) const;
+
+        /////////////////////////
+        /* PRIVATE MEMBER VARS */
+        /////////////////////////
+        std::vector<RawBlock> m_blocks;
+
+        const bool m_synced;
+
+        const std::optional<WalletTypes::TopBlock> m_topBlock;
+
+        const bool m_compress;
+
+        /* Index of the next block to go in a frame */
+        size_t m_nextBlock = 0;
+
+        bool m_sentEnd = false;
+    };
+
+    /* Accepts the stream in pieces of any size, as it comes off the socket,
+       and decodes each frame once it has fully arrived */
+    class Decoder
+    {
+      public:
+        /////////////////////////////
+        /* PUBLIC MEMBER FUNCTIONS */
+        /////////////////////////////
+
+        /* Returns false if the data is malformed, in which case the rest of
+           the stream should be discarded */
+        bool addData(const char *data, const size_t length);
+
+        /* Takes the blocks decoded so far */
+        std::vector<RawBlock> takeBlocks();
+
+        /* Whether we have received the end frame */
+        bool isComplete() const;
+
+        bool isSynced() const;
+
+        std::optional<WalletTypes::TopBlock> getTopBlock() const;
+
+      private:
+        //////////////////////////////
+        /* PRIVATE MEMBER FUNCTIONS */
+        //////////////////////////////
+        bool decodeFrame(const FrameType type, const std::string &payload);
+
+        /////////////////////////
+        /* PRIVATE MEMBER VARS */
+        /////////////////////////
+
+        /* Data we haven't got the full frame for yet */
+        std::string m_buffer;
+
+        std::vector<RawBlock> m_blocks;
+
+        bool m_complete = false;
+
+        bool m_synced = false;
+
+        std::optional<WalletTypes::TopBlock> m_topBlock;
+    };
+} // namespace CryptoNote::RawBlockStream
@@ -0,0 +1,213 @@
+// Copyright (c) 2018-2019, The TurtleCoin Developers
+//
+// Please see the included LICENSE file for more information.
+
+////////////////////////////////////
+#include <subwallets/InputStore.h>
+////////////////////////////////////
+
+#include <utilities/Utilities.h>
+
+namespace
+{
+    void eraseFromIndex(
+        std::multimap<uint64_t, Crypto::PublicKey> &index,
+        const uint64_t height,
+        const Crypto::PublicKey &key)
+    {
+        const auto [begin, end] = index.equal_range(height);
+
+        for (auto it = begin; it != end; ++it)
+        {
+            if (it->second == key)
+            {
+                index.erase(it);
+                return;
+            }
+        }
+    }
+} // namespace
+
+bool InputStore::add(const WalletTypes::TransactionInput &input)
+{
+    const auto [it, inserted] = m_inputs.emplace(input.key, input);
+
+    if (!inserted)
+    {
+        return false;
+    }
+
+    if (input.keyImage != Crypto::KeyImage())
+    {
+        m_keyImages[input.keyImage] = input.key;
+    }
+
+    m_byBlockHeight.emplace(input.blockHeight, input.key);
+    m_bySpendHeight.emplace(input.spendHeight, input.key);
+
+    if (input.unlockTime != 0)
+    {
+        m_timeLocked.insert(input.key);
+    }
+
+    m_totalAmount += input.amount;
+
+    return true;
+}
+
+bool InputStore::contains(const Crypto::PublicKey &key) const
+{
+    return m_inputs.find(key) != m_inputs.end();
+}
+
+bool InputStore::containsKeyImage(const Crypto::KeyImage &keyImage) const
+{
+    return m_keyImages.find(keyImage) != m_keyImages.end();
+}
+
+const WalletTypes::TransactionInput *
+    InputStore::find(const Crypto::KeyImage &keyImage, const Crypto::PublicKey &key) const
+{
+    const auto keyImageIt = m_keyImages.find(keyImage);
+
+    const auto it = m_inputs.find(keyImageIt != m_keyImages.end() ? keyImageIt->second : key);
+
+    return it == m_inputs.end() ? nullptr : &it->second;
+}
+
+std::optional<WalletTypes::TransactionInput> InputStore::takeByKeyImage(const Crypto::KeyImage &keyImage)
+{
+    const auto it = m_keyImages.find(keyImage);
+
+    if (it == m_keyImages.end())
+    {
+        return std::nullopt;
+    }
+
+    return remove(it->second);
+}
+
+std::vector<WalletTypes::TransactionInput> InputStore::takeReceivedFrom(const uint64_t height)
+{
+    return takeFrom(m_byBlockHeight, height);
+}
+
+std::vector<WalletTypes::TransactionInput> InputStore::takeSpentFrom(const uint64_t height)
+{
+    return takeFrom(m_bySpendHeight, height);
+}
+
+size_t InputStore::removeSpentUpTo(const uint64_t height)
+{
+    std::vector<Crypto::PublicKey> keys;
+
+    for (auto it = m_bySpendHeight.begin(); it != m_bySpendHeight.end() && it->first <= height; ++it)
+    {
+        keys.push_back(it->second);
+    }
+
+    for (const auto &key : keys)
+    {
+        remove(key);
+    }
+
+    return keys.size();
+}
+
+std::vector<WalletTypes::TransactionInput>
+    InputStore::takeByParentTransaction(const std::unordered_set<Crypto::Hash> &transactionHashes)
+{
+    std::vector<Crypto::PublicKey> keys;
+
+    for (const auto &[key, input] : m_inputs)
+    {
+        if (transactionHashes.find(input.parentTransactionHash) != transactionHashes.end())
+        {
+            keys.push_back(key);
+        }
+    }
+
+    std::vector<WalletTypes::TransactionInput> inputs;
+
+    for (const auto &key : keys)
+    {
+        inputs.push_back(remove(key));
+    }
+
+    return inputs;
+}
+
+std::tuple<uint64_t, uint64_t> InputStore::getBalance(const uint64_t height) const
+{
+    uint64_t lockedBalance = 0;
+
+    for (const auto &key : m_timeLocked)
+    {
+        const auto &input = m_inputs.at(key);
+
+        if (!Utilities::isInputUnlocked(input.unlockTime, height))
+        {
+            lockedBalance += input.amount;
+        }
+    }
+
+    return {m_totalAmount - lockedBalance, lockedBalance};
+}
+
+size_t InputStore::size() const
+{
+    return m_inputs.size();
+}
+
+void InputStore::clear()
+{
+    m_inputs.clear();
+    m_keyImages.clear();
+    m_byBlockHeight.clear();
+    m_bySpendHeight.clear();
+    m_timeLocked.clear();
+    m_totalAmount = 0;
+}
+
+WalletTypes::TransactionInput InputStore::remove(const Crypto::PublicKey &key)
+{
+    const auto it = m_inputs.find(key);
+
+    WalletTypes::TransactionInput input = std::move(it->second);
+
+    m_inputs.erase(it);
+
+    if (input.keyImage != Crypto::KeyImage())
+    {
+        m_keyImages.erase(input.keyImage);
+    }
+
+    eraseFromIndex(m_byBlockHeight, input.blockHeight, key);
+    eraseFromIndex(m_bySpendHeight, input.spendHeight, key);
+
+    m_timeLocked.erase(key);
+
+    m_totalAmount -= input.amount;
+
+    return input;
+}
+
+std::vector<WalletTypes::TransactionInput>
+    InputStore::takeFrom(const std::multimap<uint64_t, Crypto::PublicKey> &index, const uint64_t height)
+{
+    std::vector<Crypto::PublicKey> keys;
+
+    for (auto it = index.lower_bound(height); it != index.end(); ++it)
+    {
+        keys.push_back(it->second);
+    }
+
+    std::vector<WalletTypes::TransactionInput> inputs;
+
+    for (const auto &key : keys)
+    {
+        inputs.push_back(remove(key));
+    }
+
+    return inputs;
+}
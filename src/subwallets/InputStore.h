@@ -0,0 +1,103 @@
+// Copyright (c) 2018-2019, The TurtleCoin Developers
+//
+// Please see the included LICENSE file for more information.
+
+#pragma once
+
+#include "CryptoTypes.h"
+#include "WalletTypes.h"
+
+#include <map>
+#include <optional>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+/* A set of transaction inputs, indexed by key image, and by the heights
+   they were received and spent at, so wallets with lots of inputs don't
+   have to search through every one of them when syncing.
+
+   The total amount is kept up to date as inputs are added and removed, and
+   inputs with an unlock time are tracked separately, so working out the
+   balance only has to look at those. */
+class InputStore
+{
+  public:
+    /////////////////////////////
+    /* Public member functions */
+    /////////////////////////////
+
+    /* Returns false if we already have an input with this key */
+    bool add(const WalletTypes::TransactionInput &input);
+
+    /* Checks by key, since view wallets don't have key images */
+    bool contains(const Crypto::PublicKey &key) const;
+
+    bool containsKeyImage(const Crypto::KeyImage &keyImage) const;
+
+    /* Returns nullptr if we don't have an input with this key image, or key */
+    const WalletTypes::TransactionInput *find(const Crypto::KeyImage &keyImage, const Crypto::PublicKey &key) const;
+
+    /* Removes the input with this key image, if we have it */
+    std::optional<WalletTypes::TransactionInput> takeByKeyImage(const Crypto::KeyImage &keyImage);
+
+    /* Removes the inputs received at or above this height */
+    std::vector<WalletTypes::TransactionInput> takeReceivedFrom(const uint64_t height);
+
+    /* Removes the inputs spent at or above this height */
+    std::vector<WalletTypes::TransactionInput> takeSpentFrom(const uint64_t height);
+
+    /* Removes the inputs spent at or below this height, returning how many
+       were removed */
+    size_t removeSpentUpTo(const uint64_t height);
+
+    /* Removes the inputs belonging to any of these transactions */
+    std::vector<WalletTypes::TransactionInput>
+        takeByParentTransaction(const std::unordered_set<Crypto::Hash> &transactionHashes);
+
+    /* Unlocked and locked amounts at this height */
+    std::tuple<uint64_t, uint64_t> getBalance(const uint64_t height) const;
+
+    size_t size() const;
+
+    void clear();
+
+    template<typename Func> void forEach(Func &&func) const
+    {
+        for (const auto &[key, input] : m_inputs)
+        {
+            func(input);
+        }
+    }
+
+  private:
+    //////////////////////////////
+    /* Private member functions */
+    //////////////////////////////
+
+    WalletTypes::TransactionInput remove(const Crypto::PublicKey &key);
+
+    std::vector<WalletTypes::TransactionInput>
+        takeFrom(const std::multimap<uint64_t, Crypto::PublicKey> &index, const uint64_t height);
+
+    /////////////////////////////
+    /* Private member variables */
+    /////////////////////////////
+
+    /* Inputs by their key */
+    std::unordered_map<Crypto::PublicKey, WalletTypes::TransactionInput> m_inputs;
+
+    /* Key images to input keys. View wallets don't have key images, so their
+       inputs aren't in here. */
+    std::unordered_map<Crypto::KeyImage, Crypto::PublicKey> m_keyImages;
+
+    std::multimap<uint64_t, Crypto::PublicKey> m_byBlockHeight;
+
+    std::multimap<uint64_t, Crypto::PublicKey> m_bySpendHeight;
+
+    /* Inputs with an unlock time - nearly every input has none, and so is
+       always unlocked */
+    std::unordered_set<Crypto::PublicKey> m_timeLocked;
+
+    uint64_t m_totalAmount = 0;
+};
@@ -105,15 +105,8 @@ void SubWallet::storeTransactionInput(const WalletTypes::TransactionInput input,
         }
     }
 
-    auto it = std::find_if(
-        m_unspentInputs.begin(), m_unspentInputs.end(), [&input](const auto x) { return x.key == input.key; });
-
     /* Ensure we don't add the input twice */
-    if (it == m_unspentInputs.end())
-    {
-        m_unspentInputs.push_back(input);
-    }
-    else
+    if (!m_unspentInputs.add(input))
     {
         std::stringstream stream;
 
@@ -125,22 +118,7 @@ void SubWallet::storeTransactionInput(const WalletTypes::TransactionInput input,
 
 std::tuple<uint64_t, uint64_t> SubWallet::getBalance(const uint64_t currentHeight) const
 {
-    uint64_t unlockedBalance = 0;
-
-    uint64_t lockedBalance = 0;
-
-    for (const auto &input : m_unspentInputs)
-    {
-        /* If an unlock height is present, check if the input is unlocked */
-        if (Utilities::isInputUnlocked(input.unlockTime, currentHeight))
-        {
-            unlockedBalance += input.amount;
-        }
-        else
-        {
-            lockedBalance += input.amount;
-        }
-    }
+    auto [unlockedBalance, lockedBalance] = m_unspentInputs.getBalance(currentHeight);
 
     /* Add the locked balance from incoming transactions */
     for (const auto &unconfirmedInput : m_unconfirmedIncomingAmounts)
@@ -193,80 +171,48 @@ Crypto::SecretKey SubWallet::privateSpendKey() const
 
 void SubWallet::markInputAsSpent(const Crypto::KeyImage keyImage, const uint64_t spendHeight)
 {
-    /* Find the input */
-    auto it = std::find_if(
-        m_unspentInputs.begin(), m_unspentInputs.end(), [&keyImage](const auto x) { return x.keyImage == keyImage; });
+    /* Find the input, either in the unspent inputs, or in the locked inputs
+       if we sent the transaction spending it */
+    auto input = m_unspentInputs.takeByKeyImage(keyImage);
 
-    bool inSpent =
-        std::find_if(
-            m_spentInputs.begin(), m_spentInputs.end(), [&keyImage](const auto x) { return x.keyImage == keyImage; })
-        != m_spentInputs.end();
-
-    if (inSpent)
+    if (!input)
     {
-        std::stringstream stream;
-
-        stream << "Input with key image " << keyImage
-               << " being marked as spent is already present in spent inputs vector.";
-
-        Logger::logger.log(stream.str(), Logger::WARNING, {Logger::SYNC});
+        input = m_lockedInputs.takeByKeyImage(keyImage);
     }
 
-    if (it != m_unspentInputs.end())
+    if (!input)
     {
-        /* Set the spend height */
-        it->spendHeight = spendHeight;
-
+        std::stringstream stream;
 
-        /* Ensure we don't add the input twice */
-        if (!inSpent)
-        {
-            /* Add to the spent inputs vector */
-            m_spentInputs.push_back(*it);
-        }
+        stream << "Could not find key image " << keyImage << " to remove. Ignoring.";
 
-        /* Remove from the unspent vector */
-        m_unspentInputs.erase(it);
+        Logger::logger.log(stream.str(), Logger::WARNING, {Logger::SYNC});
 
         return;
     }
 
-    /* Didn't find it, lets try in the locked inputs */
-    it = std::find_if(
-        m_lockedInputs.begin(), m_lockedInputs.end(), [&keyImage](const auto x) { return x.keyImage == keyImage; });
+    /* Set the spend height */
+    input->spendHeight = spendHeight;
 
-    if (it != m_lockedInputs.end())
+    /* Ensure we don't add the input twice */
+    if (!m_spentInputs.add(*input))
     {
-        /* Set the spend height */
-        it->spendHeight = spendHeight;
-
-        if (!inSpent)
-        {
-            /* Add to the spent inputs vector */
-            m_spentInputs.push_back(*it);
-        }
+        std::stringstream stream;
 
-        /* Remove from the locked vector */
-        m_lockedInputs.erase(it);
+        stream << "Input with key image " << keyImage
+               << " being marked as spent is already present in spent inputs vector.";
 
-        return;
+        Logger::logger.log(stream.str(), Logger::WARNING, {Logger::SYNC});
     }
-
-    std::stringstream stream;
-
-    stream << "Could not find key image " << keyImage << " to remove. Ignoring.";
-
-    Logger::logger.log(stream.str(), Logger::WARNING, {Logger::SYNC});
 }
 
 void SubWallet::markInputAsLocked(const Crypto::KeyImage keyImage)
 {
     /* Find the input */
-    auto it = std::find_if(
-        m_unspentInputs.begin(), m_unspentInputs.end(), [&keyImage](const auto x) { return x.keyImage == keyImage; });
+    const auto input = m_unspentInputs.takeByKeyImage(keyImage);
 
     /* Shouldn't happen */
-    if (it == m_unspentInputs.end())
+    if (!input)
     {
         std::stringstream stream;
 
@@ -277,17 +223,8 @@ void SubWallet::markInputAsLocked(const Crypto::KeyImage keyImage)
         return;
     }
 
-    bool inLocked =
-        std::find_if(
-            m_lockedInputs.begin(), m_lockedInputs.end(), [&keyImage](const auto x) { return x.keyImage == keyImage; })
-        != m_lockedInputs.end();
-
-    if (!inLocked)
-    {
-        /* Add to the locked inputs vector */
-        m_lockedInputs.push_back(*it);
-    }
-    else
+    /* Add to the locked inputs */
+    if (!m_lockedInputs.add(*input))
     {
         std::stringstream stream;
 
@@ -296,9 +233,6 @@ void SubWallet::markInputAsLocked(const Crypto::KeyImage keyImage)
 
         Logger::logger.log(stream.str(), Logger::WARNING, {Logger::SYNC});
     }
-
-    /* Remove from the unspent vector */
-    m_unspentInputs.erase(it);
 }
 
 std::vector<Crypto::KeyImage> SubWallet::removeForkedInputs(const uint64_t forkHeight, const bool isViewWallet)
@@ -308,76 +242,33 @@ std::vector<Crypto::KeyImage> SubWallet::removeForkedInputs(const uint64_t forkH
 
     std::vector<Crypto::KeyImage> keyImagesToRemove;
 
-    auto isForked = [forkHeight, &keyImagesToRemove](const auto &input)
+    /* Remove both spent and unspent and locked inputs that were recieved after
+     * the fork height */
+    for (auto *inputs : {&m_lockedInputs, &m_unspentInputs, &m_spentInputs})
     {
-        if (input.blockHeight >= forkHeight)
+        for (const auto &input : inputs->takeReceivedFrom(forkHeight))
         {
             keyImagesToRemove.push_back(input.keyImage);
         }
+    }
 
-        return input.blockHeight >= forkHeight;
-    };
-
-    auto removeForked = [isForked](auto &inputVector)
+    /* If the input was spent after the fork height, but received before the
+       fork height, then we keep it, but move it into the unspent inputs */
+    for (auto &input : m_spentInputs.takeSpentFrom(forkHeight))
     {
-        const auto it = std::remove_if(inputVector.begin(), inputVector.end(), isForked);
+        /* Reset spend height */
+        input.spendHeight = 0;
 
-        if (it != inputVector.end())
+        /* Readd to the unspent inputs */
+        if (!m_unspentInputs.add(input))
         {
-            inputVector.erase(it, inputVector.end());
-        }
-    };
+            std::stringstream stream;
 
-    /* Remove both spent and unspent and locked inputs that were recieved after
-     * the fork height */
-    removeForked(m_lockedInputs);
-
-    removeForked(m_unspentInputs);
-
-    removeForked(m_spentInputs);
-
-    /* If the input was spent after the fork height, but received before the
-       fork height, then we keep it, but move it into the unspent vector */
-    const auto it = std::remove_if(
-        m_spentInputs.begin(),
-        m_spentInputs.end(),
-        [&forkHeight, this](auto &input)
-        {
-            if (input.spendHeight >= forkHeight)
-            {
-                /* Reset spend height */
-                input.spendHeight = 0;
-
-                bool inUnspent = std::find_if(
-                                     m_unspentInputs.begin(),
-                                     m_unspentInputs.end(),
-                                     [&input](const auto x) { return x.key == input.key; })
-                                 != m_unspentInputs.end();
-
-                if (!inUnspent)
-                {
-                    /* Readd to the unspent vector */
-                    m_unspentInputs.push_back(input);
-                }
-                else
-                {
-                    std::stringstream stream;
-
-                    stream << "Input with key " << input.key
-                           << " being marked as unspent is already present in unspent inputs vector.";
-
-                    Logger::logger.log(stream.str(), Logger::WARNING, {Logger::SYNC});
-                }
-
-                return true;
-            }
-
-            return false;
-        });
+            stream << "Input with key " << input.key
+                   << " being marked as unspent is already present in unspent inputs vector.";
 
-    if (it != m_spentInputs.end())
-    {
-        m_spentInputs.erase(it, m_spentInputs.end());
+            Logger::logger.log(stream.str(), Logger::WARNING, {Logger::SYNC});
+        }
     }
 
     if (isViewWallet)
@@ -392,29 +283,14 @@ std::vector<Crypto::KeyImage> SubWallet::removeForkedInputs(const uint64_t forkH
    included in a block for some reason */
 void SubWallet::removeCancelledTransactions(const std::unordered_set<Crypto::Hash> cancelledTransactions)
 {
-    /* Find the inputs used in the cancelled transactions */
-    auto it = std::remove_if(
-        m_lockedInputs.begin(),
-        m_lockedInputs.end(),
-        [&cancelledTransactions, this](auto &input)
-        {
-            if (cancelledTransactions.find(input.parentTransactionHash) != cancelledTransactions.end())
-            {
-                input.spendHeight = 0;
-
-                /* Re-add the input to the unspent vector now it has been returned
-                   to our wallet */
-                m_unspentInputs.push_back(input);
-
-                return true;
-            }
-            return false;
-        });
-
-    /* Remove the inputs used in the cancelled tranactions */
-    if (it != m_lockedInputs.end())
+    /* Remove the inputs used in the cancelled transactions */
+    for (auto &input : m_lockedInputs.takeByParentTransaction(cancelledTransactions))
     {
-        m_lockedInputs.erase(it, m_lockedInputs.end());
+        input.spendHeight = 0;
+
+        /* Re-add the input to the unspent inputs now it has been returned
+           to our wallet */
+        m_unspentInputs.add(input);
     }
 
     /* Find inputs that we 'received' in outgoing transfers (scanning our
@@ -433,31 +309,27 @@ void SubWallet::removeCancelledTransactions(const std::unordered_set<Crypto::Has
 
 bool SubWallet::haveSpendableInput(const WalletTypes::TransactionInput &input, const uint64_t height) const
 {
-    for (const auto &i : m_unspentInputs)
-    {
-        /* Checking for .key to support view wallets */
-        if (input.keyImage == i.keyImage || input.key == i.key)
-        {
-            /* Only gonna be one input that matches so can early return false
-             * if the input is locked */
-            return Utilities::isInputUnlocked(i.unlockTime, height);
-        }
-    }
+    /* Checking for .key to support view wallets */
+    const auto storedInput = m_unspentInputs.find(input.keyImage, input.key);
 
-    return false;
+    return storedInput && Utilities::isInputUnlocked(storedInput->unlockTime, height);
 }
 
 std::vector<WalletTypes::TxInputAndOwner> SubWallet::getSpendableInputs(const uint64_t height) const
 {
     std::vector<WalletTypes::TxInputAndOwner> inputs;
 
-    for (const auto &input : m_unspentInputs)
-    {
-        if (Utilities::isInputUnlocked(input.unlockTime, height))
+    inputs.reserve(m_unspentInputs.size());
+
+    m_unspentInputs.forEach(
+        [&](const auto &input)
         {
-            inputs.emplace_back(input, m_publicSpendKey, m_privateSpendKey);
-        }
-    }
+            if (Utilities::isInputUnlocked(input.unlockTime, height))
+            {
+                inputs.emplace_back(input, m_publicSpendKey, m_privateSpendKey);
+            }
+        });
+
     return inputs;
 }
 
@@ -488,21 +360,7 @@ void SubWallet::convertSyncTimestampToHeight(const uint64_t timestamp, const uin
 
 void SubWallet::pruneSpentInputs(const uint64_t pruneHeight)
 {
-    const uint64_t lenBeforePrune = m_spentInputs.size();
-
-    const auto it = std::remove_if(
-        m_spentInputs.begin(),
-        m_spentInputs.end(),
-        [&pruneHeight](const auto input) { return input.spendHeight <= pruneHeight; });
-
-    if (it != m_spentInputs.end())
-    {
-        m_spentInputs.erase(it, m_spentInputs.end());
-    }
-
-    const uint64_t lenAfterPrune = m_spentInputs.size();
-
-    const uint64_t difference = lenBeforePrune - lenAfterPrune;
+    const uint64_t difference = m_spentInputs.removeSpentUpTo(pruneHeight);
 
     if (difference != 0)
     {
@@ -515,11 +373,10 @@ std::vector<Crypto::KeyImage> SubWallet::getKeyImages() const
 {
     std::vector<Crypto::KeyImage> result;
 
-    const auto getKeyImages = [&result](const auto &vec)
-    {
-        std::transform(
-            vec.begin(), vec.end(), std::back_inserter(result), [](const auto &input) { return input.keyImage; });
-    };
+    result.reserve(m_unspentInputs.size() + m_lockedInputs.size() + m_spentInputs.size());
+
+    const auto getKeyImages = [&result](const InputStore &inputs)
+    { inputs.forEach([&result](const auto &input) { result.push_back(input.keyImage); }); };
 
     getKeyImages(m_unspentInputs);
 
@@ -562,7 +419,7 @@ void SubWallet::fromJSON(const JSONValue &j)
 
         input.fromJSON(x);
 
-        m_unspentInputs.push_back(input);
+        m_unspentInputs.add(input);
     }
 
     for (const auto &x : getArrayFromJSON(j, "lockedInputs"))
@@ -571,7 +428,7 @@ void SubWallet::fromJSON(const JSONValue &j)
 
         input.fromJSON(x);
 
-        m_lockedInputs.push_back(input);
+        m_lockedInputs.add(input);
     }
 
     for (const auto &x : getArrayFromJSON(j, "spentInputs"))
@@ -580,7 +437,7 @@ void SubWallet::fromJSON(const JSONValue &j)
 
         input.fromJSON(x);
 
-        m_spentInputs.push_back(input);
+        m_spentInputs.add(input);
     }
 
     m_syncStartHeight = getUint64FromJSON(j, "syncStartHeight");
@@ -619,30 +476,21 @@ void SubWallet::toJSON(rapidjson::Writer<rapidjson::StringBuffer> &writer) const
         writer.Key("unspentInputs");
         writer.StartArray();
         {
-            for (const auto &input : m_unspentInputs)
-            {
-                input.toJSON(writer);
-            }
+            m_unspentInputs.forEach([&writer](const auto &input) { input.toJSON(writer); });
         }
         writer.EndArray();
 
         writer.Key("lockedInputs");
         writer.StartArray();
         {
-            for (const auto &input : m_lockedInputs)
-            {
-                input.toJSON(writer);
-            }
+            m_lockedInputs.forEach([&writer](const auto &input) { input.toJSON(writer); });
         }
         writer.EndArray();
 
         writer.Key("spentInputs");
         writer.StartArray();
         {
-            for (const auto &input : m_spentInputs)
-            {
-                input.toJSON(writer);
-            }
+            m_spentInputs.forEach([&writer](const auto &input) { input.toJSON(writer); });
         }
         writer.EndArray();
 
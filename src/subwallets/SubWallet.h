@@ -11,6 +11,7 @@
 #include <crypto/crypto.h>
 #include <errors/Errors.h>
 #include <string>
+#include <subwallets/InputStore.h>
 #include <unordered_set>
 
 class SubWallet
@@ -102,16 +103,16 @@ class SubWallet
     /////////////////////////////
 
   private:
-    /* A vector of the stored transaction input data, to be used for
-       sending transactions later */
-    std::vector<WalletTypes::TransactionInput> m_unspentInputs;
+    /* The stored transaction input data, to be used for sending
+       transactions later */
+    InputStore m_unspentInputs;
 
     /* Inputs which have been used in a transaction, and are waiting to
        either be put into a block, or return to our wallet */
-    std::vector<WalletTypes::TransactionInput> m_lockedInputs;
+    InputStore m_lockedInputs;
 
     /* Inputs which have been spent in a transaction */
-    std::vector<WalletTypes::TransactionInput> m_spentInputs;
+    InputStore m_spentInputs;
 
     /* Inputs which have come in from a transaction we sent - either from
        change or from sending to ourself - we use this to display unlocked
@@ -14,6 +14,7 @@
 #include <random>
 #include <utilities/Addresses.h>
 #include <utilities/Utilities.h>
+#include <walletbackend/Constants.h>
 
 ///////////////////////////////////
 /* CONSTRUCTORS / DECONSTRUCTORS */
@@ -112,6 +113,8 @@ std::tuple<Error, std::string, Crypto::SecretKey, uint64_t> SubWallets::addSubWa
 
     m_publicSpendKeys.push_back(newPublicKey);
 
+    requireFullSave();
+
     return {SUCCESS, address, newPrivateKey, m_subWalletIndexCounter};
 }
 
@@ -151,6 +154,8 @@ std::tuple<Error, std::string>
 
     m_publicSpendKeys.push_back(publicSpendKey);
 
+    requireFullSave();
+
     return {SUCCESS, address};
 }
 
@@ -213,6 +218,8 @@ std::tuple<Error, std::string>
 
     m_publicSpendKeys.push_back(publicSpendKey);
 
+    requireFullSave();
+
     return {SUCCESS, address};
 }
 
@@ -248,6 +255,8 @@ Error SubWallets::deleteSubWallet(const std::string address)
         m_publicSpendKeys.erase(it2, m_publicSpendKeys.end());
     }
 
+    requireFullSave();
+
     return SUCCESS;
 }
 
@@ -357,6 +366,14 @@ void SubWallets::addUnconfirmedTransaction(const WalletTypes::Transaction tx)
     }
 
     m_lockedTransactions.push_back(tx);
+
+    addJournalEntry(
+        "addUnconfirmedTransaction",
+        [&tx](auto &writer)
+        {
+            writer.Key("transaction");
+            tx.toJSON(writer);
+        });
 }
 
 void SubWallets::addTransaction(const WalletTypes::Transaction tx)
@@ -395,6 +412,14 @@ void SubWallets::addTransaction(const WalletTypes::Transaction tx)
     }
 
     m_transactions.push_back(tx);
+
+    addJournalEntry(
+        "addTransaction",
+        [&tx](auto &writer)
+        {
+            writer.Key("transaction");
+            tx.toJSON(writer);
+        });
 }
 
 std::tuple<Crypto::KeyImage, Crypto::SecretKey> SubWallets::getTxInputKeyImage(
@@ -435,7 +460,20 @@ void SubWallets::storeTransactionInput(
         }
 
         /* If we have a view wallet, don't attempt to derive the key image */
-        return it->second.storeTransactionInput(input, m_isViewWallet);
+        it->second.storeTransactionInput(input, m_isViewWallet);
+
+        addJournalEntry(
+            "storeTransactionInput",
+            [&](auto &writer)
+            {
+                writer.Key("publicSpendKey");
+                publicSpendKey.toJSON(writer);
+
+                writer.Key("input");
+                input.toJSON(writer);
+            });
+
+        return;
     }
 
     throw std::runtime_error("Subwallet not found!");
@@ -489,20 +527,12 @@ std::vector<WalletTypes::TxInputAndOwner> SubWallets::getSpendableTransactionInp
         subWalletsToTakeFrom = m_publicSpendKeys;
     }
 
-    std::vector<SubWallet> wallets;
-
-    /* Loop through each public key and grab the associated wallet */
-    for (const auto &publicKey : subWalletsToTakeFrom)
-    {
-        wallets.push_back(m_subWallets.at(publicKey));
-    }
-
     std::vector<WalletTypes::TxInputAndOwner> availableInputs;
 
-    /* Copy the transaction inputs from this sub wallet to inputs */
-    for (const auto &subWallet : wallets)
+    /* Copy the transaction inputs from each sub wallet to inputs */
+    for (const auto &publicKey : subWalletsToTakeFrom)
     {
-        const auto moreInputs = subWallet.getSpendableInputs(height);
+        const auto moreInputs = m_subWallets.at(publicKey).getSpendableInputs(height);
 
         availableInputs.insert(availableInputs.end(), moreInputs.begin(), moreInputs.end());
     }
@@ -576,20 +606,12 @@ std::tuple<std::vector<WalletTypes::TxInputAndOwner>, uint64_t, uint64_t> SubWal
         subWalletsToTakeFrom = m_publicSpendKeys;
     }
 
-    std::vector<SubWallet> wallets;
-
-    /* Loop through each public key and grab the associated wallet */
-    for (const auto &publicKey : subWalletsToTakeFrom)
-    {
-        wallets.push_back(m_subWallets.at(publicKey));
-    }
-
     std::vector<WalletTypes::TxInputAndOwner> availableInputs;
 
-    /* Copy the transaction inputs from this sub wallet to inputs */
-    for (const auto &subWallet : wallets)
+    /* Copy the transaction inputs from each sub wallet to inputs */
+    for (const auto &publicKey : subWalletsToTakeFrom)
     {
-        const auto moreInputs = subWallet.getSpendableInputs(height);
+        const auto moreInputs = m_subWallets.at(publicKey).getSpendableInputs(height);
 
         availableInputs.insert(availableInputs.end(), moreInputs.begin(), moreInputs.end());
     }
@@ -763,6 +785,20 @@ void SubWallets::markInputAsSpent(
     std::scoped_lock lock(m_mutex);
 
     m_subWallets.at(publicKey).markInputAsSpent(keyImage, spendHeight);
+
+    addJournalEntry(
+        "markInputAsSpent",
+        [&](auto &writer)
+        {
+            writer.Key("keyImage");
+            keyImage.toJSON(writer);
+
+            writer.Key("publicSpendKey");
+            publicKey.toJSON(writer);
+
+            writer.Key("spendHeight");
+            writer.Uint64(spendHeight);
+        });
 }
 
 /* Mark a key image as locked, can no longer be used in transactions till it
@@ -776,6 +812,17 @@ void SubWallets::markInputAsLocked(const Crypto::KeyImage keyImage, const Crypto
     std::scoped_lock lock(m_mutex);
 
     m_subWallets.at(publicKey).markInputAsLocked(keyImage);
+
+    addJournalEntry(
+        "markInputAsLocked",
+        [&](auto &writer)
+        {
+            writer.Key("keyImage");
+            keyImage.toJSON(writer);
+
+            writer.Key("publicSpendKey");
+            publicKey.toJSON(writer);
+        });
 }
 
 /* Remove transactions and key images that occured on a forked chain */
@@ -810,6 +857,14 @@ void SubWallets::removeForkedTransactions(const uint64_t forkHeight)
     {
         m_keyImageOwners.erase(keyImage);
     }
+
+    addJournalEntry(
+        "removeForkedTransactions",
+        [forkHeight](auto &writer)
+        {
+            writer.Key("forkHeight");
+            writer.Uint64(forkHeight);
+        });
 }
 
 void SubWallets::removeCancelledTransactions(const std::unordered_set<Crypto::Hash> cancelledTransactions)
@@ -836,6 +891,19 @@ void SubWallets::removeCancelledTransactions(const std::unordered_set<Crypto::Ha
     {
         subWallet.removeCancelledTransactions(cancelledTransactions);
     }
+
+    addJournalEntry(
+        "removeCancelledTransactions",
+        [&cancelledTransactions](auto &writer)
+        {
+            writer.Key("transactionHashes");
+            writer.StartArray();
+            for (const auto &hash : cancelledTransactions)
+            {
+                hash.toJSON(writer);
+            }
+            writer.EndArray();
+        });
 }
 
 Crypto::SecretKey SubWallets::getPrivateViewKey() const
@@ -900,12 +968,21 @@ void SubWallets::reset(const uint64_t scanHeight)
     {
         subWallet.reset(scanHeight);
     }
+
+    requireFullSave();
 }
 
 
 void SubWallets::rewind(const uint64_t scanHeight)
 {
-    m_lockedTransactions.clear();
+    {
+        std::scoped_lock lock(m_mutex);
+
+        m_lockedTransactions.clear();
+
+        requireFullSave();
+    }
+
     removeForkedTransactions(scanHeight);
 }
 
@@ -965,7 +1042,20 @@ std::tuple<Error, std::string> SubWallets::getAddress(const Crypto::PublicKey sp
 
 void SubWallets::storeTxPrivateKey(const Crypto::SecretKey txPrivateKey, const Crypto::Hash txHash)
 {
+    std::scoped_lock lock(m_mutex);
+
     m_transactionPrivateKeys[txHash] = txPrivateKey;
+
+    addJournalEntry(
+        "storeTxPrivateKey",
+        [&](auto &writer)
+        {
+            writer.Key("transactionHash");
+            txHash.toJSON(writer);
+
+            writer.Key("txPrivateKey");
+            txPrivateKey.toJSON(writer);
+        });
 }
 
 std::tuple<bool, Crypto::SecretKey> SubWallets::getTxPrivateKey(const Crypto::Hash txHash) const
@@ -991,6 +1081,17 @@ void SubWallets::storeUnconfirmedIncomingInput(
     if (it != m_subWallets.end())
     {
         it->second.storeUnconfirmedIncomingInput(input);
+
+        addJournalEntry(
+            "storeUnconfirmedIncomingInput",
+            [&](auto &writer)
+            {
+                writer.Key("publicSpendKey");
+                publicSpendKey.toJSON(writer);
+
+                writer.Key("input");
+                input.toJSON(writer);
+            });
     }
 }
 
@@ -1002,6 +1103,17 @@ void SubWallets::convertSyncTimestampToHeight(const uint64_t timestamp, const ui
     {
         subWallet.convertSyncTimestampToHeight(timestamp, height);
     }
+
+    addJournalEntry(
+        "convertSyncTimestampToHeight",
+        [timestamp, height](auto &writer)
+        {
+            writer.Key("timestamp");
+            writer.Uint64(timestamp);
+
+            writer.Key("height");
+            writer.Uint64(height);
+        });
 }
 
 std::vector<std::tuple<std::string, uint64_t, uint64_t>> SubWallets::getBalances(const uint64_t currentHeight) const
@@ -1020,10 +1132,170 @@ std::vector<std::tuple<std::string, uint64_t, uint64_t>> SubWallets::getBalances
 
 void SubWallets::pruneSpentInputs(const uint64_t pruneHeight)
 {
+    std::scoped_lock lock(m_mutex);
+
     for (auto &[pubKey, subWallet] : m_subWallets)
     {
         subWallet.pruneSpentInputs(pruneHeight);
     }
+
+    addJournalEntry(
+        "pruneSpentInputs",
+        [pruneHeight](auto &writer)
+        {
+            writer.Key("pruneHeight");
+            writer.Uint64(pruneHeight);
+        });
+}
+
+std::tuple<std::vector<std::string>, bool> SubWallets::takeJournal()
+{
+    std::scoped_lock lock(m_mutex);
+
+    std::vector<std::string> journal;
+
+    journal.swap(m_journal);
+
+    const bool needsFullSave = m_needsFullSave;
+
+    m_journalSize = 0;
+    m_needsFullSave = false;
+
+    return {journal, needsFullSave};
+}
+
+void SubWallets::applyJournalEntry(const JSONValue &entry)
+{
+    const std::string type = getStringFromJSON(entry, "type");
+
+    if (type == "addTransaction" || type == "addUnconfirmedTransaction")
+    {
+        WalletTypes::Transaction tx;
+        tx.fromJSON(getJsonValue(entry, "transaction"));
+
+        if (type == "addTransaction")
+        {
+            addTransaction(tx);
+        }
+        else
+        {
+            addUnconfirmedTransaction(tx);
+        }
+    }
+    else if (type == "storeTransactionInput")
+    {
+        Crypto::PublicKey publicSpendKey;
+        publicSpendKey.fromJSON(getJsonValue(entry, "publicSpendKey"));
+
+        WalletTypes::TransactionInput input;
+        input.fromJSON(getJsonValue(entry, "input"));
+
+        storeTransactionInput(publicSpendKey, input);
+    }
+    else if (type == "markInputAsSpent" || type == "markInputAsLocked")
+    {
+        Crypto::KeyImage keyImage;
+        keyImage.fromJSON(getJsonValue(entry, "keyImage"));
+
+        Crypto::PublicKey publicSpendKey;
+        publicSpendKey.fromJSON(getJsonValue(entry, "publicSpendKey"));
+
+        if (type == "markInputAsSpent")
+        {
+            markInputAsSpent(keyImage, publicSpendKey, getUint64FromJSON(entry, "spendHeight"));
+        }
+        else
+        {
+            markInputAsLocked(keyImage, publicSpendKey);
+        }
+    }
+    else if (type == "removeForkedTransactions")
+    {
+        removeForkedTransactions(getUint64FromJSON(entry, "forkHeight"));
+    }
+    else if (type == "removeCancelledTransactions")
+    {
+        std::unordered_set<Crypto::Hash> cancelledTransactions;
+
+        for (const auto &x : getArrayFromJSON(entry, "transactionHashes"))
+        {
+            Crypto::Hash hash;
+            hash.fromJSON(x);
+            cancelledTransactions.insert(hash);
+        }
+
+        removeCancelledTransactions(cancelledTransactions);
+    }
+    else if (type == "storeTxPrivateKey")
+    {
+        Crypto::Hash txHash;
+        txHash.fromJSON(getJsonValue(entry, "transactionHash"));
+
+        Crypto::SecretKey txPrivateKey;
+        txPrivateKey.fromJSON(getJsonValue(entry, "txPrivateKey"));
+
+        storeTxPrivateKey(txPrivateKey, txHash);
+    }
+    else if (type == "storeUnconfirmedIncomingInput")
+    {
+        Crypto::PublicKey publicSpendKey;
+        publicSpendKey.fromJSON(getJsonValue(entry, "publicSpendKey"));
+
+        WalletTypes::UnconfirmedInput input;
+        input.fromJSON(getJsonValue(entry, "input"));
+
+        storeUnconfirmedIncomingInput(input, publicSpendKey);
+    }
+    else if (type == "convertSyncTimestampToHeight")
+    {
+        convertSyncTimestampToHeight(getUint64FromJSON(entry, "timestamp"), getUint64FromJSON(entry, "height"));
+    }
+    else if (type == "pruneSpentInputs")
+    {
+        pruneSpentInputs(getUint64FromJSON(entry, "pruneHeight"));
+    }
+    else
+    {
+        throw std::invalid_argument("Unknown wallet journal entry type: " + type);
+    }
+}
+
+template<typename Func> void SubWallets::addJournalEntry(const std::string &type, Func &&writeFields)
+{
+    /* Nothing will be appended to the journal, may as well not build it up */
+    if (m_needsFullSave)
+    {
+        return;
+    }
+
+    rapidjson::StringBuffer sb;
+    rapidjson::Writer<rapidjson::StringBuffer> writer(sb);
+
+    writer.StartObject();
+
+    writer.Key("type");
+    writer.String(type);
+
+    writeFields(writer);
+
+    writer.EndObject();
+
+    m_journal.emplace_back(sb.GetString(), sb.GetSize());
+    m_journalSize += sb.GetSize();
+
+    /* Haven't saved in a long time, a full save will be cheaper than keeping
+       all this around */
+    if (m_journalSize > Constants::MAX_WALLET_JOURNAL_SIZE)
+    {
+        requireFullSave();
+    }
+}
+
+void SubWallets::requireFullSave()
+{
+    m_needsFullSave = true;
+    m_journal.clear();
+    m_journalSize = 0;
 }
 
 void SubWallets::fromJSON(const JSONObject &j)
@@ -1090,6 +1362,24 @@ void SubWallets::fromJSON(const JSONObject &j)
 }
 
 void SubWallets::toJSON(rapidjson::Writer<rapidjson::StringBuffer> &writer) const
+{
+    std::scoped_lock lock(m_mutex);
+
+    writeJSON(writer);
+}
+
+void SubWallets::toJSONAndClearJournal(rapidjson::Writer<rapidjson::StringBuffer> &writer)
+{
+    std::scoped_lock lock(m_mutex);
+
+    writeJSON(writer);
+
+    m_journal.clear();
+    m_journalSize = 0;
+    m_needsFullSave = false;
+}
+
+void SubWallets::writeJSON(rapidjson::Writer<rapidjson::StringBuffer> &writer) const
 {
     writer.StartObject();
 
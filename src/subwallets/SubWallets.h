@@ -60,6 +60,12 @@ class SubWallets
     /* Converts the class to a json object */
     void toJSON(rapidjson::Writer<rapidjson::StringBuffer> &writer) const;
 
+    /* Converts the class to a json object for a full save, and discards the
+       journal, as everything in it is in the json. Done under the one lock,
+       so a change can't end up in both the full save and the next journal
+       record. */
+    void toJSONAndClearJournal(rapidjson::Writer<rapidjson::StringBuffer> &writer);
+
     /* Initializes the class from a json string */
     void fromJSON(const JSONObject &j);
 
@@ -171,6 +177,14 @@ class SubWallets
 
     void pruneSpentInputs(const uint64_t pruneHeight);
 
+    /* Returns the changes made since this was last called, to be appended
+       to the wallet journal, and whether something was changed which can't
+       be journaled, in which case the whole wallet needs to be saved */
+    std::tuple<std::vector<std::string>, bool> takeJournal();
+
+    /* Replays a change taken from the wallet journal */
+    void applyJournalEntry(const JSONValue &entry);
+
     /////////////////////////////
     /* Public member variables */
     /////////////////////////////
@@ -191,6 +205,15 @@ class SubWallets
        in the tx */
     void deleteAddressTransactions(std::vector<WalletTypes::Transaction> &txs, const Crypto::PublicKey spendKey);
 
+    /* Must be called with m_mutex held */
+    template<typename Func> void addJournalEntry(const std::string &type, Func &&writeFields);
+
+    /* Must be called with m_mutex held */
+    void requireFullSave();
+
+    /* Must be called with m_mutex held */
+    void writeJSON(rapidjson::Writer<rapidjson::StringBuffer> &writer) const;
+
     //////////////////////////////
     /* Private member variables */
     //////////////////////////////
@@ -217,6 +240,13 @@ class SubWallets
     /* A mapping of key images to the subwallet public spend key that owns them */
     std::unordered_map<Crypto::KeyImage, Crypto::PublicKey> m_keyImageOwners;
 
+    /* Changes made since the wallet was last saved, as JSON */
+    std::vector<std::string> m_journal;
+
+    size_t m_journalSize = 0;
+
+    bool m_needsFullSave = false;
+
     /* Need a mutex for accessing inputs, transactions, and locked
        transactions, etc as these are modified on multiple threads */
     mutable std::mutex m_mutex;
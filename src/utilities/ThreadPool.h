@@ -4,16 +4,99 @@
 
 #pragma once
 
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <exception>
 #include <functional>
 #include <future>
+#include <iterator>
+#include <memory>
 #include <mutex>
-#include <queue>
 #include <thread>
+#include <type_traits>
 #include <vector>
 
 namespace Utilities
 {
-    template<typename ReturnValue> class ThreadPool
+    /* A group of jobs which can be waited on as a whole, without needing a
+       future per job. Pass the same group to ThreadPool::addJob / addJobs,
+       then call ThreadPool::wait(group). */
+    class JobGroup
+    {
+      public:
+        JobGroup(): m_remaining(0), m_complete(true) {}
+
+        /* Can't copy or move a group while jobs may be referencing it */
+        JobGroup(const JobGroup &) = delete;
+
+        JobGroup &operator=(const JobGroup &) = delete;
+
+      private:
+        friend class ThreadPool;
+
+        void add(const size_t count)
+        {
+            if (count == 0)
+            {
+                return;
+            }
+
+            std::scoped_lock<std::mutex> lock(m_mutex);
+
+            m_remaining += count;
+            m_complete = false;
+        }
+
+        void done()
+        {
+            /* Only the last job out touches the mutex. The waiter doesn't
+               return until it sees m_complete under the lock, so it can't
+               destroy the group while we're still using it. */
+            if (--m_remaining == 0)
+            {
+                std::scoped_lock<std::mutex> lock(m_mutex);
+
+                if (m_remaining == 0)
+                {
+                    m_complete = true;
+                    m_finished.notify_all();
+                }
+            }
+        }
+
+        void setException(std::exception_ptr exception)
+        {
+            std::scoped_lock<std::mutex> lock(m_mutex);
+
+            /* Only the first exception is reported to the waiter */
+            if (!m_exception)
+            {
+                m_exception = exception;
+            }
+        }
+
+        /* How many jobs in the group have not yet completed */
+        std::atomic<size_t> m_remaining;
+
+        /* Set by the last job to complete. Guarded by m_mutex. */
+        bool m_complete;
+
+        std::mutex m_mutex;
+
+        std::condition_variable m_finished;
+
+        /* The first exception thrown by a job in the group, if any */
+        std::exception_ptr m_exception;
+    };
+
+    /* A work stealing thread pool. Each worker has its own job deque, which it
+       pops from the back of. When it runs out of work, it steals from the front
+       of the other workers deques. Jobs submitted from outside the pool are
+       spread over the workers deques, so there is no single lock that every
+       submission and every worker contends on. */
+    class ThreadPool
     {
       public:
         /////////////////
@@ -22,7 +105,7 @@ namespace Utilities
 
         ThreadPool(): ThreadPool(std::thread::hardware_concurrency()) {}
 
-        ThreadPool(uint64_t threadCount): m_shouldStop(false)
+        ThreadPool(uint64_t threadCount): m_shouldStop(false), m_pendingJobs(0), m_sleepingThreads(0), m_nextQueue(0)
         {
             if (threadCount == 0)
             {
@@ -31,24 +114,40 @@ namespace Utilities
 
             m_threadCount = threadCount;
 
+            m_queues.reserve(threadCount);
+
+            for (uint64_t i = 0; i < threadCount; i++)
+            {
+                m_queues.push_back(std::make_unique<WorkerQueue>());
+            }
+
             /* Launch our worker threads */
             for (uint64_t i = 0; i < threadCount; i++)
             {
-                m_threads.push_back(std::thread(&ThreadPool::waitForJob, this));
+                m_threads.push_back(std::thread(&ThreadPool::waitForJob, this, i));
             }
         }
 
+        /* Can't copy or move the pool, the workers reference it */
+        ThreadPool(const ThreadPool &) = delete;
+
+        ThreadPool &operator=(const ThreadPool &) = delete;
+
         ////////////////
         /* DESTRUCTOR */
         ////////////////
 
         ~ThreadPool()
         {
-            /* Signal threads to stop */
+            /* Signal threads to stop once they have finished the queued jobs */
             m_shouldStop = true;
 
-            /* Wake them all up */
-            m_haveJob.notify_all();
+            {
+                std::scoped_lock<std::mutex> lock(m_sleepMutex);
+
+                /* Wake them all up */
+                m_haveJob.notify_all();
+            }
 
             /* Wait for them to stop */
             for (auto &thread : m_threads)
@@ -61,68 +160,362 @@ namespace Utilities
         /* PUBLIC MEMBER FUNCTIONS */
         /////////////////////////////
 
-        std::future<ReturnValue> addJob(const std::function<ReturnValue()> job)
+        /* Add a single job, and get a future for its result. Prefer a JobGroup
+           or parallelFor when submitting many small jobs. */
+        template<typename Function> std::future<std::invoke_result_t<Function>> addJob(Function job)
         {
-            std::promise<ReturnValue> promise;
+            using ReturnValue = std::invoke_result_t<Function>;
 
-            std::future<ReturnValue> result = promise.get_future();
+            /* std::function must be copyable, packaged_task is not */
+            auto task = std::make_shared<std::packaged_task<ReturnValue()>>(std::move(job));
 
-            /* Aquire lock */
-            std::unique_lock<std::mutex> lock(m_mutex);
+            std::future<ReturnValue> result = task->get_future();
 
-            /* Add job to queue */
-            m_queue.push({job, std::move(promise)});
+            push(std::function<void()>([task]() { (*task)(); }));
 
-            /* Manually unlocking here so we don't wake up and instantly
-             * sleep upon notify_one */
-            lock.unlock();
+            return result;
+        }
 
-            /* Wake up a thread to process the job */
-            m_haveJob.notify_one();
+        /* Add a single job to the given group */
+        template<typename Function> void addJob(JobGroup &group, Function job)
+        {
+            group.add(1);
 
-            return result;
+            push(wrapGroupJob(group, std::move(job)));
+        }
+
+        /* Add a job for each item in [begin, end) to the group, calling
+           func(item). The jobs are split between the workers with one lock
+           per worker and a single wake up. */
+        template<typename Iterator, typename Function>
+        void addJobs(JobGroup &group, Iterator begin, Iterator end, Function func)
+        {
+            std::vector<std::function<void()>> jobs;
+
+            jobs.reserve(std::distance(begin, end));
+
+            for (auto it = begin; it != end; it++)
+            {
+                jobs.push_back(wrapGroupJob(group, [func, it]() { func(*it); }));
+            }
+
+            group.add(jobs.size());
+
+            push(std::move(jobs));
+        }
+
+        /* Calls func(i) for every i in [begin, end), split into chunks across
+           the workers. The calling thread helps run jobs, and this returns once
+           every call has completed. Rethrows the first exception thrown. */
+        template<typename Function> void parallelFor(const size_t begin, const size_t end, Function func)
+        {
+            if (begin >= end)
+            {
+                return;
+            }
+
+            /* A few chunks per thread, so faster threads can steal work from
+               slower ones, without paying for a job per index */
+            const size_t count = end - begin;
+            const size_t chunkSize = std::max<size_t>(1, count / (m_threadCount * 4));
+
+            std::vector<std::function<void()>> jobs;
+
+            JobGroup group;
+
+            for (size_t chunkStart = begin; chunkStart < end; chunkStart += chunkSize)
+            {
+                const size_t chunkEnd = std::min(end, chunkStart + chunkSize);
+
+                jobs.push_back(wrapGroupJob(
+                    group,
+                    [&func, chunkStart, chunkEnd]()
+                    {
+                        for (size_t i = chunkStart; i < chunkEnd; i++)
+                        {
+                            func(i);
+                        }
+                    }));
+            }
+
+            group.add(jobs.size());
+
+            push(std::move(jobs));
+
+            wait(group);
+        }
+
+        /* Waits for every job in the group to complete. The calling thread runs
+           queued jobs while it waits, so it is safe to call from inside a job.
+           Rethrows the first exception thrown by a job in the group. */
+        void wait(JobGroup &group)
+        {
+            while (group.m_remaining != 0)
+            {
+                std::function<void()> job;
+
+                if (tryGetJob(currentWorkerIndex(), job))
+                {
+                    job();
+                    continue;
+                }
+
+                /* Nothing left to help with. tryGetJob has looked at every
+                   queue under its lock, so the remaining jobs in the group
+                   are running on other threads. */
+                break;
+            }
+
+            std::unique_lock<std::mutex> lock(group.m_mutex);
+
+            group.m_finished.wait(lock, [&group]() { return group.m_complete; });
+
+            if (group.m_exception)
+            {
+                auto exception = group.m_exception;
+                group.m_exception = nullptr;
+                std::rethrow_exception(exception);
+            }
+        }
+
+        uint64_t getThreadCount() const
+        {
+            return m_threadCount;
         }
 
       private:
+        struct WorkerQueue
+        {
+            std::mutex mutex;
+
+            std::deque<std::function<void()>> jobs;
+        };
+
         //////////////////////////////
         /* PRIVATE MEMBER FUNCTIONS */
         //////////////////////////////
 
-        void waitForJob()
+        template<typename Function> std::function<void()> wrapGroupJob(JobGroup &group, Function job)
+        {
+            return [&group, job = std::move(job)]() mutable
+            {
+                try
+                {
+                    job();
+                }
+                catch (...)
+                {
+                    group.setException(std::current_exception());
+                }
+
+                group.done();
+            };
+        }
+
+        /* The pool the calling thread is a worker of, and its queue. Only
+           set by the worker itself, so a worker submitting to, or helping
+           out in, another pool doesn't lose track of its own queue. */
+        struct WorkerSlot
         {
-            while (!m_shouldStop)
+            const ThreadPool *pool = nullptr;
+
+            size_t index = 0;
+        };
+
+        static WorkerSlot &workerSlot()
+        {
+            thread_local WorkerSlot slot;
+
+            return slot;
+        }
+
+        /* The index of the worker queue owned by the calling thread, or
+           m_threadCount if the calling thread is not one of our workers */
+        size_t currentWorkerIndex() const
+        {
+            const WorkerSlot &slot = workerSlot();
+
+            return slot.pool == this ? slot.index : m_threadCount;
+        }
+
+        void push(std::vector<std::function<void()>> &&jobs)
+        {
+            if (jobs.empty())
             {
-                std::unique_lock<std::mutex> lock(m_mutex);
+                return;
+            }
 
-                /* Wait for data to become available or to be stopped */
-                m_haveJob.wait(
-                    lock,
-                    [&]
-                    {
-                        if (m_shouldStop)
-                        {
-                            return true;
-                        }
+            /* Counted before the jobs are visible, so a worker can never take
+               m_pendingJobs below zero. Worst case, a worker wakes slightly early
+               and looks again. */
+            m_pendingJobs += jobs.size();
+
+            const size_t workerIndex = currentWorkerIndex();
+
+            if (workerIndex < m_threadCount)
+            {
+                /* Submitted from one of our workers - keep the jobs local, the
+                   other workers will steal them if they are idle */
+                std::scoped_lock<std::mutex> lock(m_queues[workerIndex]->mutex);
+
+                std::move(jobs.begin(), jobs.end(), std::back_inserter(m_queues[workerIndex]->jobs));
+            }
+            else
+            {
+                /* Deal the jobs out in contiguous runs, one lock per worker */
+                const size_t perQueue = (jobs.size() + m_threadCount - 1) / m_threadCount;
+                const size_t firstQueue = m_nextQueue++;
+
+                for (size_t i = 0, offset = 0; offset < jobs.size(); i++, offset += perQueue)
+                {
+                    auto &queue = *m_queues[(firstQueue + i) % m_threadCount];
+
+                    const size_t last = std::min(jobs.size(), offset + perQueue);
 
-                        return !m_queue.empty();
-                    });
+                    std::scoped_lock<std::mutex> lock(queue.mutex);
+
+                    std::move(jobs.begin() + offset, jobs.begin() + last, std::back_inserter(queue.jobs));
+                }
+            }
 
-                if (m_shouldStop)
+            /* Only pay for a notify if someone is actually asleep. Pairs with
+               the increment of m_sleepingThreads in waitForJob. */
+            if (m_sleepingThreads > 0)
+            {
+                std::scoped_lock<std::mutex> lock(m_sleepMutex);
+
+                if (jobs.size() == 1)
                 {
-                    return;
+                    m_haveJob.notify_one();
+                }
+                else
+                {
+                    m_haveJob.notify_all();
+                }
+            }
+        }
+
+        void push(std::function<void()> &&job)
+        {
+            std::vector<std::function<void()>> jobs;
+            jobs.push_back(std::move(job));
+            push(std::move(jobs));
+        }
+
+        /* Pop a job from the back of our own queue, or steal one from the
+           front of another workers queue */
+        bool tryGetJob(const size_t workerIndex, std::function<void()> &job)
+        {
+            if (m_pendingJobs == 0)
+            {
+                return false;
+            }
+
+            if (workerIndex < m_threadCount)
+            {
+                auto &queue = *m_queues[workerIndex];
+
+                std::scoped_lock<std::mutex> lock(queue.mutex);
+
+                if (!queue.jobs.empty())
+                {
+                    job = std::move(queue.jobs.back());
+                    queue.jobs.pop_back();
+                    m_pendingJobs--;
+                    return true;
+                }
+            }
+
+            const size_t start = workerIndex < m_threadCount ? workerIndex + 1 : 0;
+
+            /* Skip over queues someone else is busy with on the first pass.
+               If that finds nothing, go back and wait for the locks - a
+               failed try_lock doesn't mean the queue is empty, and we must
+               not go to sleep while jobs are still sitting in one. */
+            bool contended = false;
+
+            for (size_t i = 0; i < m_threadCount; i++)
+            {
+                auto &queue = *m_queues[(start + i) % m_threadCount];
+
+                std::unique_lock<std::mutex> lock(queue.mutex, std::try_to_lock);
+
+                if (!lock.owns_lock())
+                {
+                    contended = true;
+                    continue;
+                }
+
+                if (stealFront(queue, job))
+                {
+                    return true;
+                }
+            }
+
+            if (!contended)
+            {
+                return false;
+            }
+
+            for (size_t i = 0; i < m_threadCount; i++)
+            {
+                auto &queue = *m_queues[(start + i) % m_threadCount];
+
+                std::scoped_lock<std::mutex> lock(queue.mutex);
+
+                if (stealFront(queue, job))
+                {
+                    return true;
+                }
+            }
+
+            return false;
+        }
+
+        /* Take the oldest job from a queue. The caller must hold its lock. */
+        bool stealFront(WorkerQueue &queue, std::function<void()> &job)
+        {
+            if (queue.jobs.empty())
+            {
+                return false;
+            }
+
+            job = std::move(queue.jobs.front());
+            queue.jobs.pop_front();
+            m_pendingJobs--;
+            return true;
+        }
+
+        void waitForJob(const size_t workerIndex)
+        {
+            workerSlot() = {this, workerIndex};
+
+            while (true)
+            {
+                std::function<void()> job;
+
+                if (tryGetJob(workerIndex, job))
+                {
+                    job();
+                    continue;
                 }
 
-                /* Take next job from queue */
-                auto [job, result] = std::move(m_queue.front());
+                std::unique_lock<std::mutex> lock(m_sleepMutex);
+
+                m_sleepingThreads++;
 
-                /* Remove item from queue */
-                m_queue.pop();
+                /* Wait for data to become available or to be stopped. We only
+                   get here once every queue has been checked under its lock,
+                   so m_pendingJobs is only non zero if a push is part way
+                   through, or a job was added since we looked. */
+                m_haveJob.wait(lock, [&]() { return m_shouldStop || m_pendingJobs > 0; });
 
-                /* Undo the lock so other threads can process jobs */
-                lock.unlock();
+                m_sleepingThreads--;
 
-                /* Process job and set return value */
-                result.set_value(job());
+                if (m_shouldStop && m_pendingJobs == 0)
+                {
+                    return;
+                }
             }
         }
 
@@ -133,19 +526,28 @@ namespace Utilities
         /* The work threads */
         std::vector<std::thread> m_threads;
 
+        /* One job queue per worker thread */
+        std::vector<std::unique_ptr<WorkerQueue>> m_queues;
+
         /* The amount of threads to launch */
         uint64_t m_threadCount;
 
         /* Whether we're stopping */
         std::atomic<bool> m_shouldStop;
 
+        /* Jobs sitting in a queue, waiting to be picked up */
+        std::atomic<size_t> m_pendingJobs;
+
+        /* Workers currently asleep on m_haveJob */
+        std::atomic<size_t> m_sleepingThreads;
+
+        /* Which queue to start dealing jobs from next, for external submitters */
+        std::atomic<size_t> m_nextQueue;
+
         /* Whether we have a new job to process */
         std::condition_variable m_haveJob;
 
-        /* Mutex to serialize access to job queue */
-        std::mutex m_mutex;
-
-        /* The queue of job functions and job results */
-        std::queue<std::tuple<std::function<ReturnValue()>, std::promise<ReturnValue>>> m_queue;
+        /* Mutex for sleeping / waking the workers */
+        std::mutex m_sleepMutex;
     };
 } // namespace Utilities
@@ -246,8 +246,41 @@ bool BlockDownloader::downloadBlocks()
         Logger::logger.log(stream.str(), Logger::DEBUG, {Logger::SYNC});
     }
 
-    const auto [success, blocks, topBlock] = m_daemon->getWalletSyncData(
-        blockCheckpoints, m_startHeight, m_startTimestamp, Config::config.wallet.skipCoinbaseTransactions);
+    size_t blockCount = 0;
+
+    uint64_t firstBlockHeight = 0;
+
+    uint64_t lastBlockHeight = 0;
+
+    /* Store the blocks as they arrive, so the synchronizer can start on them
+       before the whole response has been downloaded */
+    const auto [success, topBlock] = m_daemon->getWalletSyncData(
+        blockCheckpoints,
+        m_startHeight,
+        m_startTimestamp,
+        Config::config.wallet.skipCoinbaseTransactions,
+        [&](WalletTypes::WalletBlockInfo block) {
+            /* Timestamp is transient and can change - block height is constant. */
+            if (m_startTimestamp != 0)
+            {
+                m_startTimestamp = 0;
+                m_startHeight = block.blockHeight;
+
+                m_subWallets->convertSyncTimestampToHeight(m_startTimestamp, m_startHeight);
+            }
+
+            if (blockCount == 0)
+            {
+                firstBlockHeight = block.blockHeight;
+            }
+
+            lastBlockHeight = block.blockHeight;
+
+            blockCount++;
+
+            /* Fails if we're stopping */
+            return m_storedBlocks.push_back({std::move(block), m_arrivalIndex++});
+        });
 
     /* Synced, store the top block so sync status displayes correctly if
        we are not scanning coinbase tx only blocks */
@@ -257,7 +290,7 @@ bool BlockDownloader::downloadBlocks()
        topblock, which is also 1000, as having being processed, when in
        fact, we're still waiting for it to be processed. So, if we only store
        it if we have no blocks waiting to be processed, it fixes this issue */
-    if (success && blocks.empty() && topBlock && m_storedBlocks.size() == 0)
+    if (success && blockCount == 0 && topBlock && m_storedBlocks.size() == 0)
     {
         m_synchronizationStatus.storeBlockHash(topBlock->hash, topBlock->height);
         return false;
@@ -265,7 +298,7 @@ bool BlockDownloader::downloadBlocks()
     /* If we get no blocks, we are fully synced.
        (Or timed out/failed to get blocks)
        Sleep a bit so we don't spam the daemon. */
-    else if (!success || blocks.empty())
+    else if (blockCount == 0)
     {
         /* We may have also failed because we requested
            more data than could be returned in a reasonable
@@ -277,36 +310,26 @@ bool BlockDownloader::downloadBlocks()
         return false;
     }
 
-    /* If we received data back, we'll make sure we're back
-       to running at full speed in case we backed off a little
-       bit before */
-    m_daemon->resetRequestedBlockCount();
-
-    /* Timestamp is transient and can change - block height is constant. */
-    if (m_startTimestamp != 0)
+    /* If the request failed part way through, the blocks we got are still
+       valid and have been stored, but back off a bit in case we asked for
+       too much. Otherwise, we'll make sure we're back to running at full
+       speed in case we backed off a little bit before */
+    if (!success)
     {
-        m_startTimestamp = 0;
-        m_startHeight = blocks.front().blockHeight;
-
-        m_subWallets->convertSyncTimestampToHeight(m_startTimestamp, m_startHeight);
+        m_daemon->decreaseRequestedBlockCount();
+    }
+    else
+    {
+        m_daemon->resetRequestedBlockCount();
     }
 
     std::stringstream stream;
 
-    stream << "Downloaded " << blocks.size() << " blocks from daemon, [" << blocks.front().blockHeight << ", "
-           << blocks.back().blockHeight << "]";
+    stream << "Downloaded " << blockCount << " blocks from daemon, [" << firstBlockHeight << ", " << lastBlockHeight
+           << "]";
 
     Logger::logger.log(stream.str(), Logger::DEBUG, {Logger::SYNC});
 
-    std::vector<std::tuple<WalletTypes::WalletBlockInfo, uint32_t>> blocksWithIndex;
-
-    for (const auto &block : blocks)
-    {
-        blocksWithIndex.push_back({block, m_arrivalIndex++});
-    }
-
-    m_storedBlocks.push_back_n(blocksWithIndex.begin(), blocksWithIndex.end());
-
     return true;
 }
 
@@ -6,6 +6,7 @@
 
 #include <array>
 #include <config/CryptoNoteConfig.h>
+#include <string>
 
 namespace Constants
 {
@@ -26,6 +27,10 @@ namespace Constants
                                                                   0x62, 0x69, 0x67, 0x20, 0x67, 0x75, 0x79, 0x2e, 0x0a,
                                                                   0x46, 0x6f, 0x72, 0x20, 0x79, 0x6f, 0x75, 0x2e}};
 
+    /* Starts the wallet journal file, so we don't try and replay some
+       other file on top of the wallet */
+    const std::string IS_A_WALLET_JOURNAL_IDENTIFIER = "TurtleCoin wallet journal\n";
+
     /* The number of iterations of PBKDF2 to perform on the wallet
        password. */
     const uint64_t PBKDF2_ITERATIONS = 500000;
@@ -60,4 +65,9 @@ namespace Constants
        jumps in the sync height, but should offer better performance from a
        decrease in locking of data structures. */
     const uint64_t BLOCK_PROCESSING_CHUNK = 500;
+
+    /* Once the wallet journal grows past this size, the next save writes out
+       the whole wallet and starts a new journal, so opening the wallet
+       doesn't have to replay a huge amount of changes */
+    const uint64_t MAX_WALLET_JOURNAL_SIZE = 1024 * 1024 * 32;
 } // namespace Constants
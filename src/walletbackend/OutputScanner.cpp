@@ -0,0 +1,61 @@
+// Copyright (c) 2018-2019, The TurtleCoin Developers
+//
+// Please see the included LICENSE file for more information.
+
+///////////////////////////////////////
+#include <walletbackend/OutputScanner.h>
+///////////////////////////////////////
+
+#include <crypto/crypto.h>
+
+size_t OutputScanner::addWallet(
+    const Crypto::SecretKey &privateViewKey,
+    const std::vector<Crypto::PublicKey> &publicSpendKeys)
+{
+    m_privateViewKeys.push_back(privateViewKey);
+    m_publicSpendKeys.emplace_back(publicSpendKeys.begin(), publicSpendKeys.end());
+
+    return m_privateViewKeys.size() - 1;
+}
+
+std::vector<OutputScanner::OwnedOutput>
+    OutputScanner::scanTransaction(const WalletTypes::RawCoinbaseTransaction &tx) const
+{
+    std::vector<OwnedOutput> ownedOutputs;
+
+    if (tx.keyOutputs.empty() || m_privateViewKeys.empty())
+    {
+        return ownedOutputs;
+    }
+
+    std::vector<Crypto::KeyDerivation> derivations;
+
+    /* Invalid transaction key, can't belong to anyone */
+    if (!Crypto::crypto_ops::generateKeyDerivations(tx.transactionPublicKey, m_privateViewKeys, derivations))
+    {
+        return ownedOutputs;
+    }
+
+    std::vector<Crypto::PublicKey> derivedSpendKeys;
+
+    for (uint64_t outputIndex = 0; outputIndex < tx.keyOutputs.size(); outputIndex++)
+    {
+        if (!Crypto::crypto_ops::underivePublicKeys(
+                derivations, outputIndex, tx.keyOutputs[outputIndex].key, derivedSpendKeys))
+        {
+            continue;
+        }
+
+        for (size_t i = 0; i < derivedSpendKeys.size(); i++)
+        {
+            /* If the derived spend key matches one of the wallets spend keys,
+               the output belongs to it */
+            if (m_publicSpendKeys[i].find(derivedSpendKeys[i]) != m_publicSpendKeys[i].end())
+            {
+                ownedOutputs.push_back({i, outputIndex, derivedSpendKeys[i], derivations[i]});
+            }
+        }
+    }
+
+    return ownedOutputs;
+}
@@ -0,0 +1,54 @@
+// Copyright (c) 2018-2019, The TurtleCoin Developers
+//
+// Please see the included LICENSE file for more information.
+
+#pragma once
+
+#include <CryptoTypes.h>
+#include <WalletTypes.h>
+#include <unordered_set>
+#include <vector>
+
+/* Finds the outputs in a transaction which belong to one or more wallets,
+   each made up of a private view key and the public spend keys of its
+   subwallets.
+
+   The transaction public key, and each output key, is decoded once and
+   shared between every wallet, so scanning several wallets against the same
+   blocks costs a lot less than scanning the blocks once per wallet. */
+class OutputScanner
+{
+  public:
+    struct OwnedOutput
+    {
+        /* Index of the wallet, in the order they were added */
+        size_t walletIndex;
+
+        /* Index of the output in the transaction */
+        uint64_t outputIndex;
+
+        /* The subwallet the output belongs to */
+        Crypto::PublicKey publicSpendKey;
+
+        Crypto::KeyDerivation derivation;
+    };
+
+    /////////////////////////////
+    /* Public member functions */
+    /////////////////////////////
+
+    /* Returns the index of the wallet */
+    size_t addWallet(const Crypto::SecretKey &privateViewKey, const std::vector<Crypto::PublicKey> &publicSpendKeys);
+
+    std::vector<OwnedOutput> scanTransaction(const WalletTypes::RawCoinbaseTransaction &tx) const;
+
+  private:
+    //////////////////////////////
+    /* Private member variables */
+    //////////////////////////////
+
+    std::vector<Crypto::SecretKey> m_privateViewKeys;
+
+    /* The spend keys of each wallet, in the same order as the view keys */
+    std::vector<std::unordered_set<Crypto::PublicKey>> m_publicSpendKeys;
+};
@@ -639,7 +639,94 @@ Error WalletBackend::save() const
    blockchain synchronizer first (Call save()) */
 Error WalletBackend::unsafeSave() const
 {
-    return WalletBackend::saveWalletJSONToDisk(unsafeToJSON(), m_filename, m_password);
+    const auto [journalEntries, needsFullSave] = m_subWallets->takeJournal();
+
+    if (needsFullSave || m_journal == nullptr || m_journal->getSize() > Constants::MAX_WALLET_JOURNAL_SIZE)
+    {
+        return unsafeSaveSnapshot();
+    }
+
+    StringBuffer syncState;
+    Writer<StringBuffer> syncStateWriter(syncState);
+
+    m_walletSynchronizer->toJSON(syncStateWriter);
+
+    /* Nothing to save */
+    if (journalEntries.empty() && m_lastJournaledSyncState == syncState.GetString())
+    {
+        return SUCCESS;
+    }
+
+    StringBuffer sb;
+    Writer<StringBuffer> writer(sb);
+
+    writer.StartObject();
+
+    writer.Key("subWallets");
+    writer.StartArray();
+    for (const auto &entry : journalEntries)
+    {
+        writer.RawValue(entry.c_str(), entry.size(), rapidjson::kObjectType);
+    }
+    writer.EndArray();
+
+    writer.Key("walletSynchronizer");
+    writer.RawValue(syncState.GetString(), syncState.GetSize(), rapidjson::kObjectType);
+
+    writer.EndObject();
+
+    if (Error error = m_journal->append(sb.GetString()); error != SUCCESS)
+    {
+        Logger::logger.log(
+            "Failed to append to wallet journal, saving full wallet instead: " + error.getErrorMessage(),
+            Logger::WARNING,
+            {Logger::FILESYSTEM, Logger::SAVE});
+
+        return unsafeSaveSnapshot();
+    }
+
+    m_lastJournaledSyncState = syncState.GetString();
+
+    return SUCCESS;
+}
+
+Error WalletBackend::unsafeSaveSnapshot() const
+{
+    /* Only need to run PBKDF2 again if we don't have a journal already, or the
+       password has changed */
+    if (m_journal == nullptr)
+    {
+        m_journal = std::make_unique<WalletJournal>(m_filename, m_password);
+    }
+
+    const std::string journalId = WalletJournal::generateJournalId();
+
+    if (Error error = saveWalletJSONToDisk(unsafeToJSON(journalId), m_filename, m_password); error != SUCCESS)
+    {
+        /* The changes we took from the subwallets are gone, so make sure the
+           next save writes everything out */
+        m_journal = nullptr;
+
+        return error;
+    }
+
+    m_lastJournaledSyncState.clear();
+
+    /* Only replace the old journal once the new wallet file is written - if
+       we crash before then, the old journal is still needed. */
+    if (Error error = m_journal->reset(journalId); error != SUCCESS)
+    {
+        Logger::logger.log(
+            "Failed to start new wallet journal: " + error.getErrorMessage(),
+            Logger::WARNING,
+            {Logger::FILESYSTEM, Logger::SAVE});
+
+        /* The wallet file is complete, we'll just have to write it all out
+           again next time */
+        m_journal = nullptr;
+    }
+
+    return SUCCESS;
 }
 
 /* Get the balance for one subwallet (error, unlocked, locked) */
@@ -1057,7 +1144,70 @@ Error WalletBackend::changePassword(const std::string newPassword)
 
     m_password = newPassword;
 
-    return save();
+    return m_syncRAIIWrapper->pauseSynchronizerToRunFunction(
+        [this]()
+        {
+            /* The journal is encrypted with the old password, so write
+               everything out with the new one, and start a new journal */
+            m_journal = nullptr;
+
+            return unsafeSave();
+        });
+}
+
+Error WalletBackend::replayJournal(const std::string &journalId)
+{
+    auto [error, journal, records] = WalletJournal::open(m_filename, m_password, journalId);
+
+    if (error)
+    {
+        return error;
+    }
+
+    try
+    {
+        /* Each record has the whole sync state, so only the last one is needed */
+        rapidjson::Document lastRecord;
+
+        for (const auto &record : records)
+        {
+            rapidjson::Document j;
+
+            if (j.Parse(record.c_str()).HasParseError())
+            {
+                return WALLET_FILE_CORRUPTED;
+            }
+
+            for (const auto &entry : getArrayFromJSON(j, "subWallets"))
+            {
+                m_subWallets->applyJournalEntry(entry);
+            }
+
+            lastRecord.Swap(j);
+        }
+
+        if (!records.empty())
+        {
+            m_walletSynchronizer = std::make_shared<WalletSynchronizer>();
+            m_walletSynchronizer->fromJSON(getObjectFromJSON(lastRecord, "walletSynchronizer"));
+        }
+    }
+    catch (const std::exception &e)
+    {
+        Logger::logger.log(
+            std::string("Failed to replay wallet journal: ") + e.what(),
+            Logger::FATAL,
+            {Logger::FILESYSTEM, Logger::SAVE});
+
+        return WALLET_FILE_CORRUPTED;
+    }
+
+    /* These are already in the journal */
+    m_subWallets->takeJournal();
+
+    m_journal = std::move(journal);
+
+    return SUCCESS;
 }
 
 std::tuple<Error, Crypto::PublicKey, Crypto::SecretKey, uint64_t>
@@ -1232,6 +1382,11 @@ std::string WalletBackend::toJSON() const
 }
 
 std::string WalletBackend::unsafeToJSON() const
+{
+    return unsafeToJSON(std::string());
+}
+
+std::string WalletBackend::unsafeToJSON(const std::string &journalId) const
 {
     StringBuffer sb;
     Writer<StringBuffer> writer(sb);
@@ -1242,11 +1397,26 @@ std::string WalletBackend::unsafeToJSON() const
     writer.Uint(Constants::WALLET_FILE_FORMAT_VERSION);
 
     writer.Key("subWallets");
-    m_subWallets->toJSON(writer);
+
+    /* Starting a new journal, so anything in the old one is covered by this */
+    if (!journalId.empty())
+    {
+        m_subWallets->toJSONAndClearJournal(writer);
+    }
+    else
+    {
+        m_subWallets->toJSON(writer);
+    }
 
     writer.Key("walletSynchronizer");
     m_walletSynchronizer->toJSON(writer);
 
+    if (!journalId.empty())
+    {
+        writer.Key("journalId");
+        writer.String(journalId);
+    }
+
     writer.EndObject();
 
     return sb.GetString();
@@ -1288,6 +1458,15 @@ Error WalletBackend::fromJSON(
     m_password = password;
     m_syncThreadCount = syncThreadCount;
 
+    /* Older wallet files won't have a journal */
+    if (j.HasMember("journalId"))
+    {
+        if (Error error = replayJournal(getStringFromJSON(j, "journalId")); error != SUCCESS)
+        {
+            return error;
+        }
+    }
+
     m_daemon = std::make_shared<Nigel>(daemonHost, daemonPort, daemonSSL);
 
     init();
@@ -13,6 +13,7 @@
 #include <subwallets/SubWallets.h>
 #include <tuple>
 #include <vector>
+#include <walletbackend/WalletJournal.h>
 #include <walletbackend/WalletSynchronizer.h>
 #include <walletbackend/WalletSynchronizerRAIIWrapper.h>
 
@@ -313,8 +314,19 @@ class WalletBackend
 
     Error unsafeSave() const;
 
+    /* Writes the whole wallet out, and starts a new, empty journal */
+    Error unsafeSaveSnapshot() const;
+
     std::string unsafeToJSON() const;
 
+    /* The wallet file stores the ID of the journal started from it. Given
+       one, the subwallet changes waiting to be journaled are dropped, as
+       they are all in the file. */
+    std::string unsafeToJSON(const std::string &journalId) const;
+
+    /* Applies the changes saved since the wallet file was written */
+    Error replayJournal(const std::string &journalId);
+
     void init();
 
     //////////////////////////////
@@ -338,6 +350,14 @@ class WalletBackend
 
     std::shared_ptr<WalletSynchronizerRAIIWrapper> m_syncRAIIWrapper;
 
+    /* Changes made since the wallet file was last written out in full. Null
+       if the next save needs to write out everything. */
+    mutable std::unique_ptr<WalletJournal> m_journal;
+
+    /* The synchronizer state in the last journal record, so we don't keep
+       appending it when nothing has changed */
+    mutable std::string m_lastJournaledSyncState;
+
     unsigned int m_syncThreadCount;
 
     /* Prepared, unsent transactions. */
@@ -0,0 +1,303 @@
+// Copyright (c) 2018-2019, The TurtleCoin Developers
+//
+// Please see the included LICENSE file for more information.
+
+///////////////////////////////////////
+#include <walletbackend/WalletJournal.h>
+///////////////////////////////////////
+
+#include <common/FileSystemShim.h>
+#include <common/StringTools.h>
+#include <crypto/random.h>
+#include <cryptopp/aes.h>
+#include <cryptopp/filters.h>
+#include <cryptopp/modes.h>
+#include <cryptopp/pwdbased.h>
+#include <cryptopp/sha.h>
+#include <cstring>
+#include <logger/Logger.h>
+#include <walletbackend/Constants.h>
+
+namespace
+{
+    const size_t JOURNAL_ID_SIZE = 16;
+
+    const size_t IV_SIZE = 16;
+
+    const size_t HEADER_SIZE = Constants::IS_A_WALLET_JOURNAL_IDENTIFIER.size() + JOURNAL_ID_SIZE + 16;
+
+    void writeUint32(std::string &out, const uint32_t value)
+    {
+        for (int i = 0; i < 4; i++)
+        {
+            out += static_cast<char>((value >> (i * 8)) & 0xff);
+        }
+    }
+
+    uint32_t readUint32(const char *data)
+    {
+        const auto bytes = reinterpret_cast<const uint8_t *>(data);
+
+        return bytes[0] | (bytes[1] << 8) | (bytes[2] << 16) | (static_cast<uint32_t>(bytes[3]) << 24);
+    }
+} // namespace
+
+WalletJournal::WalletJournal(const std::string &walletFilename, const std::string &password):
+    m_filename(getJournalFilename(walletFilename))
+{
+    Random::randomBytes(m_salt.size(), m_salt.data());
+
+    deriveKey(password);
+}
+
+std::tuple<Error, std::unique_ptr<WalletJournal>, std::vector<std::string>> WalletJournal::open(
+    const std::string &walletFilename,
+    const std::string &password,
+    const std::string &journalId)
+{
+    const std::string filename = getJournalFilename(walletFilename);
+
+    std::ifstream file(filename, std::ios_base::binary);
+
+    /* No journal, the snapshot is all there is */
+    if (!file)
+    {
+        return {SUCCESS, nullptr, std::vector<std::string>()};
+    }
+
+    const std::string data((std::istreambuf_iterator<char>(file)), (std::istreambuf_iterator<char>()));
+
+    const auto &identifier = Constants::IS_A_WALLET_JOURNAL_IDENTIFIER;
+
+    if (data.size() < HEADER_SIZE || data.compare(0, identifier.size(), identifier) != 0)
+    {
+        Logger::logger.log(
+            "Wallet journal " + filename + " is invalid, ignoring it", Logger::WARNING, {Logger::FILESYSTEM});
+
+        return {SUCCESS, nullptr, std::vector<std::string>()};
+    }
+
+    size_t offset = identifier.size();
+
+    /* Left over from an older snapshot, everything in it has already been
+       written out in full */
+    if (Common::toHex(data.data() + offset, JOURNAL_ID_SIZE) != journalId)
+    {
+        return {SUCCESS, nullptr, std::vector<std::string>()};
+    }
+
+    offset += JOURNAL_ID_SIZE;
+
+    std::unique_ptr<WalletJournal> journal(new WalletJournal());
+
+    journal->m_filename = filename;
+    journal->m_journalId = journalId;
+
+    std::memcpy(journal->m_salt.data(), data.data() + offset, journal->m_salt.size());
+    offset += journal->m_salt.size();
+
+    journal->deriveKey(password);
+
+    CryptoPP::CBC_Mode<CryptoPP::AES>::Decryption cbcDecryption;
+
+    const std::string passwordIdentifier(
+        Constants::IS_CORRECT_PASSWORD_IDENTIFIER.begin(), Constants::IS_CORRECT_PASSWORD_IDENTIFIER.end());
+
+    std::vector<std::string> records;
+
+    while (data.size() - offset >= 4 + IV_SIZE)
+    {
+        const uint32_t length = readUint32(data.data() + offset);
+
+        if (data.size() - offset - 4 - IV_SIZE < length)
+        {
+            break;
+        }
+
+        const auto iv = reinterpret_cast<const CryptoPP::byte *>(data.data() + offset + 4);
+
+        cbcDecryption.SetKeyWithIV(journal->m_key.data(), journal->m_key.size(), iv);
+
+        std::string record;
+
+        try
+        {
+            CryptoPP::StringSource(
+                reinterpret_cast<const CryptoPP::byte *>(data.data() + offset + 4 + IV_SIZE),
+                length,
+                true,
+                new CryptoPP::StreamTransformationFilter(cbcDecryption, new CryptoPP::StringSink(record)));
+        }
+        catch (const CryptoPP::Exception &)
+        {
+            break;
+        }
+
+        if (record.compare(0, passwordIdentifier.size(), passwordIdentifier) != 0)
+        {
+            break;
+        }
+
+        records.push_back(record.substr(passwordIdentifier.size()));
+
+        offset += 4 + IV_SIZE + length;
+    }
+
+    if (offset != data.size())
+    {
+        Logger::logger.log(
+            "Wallet journal " + filename + " has a partially written record, discarding it",
+            Logger::WARNING,
+            {Logger::FILESYSTEM});
+    }
+
+    file.close();
+
+    /* Cut off anything we couldn't read, so new records go straight after
+       the last good one */
+    try
+    {
+        fs::resize_file(filename, offset);
+    }
+    catch (const fs::filesystem_error &e)
+    {
+        return {
+            Error(INVALID_WALLET_FILENAME, std::string("Failed to open wallet journal: ") + e.what()),
+            nullptr,
+            std::vector<std::string>()};
+    }
+
+    journal->m_file.open(filename, std::ios_base::binary | std::ios_base::app);
+
+    if (!journal->m_file)
+    {
+        return {
+            Error(
+                INVALID_WALLET_FILENAME,
+                "Failed to open wallet journal " + filename + ". Error: " + std::string(strerror(errno))),
+            nullptr,
+            std::vector<std::string>()};
+    }
+
+    journal->m_size = offset;
+
+    return {SUCCESS, std::move(journal), records};
+}
+
+std::string WalletJournal::getJournalFilename(const std::string &walletFilename)
+{
+    return walletFilename + ".journal";
+}
+
+std::string WalletJournal::generateJournalId()
+{
+    return Common::toHex(Random::randomBytes(JOURNAL_ID_SIZE));
+}
+
+Error WalletJournal::reset(const std::string &journalId)
+{
+    std::vector<uint8_t> journalIdBytes;
+
+    if (!Common::fromHex(journalId, journalIdBytes) || journalIdBytes.size() != JOURNAL_ID_SIZE)
+    {
+        throw std::invalid_argument("Invalid journal ID");
+    }
+
+    if (m_file.is_open())
+    {
+        m_file.close();
+    }
+
+    m_file.open(m_filename, std::ios_base::binary | std::ios_base::trunc);
+
+    if (!m_file)
+    {
+        return Error(
+            INVALID_WALLET_FILENAME,
+            "Failed to create wallet journal " + m_filename + ". Error: " + std::string(strerror(errno)));
+    }
+
+    std::string header = Constants::IS_A_WALLET_JOURNAL_IDENTIFIER;
+
+    header.append(journalIdBytes.begin(), journalIdBytes.end());
+    header.append(m_salt.begin(), m_salt.end());
+
+    m_file.write(header.data(), header.size());
+    m_file.flush();
+
+    if (!m_file)
+    {
+        return Error(INVALID_WALLET_FILENAME, "Failed to write to wallet journal " + m_filename);
+    }
+
+    m_journalId = journalId;
+    m_size = header.size();
+
+    return SUCCESS;
+}
+
+Error WalletJournal::append(const std::string &record)
+{
+    const std::string passwordIdentifier(
+        Constants::IS_CORRECT_PASSWORD_IDENTIFIER.begin(), Constants::IS_CORRECT_PASSWORD_IDENTIFIER.end());
+
+    std::array<uint8_t, IV_SIZE> iv;
+
+    Random::randomBytes(iv.size(), iv.data());
+
+    CryptoPP::CBC_Mode<CryptoPP::AES>::Encryption cbcEncryption;
+
+    cbcEncryption.SetKeyWithIV(m_key.data(), m_key.size(), iv.data());
+
+    std::string encryptedData;
+
+    CryptoPP::StringSource(
+        passwordIdentifier + record,
+        true,
+        new CryptoPP::StreamTransformationFilter(cbcEncryption, new CryptoPP::StringSink(encryptedData)));
+
+    std::string data;
+
+    data.reserve(4 + iv.size() + encryptedData.size());
+
+    writeUint32(data, static_cast<uint32_t>(encryptedData.size()));
+    data.append(iv.begin(), iv.end());
+    data += encryptedData;
+
+    m_file.write(data.data(), data.size());
+    m_file.flush();
+
+    if (!m_file)
+    {
+        return Error(INVALID_WALLET_FILENAME, "Failed to write to wallet journal " + m_filename);
+    }
+
+    m_size += data.size();
+
+    return SUCCESS;
+}
+
+std::string WalletJournal::getJournalId() const
+{
+    return m_journalId;
+}
+
+uint64_t WalletJournal::getSize() const
+{
+    return m_size;
+}
+
+void WalletJournal::deriveKey(const std::string &password)
+{
+    CryptoPP::PKCS5_PBKDF2_HMAC<CryptoPP::SHA256> pbkdf2;
+
+    pbkdf2.DeriveKey(
+        m_key.data(),
+        m_key.size(),
+        0,
+        reinterpret_cast<const CryptoPP::byte *>(password.c_str()),
+        password.size(),
+        m_salt.data(),
+        m_salt.size(),
+        Constants::PBKDF2_ITERATIONS);
+}
@@ -0,0 +1,89 @@
+// Copyright (c) 2018-2019, The TurtleCoin Developers
+//
+// Please see the included LICENSE file for more information.
+
+#pragma once
+
+#include <array>
+#include <errors/Errors.h>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <tuple>
+#include <vector>
+
+/* An append only log of the changes made to a wallet since it was last
+   written out in full, stored next to the wallet file. Saving then only has
+   to encrypt and write what changed, rather than the whole wallet.
+
+   Each journal has an ID, which the full wallet file (the snapshot) stores,
+   so we only replay a journal on top of the snapshot it was started from.
+
+   The file is laid out as:
+
+   [Identifier][Journal ID, 16 bytes][Salt, 16 bytes][Record][Record]...
+
+   And each record as:
+
+   [Length, 4 bytes, little endian][IV, 16 bytes][Encrypted data]
+
+   The key is derived with PBKDF2 from the password and the salt, like the
+   wallet file, but only once - each record gets its own random IV. If we
+   crash halfway through writing a record, it is dropped on the next open. */
+class WalletJournal
+{
+  public:
+    /////////////////
+    /* Constructor */
+    /////////////////
+
+    /* Slow, as it has to run PBKDF2 on the password */
+    WalletJournal(const std::string &walletFilename, const std::string &password);
+
+    /////////////////////////////
+    /* Public member functions */
+    /////////////////////////////
+
+    /* Opens the journal belonging to this wallet file, if it was started
+       from the snapshot with the given journal ID. Returns the records in it,
+       oldest first. Returns a nullptr journal if there isn't one, or it
+       belongs to another snapshot. */
+    static std::tuple<Error, std::unique_ptr<WalletJournal>, std::vector<std::string>> open(
+        const std::string &walletFilename,
+        const std::string &password,
+        const std::string &journalId);
+
+    static std::string getJournalFilename(const std::string &walletFilename);
+
+    /* Makes a random ID for a new journal */
+    static std::string generateJournalId();
+
+    /* Starts a new, empty journal with the given ID, replacing the current
+       one. Reuses the key we already derived. */
+    Error reset(const std::string &journalId);
+
+    /* Encrypts and appends a record, flushing it to disk */
+    Error append(const std::string &record);
+
+    std::string getJournalId() const;
+
+    /* Size of the journal file in bytes */
+    uint64_t getSize() const;
+
+  private:
+    WalletJournal() = default;
+
+    void deriveKey(const std::string &password);
+
+    std::string m_filename;
+
+    std::string m_journalId;
+
+    std::array<uint8_t, 16> m_salt;
+
+    std::array<uint8_t, 16> m_key;
+
+    std::ofstream m_file;
+
+    uint64_t m_size = 0;
+};
@@ -13,8 +13,6 @@
 #include <future>
 #include <iostream>
 #include <logger/Logger.h>
-#include <utilities/ThreadSafeDeque.h>
-#include <utilities/ThreadSafeQueue.h>
 #include <utilities/Utilities.h>
 #include <walletbackend/Constants.h>
 
@@ -90,11 +88,15 @@ WalletSynchronizer &WalletSynchronizer::operator=(WalletSynchronizer &&old)
 
     m_subWallets = std::move(old.m_subWallets);
 
-    m_blockProcessingQueue = std::move(old.m_blockProcessingQueue);
+    m_threadCount = std::move(old.m_threadCount);
 
-    m_processedBlocks = std::move(old.m_processedBlocks);
+    /* m_threadPool is deliberately not moved. It only exists between start()
+       and stop(), and if old is still running, its sync thread is using
+       old's pool. We make our own in start(). */
 
-    m_threadCount = std::move(old.m_threadCount);
+    m_poolTransactions = std::move(old.m_poolTransactions);
+    m_poolEpoch = std::move(old.m_poolEpoch);
+    m_poolCursor = std::move(old.m_poolCursor);
 
     return *this;
 }
@@ -119,46 +121,36 @@ void WalletSynchronizer::mainLoop()
 
         if (!blocks.empty())
         {
-            m_blockProcessingQueue.push_back_n(blocks.begin(), blocks.end());
-
-            /* Tell the child threads to wake up */
-            m_haveBlocksToProcess.notify_all();
-
-            const size_t chunkSize = blocks.size();
-
-            {
-                /* *possibly* should use another mutex here for the different
-                    condition variable? I think it's fine since we're only
-                    stopping the child threads from aquiring the mutex for
-                    a very short time (since the check will fail when not all
-                    blocks are available) */
-                std::unique_lock<std::mutex> lock(m_mutex);
-
-                m_haveProcessedBlocksToHandle.wait(
-                    lock,
-                    [&]
+            /* The inputs belonging to us in each block, in the same order as
+               the blocks arrived. This order is needed to ensure correct
+               handling of network forks. */
+            std::vector<BlockInputsAndOwners> processedBlocks(blocks.size());
+
+            /* Subwallets can only be added or removed while we're stopped, so
+               the spend keys won't change under us */
+            OutputScanner scanner;
+            scanner.addWallet(m_privateViewKey, m_subWallets->m_publicSpendKeys);
+
+            /* Scan the blocks for our outputs on the thread pool */
+            m_threadPool->parallelFor(
+                0,
+                blocks.size(),
+                [&](const size_t i)
+                {
+                    if (!m_shouldStop)
                     {
-                        if (m_shouldStop)
-                        {
-                            return true;
-                        }
-
-                        /* Wait until all the blocks have been added to the queue */
-                        return m_processedBlocks.size() == chunkSize;
-                    });
+                        processedBlocks[i] = processBlock(std::get<0>(blocks[i]), scanner);
+                    }
+                });
 
-                if (m_shouldStop)
-                {
-                    return;
-                }
+            if (m_shouldStop)
+            {
+                return;
             }
 
-            /* Nothing else should be pushing to the queue here, since the
-               child threads are waiting for a new chunk, so don't need to
-               use mutex to access */
-            while (!m_processedBlocks.empty_unsafe() && !m_shouldStop)
+            for (size_t i = 0; i < blocks.size() && !m_shouldStop; i++)
             {
-                const auto [block, ourInputs, arrivalIndex] = m_processedBlocks.top_unsafe();
+                const auto &block = std::get<0>(blocks[i]);
 
                 /* if endScanHeight is set, stop syncing at endScanHeight and start syncing from top of the chain */
                 if (m_endScanHeight && getCurrentScanHeight() >= m_endScanHeight)
@@ -178,8 +170,7 @@ void WalletSynchronizer::mainLoop()
                     break;
                 }
 
-                completeBlockProcessing(block, ourInputs);
-                m_processedBlocks.pop_unsafe();
+                completeBlockProcessing(block, processedBlocks[i]);
             }
         }
 
@@ -201,144 +192,77 @@ void WalletSynchronizer::mainLoop()
     }
 }
 
-void WalletSynchronizer::blockProcessingThread()
+BlockInputsAndOwners
+    WalletSynchronizer::processBlock(const WalletTypes::WalletBlockInfo &block, const OutputScanner &scanner) const
 {
-    /* Take the max chunk size, split by the threads, divided by 2. So in
-       theory, each thread processes 2 chunks. This is to decrease locking,
-       while also trying to stop slower threads from delaying the system. */
-    size_t chunkSize = Constants::BLOCK_PROCESSING_CHUNK / m_threadCount / 2;
+    Logger::logger.log("Processing block " + std::to_string(block.blockHeight), Logger::DEBUG, {Logger::SYNC});
 
-    if (chunkSize == 0)
-    {
-        chunkSize = 1;
-    }
-
-    /* No point splitting into chunks if we're only using 1 thread */
-    if (m_threadCount == 1)
-    {
-        chunkSize = Constants::BLOCK_PROCESSING_CHUNK;
-    }
+    auto ourInputs = processBlockOutputs(block, scanner);
 
-    std::vector<SemiProcessedBlock> processedBlocks;
+    std::unordered_map<Crypto::Hash, std::vector<uint64_t>> globalIndexes;
 
-    while (!m_shouldStop)
+    for (auto &[publicKey, input] : ourInputs)
     {
+        if (!m_subWallets->isViewWallet() && !input.globalOutputIndex)
         {
-            std::unique_lock<std::mutex> lock(m_mutex);
-
-            /* Wait for blocks to be available */
-            m_haveBlocksToProcess.wait(
-                lock,
-                [&]
-                {
-                    if (m_shouldStop)
-                    {
-                        return true;
-                    }
-
-                    return m_blockProcessingQueue.size() > 0;
-                });
-
-            if (m_shouldStop)
+            if (globalIndexes.empty())
             {
-                return;
+                globalIndexes = getGlobalIndexes(block.blockHeight);
             }
-        }
 
-        auto chunk = m_blockProcessingQueue.front_n_and_remove(chunkSize);
+            auto it = globalIndexes.find(input.parentTransactionHash);
 
-        /* Process blocks while we've got more to process */
-        while (!chunk.empty() && !m_shouldStop)
-        {
-            for (const auto &[block, arrivalIndex] : chunk)
-            {
-                Logger::logger.log(
-                    "Processing block " + std::to_string(block.blockHeight), Logger::DEBUG, {Logger::SYNC});
-
-                auto ourInputs = processBlockOutputs(block);
-
-                std::unordered_map<Crypto::Hash, std::vector<uint64_t>> globalIndexes;
+            /* Daemon returns indexes for hashes in a range. If we don't
+               find our hash, either the chain has forked, or the daemon
+               is faulty. Print a warning message, then return so we
+               can fetch new blocks, in the likely case the daemon has
+               forked.
 
-                for (auto &[publicKey, input] : ourInputs)
+               Also need to check there are enough indexes for the one we want */
+            while (it == globalIndexes.end() || it->second.size() <= input.transactionIndex)
+            {
+                if (m_shouldStop)
                 {
-                    if (!m_subWallets->isViewWallet() && !input.globalOutputIndex)
-                    {
-                        if (globalIndexes.empty())
-                        {
-                            globalIndexes = getGlobalIndexes(block.blockHeight);
-                        }
-
-                        auto it = globalIndexes.find(input.parentTransactionHash);
-
-                        /* Daemon returns indexes for hashes in a range. If we don't
-                           find our hash, either the chain has forked, or the daemon
-                           is faulty. Print a warning message, then return so we
-                           can fetch new blocks, in the likely case the daemon has
-                           forked.
-
-                           Also need to check there are enough indexes for the one we want */
-                        while (it == globalIndexes.end() || it->second.size() <= input.transactionIndex)
-                        {
-                            if (m_shouldStop)
-                            {
-                                return;
-                            }
-
-                            Logger::logger.log(
-                                "Warning: Failed to get correct global indexes from daemon."
-                                "\nThe daemon may have gone offline or the chain may have just forked.",
-                                Logger::FATAL,
-                                {Logger::SYNC, Logger::DAEMON});
-
-                            std::this_thread::sleep_for(std::chrono::seconds(5));
-
-                            globalIndexes = getGlobalIndexes(block.blockHeight);
-
-                            it = globalIndexes.find(input.parentTransactionHash);
-                        }
-
-                        input.globalOutputIndex = it->second[input.transactionIndex];
-                    }
+                    return ourInputs;
                 }
 
-                processedBlocks.push_back({block, ourInputs, arrivalIndex});
-            }
+                Logger::logger.log(
+                    "Warning: Failed to get correct global indexes from daemon."
+                    "\nThe daemon may have gone offline or the chain may have just forked.",
+                    Logger::FATAL,
+                    {Logger::SYNC, Logger::DAEMON});
 
-            chunk = m_blockProcessingQueue.front_n_and_remove(chunkSize);
-        }
+                std::this_thread::sleep_for(std::chrono::seconds(5));
 
-        /* Push our processed blocks */
-        if (!processedBlocks.empty())
-        {
-            /* Store this chunks worth of blocks */
-            m_processedBlocks.push_n(processedBlocks.begin(), processedBlocks.end());
+                globalIndexes = getGlobalIndexes(block.blockHeight);
 
-            /* Notify the parent thread we've pushed data to the queue */
-            m_haveProcessedBlocksToHandle.notify_all();
+                it = globalIndexes.find(input.parentTransactionHash);
+            }
 
-            /* Empty the processed blocks */
-            processedBlocks.clear();
+            input.globalOutputIndex = it->second[input.transactionIndex];
         }
-
-        /* Then go back to waiting for more data */
     }
+
+    return ourInputs;
 }
 
 std::vector<std::tuple<Crypto::PublicKey, WalletTypes::TransactionInput>>
-    WalletSynchronizer::processBlockOutputs(const WalletTypes::WalletBlockInfo &block) const
+    WalletSynchronizer::processBlockOutputs(
+        const WalletTypes::WalletBlockInfo &block,
+        const OutputScanner &scanner) const
 {
     std::vector<std::tuple<Crypto::PublicKey, WalletTypes::TransactionInput>> inputs;
 
     if (!Config::config.wallet.skipCoinbaseTransactions && block.coinbaseTransaction)
     {
-        const auto newInputs = processTransactionOutputs(*(block.coinbaseTransaction), block.blockHeight);
+        const auto newInputs = processTransactionOutputs(*(block.coinbaseTransaction), block.blockHeight, scanner);
 
         inputs.insert(inputs.end(), newInputs.begin(), newInputs.end());
     }
 
     for (const auto &tx : block.transactions)
     {
-        const auto newInputs = processTransactionOutputs(tx, block.blockHeight);
+        const auto newInputs = processTransactionOutputs(tx, block.blockHeight, scanner);
 
         inputs.insert(inputs.end(), newInputs.begin(), newInputs.end());
     }
@@ -565,56 +489,38 @@ std::tuple<std::optional<WalletTypes::Transaction>, std::vector<std::tuple<Crypt
 
 std::vector<std::tuple<Crypto::PublicKey, WalletTypes::TransactionInput>> WalletSynchronizer::processTransactionOutputs(
     const WalletTypes::RawCoinbaseTransaction &rawTX,
-    const uint64_t blockHeight) const
+    const uint64_t blockHeight,
+    const OutputScanner &scanner) const
 {
     std::vector<std::tuple<Crypto::PublicKey, WalletTypes::TransactionInput>> inputs;
 
-    Crypto::KeyDerivation derivation;
-
-    Crypto::generate_key_derivation(rawTX.transactionPublicKey, m_privateViewKey, derivation);
-
-    const std::vector<Crypto::PublicKey> spendKeys = m_subWallets->m_publicSpendKeys;
-
-    uint64_t outputIndex = 0;
-
-    for (const auto &output : rawTX.keyOutputs)
+    for (const auto &ownedOutput : scanner.scanTransaction(rawTX))
     {
-        Crypto::PublicKey derivedSpendKey;
-
-        Crypto::underive_public_key(derivation, outputIndex, output.key, derivedSpendKey);
-
-        /* See if the derived spend key matches any of our spend keys */
-        const auto ourSpendKey = std::find(spendKeys.begin(), spendKeys.end(), derivedSpendKey);
-
-        /* If it does, the transaction belongs to us */
-        if (ourSpendKey != spendKeys.end())
-        {
-            /* We need to fill in the key image of the transaction input -
-               we'll let the subwallet do this since we need the private spend
-               key. We use the key images to detect outgoing transactions,
-               and we use the transaction inputs to make transactions ourself */
-            const auto [keyImage, privateEphemeral] =
-                m_subWallets->getTxInputKeyImage(derivedSpendKey, derivation, outputIndex);
-
-            const uint64_t spendHeight = 0;
-
-            const WalletTypes::TransactionInput input(
-                {keyImage,
-                 output.amount,
-                 blockHeight,
-                 rawTX.transactionPublicKey,
-                 outputIndex,
-                 output.globalOutputIndex,
-                 output.key,
-                 spendHeight,
-                 rawTX.unlockTime,
-                 rawTX.hash,
-                 privateEphemeral});
-
-            inputs.emplace_back(derivedSpendKey, input);
-        }
-
-        outputIndex++;
+        const auto &output = rawTX.keyOutputs[ownedOutput.outputIndex];
+
+        /* We need to fill in the key image of the transaction input -
+           we'll let the subwallet do this since we need the private spend
+           key. We use the key images to detect outgoing transactions,
+           and we use the transaction inputs to make transactions ourself */
+        const auto [keyImage, privateEphemeral] = m_subWallets->getTxInputKeyImage(
+            ownedOutput.publicSpendKey, ownedOutput.derivation, ownedOutput.outputIndex);
+
+        const uint64_t spendHeight = 0;
+
+        const WalletTypes::TransactionInput input(
+            {keyImage,
+             output.amount,
+             blockHeight,
+             rawTX.transactionPublicKey,
+             ownedOutput.outputIndex,
+             output.globalOutputIndex,
+             output.key,
+             spendHeight,
+             rawTX.unlockTime,
+             rawTX.hash,
+             privateEphemeral});
+
+        inputs.emplace_back(ownedOutput.publicSpendKey, input);
     }
 
     return inputs;
@@ -643,10 +549,56 @@ std::unordered_map<Crypto::Hash, std::vector<uint64_t>>
     return indexes;
 }
 
+bool WalletSynchronizer::updatePoolTransactions()
+{
+    bool fullSnapshot = false;
+
+    std::vector<Crypto::Hash> addedTransactions;
+
+    std::vector<Crypto::Hash> deletedTransactions;
+
+    if (!m_daemon->getPoolChanges(m_poolEpoch, m_poolCursor, fullSnapshot, addedTransactions, deletedTransactions))
+    {
+        return false;
+    }
+
+    if (fullSnapshot)
+    {
+        m_poolTransactions.clear();
+    }
+
+    m_poolTransactions.insert(addedTransactions.begin(), addedTransactions.end());
+
+    for (const auto &hash : deletedTransactions)
+    {
+        m_poolTransactions.erase(hash);
+    }
+
+    return true;
+}
+
 void WalletSynchronizer::checkLockedTransactions()
 {
     /* Get the hashes of any locked tx's we have */
-    const auto lockedTxHashes = m_subWallets->getLockedTransactionsHashes();
+    auto lockedTxHashes = m_subWallets->getLockedTransactionsHashes();
+
+    /* Locked transactions still in the pool haven't gone anywhere, so we only
+       need to ask the daemon about the rest. If it can't tell us what's in
+       its pool, we ask about all of them. */
+    if (lockedTxHashes.size() != 0 && updatePoolTransactions())
+    {
+        for (auto it = lockedTxHashes.begin(); it != lockedTxHashes.end();)
+        {
+            if (m_poolTransactions.find(*it) != m_poolTransactions.end())
+            {
+                it = lockedTxHashes.erase(it);
+            }
+            else
+            {
+                ++it;
+            }
+        }
+    }
 
     if (lockedTxHashes.size() != 0)
     {
@@ -704,20 +656,13 @@ void WalletSynchronizer::start(const bool startSyncThread)
     }
 
     m_blockDownloader.start();
-    m_blockProcessingQueue.start();
-    m_processedBlocks.start();
+
+    m_threadPool = std::make_unique<Utilities::ThreadPool>(m_threadCount);
 
     if (startSyncThread)
     {
         m_syncThread = std::thread(&WalletSynchronizer::mainLoop, this);
     }
-
-    m_syncThreads.clear();
-
-    for (unsigned int i = 0; i < m_threadCount; i++)
-    {
-        m_syncThreads.push_back(std::thread(&WalletSynchronizer::blockProcessingThread, this));
-    }
 }
 
 void WalletSynchronizer::stop(const bool stopSyncThread)
@@ -729,15 +674,6 @@ void WalletSynchronizer::stop(const bool stopSyncThread)
 
     /* Tell the block downloader to stop and wait for it */
     m_blockDownloader.stop();
-    m_blockProcessingQueue.stop();
-    m_processedBlocks.stop();
-
-    m_haveBlocksToProcess.notify_all();
-    m_haveProcessedBlocksToHandle.notify_all();
-
-    m_blockProcessingQueue.clear();
-    m_processedBlocks.clear();
-
 
     if (stopSyncThread)
     {
@@ -748,14 +684,9 @@ void WalletSynchronizer::stop(const bool stopSyncThread)
         }
     }
 
-    /* Wait for each child thread to finish */
-    for (auto &thread : m_syncThreads)
-    {
-        if (thread.joinable())
-        {
-            thread.join();
-        }
-    }
+    /* The sync thread is no longer submitting work, so we can wait for the
+       pool to finish any remaining jobs and shut it down */
+    m_threadPool.reset();
 }
 
 void WalletSynchronizer::reset(uint64_t startHeight)
@@ -824,6 +755,11 @@ uint64_t WalletSynchronizer::getCurrentScanHeight() const
 void WalletSynchronizer::swapNode(const std::shared_ptr<Nigel> daemon)
 {
     m_daemon = daemon;
+
+    /* The cursor means nothing to another daemon */
+    m_poolTransactions.clear();
+    m_poolEpoch = 0;
+    m_poolCursor = 0;
 }
 
 void WalletSynchronizer::fromJSON(const JSONObject &j)
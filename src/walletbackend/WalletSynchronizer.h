@@ -8,16 +8,14 @@
 #include <memory>
 #include <nigel/Nigel.h>
 #include <subwallets/SubWallets.h>
-#include <utilities/ThreadSafeDeque.h>
-#include <utilities/ThreadSafePriorityQueue.h>
+#include <utilities/ThreadPool.h>
 #include <walletbackend/BlockDownloader.h>
 #include <walletbackend/EventHandler.h>
+#include <walletbackend/OutputScanner.h>
 #include <walletbackend/SynchronizationStatus.h>
 
 typedef std::vector<std::tuple<Crypto::PublicKey, WalletTypes::TransactionInput>> BlockInputsAndOwners;
 
-typedef std::tuple<WalletTypes::WalletBlockInfo, BlockInputsAndOwners, uint32_t> SemiProcessedBlock;
-
 /* Used to store the data we have accumulating when scanning a specific
    block. We can't add the items directly, because we may stop midway
    through. If so, we need to not add anything. */
@@ -34,17 +32,6 @@ struct BlockScanTmpInfo
     std::vector<std::tuple<Crypto::PublicKey, Crypto::KeyImage>> keyImagesToMarkSpent;
 };
 
-class OrderByArrivalIndex
-{
-  public:
-    /* Ordering based on the arrival index of the blocks, not on the block
-       height. This is needed to ensure correct handling of network forks. */
-    bool operator()(SemiProcessedBlock a, SemiProcessedBlock b)
-    {
-        return std::get<2>(a) > std::get<2>(b);
-    }
-};
-
 class WalletSynchronizer
 {
   public:
@@ -118,10 +105,10 @@ class WalletSynchronizer
 
     void mainLoop();
 
-    void blockProcessingThread();
+    BlockInputsAndOwners processBlock(const WalletTypes::WalletBlockInfo &block, const OutputScanner &scanner) const;
 
     std::vector<std::tuple<Crypto::PublicKey, WalletTypes::TransactionInput>>
-        processBlockOutputs(const WalletTypes::WalletBlockInfo &block) const;
+        processBlockOutputs(const WalletTypes::WalletBlockInfo &block, const OutputScanner &scanner) const;
 
     void completeBlockProcessing(
         const WalletTypes::WalletBlockInfo &block,
@@ -142,7 +129,10 @@ class WalletSynchronizer
             const WalletTypes::RawTransaction &tx) const;
 
     std::vector<std::tuple<Crypto::PublicKey, WalletTypes::TransactionInput>>
-        processTransactionOutputs(const WalletTypes::RawCoinbaseTransaction &rawTX, const uint64_t blockHeight) const;
+        processTransactionOutputs(
+            const WalletTypes::RawCoinbaseTransaction &rawTX,
+            const uint64_t blockHeight,
+            const OutputScanner &scanner) const;
 
     std::unordered_map<Crypto::Hash, std::vector<uint64_t>> getGlobalIndexes(const uint64_t blockHeight) const;
 
@@ -150,6 +140,10 @@ class WalletSynchronizer
 
     void checkLockedTransactions();
 
+    /* Brings m_poolTransactions up to date with the daemon. Returns false if
+       the daemon couldn't tell us. */
+    bool updatePoolTransactions();
+
     //////////////////////////////
     /* Private member variables */
     //////////////////////////////
@@ -183,28 +177,18 @@ class WalletSynchronizer
     /* The sub wallets (shared with the main class) */
     std::shared_ptr<SubWallets> m_subWallets;
 
-    /* Stores blocks for processing by processing threads */
-    ThreadSafeDeque<std::tuple<WalletTypes::WalletBlockInfo, uint32_t>> m_blockProcessingQueue;
-
-    /* Synchronizes the child threads waiting for blocks to process
-       and the parent pushing blocks in */
-    std::condition_variable m_haveBlocksToProcess;
-
-    /* Synchronizes the child threads pushing blocks into the priority
-       queue and the parent thread waiting for them all to arrive */
-    std::condition_variable m_haveProcessedBlocksToHandle;
-
-    std::mutex m_mutex;
-
-    /* yeah.... that's a thread safe queue, which holds a block, and it's
-       corresponding inputs, and the subwallet public key that each input
-       belongs to. The blocks which arrived earlier come at the front of
-       the queue. */
-    ThreadSafePriorityQueue<SemiProcessedBlock, OrderByArrivalIndex> m_processedBlocks;
+    /* Scans downloaded blocks for our outputs */
+    std::unique_ptr<Utilities::ThreadPool> m_threadPool;
 
     /* Amount of sync threads to run */
     unsigned int m_threadCount;
 
-    /* Stores thread ids of the block output processing threads */
-    std::vector<std::thread> m_syncThreads;
+    /* Our copy of the hashes in the daemon's pool, kept up to date with just
+       what has changed since we last asked */
+    std::unordered_set<Crypto::Hash> m_poolTransactions;
+
+    /* Where the daemon's pool was when we last asked */
+    uint64_t m_poolEpoch = 0;
+
+    uint64_t m_poolCursor = 0;
 };